@@ -214,6 +214,13 @@ NMCResultCode
 do_agent (NmCli *nmc, int argc, char **argv)
 {
 	next_arg (nmc, &argc, &argv, NULL);
+
+	if (nmc->batch_file && !nmc->complete) {
+		/* the agents keep running and prompt for secrets on stdin. */
+		g_string_printf (nmc->return_text, _("Error: the agents are not available with '--batch'."));
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
 	nmc_do_cmd (nmc, agent_cmds, *argv, argc, argv);
 
 	return nmc->return_value;
@@ -2430,6 +2430,7 @@ typedef struct {
 	NmCli *nmc;
 	NMDevice *device;
 	NMActiveConnection *active;
+	guint timeout_id;
 } ActivateConnectionInfo;
 
 static void
@@ -2541,6 +2542,8 @@ activate_connection_timeout_cb (gpointer user_data)
 {
 	ActivateConnectionInfo *info = user_data;
 
+	info->timeout_id = 0;
+
 	/* Time expired -> exit nmcli */
 	set_nmc_error_timeout (info->nmc);
 	activate_connection_info_finish (info);
@@ -2589,6 +2592,8 @@ progress_active_connection_cb (gpointer user_data)
 static void
 activate_connection_info_finish (ActivateConnectionInfo *info)
 {
+	nm_clear_g_source (&info->timeout_id);
+
 	if (info->device) {
 		g_signal_handlers_disconnect_by_func (info->device, G_CALLBACK (device_state_cb), info);
 		g_object_unref (info->device);
@@ -2662,7 +2667,7 @@ activate_connection_cb (GObject *client, GAsyncResult *result, gpointer user_dat
 			}
 
 			/* Start timer not to loop forever when signals are not emitted */
-			g_timeout_add_seconds (nmc->timeout, activate_connection_timeout_cb, info);
+			info->timeout_id = g_timeout_add_seconds (nmc->timeout, activate_connection_timeout_cb, info);
 		}
 	}
 }
@@ -8288,6 +8293,12 @@ do_connection_edit (NmCli *nmc, int argc, char **argv)
 	if (argc == 1 && nmc->complete)
 		nmc_complete_strings (*argv, "type", "con-name", "id", "uuid", "path",  "filename");
 
+	if (nmc->batch_file && !nmc->complete) {
+		/* the editor reads its commands from stdin, like the batch. */
+		g_string_printf (nmc->return_text, _("Error: the interactive editor is not available with '--batch'."));
+		return NMC_RESULT_ERROR_USER_INPUT;
+	}
+
 	nmc->return_value = NMC_RESULT_SUCCESS;
 
 	if (argc == 1)
@@ -676,6 +676,7 @@ const NmcMetaGenericInfo *const nmc_fields_dev_lldp_list[] = {
                                          "SYSTEM-CAPABILITIES"
 
 static guint progress_id = 0;  /* ID of event source for displaying progress */
+static guint timeout_id = 0;   /* ID of event source for the operation timeout */
 
 static void
 usage (void)
@@ -882,6 +883,7 @@ quit (void)
 {
 	if (nm_clear_g_source (&progress_id))
 		nmc_terminal_erase_line ();
+	nm_clear_g_source (&timeout_id);
 	g_main_loop_quit (loop);
 }
 
@@ -1905,7 +1907,9 @@ add_and_activate_cb (GObject *client,
 	connected_state_cb (g_object_ref (device),
 	                    g_steal_pointer (&active));
 
-	g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);  /* Exit if timeout expires */
+	/* Exit if timeout expires */
+	nm_clear_g_source (&timeout_id);
+	timeout_id = g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);
 
 	if (nmc->nmc_config.print_output == NMC_PRINT_PRETTY)
 		progress_id = g_timeout_add (120, progress_cb, device);
@@ -1993,7 +1997,8 @@ connect_device_cb (GObject *client, GAsyncResult *result, gpointer user_data)
 	                    g_steal_pointer (&active));
 
 	/* Start timer not to loop forever if "notify::state" signal is not issued */
-	g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);
+	nm_clear_g_source (&timeout_id);
+	timeout_id = g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);
 }
 
 static NMCResultCode
@@ -483,9 +483,12 @@ usage_monitor (void)
 	              "Prints a line whenever a change occurs in NetworkManager\n\n"));
 }
 
+static guint timeout_id = 0;  /* ID of event source for the operation timeout */
+
 static void
 quit (void)
 {
+	nm_clear_g_source (&timeout_id);
 	g_main_loop_quit (loop);
 }
 
@@ -620,7 +623,8 @@ show_nm_permissions (NmCli *nmc)
 
 	if (nmc->timeout == -1)
 		nmc->timeout = 10;
-	g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);
+	nm_clear_g_source (&timeout_id);
+	timeout_id = g_timeout_add_seconds (nmc->timeout, timeout_cb, nmc);
 
 	nmc->should_wait++;
 	return TRUE;
@@ -231,6 +231,7 @@ usage (void)
 	              "\n"
 	              "OPTIONS\n"
 	              "  -a, --ask                                ask for missing parameters\n"
+	              "  -b, --batch <file>|-                     run commands read from file or stdin\n"
 	              "  -c, --colors auto|yes|no                 whether to use colors in output\n"
 	              "  -e, --escape yes|no                      escape columns separators in values\n"
 	              "  -f, --fields <field,...>|all|common      specify fields to output\n"
@@ -696,6 +697,94 @@ set_colors (NmcColorOption color_option,
 
 /*************************************************************************************/
 
+/* Runs the commands from @filename (or stdin, for "-") one after another.
+ * All commands share the same NMClient instance, so that the object tree
+ * is only fetched once. Each command is finished before the next one
+ * starts, as the commands share the global state of @nmc. */
+static void
+process_batch (NmCli *nmc, const char *filename)
+{
+	gs_unref_ptrarray GPtrArray *argvs = NULL;
+	gs_free char *line = NULL;
+	size_t line_len = 0;
+	FILE *f;
+	guint lineno = 0;
+	guint n_cmds = 0;
+	guint n_failed = 0;
+	NMCResultCode return_value = NMC_RESULT_SUCCESS;
+
+	if (nm_streq (filename, "-"))
+		f = stdin;
+	else {
+		f = fopen (filename, "re");
+		if (!f) {
+			int errsv = errno;
+
+			g_string_printf (nmc->return_text, _("Error: failed to open batch file '%s': %s."),
+			                 filename, nm_strerror_native (errsv));
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+			return;
+		}
+	}
+
+	/* The command handlers may still reference their argument vector after
+	 * returning (see nmc_do_cmd()). Keep all of them until the end. */
+	argvs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_strfreev);
+
+	while (getline (&line, &line_len, f) >= 0) {
+		gs_free_error GError *error = NULL;
+		char **cmd_argv;
+		int cmd_argc;
+		const char *s;
+
+		lineno++;
+
+		s = nm_strstrip (line);
+		if (   !s[0]
+		    || s[0] == '#')
+			continue;
+
+		n_cmds++;
+
+		if (!g_shell_parse_argv (s, &cmd_argc, &cmd_argv, &error)) {
+			g_printerr (_("Error: line %u: %s\n"), lineno, error->message);
+			return_value = NMC_RESULT_ERROR_USER_INPUT;
+			n_failed++;
+			continue;
+		}
+		g_ptr_array_add (argvs, cmd_argv);
+
+		nmc->return_value = NMC_RESULT_SUCCESS;
+		g_string_assign (nmc->return_text, _("Success"));
+		nmc->should_wait = 0;
+
+		nmc_do_cmd (nmc, nmcli_cmds, cmd_argv[0], cmd_argc, cmd_argv);
+		g_main_loop_run (loop);
+
+		if (nmc->return_value != NMC_RESULT_SUCCESS) {
+			g_printerr (_("Error: line %u: %s\n"), lineno, nmc->return_text->str);
+			return_value = nmc->return_value;
+			n_failed++;
+			if (return_value >= 0x80) {
+				/* terminated by a signal. */
+				break;
+			}
+		}
+	}
+
+	if (f != stdin)
+		fclose (f);
+
+	if (n_failed > 0) {
+		nmc->return_value = return_value;
+		g_string_printf (nmc->return_text, _("Error: %u of %u batch commands failed."),
+		                 n_failed, n_cmds);
+	} else {
+		nmc->return_value = NMC_RESULT_SUCCESS;
+		g_string_assign (nmc->return_text, _("Success"));
+	}
+}
+
 static gboolean
 process_command_line (NmCli *nmc, int argc, char **argv)
 {
@@ -723,7 +812,7 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 
 		if (argc == 1 && nmc->complete) {
 			nmc_complete_strings (argv[0], "--terse", "--pretty", "--mode", "--overview",
-			                               "--colors", "--escape",
+			                               "--colors", "--escape", "--batch",
 			                               "--fields", "--nocheck", "--get-values",
 			                               "--wait", "--version", "--help");
 		}
@@ -815,6 +904,12 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 			 * before the "-g <field>" option (-g may be still more practical and easy to remember than -t -f).
 			*/
 			nmc->mode_specified = TRUE;
+		} else if (matches_arg (nmc, &argc, &argv, "-batch", &value)) {
+			if (argc == 1 && nmc->complete) {
+				nmc->return_value = NMC_RESULT_COMPLETE_FILE;
+				return FALSE;
+			}
+			nmc->batch_file = value;
 		} else if (matches_arg (nmc, &argc, &argv, "-nocheck", NULL)) {
 			/* ignore for backward compatibility */
 		} else if (matches_arg (nmc, &argc, &argv, "-wait", &value)) {
@@ -854,6 +949,24 @@ process_command_line (NmCli *nmc, int argc, char **argv)
 	            &nmc->palette_buffer,
 	            nmc->nmc_config_mutable.palette);
 
+	if (nmc->batch_file) {
+		if (nmc->complete)
+			return FALSE;
+		if (argc) {
+			g_string_printf (nmc->return_text, _("Error: no command is accepted together with '--batch'."));
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+			return FALSE;
+		}
+		if (nmc->ask) {
+			/* the questions would be read from the same input as the commands. */
+			g_string_printf (nmc->return_text, _("Error: '--ask' cannot be used together with '--batch'."));
+			nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+			return FALSE;
+		}
+		process_batch (nmc, nmc->batch_file);
+		return FALSE;
+	}
+
 	/* Now run the requested command */
 	nmc_do_cmd (nmc, nmcli_cmds, *argv, argc, argv);
 
@@ -980,22 +980,13 @@ _print_data_cell_clear (gpointer cell_p)
 	_print_data_cell_clear_text (cell);
 }
 
-static void
-_print_fill (const NmcConfig *nmc_config,
-             gpointer const *targets,
-             gpointer targets_data,
-             const PrintDataCol *cols,
-             guint cols_len,
-             GArray **out_header_row,
-             GArray **out_cells)
+static GArray *
+_print_fill_header (const NmcConfig *nmc_config,
+                    const PrintDataCol *cols,
+                    guint cols_len)
 {
-	GArray *cells;
 	GArray *header_row;
-	guint i_row, i_col;
-	guint targets_len;
-	NMMetaAccessorGetType text_get_type;
-	NMMetaAccessorGetFlags text_get_flags;
-
+	guint i_col;
 
 	header_row = g_array_sized_new (FALSE, TRUE, sizeof (PrintDataHeaderCell), cols_len);
 	g_array_set_clear_func (header_row, _print_data_header_cell_clear);
@@ -1037,102 +1028,135 @@ _print_fill (const NmcConfig *nmc_config,
 		}
 	}
 
-	targets_len = NM_PTRARRAY_LEN (targets);
+	return header_row;
+}
 
-	cells = g_array_sized_new (FALSE, TRUE, sizeof (PrintDataCell), targets_len * header_row->len);
-	g_array_set_clear_func (cells, _print_data_cell_clear);
-	g_array_set_size (cells, targets_len * header_row->len);
+static void
+_print_fill_cell (const NmcConfig *nmc_config,
+                  gpointer target,
+                  gpointer targets_data,
+                  guint i_row,
+                  PrintDataHeaderCell *header_cell,
+                  PrintDataCell *cell)
+{
+	char *to_free = NULL;
+	const NMMetaAbstractInfo *info;
+	NMMetaAccessorGetType text_get_type;
+	NMMetaAccessorGetFlags text_get_flags;
+	NMMetaAccessorGetOutFlags text_out_flags, color_out_flags;
+	gconstpointer value;
+	gboolean is_default;
 
 	text_get_type = nmc_print_output_to_accessor_get_type (nmc_config->print_output);
 	text_get_flags = NM_META_ACCESSOR_GET_FLAGS_ACCEPT_STRV;
 	if (nmc_config->show_secrets)
 		text_get_flags |= NM_META_ACCESSOR_GET_FLAGS_SHOW_SECRETS;
 
+	info = header_cell->col->selection_item->info;
+
+	cell->row_idx = i_row;
+	cell->header_cell = header_cell;
+
+	value = nm_meta_abstract_info_get (info,
+	                                   nmc_meta_environment,
+	                                   nmc_meta_environment_arg,
+	                                   target,
+	                                   targets_data,
+	                                   text_get_type,
+	                                   text_get_flags,
+	                                   &text_out_flags,
+	                                   &is_default,
+	                                   (gpointer *) &to_free);
+
+	nm_assert (!to_free || value == to_free);
+
+	if (   is_default
+	    && (   nmc_config->overview
+	        || NM_FLAGS_HAS (text_out_flags, NM_META_ACCESSOR_GET_OUT_FLAGS_HIDE))) {
+		/* don't mark the entry for display. This is to shorten the output in case
+		 * the property is the default value. But we only do that, if the user
+		 * opts in to this behavior (-overview), or of the property marks itself
+		 * eligible to be hidden.
+		 *
+		 * In general, only new API shall mark itself eligible to be hidden.
+		 * Long established properties cannot, because it would be a change
+		 * in behavior. */
+	} else
+		header_cell->to_print = TRUE;
+
+	if (NM_FLAGS_HAS (text_out_flags, NM_META_ACCESSOR_GET_OUT_FLAGS_STRV)) {
+		if (nmc_config->multiline_output) {
+			cell->text_format = PRINT_DATA_CELL_FORMAT_TYPE_STRV;
+			cell->text.strv = value;
+			cell->text_to_free = !!to_free;
+		} else {
+			if (value && ((const char *const*) value)[0]) {
+				cell->text.plain = g_strjoinv (" | ", (char **) value);
+				cell->text_to_free = TRUE;
+			}
+			if (to_free)
+				g_strfreev ((char **) to_free);
+		}
+	} else {
+		cell->text.plain = value;
+		cell->text_to_free = !!to_free;
+	}
+
+	cell->color = GPOINTER_TO_INT (nm_meta_abstract_info_get (info,
+	                                                          nmc_meta_environment,
+	                                                          nmc_meta_environment_arg,
+	                                                          target,
+	                                                          targets_data,
+	                                                          NM_META_ACCESSOR_GET_TYPE_COLOR,
+	                                                          NM_META_ACCESSOR_GET_FLAGS_NONE,
+	                                                          &color_out_flags,
+	                                                          NULL,
+	                                                          NULL));
+
+	if (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_PLAIN) {
+		if (   NM_IN_SET (nmc_config->print_output, NMC_PRINT_NORMAL, NMC_PRINT_PRETTY)
+		    && (   !cell->text.plain
+		        || !cell->text.plain[0])) {
+			_print_data_cell_clear_text (cell);
+			cell->text.plain = "--";
+		} else if (!cell->text.plain)
+			cell->text.plain = "";
+		nm_assert (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_PLAIN);
+	}
+}
+
+static void
+_print_fill (const NmcConfig *nmc_config,
+             gpointer const *targets,
+             gpointer targets_data,
+             const PrintDataCol *cols,
+             guint cols_len,
+             GArray **out_header_row,
+             GArray **out_cells)
+{
+	GArray *cells;
+	GArray *header_row;
+	guint i_row, i_col;
+	guint targets_len;
+
+	header_row = _print_fill_header (nmc_config, cols, cols_len);
+
+	targets_len = NM_PTRARRAY_LEN (targets);
+
+	cells = g_array_sized_new (FALSE, TRUE, sizeof (PrintDataCell), targets_len * header_row->len);
+	g_array_set_clear_func (cells, _print_data_cell_clear);
+	g_array_set_size (cells, targets_len * header_row->len);
+
 	for (i_row = 0; i_row < targets_len; i_row++) {
-		gpointer target = targets[i_row];
 		PrintDataCell *cells_line = &g_array_index (cells, PrintDataCell, i_row * header_row->len);
 
 		for (i_col = 0; i_col < header_row->len; i_col++) {
-			char *to_free = NULL;
-			PrintDataCell *cell = &cells_line[i_col];
-			PrintDataHeaderCell *header_cell;
-			const NMMetaAbstractInfo *info;
-			NMMetaAccessorGetOutFlags text_out_flags, color_out_flags;
-			gconstpointer value;
-			gboolean is_default;
-
-			header_cell = &g_array_index (header_row, PrintDataHeaderCell, i_col);
-			info = header_cell->col->selection_item->info;
-
-			cell->row_idx = i_row;
-			cell->header_cell = header_cell;
-
-			value = nm_meta_abstract_info_get (info,
-			                                   nmc_meta_environment,
-			                                   nmc_meta_environment_arg,
-			                                   target,
-			                                   targets_data,
-			                                   text_get_type,
-			                                   text_get_flags,
-			                                   &text_out_flags,
-			                                   &is_default,
-			                                   (gpointer *) &to_free);
-
-			nm_assert (!to_free || value == to_free);
-
-			if (   is_default
-			    && (   nmc_config->overview
-			        || NM_FLAGS_HAS (text_out_flags, NM_META_ACCESSOR_GET_OUT_FLAGS_HIDE))) {
-				/* don't mark the entry for display. This is to shorten the output in case
-				 * the property is the default value. But we only do that, if the user
-				 * opts in to this behavior (-overview), or of the property marks itself
-				 * eligible to be hidden.
-				 *
-				 * In general, only new API shall mark itself eligible to be hidden.
-				 * Long established properties cannot, because it would be a change
-				 * in behavior. */
-			} else
-				header_cell->to_print = TRUE;
-
-			if (NM_FLAGS_HAS (text_out_flags, NM_META_ACCESSOR_GET_OUT_FLAGS_STRV)) {
-				if (nmc_config->multiline_output) {
-					cell->text_format = PRINT_DATA_CELL_FORMAT_TYPE_STRV;
-					cell->text.strv = value;
-					cell->text_to_free = !!to_free;
-				} else {
-					if (value && ((const char *const*) value)[0]) {
-						cell->text.plain = g_strjoinv (" | ", (char **) value);
-						cell->text_to_free = TRUE;
-					}
-					if (to_free)
-						g_strfreev ((char **) to_free);
-				}
-			} else {
-				cell->text.plain = value;
-				cell->text_to_free = !!to_free;
-			}
-
-			cell->color = GPOINTER_TO_INT (nm_meta_abstract_info_get (info,
-			                                                          nmc_meta_environment,
-			                                                          nmc_meta_environment_arg,
-			                                                          target,
-			                                                          targets_data,
-			                                                          NM_META_ACCESSOR_GET_TYPE_COLOR,
-			                                                          NM_META_ACCESSOR_GET_FLAGS_NONE,
-			                                                          &color_out_flags,
-			                                                          NULL,
-			                                                          NULL));
-
-			if (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_PLAIN) {
-				if (   NM_IN_SET (nmc_config->print_output, NMC_PRINT_NORMAL, NMC_PRINT_PRETTY)
-				    && (   !cell->text.plain
-				        || !cell->text.plain[0])) {
-					_print_data_cell_clear_text (cell);
-					cell->text.plain = "--";
-				} else if (!cell->text.plain)
-					cell->text.plain = "";
-				nm_assert (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_PLAIN);
-			}
+			_print_fill_cell (nmc_config,
+			                  targets[i_row],
+			                  targets_data,
+			                  i_row,
+			                  &g_array_index (header_row, PrintDataHeaderCell, i_col),
+			                  &cells_line[i_col]);
 		}
 	}
 
@@ -1206,17 +1230,14 @@ _print_skip_column (const NmcConfig *nmc_config,
 }
 
 static void
-_print_do (const NmcConfig *nmc_config,
-           const char *header_name_no_l10n,
-           guint col_len,
-           guint row_len,
-           const PrintDataHeaderCell *header_row,
-           const PrintDataCell *cells)
+_print_do_header (const NmcConfig *nmc_config,
+                  const char *header_name_no_l10n,
+                  guint col_len,
+                  const PrintDataHeaderCell *header_row)
 {
 	int width1, width2;
 	int table_width = 0;
-	guint i_row, i_col;
-	nm_auto_free_gstring GString *str = NULL;
+	guint i_col;
 
 	g_assert (col_len);
 
@@ -1244,13 +1265,11 @@ _print_do (const NmcConfig *nmc_config,
 		g_print ("%s\n", line);
 	}
 
-	str = !nmc_config->multiline_output
-	      ? g_string_sized_new (100)
-	      : NULL;
-
 	/* print the header for the tabular form */
 	if (   NM_IN_SET (nmc_config->print_output, NMC_PRINT_NORMAL, NMC_PRINT_PRETTY)
 	    && !nmc_config->multiline_output) {
+		nm_auto_free_gstring GString *str = g_string_sized_new (100);
+
 		for (i_col = 0; i_col < col_len; i_col++) {
 			const PrintDataHeaderCell *header_cell = &header_row[i_col];
 			const char *title;
@@ -1270,7 +1289,6 @@ _print_do (const NmcConfig *nmc_config,
 		if (str->len)
 			g_string_truncate (str, str->len-1);  /* Chop off last column separator */
 		g_print ("%s\n", str->str);
-		g_string_truncate (str, 0);
 
 		/* Print horizontal separator */
 		if (nmc_config->print_output == NMC_PRINT_PRETTY) {
@@ -1279,93 +1297,207 @@ _print_do (const NmcConfig *nmc_config,
 			g_print ("%s\n", (line = g_strnfill (table_width, '-')));
 		}
 	}
+}
 
-	for (i_row = 0; i_row < row_len; i_row++) {
-		const PrintDataCell *current_line = &cells[i_row * col_len];
+static void
+_print_do_row (const NmcConfig *nmc_config,
+               guint col_len,
+               const PrintDataHeaderCell *header_row,
+               const PrintDataCell *current_line,
+               GString *str)
+{
+	int width1, width2;
+	guint i_col;
 
-		for (i_col = 0; i_col < col_len; i_col++) {
-			const PrintDataCell *cell = &current_line[i_col];
-			const char *const*lines = NULL;
-			guint i_lines, lines_len;
+	for (i_col = 0; i_col < col_len; i_col++) {
+		const PrintDataCell *cell = &current_line[i_col];
+		const char *const*lines = NULL;
+		guint i_lines, lines_len;
 
-			if (_print_skip_column (nmc_config, cell->header_cell))
-				continue;
+		if (_print_skip_column (nmc_config, cell->header_cell))
+			continue;
 
-			lines_len = 0;
-			switch (cell->text_format) {
-			case PRINT_DATA_CELL_FORMAT_TYPE_PLAIN:
-				lines = &cell->text.plain;
-				lines_len = 1;
-				break;
-			case PRINT_DATA_CELL_FORMAT_TYPE_STRV:
-				nm_assert (nmc_config->multiline_output);
-				lines = cell->text.strv;
-				lines_len = NM_PTRARRAY_LEN (lines);
-				break;
-			}
+		lines_len = 0;
+		switch (cell->text_format) {
+		case PRINT_DATA_CELL_FORMAT_TYPE_PLAIN:
+			lines = &cell->text.plain;
+			lines_len = 1;
+			break;
+		case PRINT_DATA_CELL_FORMAT_TYPE_STRV:
+			nm_assert (nmc_config->multiline_output);
+			lines = cell->text.strv;
+			lines_len = NM_PTRARRAY_LEN (lines);
+			break;
+		}
 
-			for (i_lines = 0; i_lines < lines_len; i_lines++) {
-				gs_free char *text_to_free = NULL;
-				const char *text;
+		for (i_lines = 0; i_lines < lines_len; i_lines++) {
+			gs_free char *text_to_free = NULL;
+			const char *text;
 
-				text = colorize_string (nmc_config, cell->color, lines[i_lines], &text_to_free);
-				if (nmc_config->multiline_output) {
-					gs_free char *prefix = NULL;
+			text = colorize_string (nmc_config, cell->color, lines[i_lines], &text_to_free);
+			if (nmc_config->multiline_output) {
+				gs_free char *prefix = NULL;
 
-					if (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_STRV)
-						prefix = g_strdup_printf ("%s[%u]:", cell->header_cell->title, i_lines + 1);
-					else
-						prefix = g_strdup_printf ("%s:", cell->header_cell->title);
-					width1 = strlen (prefix);
-					width2 = nmc_string_screen_width (prefix, NULL);
-					g_print ("%-*s%s\n",
-					         (int) (  nmc_config->print_output == NMC_PRINT_TERSE
-					               ? 0
-					               : ML_VALUE_INDENT+width1-width2),
-					         prefix,
-					         text);
-				} else {
-					nm_assert (str);
-					if (nmc_config->print_output == NMC_PRINT_TERSE) {
-						if (nmc_config->escape_values) {
-							const char *p = text;
-							while (*p) {
-								if (*p == ':' || *p == '\\')
-									g_string_append_c (str, '\\');  /* Escaping by '\' */
-								g_string_append_c (str, *p);
-								p++;
-							}
+				if (cell->text_format == PRINT_DATA_CELL_FORMAT_TYPE_STRV)
+					prefix = g_strdup_printf ("%s[%u]:", cell->header_cell->title, i_lines + 1);
+				else
+					prefix = g_strdup_printf ("%s:", cell->header_cell->title);
+				width1 = strlen (prefix);
+				width2 = nmc_string_screen_width (prefix, NULL);
+				g_print ("%-*s%s\n",
+				         (int) (  nmc_config->print_output == NMC_PRINT_TERSE
+				               ? 0
+				               : ML_VALUE_INDENT+width1-width2),
+				         prefix,
+				         text);
+			} else {
+				nm_assert (str);
+				if (nmc_config->print_output == NMC_PRINT_TERSE) {
+					if (nmc_config->escape_values) {
+						const char *p = text;
+						while (*p) {
+							if (*p == ':' || *p == '\\')
+								g_string_append_c (str, '\\');  /* Escaping by '\' */
+							g_string_append_c (str, *p);
+							p++;
 						}
-						else
-							g_string_append_printf (str, "%s", text);
-						g_string_append_c (str, ':');  /* Column separator */
-					} else {
-						const PrintDataHeaderCell *header_cell = &header_row[i_col];
-
-						width1 = strlen (text);
-						width2 = nmc_string_screen_width (text, NULL);  /* Width of the string (in screen columns) */
-						g_string_append_printf (str, "%-*s", (int) (header_cell->width + width1 - width2), text);
-						g_string_append_c (str, ' ');  /* Column separator */
-						table_width += header_cell->width + width1 - width2 + 1;
 					}
+					else
+						g_string_append_printf (str, "%s", text);
+					g_string_append_c (str, ':');  /* Column separator */
+				} else {
+					const PrintDataHeaderCell *header_cell = &header_row[i_col];
+
+					width1 = strlen (text);
+					width2 = nmc_string_screen_width (text, NULL);  /* Width of the string (in screen columns) */
+					g_string_append_printf (str, "%-*s", (int) (header_cell->width + width1 - width2), text);
+					g_string_append_c (str, ' ');  /* Column separator */
 				}
 			}
 		}
+	}
 
-		if (!nmc_config->multiline_output) {
-			if (str->len)
-				g_string_truncate (str, str->len-1);  /* Chop off last column separator */
-			g_print ("%s\n", str->str);
+	if (!nmc_config->multiline_output) {
+		if (str->len)
+			g_string_truncate (str, str->len-1);  /* Chop off last column separator */
+		g_print ("%s\n", str->str);
+
+		g_string_truncate (str, 0);
+	}
+
+	if (   nmc_config->print_output == NMC_PRINT_PRETTY
+	    && nmc_config->multiline_output) {
+		gs_free char *line = NULL;
+
+		g_print ("%s\n", (line = g_strnfill (ML_HEADER_WIDTH, '-')));
+	}
+}
 
-			g_string_truncate (str, 0);
+static void
+_print_do (const NmcConfig *nmc_config,
+           const char *header_name_no_l10n,
+           guint col_len,
+           guint row_len,
+           const PrintDataHeaderCell *header_row,
+           const PrintDataCell *cells)
+{
+	nm_auto_free_gstring GString *str = NULL;
+	guint i_row;
+
+	_print_do_header (nmc_config, header_name_no_l10n, col_len, header_row);
+
+	str = !nmc_config->multiline_output
+	      ? g_string_sized_new (100)
+	      : NULL;
+
+	for (i_row = 0; i_row < row_len; i_row++)
+		_print_do_row (nmc_config, col_len, header_row, &cells[i_row * col_len], str);
+}
+
+/* Prints the rows one by one, without keeping the cells of all rows in
+ * memory. This is only possible if the column widths don't matter,
+ * that is for terse or multiline output. */
+static void
+_print_stream (const NmcConfig *nmc_config,
+               gpointer const *targets,
+               gpointer targets_data,
+               const char *header_name_no_l10n,
+               const PrintDataCol *cols,
+               guint cols_len)
+{
+	gs_unref_array GArray *header_row = NULL;
+	nm_auto_free_gstring GString *str = NULL;
+	gs_free PrintDataCell *cells_line = NULL;
+	guint targets_len;
+	guint i_row, i_col;
+	guint n_to_print;
+
+	nm_assert (   nmc_config->print_output == NMC_PRINT_TERSE
+	           || nmc_config->multiline_output);
+
+	header_row = _print_fill_header (nmc_config, cols, cols_len);
+	if (header_row->len == 0)
+		return;
+
+	targets_len = NM_PTRARRAY_LEN (targets);
+	cells_line = g_new0 (PrintDataCell, header_row->len);
+
+	/* Whether a column is printed depends on all rows. Find the columns that
+	 * are to be printed upfront. Usually, all columns are marked within the
+	 * first rows, so we can stop early. */
+	n_to_print = 0;
+	for (i_row = 0; i_row < targets_len && n_to_print < header_row->len; i_row++) {
+		for (i_col = 0; i_col < header_row->len; i_col++) {
+			PrintDataHeaderCell *header_cell = &g_array_index (header_row, PrintDataHeaderCell, i_col);
+
+			if (header_cell->to_print)
+				continue;
+			_print_fill_cell (nmc_config,
+			                  targets[i_row],
+			                  targets_data,
+			                  i_row,
+			                  header_cell,
+			                  &cells_line[i_col]);
+			_print_data_cell_clear (&cells_line[i_col]);
+			if (header_cell->to_print)
+				n_to_print++;
 		}
+	}
 
-		if (   nmc_config->print_output == NMC_PRINT_PRETTY
-		    && nmc_config->multiline_output) {
-			gs_free char *line = NULL;
+	_print_do_header (nmc_config,
+	                  header_name_no_l10n,
+	                  header_row->len,
+	                  &g_array_index (header_row, PrintDataHeaderCell, 0));
 
-			g_print ("%s\n", (line = g_strnfill (ML_HEADER_WIDTH, '-')));
+	str = !nmc_config->multiline_output
+	      ? g_string_sized_new (100)
+	      : NULL;
+
+	for (i_row = 0; i_row < targets_len; i_row++) {
+		gboolean to_print_old;
+
+		for (i_col = 0; i_col < header_row->len; i_col++) {
+			PrintDataHeaderCell *header_cell = &g_array_index (header_row, PrintDataHeaderCell, i_col);
+
+			/* the visibility of the columns is already decided. */
+			to_print_old = header_cell->to_print;
+			_print_fill_cell (nmc_config,
+			                  targets[i_row],
+			                  targets_data,
+			                  i_row,
+			                  header_cell,
+			                  &cells_line[i_col]);
+			header_cell->to_print = to_print_old;
 		}
+
+		_print_do_row (nmc_config,
+		               header_row->len,
+		               &g_array_index (header_row, PrintDataHeaderCell, 0),
+		               cells_line,
+		               str);
+
+		for (i_col = 0; i_col < header_row->len; i_col++)
+			_print_data_cell_clear (&cells_line[i_col]);
 	}
 }
 
@@ -1388,6 +1520,18 @@ nmc_print (const NmcConfig *nmc_config,
 	                              error))
 		return FALSE;
 
+	if (   nmc_config->print_output == NMC_PRINT_TERSE
+	    || nmc_config->multiline_output) {
+		/* no column widths needed. Don't build the cells for all rows. */
+		_print_stream (nmc_config,
+		               targets,
+		               targets_data,
+		               header_name_no_l10n,
+		               &g_array_index (cols, PrintDataCol, 0),
+		               cols->len);
+		return TRUE;
+	}
+
 	_print_fill (nmc_config,
 	             targets,
 	             targets_data,
@@ -90,6 +90,7 @@ import socket
 import itertools
 import subprocess
 import shlex
+import tempfile
 import re
 import dbus
 import time
@@ -495,7 +496,8 @@ class TestNmcli(NmTestBase):
                      replace_stderr = None,
                      sort_lines_stdout = False,
                      extra_env = None,
-                     sync_barrier = False):
+                     sync_barrier = False,
+                     check_stdout = None):
         frame = sys._getframe(1)
         for lang in [ 'C', 'pl' ]:
             self._call_nmcli(args,
@@ -510,6 +512,7 @@ class TestNmcli(NmTestBase):
                              sort_lines_stdout,
                              extra_env,
                              sync_barrier,
+                             check_stdout,
                              frame)
 
 
@@ -526,7 +529,8 @@ class TestNmcli(NmTestBase):
                    replace_stderr = None,
                    sort_lines_stdout = False,
                    extra_env = None,
-                   sync_barrier = None):
+                   sync_barrier = None,
+                   check_stdout = None):
 
         frame = sys._getframe(1)
 
@@ -553,6 +557,7 @@ class TestNmcli(NmTestBase):
                              sort_lines_stdout,
                              extra_env,
                              sync_barrier,
+                             check_stdout,
                              frame)
 
     def _call_nmcli(self,
@@ -568,6 +573,7 @@ class TestNmcli(NmTestBase):
                     sort_lines_stdout,
                     extra_env,
                     sync_barrier,
+                    check_stdout,
                     frame):
 
         if sync_barrier:
@@ -673,6 +679,8 @@ class TestNmcli(NmTestBase):
                         self.assertEqual(expected_stdout, stdout)
             if expected_returncode is not None:
                 self.assertEqual(expected_returncode, returncode)
+            if check_stdout is not None:
+                check_stdout(stdout)
 
             if fatal_warnings is _DEFAULT_ARG:
                 if expected_returncode != -5:
@@ -1131,6 +1139,68 @@ class TestNmcli(NmTestBase):
             self.call_nmcli_l(mode + ['dev', 'lldp', 'list', 'ifname', 'eth0'],
                               replace_stdout = replace_stdout)
 
+        # Commands that read from stdin or keep running are rejected in
+        # batch mode, while the other commands of the batch still run.
+        batch_file = tempfile.NamedTemporaryFile(mode = 'w', suffix = '.nmcli', delete = False)
+        try:
+            batch_file.write('# interactive commands\n'
+                             'connection edit con-xx1\n'
+                             'agent secret\n')
+            batch_file.close()
+
+            self.call_nmcli(['--batch', batch_file.name],
+                            expected_returncode = 2,
+                            expected_stdout = b'',
+                            expected_stderr = b"Error: line 2: Error: the interactive editor is not available with '--batch'.\n"
+                                              b"Error: line 3: Error: the agents are not available with '--batch'.\n"
+                                              b"Error: 2 of 2 batch commands failed.\n")
+
+            self.call_nmcli(['--ask', '--batch', batch_file.name],
+                            expected_returncode = 2,
+                            expected_stdout = b'',
+                            expected_stderr = b"Error: '--ask' cannot be used together with '--batch'.\n")
+        finally:
+            os.unlink(batch_file.name)
+
+        # Terse and multiline output print one row at a time, while tabular
+        # output formats all rows first. All of them must show the same rows.
+        def rows_tabular(stdout):
+            return [l.split() for l in stdout.decode('utf-8').splitlines()[1:] if l]
+
+        def rows_terse(stdout):
+            return [[v or '--' for v in l.split(':')] for l in stdout.decode('utf-8').splitlines() if l]
+
+        def rows_multiline(n_cols):
+            def parse(stdout):
+                values = [l.split(':', 1)[1].strip() for l in stdout.decode('utf-8').splitlines() if l]
+                self.assertEqual(len(values) % n_cols, 0)
+                return [values[i:i + n_cols] for i in range(0, len(values), n_cols)]
+            return parse
+
+        for fields, cmd in [ ('DEVICE,TYPE',          ['dev']),
+                             ('NAME,UUID,TYPE,DEVICE', ['con']) ]:
+            rows = {}
+
+            def check(key, parse):
+                def f(stdout):
+                    rows[key] = parse(stdout)
+                    self.assertTrue(rows[key])
+                    self.assertEqual(rows[key], rows['tabular'])
+                return f
+
+            self.call_nmcli(['--mode', 'tabular', '-f', fields] + cmd,
+                            check_on_disk = False,
+                            expected_returncode = 0,
+                            check_stdout = lambda stdout: rows.update(tabular = rows_tabular(stdout)))
+            self.call_nmcli(['--terse', '-f', fields] + cmd,
+                            check_on_disk = False,
+                            expected_returncode = 0,
+                            check_stdout = check('terse', rows_terse))
+            self.call_nmcli(['--mode', 'multiline', '-f', fields] + cmd,
+                            check_on_disk = False,
+                            expected_returncode = 0,
+                            check_stdout = check('multiline', rows_multiline(len(fields.split(',')))))
+
 ###############################################################################
 
 def main():
@@ -0,0 +1,549 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2008 - 2012 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-dispatcher-request.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*****************************************************************************/
+
+/* Requests with "wait" scripts are serialized through a RequestQueue.
+ * By default, there is only one queue (with an empty @iface) for all
+ * requests. In parallel mode, there is one queue per interface, so that
+ * requests for different interfaces don't block each other.
+ *
+ * The queue is ref-counted. @request_queues owns one reference for as long
+ * as the queue is in use, and each enqueued request owns another one. */
+struct RequestQueue {
+	int ref_count;
+	char *iface;
+	Request *current_request;
+	GQueue requests_waiting;
+};
+
+static struct {
+	/* the maximum number of "parallel" scripts that run at the same time
+	 * for one request. A value <= 1 disables parallel mode. */
+	int max_parallel;
+
+	GHashTable *request_queues;
+	int num_requests_pending;
+
+	NMDispatcherRequestCompleteFunc complete_func;
+	NMDispatcherRequestsIdleFunc idle_func;
+} gl;
+
+/*****************************************************************************/
+
+static gboolean dispatch_one_script (Request *request);
+
+/*****************************************************************************/
+
+void
+nm_dispatcher_script_info_free (gpointer ptr)
+{
+	ScriptInfo *info = ptr;
+
+	g_free (info->script);
+	g_free (info->error);
+	g_slice_free (ScriptInfo, info);
+}
+
+static RequestQueue *
+request_queue_ref (RequestQueue *queue)
+{
+	nm_assert (queue);
+	nm_assert (queue->ref_count > 0);
+
+	queue->ref_count++;
+	return queue;
+}
+
+static void
+request_queue_unref (RequestQueue *queue)
+{
+	nm_assert (queue);
+	nm_assert (queue->ref_count > 0);
+
+	if (--queue->ref_count > 0)
+		return;
+
+	/* on shutdown, pending requests are leaked. */
+	g_queue_clear (&queue->requests_waiting);
+	g_free (queue->iface);
+	g_slice_free (RequestQueue, queue);
+}
+
+NM_AUTO_DEFINE_FCN0 (RequestQueue *, _nm_auto_unref_request_queue, request_queue_unref);
+#define nm_auto_unref_request_queue nm_auto (_nm_auto_unref_request_queue)
+
+void
+nm_dispatcher_request_free (Request *request)
+{
+	g_assert_cmpuint (request->num_scripts_done, ==, request->scripts->len);
+	g_assert_cmpuint (request->num_scripts_nowait, ==, 0);
+	g_assert_cmpuint (request->num_scripts_parallel, ==, 0);
+
+	g_free (request->action);
+	g_free (request->iface);
+	g_strfreev (request->envp);
+	g_ptr_array_free (request->scripts, TRUE);
+	nm_clear_pointer (&request->queue, request_queue_unref);
+
+	g_slice_free (Request, request);
+}
+
+static RequestQueue *
+request_queue_get (Request *request)
+{
+	RequestQueue *queue;
+	const char *iface = "";
+
+	if (   gl.max_parallel > 1
+	    && request->iface)
+		iface = request->iface;
+
+	queue = g_hash_table_lookup (gl.request_queues, iface);
+	if (!queue) {
+		queue = g_slice_new0 (RequestQueue);
+		queue->ref_count = 1;
+		queue->iface = g_strdup (iface);
+		g_queue_init (&queue->requests_waiting);
+		g_hash_table_insert (gl.request_queues, queue->iface, queue);
+	}
+	return queue;
+}
+
+/**
+ * next_request:
+ * @queue: the request queue
+ * @request: (allow-none): the request to set as next. If %NULL, dequeue the next
+ * waiting request. Otherwise, try to set the given request.
+ *
+ * Sets the currently active request (@current_request) of @queue. The current request
+ * is a request that has at least on "wait" script, because requests that only
+ * consist of "no-wait" scripts are handled right away and not enqueued to
+ * @requests_waiting nor set as @current_request.
+ *
+ * If @request is %NULL and there are no more requests waiting, @queue gets
+ * removed from @request_queues. It stays alive as long as the caller or
+ * any request still holds a reference.
+ *
+ * Returns: %TRUE, if there was currently not request in process and it set
+ * a new request as current.
+ */
+static gboolean
+next_request (RequestQueue *queue, Request *request)
+{
+	if (request) {
+		nm_assert (!request->queue);
+		request->queue = request_queue_ref (queue);
+		if (queue->current_request) {
+			g_queue_push_tail (&queue->requests_waiting, request);
+			return FALSE;
+		}
+	} else {
+		/* when calling next_request() without explicit @request, we always
+		 * forcefully clear @current_request. That one is certainly
+		 * handled already. */
+		queue->current_request = NULL;
+
+		request = g_queue_pop_head (&queue->requests_waiting);
+		if (!request) {
+			if (g_hash_table_lookup (gl.request_queues, queue->iface) == queue)
+				g_hash_table_remove (gl.request_queues, queue->iface);
+			return FALSE;
+		}
+	}
+
+	_LOG_R_D (request, "start running ordered scripts...");
+
+	queue->current_request = request;
+
+	return TRUE;
+}
+
+/**
+ * complete_request:
+ * @request: the request
+ *
+ * Checks if all the scripts for the request have terminated and in such case
+ * it sends the D-Bus response and releases the request resources.
+ *
+ * It also decreases @num_requests_pending and possibly invokes the idle function.
+ */
+static void
+complete_request (Request *request)
+{
+	GVariantBuilder results;
+	GVariant *ret;
+	guint i;
+
+	nm_assert (request);
+
+	/* Are there still pending scripts? Then do nothing (for now). */
+	if (request->num_scripts_done < request->scripts->len)
+		return;
+
+	g_variant_builder_init (&results, G_VARIANT_TYPE ("a(sus)"));
+	for (i = 0; i < request->scripts->len; i++) {
+		ScriptInfo *script = g_ptr_array_index (request->scripts, i);
+
+		g_variant_builder_add (&results, "(sus)",
+		                       script->script,
+		                       script->result,
+		                       script->error ?: "");
+	}
+
+	ret = g_variant_new ("(a(sus))", &results);
+	gl.complete_func (request, ret);
+
+	_LOG_R_T (request, "completed (%u scripts)", request->scripts->len);
+
+	if (   request->queue
+	    && request->queue->current_request == request)
+		request->queue->current_request = NULL;
+
+	nm_dispatcher_request_free (request);
+
+	g_assert_cmpuint (gl.num_requests_pending, >, 0);
+	if (   --gl.num_requests_pending <= 0
+	    && gl.idle_func)
+		gl.idle_func ();
+}
+
+static void
+complete_script (ScriptInfo *script)
+{
+	nm_auto_unref_request_queue RequestQueue *queue = NULL;
+	Request *request;
+	gboolean wait = script->wait;
+
+	request = script->request;
+
+	/* completing the request drops its reference to the queue. Keep
+	 * our own, for the remainder of the function. */
+	if (request->queue)
+		queue = request_queue_ref (request->queue);
+
+	if (wait) {
+		/* for "wait" scripts, try to schedule the next blocking script.
+		 * If that is successful, return (as we must wait for its completion). */
+		if (dispatch_one_script (request))
+			return;
+	}
+
+	nm_assert (!wait || (queue && queue->current_request == request));
+
+	/* Try to complete the request. @request will be possibly free'd,
+	 * making @script and @request a dangling pointer. */
+	complete_request (request);
+
+	if (!wait) {
+		/* this was a "no-wait" script. We either completed the request,
+		 * or there is nothing to do. Especially, there is no need to
+		 * queue the next_request() -- because no-wait scripts don't block
+		 * requests. However, if this was the last "no-wait" script and
+		 * there are "wait" scripts ready to run, launch them.
+		 *
+		 * Note that a request with "no-wait" scripts only has no @queue and
+		 * might be free'd by now. If the request was current on @queue, it
+		 * is not free'd either, as it still has "wait" scripts. */
+		if (   queue
+		    && queue->current_request == request
+		    && queue->current_request->num_scripts_nowait == 0) {
+
+			if (dispatch_one_script (queue->current_request))
+				return;
+
+			complete_request (queue->current_request);
+		} else
+			return;
+	} else {
+		/* if the script is a "wait" script, we already tried above to
+		 * dispatch the next script. As we didn't do that, it means we
+		 * just completed the last script of @request and we can continue
+		 * with the next request...
+		 *
+		 * Also, it cannot be that there is another request currently being
+		 * processed on this queue because only requests with "wait" scripts can become
+		 * @current_request. As dispatch_one_script() only returns %FALSE
+		 * after all "wait" scripts terminated, it means complete_request() above
+		 * completed @request. */
+		nm_assert (!queue->current_request);
+	}
+
+	while (next_request (queue, NULL)) {
+		request = queue->current_request;
+
+		if (dispatch_one_script (request))
+			return;
+
+		/* Try to complete the request. It will be either completed
+		 * now, or when all pending "no-wait" scripts return. */
+		complete_request (request);
+
+		/* We can immediately start next_request(), because our current
+		 * @request has obviously no more "wait" scripts either.
+		 * Repeat... */
+	}
+}
+
+static void
+script_watch_cb (GPid pid, int status, gpointer user_data)
+{
+	ScriptInfo *script = user_data;
+	guint err;
+
+	g_assert (pid == script->pid);
+
+	script->watch_id = 0;
+	nm_clear_g_source (&script->timeout_id);
+	script->request->num_scripts_done++;
+	if (!script->wait)
+		script->request->num_scripts_nowait--;
+	else if (script->parallel)
+		script->request->num_scripts_parallel--;
+
+	if (WIFEXITED (status)) {
+		err = WEXITSTATUS (status);
+		if (err == 0)
+			script->result = DISPATCH_RESULT_SUCCESS;
+		else {
+			script->error = g_strdup_printf ("Script '%s' exited with error status %d.",
+			                                 script->script, err);
+		}
+	} else if (WIFSTOPPED (status)) {
+		script->error = g_strdup_printf ("Script '%s' stopped unexpectedly with signal %d.",
+		                                 script->script, WSTOPSIG (status));
+	} else if (WIFSIGNALED (status)) {
+		script->error = g_strdup_printf ("Script '%s' died with signal %d",
+		                                 script->script, WTERMSIG (status));
+	} else {
+		script->error = g_strdup_printf ("Script '%s' died from an unknown cause",
+		                                 script->script);
+	}
+
+	if (script->result == DISPATCH_RESULT_SUCCESS) {
+		_LOG_S_T (script, "complete");
+	} else {
+		script->result = DISPATCH_RESULT_FAILED;
+		_LOG_S_W (script, "complete: failed with %s", script->error);
+	}
+
+	g_spawn_close_pid (script->pid);
+
+	complete_script (script);
+}
+
+static gboolean
+script_timeout_cb (gpointer user_data)
+{
+	ScriptInfo *script = user_data;
+
+	script->timeout_id = 0;
+	nm_clear_g_source (&script->watch_id);
+	script->request->num_scripts_done++;
+	if (!script->wait)
+		script->request->num_scripts_nowait--;
+	else if (script->parallel)
+		script->request->num_scripts_parallel--;
+
+	_LOG_S_W (script, "complete: timeout (kill script)");
+
+	kill (script->pid, SIGKILL);
+again:
+	if (waitpid (script->pid, NULL, 0) == -1) {
+		if (errno == EINTR)
+			goto again;
+	}
+
+	script->error = g_strdup_printf ("Script '%s' timed out.", script->script);
+	script->result = DISPATCH_RESULT_TIMEOUT;
+
+	g_spawn_close_pid (script->pid);
+
+	complete_script (script);
+
+	return FALSE;
+}
+
+#define SCRIPT_TIMEOUT 600  /* 10 minutes */
+
+static gboolean
+script_dispatch (ScriptInfo *script)
+{
+	GError *error = NULL;
+	char *argv[4];
+	Request *request = script->request;
+
+	if (script->dispatched)
+		return FALSE;
+
+	script->dispatched = TRUE;
+
+	argv[0] = script->script;
+	argv[1] = request->iface ?: (!strcmp(request->action, NMD_ACTION_HOSTNAME) ? "none" : "");
+	argv[2] = request->action;
+	argv[3] = NULL;
+
+	_LOG_S_T (script, "run script%s",
+	          !script->wait ? " (no-wait)" : (script->parallel ? " (parallel)" : ""));
+
+	if (g_spawn_async ("/", argv, request->envp, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &script->pid, &error)) {
+		script->watch_id = g_child_watch_add (script->pid, (GChildWatchFunc) script_watch_cb, script);
+		script->timeout_id = g_timeout_add_seconds (SCRIPT_TIMEOUT, script_timeout_cb, script);
+		if (!script->wait)
+			request->num_scripts_nowait++;
+		else if (script->parallel)
+			request->num_scripts_parallel++;
+		return TRUE;
+	} else {
+		_LOG_S_W (script, "complete: failed to execute script: %s", error->message);
+		script->result = DISPATCH_RESULT_EXEC_FAILED;
+		script->error = g_strdup (error->message);
+		request->num_scripts_done++;
+		g_clear_error (&error);
+		return FALSE;
+	}
+}
+
+/**
+ * dispatch_one_script:
+ * @request: the request
+ *
+ * Schedules the next "wait" script(s) of @request. Ordered scripts run
+ * one at a time. A consecutive run of "parallel" scripts is started
+ * together, up to @max_parallel scripts at a time, and the next ordered
+ * script only starts after all of them terminated.
+ *
+ * Returns: %TRUE, if there are scripts running and we must wait for
+ * their completion.
+ */
+static gboolean
+dispatch_one_script (Request *request)
+{
+	if (request->num_scripts_nowait > 0)
+		return TRUE;
+
+	while (request->idx < request->scripts->len) {
+		ScriptInfo *script;
+
+		script = g_ptr_array_index (request->scripts, request->idx);
+
+		if (request->num_scripts_parallel > 0) {
+			/* parallel scripts are still running. We can only start
+			 * another parallel script, as long as we don't exceed
+			 * the limit. */
+			if (   !script->parallel
+			    || request->num_scripts_parallel >= gl.max_parallel)
+				return TRUE;
+		}
+
+		request->idx++;
+		if (   script_dispatch (script)
+		    && !script->parallel)
+			return TRUE;
+	}
+	return request->num_scripts_parallel > 0;
+}
+
+/**
+ * nm_dispatcher_request_start:
+ * @request: the request, with at least one script
+ *
+ * Starts the "no-wait" scripts of @request right away, and schedules
+ * its "wait" scripts on the request queue. @request is destroyed after
+ * its complete function was invoked.
+ */
+void
+nm_dispatcher_request_start (Request *request)
+{
+	guint i, num_nowait = 0;
+
+	nm_assert (request->scripts->len > 0);
+
+	gl.num_requests_pending++;
+
+	for (i = 0; i < request->scripts->len; i++) {
+		ScriptInfo *s = g_ptr_array_index (request->scripts, i);
+
+		if (!s->wait) {
+			script_dispatch (s);
+			num_nowait++;
+		}
+	}
+
+	if (num_nowait < request->scripts->len) {
+		nm_auto_unref_request_queue RequestQueue *queue = NULL;
+
+		queue = request_queue_ref (request_queue_get (request));
+
+		/* The request has at least one wait script.
+		 * Try next_request() to schedule the request for
+		 * execution. This either enqueues the request or
+		 * sets it as the current_request of its queue. */
+		if (next_request (queue, request)) {
+			/* @request is now @current_request. Go ahead and
+			 * schedule the first wait script. */
+			if (!dispatch_one_script (request)) {
+				/* If that fails, we might be already finished with the
+				 * request. Try complete_request(). */
+				complete_request (request);
+
+				if (next_request (queue, NULL)) {
+					/* As @request was successfully scheduled as next_request(), there is no
+					 * other request in queue that can be scheduled afterwards. Assert against
+					 * that, but call next_request() to clear current_request. */
+					g_assert_not_reached ();
+				}
+			}
+		}
+	} else {
+		/* The request contains only no-wait scripts. Try to complete
+		 * the request right away (we might have failed to schedule any
+		 * of the scripts). It will be either completed now, or later
+		 * when the pending scripts return.
+		 * We don't enqueue it to a RequestQueue.
+		 * There is no need to handle next_request(), because @request is
+		 * not the current request anyway and does not interfere with requests
+		 * that have any "wait" scripts. */
+		complete_request (request);
+	}
+}
+
+int
+nm_dispatcher_requests_get_num_pending (void)
+{
+	return gl.num_requests_pending;
+}
+
+void
+nm_dispatcher_requests_init (int max_parallel,
+                             NMDispatcherRequestCompleteFunc complete_func,
+                             NMDispatcherRequestsIdleFunc idle_func)
+{
+	g_return_if_fail (!gl.request_queues);
+	g_return_if_fail (complete_func);
+
+	gl.max_parallel = max_parallel;
+	gl.complete_func = complete_func;
+	gl.idle_func = idle_func;
+	gl.num_requests_pending = 0;
+	gl.request_queues = g_hash_table_new_full (nm_str_hash, g_str_equal,
+	                                           NULL, (GDestroyNotify) request_queue_unref);
+}
+
+void
+nm_dispatcher_requests_shutdown (void)
+{
+	nm_clear_pointer (&gl.request_queues, g_hash_table_unref);
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2008 - 2012 Red Hat, Inc.
+ */
+
+#ifndef __NETWORKMANAGER_DISPATCHER_REQUEST_H__
+#define __NETWORKMANAGER_DISPATCHER_REQUEST_H__
+
+#include "nm-libnm-core-aux/nm-dispatcher-api.h"
+
+typedef struct Request Request;
+typedef struct RequestQueue RequestQueue;
+
+typedef struct {
+	Request *request;
+
+	char *script;
+	GPid pid;
+	DispatchResult result;
+	char *error;
+	gboolean wait;
+	gboolean parallel;
+	gboolean dispatched;
+	guint watch_id;
+	guint timeout_id;
+} ScriptInfo;
+
+struct Request {
+	guint request_id;
+
+	GDBusMethodInvocation *context;
+	char *action;
+	char *iface;
+	char **envp;
+	gboolean debug;
+
+	RequestQueue *queue;
+
+	GPtrArray *scripts;  /* list of ScriptInfo */
+	guint idx;
+	int num_scripts_done;
+	int num_scripts_nowait;
+	int num_scripts_parallel;
+};
+
+/*****************************************************************************/
+
+#define __LOG_print(print_cmd, ...) \
+	G_STMT_START { \
+		if (FALSE) { \
+			/* g_message() alone does not warn about invalid format. Add a dummy printf() statement to
+			 * get a compiler warning about wrong format. */ \
+			printf (__VA_ARGS__); \
+		} \
+		print_cmd (__VA_ARGS__); \
+	} G_STMT_END
+
+#define __LOG_print_R(print_cmd, _request, ...) \
+	G_STMT_START { \
+		__LOG_print (print_cmd, \
+		             "req:%u '%s'%s%s%s" _NM_UTILS_MACRO_FIRST (__VA_ARGS__), \
+		             (_request)->request_id, \
+		             (_request)->action, \
+		             (_request)->iface ? " [" : "", \
+		             (_request)->iface ?: "", \
+		             (_request)->iface ? "]" : "" \
+		             _NM_UTILS_MACRO_REST (__VA_ARGS__)); \
+	} G_STMT_END
+
+#define __LOG_print_S(print_cmd, _request, _script, ...) \
+	G_STMT_START { \
+		__LOG_print_R (print_cmd, \
+		               (_request), \
+		               "%s%s%s" _NM_UTILS_MACRO_FIRST (__VA_ARGS__), \
+		               (_script) ? ", \"" : "", \
+		               (_script) ? (_script)->script : "", \
+		               (_script) ? "\"" : "" \
+		               _NM_UTILS_MACRO_REST (__VA_ARGS__)); \
+	} G_STMT_END
+
+#define _LOG_R_(enabled_cmd, x_request, print_cmd, ...) \
+	G_STMT_START { \
+		const Request *const _request = (x_request); \
+		\
+		nm_assert (_request); \
+		if (enabled_cmd) \
+			__LOG_print_R (print_cmd, _request, ": "__VA_ARGS__); \
+	} G_STMT_END
+
+#define _LOG_S_(enabled_cmd, x_script, print_cmd, ...) \
+	G_STMT_START { \
+		const ScriptInfo *const _script = (x_script); \
+		const Request *const _request = _script ? _script->request : NULL; \
+		\
+		nm_assert (_script && _request); \
+		if (enabled_cmd) \
+			__LOG_print_S (print_cmd, _request, _script, ": "__VA_ARGS__); \
+	} G_STMT_END
+
+#define _LOG_R_D_enabled(request) (_NM_ENSURE_TYPE_CONST (Request *, request)->debug)
+#define _LOG_R_T_enabled(request) _LOG_R_D_enabled (request)
+
+#define _LOG_R_T(request, ...) _LOG_R_ (_LOG_R_T_enabled (_request), request, g_debug,   __VA_ARGS__)
+#define _LOG_R_D(request, ...) _LOG_R_ (_LOG_R_D_enabled (_request), request, g_info,    __VA_ARGS__)
+#define _LOG_R_W(request, ...) _LOG_R_ (TRUE,                        request, g_warning, __VA_ARGS__)
+
+#define _LOG_S_T(script, ...)  _LOG_S_ (_LOG_R_T_enabled (_request), script,  g_debug,   __VA_ARGS__)
+#define _LOG_S_D(script, ...)  _LOG_S_ (_LOG_R_D_enabled (_request), script,  g_info,    __VA_ARGS__)
+#define _LOG_S_W(script, ...)  _LOG_S_ (TRUE,                        script,  g_warning, __VA_ARGS__)
+
+/*****************************************************************************/
+
+/* called with the results of a request, right before it gets destroyed. */
+typedef void (*NMDispatcherRequestCompleteFunc) (Request *request, GVariant *results);
+
+/* called when the last pending request completed. */
+typedef void (*NMDispatcherRequestsIdleFunc) (void);
+
+void nm_dispatcher_requests_init (int max_parallel,
+                                  NMDispatcherRequestCompleteFunc complete_func,
+                                  NMDispatcherRequestsIdleFunc idle_func);
+void nm_dispatcher_requests_shutdown (void);
+
+int nm_dispatcher_requests_get_num_pending (void);
+
+void nm_dispatcher_script_info_free (gpointer ptr);
+void nm_dispatcher_request_free (Request *request);
+
+void nm_dispatcher_request_start (Request *request);
+
+#endif  /* __NETWORKMANAGER_DISPATCHER_REQUEST_H__ */
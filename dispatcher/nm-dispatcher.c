@@ -18,11 +18,10 @@
 
 #include "nm-libnm-core-aux/nm-dispatcher-api.h"
 #include "nm-dispatcher-utils.h"
+#include "nm-dispatcher-request.h"
 
 /*****************************************************************************/
 
-typedef struct Request Request;
-
 static struct {
 	GDBusConnection *dbus_connection;
 	GMainLoop *loop;
@@ -33,148 +32,29 @@ static struct {
 	gboolean ever_acquired_name;
 	bool exit_with_failure;
 
-	Request *current_request;
-	GQueue *requests_waiting;
-	int num_requests_pending;
+	/* the maximum number of "parallel" scripts that run at the same time
+	 * for one request. A value <= 1 disables parallel mode. */
+	int max_parallel;
 } gl;
 
-typedef struct {
-	Request *request;
-
-	char *script;
-	GPid pid;
-	DispatchResult result;
-	char *error;
-	gboolean wait;
-	gboolean dispatched;
-	guint watch_id;
-	guint timeout_id;
-} ScriptInfo;
-
-struct Request {
-	guint request_id;
-
-	GDBusMethodInvocation *context;
-	char *action;
-	char *iface;
-	char **envp;
-	gboolean debug;
-
-	GPtrArray *scripts;  /* list of ScriptInfo */
-	guint idx;
-	int num_scripts_done;
-	int num_scripts_nowait;
-};
-
 /*****************************************************************************/
 
-#define __LOG_print(print_cmd, ...) \
-	G_STMT_START { \
-		if (FALSE) { \
-			/* g_message() alone does not warn about invalid format. Add a dummy printf() statement to
-			 * get a compiler warning about wrong format. */ \
-			printf (__VA_ARGS__); \
-		} \
-		print_cmd (__VA_ARGS__); \
-	} G_STMT_END
-
-#define __LOG_print_R(print_cmd, _request, ...) \
-	G_STMT_START { \
-		__LOG_print (print_cmd, \
-		             "req:%u '%s'%s%s%s" _NM_UTILS_MACRO_FIRST (__VA_ARGS__), \
-		             (_request)->request_id, \
-		             (_request)->action, \
-		             (_request)->iface ? " [" : "", \
-		             (_request)->iface ?: "", \
-		             (_request)->iface ? "]" : "" \
-		             _NM_UTILS_MACRO_REST (__VA_ARGS__)); \
-	} G_STMT_END
-
-#define __LOG_print_S(print_cmd, _request, _script, ...) \
-	G_STMT_START { \
-		__LOG_print_R (print_cmd, \
-		               (_request), \
-		               "%s%s%s" _NM_UTILS_MACRO_FIRST (__VA_ARGS__), \
-		               (_script) ? ", \"" : "", \
-		               (_script) ? (_script)->script : "", \
-		               (_script) ? "\"" : "" \
-		               _NM_UTILS_MACRO_REST (__VA_ARGS__)); \
-	} G_STMT_END
-
 #define _LOG_X_(enabled_cmd, print_cmd, ...) \
 	G_STMT_START { \
 		if (enabled_cmd) \
 			__LOG_print (print_cmd, __VA_ARGS__); \
 	} G_STMT_END
 
-#define _LOG_R_(enabled_cmd, x_request, print_cmd, ...) \
-	G_STMT_START { \
-		const Request *const _request = (x_request); \
-		\
-		nm_assert (_request); \
-		if (enabled_cmd) \
-			__LOG_print_R (print_cmd, _request, ": "__VA_ARGS__); \
-	} G_STMT_END
-
-#define _LOG_S_(enabled_cmd, x_script, print_cmd, ...) \
-	G_STMT_START { \
-		const ScriptInfo *const _script = (x_script); \
-		const Request *const _request = _script ? _script->request : NULL; \
-		\
-		nm_assert (_script && _request); \
-		if (enabled_cmd) \
-			__LOG_print_S (print_cmd, _request, _script, ": "__VA_ARGS__); \
-	} G_STMT_END
-
 #define _LOG_X_D_enabled() (gl.debug)
 #define _LOG_X_T_enabled() _LOG_X_D_enabled ()
 
-#define _LOG_R_D_enabled(request) (_NM_ENSURE_TYPE_CONST (Request *, request)->debug)
-#define _LOG_R_T_enabled(request) _LOG_R_D_enabled (request)
-
 #define _LOG_X_T(...)          _LOG_X_ (_LOG_X_T_enabled (),                  g_debug,   __VA_ARGS__)
 #define _LOG_X_D(...)          _LOG_X_ (_LOG_X_D_enabled (),                  g_info,    __VA_ARGS__)
 #define _LOG_X_I(...)          _LOG_X_ (TRUE,                                 g_message, __VA_ARGS__)
 #define _LOG_X_W(...)          _LOG_X_ (TRUE,                                 g_warning, __VA_ARGS__)
 
-#define _LOG_R_T(request, ...) _LOG_R_ (_LOG_R_T_enabled (_request), request, g_debug,   __VA_ARGS__)
-#define _LOG_R_D(request, ...) _LOG_R_ (_LOG_R_D_enabled (_request), request, g_info,    __VA_ARGS__)
-#define _LOG_R_W(request, ...) _LOG_R_ (TRUE,                        request, g_warning, __VA_ARGS__)
-
-#define _LOG_S_T(script, ...)  _LOG_S_ (_LOG_R_T_enabled (_request), script,  g_debug,   __VA_ARGS__)
-#define _LOG_S_D(script, ...)  _LOG_S_ (_LOG_R_D_enabled (_request), script,  g_info,    __VA_ARGS__)
-#define _LOG_S_W(script, ...)  _LOG_S_ (TRUE,                        script,  g_warning, __VA_ARGS__)
-
-/*****************************************************************************/
-
-static gboolean dispatch_one_script (Request *request);
-
 /*****************************************************************************/
 
-static void
-script_info_free (gpointer ptr)
-{
-	ScriptInfo *info = ptr;
-
-	g_free (info->script);
-	g_free (info->error);
-	g_slice_free (ScriptInfo, info);
-}
-
-static void
-request_free (Request *request)
-{
-	g_assert_cmpuint (request->num_scripts_done, ==, request->scripts->len);
-	g_assert_cmpuint (request->num_scripts_nowait, ==, 0);
-
-	g_free (request->action);
-	g_free (request->iface);
-	g_strfreev (request->envp);
-	g_ptr_array_free (request->scripts, TRUE);
-
-	g_slice_free (Request, request);
-}
-
 static gboolean
 quit_timeout_cb (gpointer user_data)
 {
@@ -192,234 +72,10 @@ quit_timeout_reschedule (void)
 	}
 }
 
-/**
- * next_request:
- *
- * @request: (allow-none): the request to set as next. If %NULL, dequeue the next
- * waiting request. Otherwise, try to set the given request.
- *
- * Sets the currently active request (@current_request). The current request
- * is a request that has at least on "wait" script, because requests that only
- * consist of "no-wait" scripts are handled right away and not enqueued to
- * @requests_waiting nor set as @current_request.
- *
- * Returns: %TRUE, if there was currently not request in process and it set
- * a new request as current.
- */
-static gboolean
-next_request (Request *request)
-{
-	if (request) {
-		if (gl.current_request) {
-			g_queue_push_tail (gl.requests_waiting, request);
-			return FALSE;
-		}
-	} else {
-		/* when calling next_request() without explicit @request, we always
-		 * forcefully clear @current_request. That one is certainly
-		 * handled already. */
-		gl.current_request = NULL;
-
-		request = g_queue_pop_head (gl.requests_waiting);
-		if (!request)
-			return FALSE;
-	}
-
-	_LOG_R_D (request, "start running ordered scripts...");
-
-	gl.current_request = request;
-
-	return TRUE;
-}
-
-/**
- * complete_request:
- * @request: the request
- *
- * Checks if all the scripts for the request have terminated and in such case
- * it sends the D-Bus response and releases the request resources.
- *
- * It also decreases @num_requests_pending and possibly does quit_timeout_reschedule().
- */
-static void
-complete_request (Request *request)
-{
-	GVariantBuilder results;
-	GVariant *ret;
-	guint i;
-
-	nm_assert (request);
-
-	/* Are there still pending scripts? Then do nothing (for now). */
-	if (request->num_scripts_done < request->scripts->len)
-		return;
-
-	g_variant_builder_init (&results, G_VARIANT_TYPE ("a(sus)"));
-	for (i = 0; i < request->scripts->len; i++) {
-		ScriptInfo *script = g_ptr_array_index (request->scripts, i);
-
-		g_variant_builder_add (&results, "(sus)",
-		                       script->script,
-		                       script->result,
-		                       script->error ?: "");
-	}
-
-	ret = g_variant_new ("(a(sus))", &results);
-	g_dbus_method_invocation_return_value (request->context, ret);
-
-	_LOG_R_T (request, "completed (%u scripts)", request->scripts->len);
-
-	if (gl.current_request == request)
-		gl.current_request = NULL;
-
-	request_free (request);
-
-	g_assert_cmpuint (gl.num_requests_pending, >, 0);
-	if (--gl.num_requests_pending <= 0) {
-		nm_assert (!gl.current_request && !g_queue_peek_head (gl.requests_waiting));
-		quit_timeout_reschedule ();
-	}
-}
-
-static void
-complete_script (ScriptInfo *script)
-{
-	Request *request;
-	gboolean wait = script->wait;
-
-	request = script->request;
-
-	if (wait) {
-		/* for "wait" scripts, try to schedule the next blocking script.
-		 * If that is successful, return (as we must wait for its completion). */
-		if (dispatch_one_script (request))
-			return;
-	}
-
-	nm_assert (!wait || gl.current_request == request);
-
-	/* Try to complete the request. @request will be possibly free'd,
-	 * making @script and @request a dangling pointer. */
-	complete_request (request);
-
-	if (!wait) {
-		/* this was a "no-wait" script. We either completed the request,
-		 * or there is nothing to do. Especially, there is no need to
-		 * queue the next_request() -- because no-wait scripts don't block
-		 * requests. However, if this was the last "no-wait" script and
-		 * there are "wait" scripts ready to run, launch them.
-		 */
-		if (   gl.current_request == request
-		    && gl.current_request->num_scripts_nowait == 0) {
-
-			if (dispatch_one_script (gl.current_request))
-				return;
-
-			complete_request (gl.current_request);
-		} else
-			return;
-	} else {
-		/* if the script is a "wait" script, we already tried above to
-		 * dispatch the next script. As we didn't do that, it means we
-		 * just completed the last script of @request and we can continue
-		 * with the next request...
-		 *
-		 * Also, it cannot be that there is another request currently being
-		 * processed because only requests with "wait" scripts can become
-		 * @current_request. As there can only be one "wait" script running
-		 * at any time, it means complete_request() above completed @request. */
-		nm_assert (!gl.current_request);
-	}
-
-	while (next_request (NULL)) {
-		request = gl.current_request;
-
-		if (dispatch_one_script (request))
-			return;
-
-		/* Try to complete the request. It will be either completed
-		 * now, or when all pending "no-wait" scripts return. */
-		complete_request (request);
-
-		/* We can immediately start next_request(), because our current
-		 * @request has obviously no more "wait" scripts either.
-		 * Repeat... */
-	}
-}
-
 static void
-script_watch_cb (GPid pid, int status, gpointer user_data)
+request_complete_cb (Request *request, GVariant *results)
 {
-	ScriptInfo *script = user_data;
-	guint err;
-
-	g_assert (pid == script->pid);
-
-	script->watch_id = 0;
-	nm_clear_g_source (&script->timeout_id);
-	script->request->num_scripts_done++;
-	if (!script->wait)
-		script->request->num_scripts_nowait--;
-
-	if (WIFEXITED (status)) {
-		err = WEXITSTATUS (status);
-		if (err == 0)
-			script->result = DISPATCH_RESULT_SUCCESS;
-		else {
-			script->error = g_strdup_printf ("Script '%s' exited with error status %d.",
-			                                 script->script, err);
-		}
-	} else if (WIFSTOPPED (status)) {
-		script->error = g_strdup_printf ("Script '%s' stopped unexpectedly with signal %d.",
-		                                 script->script, WSTOPSIG (status));
-	} else if (WIFSIGNALED (status)) {
-		script->error = g_strdup_printf ("Script '%s' died with signal %d",
-		                                 script->script, WTERMSIG (status));
-	} else {
-		script->error = g_strdup_printf ("Script '%s' died from an unknown cause",
-		                                 script->script);
-	}
-
-	if (script->result == DISPATCH_RESULT_SUCCESS) {
-		_LOG_S_T (script, "complete");
-	} else {
-		script->result = DISPATCH_RESULT_FAILED;
-		_LOG_S_W (script, "complete: failed with %s", script->error);
-	}
-
-	g_spawn_close_pid (script->pid);
-
-	complete_script (script);
-}
-
-static gboolean
-script_timeout_cb (gpointer user_data)
-{
-	ScriptInfo *script = user_data;
-
-	script->timeout_id = 0;
-	nm_clear_g_source (&script->watch_id);
-	script->request->num_scripts_done++;
-	if (!script->wait)
-		script->request->num_scripts_nowait--;
-
-	_LOG_S_W (script, "complete: timeout (kill script)");
-
-	kill (script->pid, SIGKILL);
-again:
-	if (waitpid (script->pid, NULL, 0) == -1) {
-		if (errno == EINTR)
-			goto again;
-	}
-
-	script->error = g_strdup_printf ("Script '%s' timed out.", script->script);
-	script->result = DISPATCH_RESULT_TIMEOUT;
-
-	g_spawn_close_pid (script->pid);
-
-	complete_script (script);
-
-	return FALSE;
+	g_dbus_method_invocation_return_value (request->context, results);
 }
 
 static gboolean
@@ -477,59 +133,6 @@ check_filename (const char *file_name)
 	return TRUE;
 }
 
-#define SCRIPT_TIMEOUT 600  /* 10 minutes */
-
-static gboolean
-script_dispatch (ScriptInfo *script)
-{
-	GError *error = NULL;
-	char *argv[4];
-	Request *request = script->request;
-
-	if (script->dispatched)
-		return FALSE;
-
-	script->dispatched = TRUE;
-
-	argv[0] = script->script;
-	argv[1] = request->iface ?: (!strcmp(request->action, NMD_ACTION_HOSTNAME) ? "none" : "");
-	argv[2] = request->action;
-	argv[3] = NULL;
-
-	_LOG_S_T (script, "run script%s", script->wait ? "" : " (no-wait)");
-
-	if (g_spawn_async ("/", argv, request->envp, G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL, &script->pid, &error)) {
-		script->watch_id = g_child_watch_add (script->pid, (GChildWatchFunc) script_watch_cb, script);
-		script->timeout_id = g_timeout_add_seconds (SCRIPT_TIMEOUT, script_timeout_cb, script);
-		if (!script->wait)
-			request->num_scripts_nowait++;
-		return TRUE;
-	} else {
-		_LOG_S_W (script, "complete: failed to execute script: %s", error->message);
-		script->result = DISPATCH_RESULT_EXEC_FAILED;
-		script->error = g_strdup (error->message);
-		request->num_scripts_done++;
-		g_clear_error (&error);
-		return FALSE;
-	}
-}
-
-static gboolean
-dispatch_one_script (Request *request)
-{
-	if (request->num_scripts_nowait > 0)
-		return TRUE;
-
-	while (request->idx < request->scripts->len) {
-		ScriptInfo *script;
-
-		script = g_ptr_array_index (request->scripts, request->idx++);
-		if (script_dispatch (script))
-			return TRUE;
-	}
-	return FALSE;
-}
-
 static int
 _compare_basenames (gconstpointer a, gconstpointer b)
 {
@@ -634,34 +237,45 @@ find_scripts (Request *request)
 	return g_slist_sort (script_list, _compare_basenames);
 }
 
-static gboolean
-script_must_wait (const char *path)
+static char *
+script_get_link_dir (const char *path)
 {
 	gs_free char *link = NULL;
 	gs_free char *dir = NULL;
-	gs_free char *real = NULL;
 	char *tmp;
 
-
 	link = g_file_read_link (path, NULL);
-	if (link) {
-		if (!g_path_is_absolute (link)) {
-			dir = g_path_get_dirname (path);
-			tmp = g_build_path ("/", dir, link, NULL);
-			g_free (link);
-			g_free (dir);
-			link = tmp;
-		}
-
-		dir = g_path_get_dirname (link);
-		real = realpath (dir, NULL);
-		if (real && !g_str_has_suffix (real, "/no-wait.d"))
-			return FALSE;
+	if (!link)
+		return NULL;
+
+	if (!g_path_is_absolute (link)) {
+		dir = g_path_get_dirname (path);
+		tmp = g_build_path ("/", dir, link, NULL);
+		g_free (link);
+		g_free (dir);
+		link = tmp;
 	}
 
+	dir = g_path_get_dirname (link);
+	return realpath (dir, NULL);
+}
+
+static gboolean
+script_must_wait (const char *link_dir)
+{
+	if (link_dir && !g_str_has_suffix (link_dir, "/no-wait.d"))
+		return FALSE;
 	return TRUE;
 }
 
+static gboolean
+script_is_parallel (const char *link_dir)
+{
+	return    gl.max_parallel > 1
+	       && link_dir
+	       && g_str_has_suffix (link_dir, "/parallel.d");
+}
+
 static void
 _method_call_action (GDBusMethodInvocation *invocation,
                      GVariant *parameters)
@@ -685,7 +299,6 @@ _method_call_action (GDBusMethodInvocation *invocation,
 	GSList *iter;
 	Request *request;
 	char **p;
-	guint i, num_nowait = 0;
 	const char *error_message = NULL;
 
 	g_variant_get (parameters, "("
@@ -744,16 +357,19 @@ _method_call_action (GDBusMethodInvocation *invocation,
 	                                                    &request->iface,
 	                                                    &error_message);
 
-	request->scripts = g_ptr_array_new_full (5, script_info_free);
+	request->scripts = g_ptr_array_new_full (5, nm_dispatcher_script_info_free);
 
 	sorted_scripts = find_scripts (request);
 	for (iter = sorted_scripts; iter; iter = g_slist_next (iter)) {
+		gs_free char *link_dir = NULL;
 		ScriptInfo *s;
 
 		s = g_slice_new0 (ScriptInfo);
 		s->request = request;
 		s->script = iter->data;
-		s->wait = script_must_wait (s->script);
+		link_dir = script_get_link_dir (s->script);
+		s->parallel = script_is_parallel (link_dir);
+		s->wait = s->parallel || script_must_wait (link_dir);
 		g_ptr_array_add (request->scripts, s);
 	}
 	g_slist_free (sorted_scripts);
@@ -776,55 +392,13 @@ _method_call_action (GDBusMethodInvocation *invocation,
 		results = g_variant_new_array (G_VARIANT_TYPE ("(sus)"), NULL, 0);
 		g_dbus_method_invocation_return_value (invocation, g_variant_new ("(@a(sus))", results));
 		request->num_scripts_done = request->scripts->len;
-		request_free (request);
+		nm_dispatcher_request_free (request);
 		return;
 	}
 
 	nm_clear_g_source (&gl.quit_id);
 
-	gl.num_requests_pending++;
-
-	for (i = 0; i < request->scripts->len; i++) {
-		ScriptInfo *s = g_ptr_array_index (request->scripts, i);
-
-		if (!s->wait) {
-			script_dispatch (s);
-			num_nowait++;
-		}
-	}
-
-	if (num_nowait < request->scripts->len) {
-		/* The request has at least one wait script.
-		 * Try next_request() to schedule the request for
-		 * execution. This either enqueues the request or
-		 * sets it as gl.current_request. */
-		if (next_request (request)) {
-			/* @request is now @current_request. Go ahead and
-			 * schedule the first wait script. */
-			if (!dispatch_one_script (request)) {
-				/* If that fails, we might be already finished with the
-				 * request. Try complete_request(). */
-				complete_request (request);
-
-				if (next_request (NULL)) {
-					/* As @request was successfully scheduled as next_request(), there is no
-					 * other request in queue that can be scheduled afterwards. Assert against
-					 * that, but call next_request() to clear current_request. */
-					g_assert_not_reached ();
-				}
-			}
-		}
-	} else {
-		/* The request contains only no-wait scripts. Try to complete
-		 * the request right away (we might have failed to schedule any
-		 * of the scripts). It will be either completed now, or later
-		 * when the pending scripts return.
-		 * We don't enqueue it to gl.requests_waiting.
-		 * There is no need to handle next_request(), because @request is
-		 * not the current request anyway and does not interfere with requests
-		 * that have any "wait" scripts. */
-		complete_request (request);
-	}
+	nm_dispatcher_request_start (request);
 }
 
 static void
@@ -983,6 +557,7 @@ parse_command_line (int *p_argc,
 	GOptionEntry entries[] = {
 		{ "debug", 0, 0, G_OPTION_ARG_NONE, &gl.debug, "Output to console rather than syslog", NULL },
 		{ "persist", 0, 0, G_OPTION_ARG_NONE, &gl.persist, "Don't quit after a short timeout", NULL },
+		{ "parallel", 0, 0, G_OPTION_ARG_INT, &gl.max_parallel, "Run requests for different interfaces in parallel and up to N scripts from parallel.d at the same time", "N" },
 		{ NULL }
 	};
 	gboolean success;
@@ -1037,7 +612,7 @@ main (int argc, char **argv)
 		goto done;
 	}
 
-	gl.requests_waiting = g_queue_new ();
+	nm_dispatcher_requests_init (gl.max_parallel, request_complete_cb, quit_timeout_reschedule);
 
 	dbus_regist_id = g_dbus_connection_register_object (gl.dbus_connection,
 	                                                    NM_DISPATCHER_DBUS_PATH,
@@ -1065,7 +640,7 @@ main (int argc, char **argv)
 
 done:
 
-	if (gl.num_requests_pending > 0) {
+	if (nm_dispatcher_requests_get_num_pending () > 0) {
 		/* this only happens when we quit due to SIGTERM (not due to the idle timer).
 		 *
 		 * Log a warning about pending scripts.
@@ -1077,7 +652,7 @@ done:
 		 * Note that systemd would not terminate NetworkManager-dispatcher before NetworkManager.
 		 * It's NetworkManager's responsibility to keep running long enough so that all requests
 		 * can complete (with a watchdog timer, and a warning that user provided scripts hang). */
-		_LOG_X_W ("exiting but there are still %u requests pending", gl.num_requests_pending);
+		_LOG_X_W ("exiting but there are still %d requests pending", nm_dispatcher_requests_get_num_pending ());
 	}
 
 	if (dbus_own_name_id != 0)
@@ -1086,7 +661,7 @@ done:
 	if (dbus_regist_id != 0)
 		g_dbus_connection_unregister_object (gl.dbus_connection, nm_steal_int (&dbus_regist_id));
 
-	nm_clear_pointer (&gl.requests_waiting, g_queue_free);
+	nm_dispatcher_requests_shutdown ();
 
 	nm_clear_g_source (&signal_id_term);
 	nm_clear_g_source (&signal_id_int);
@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "nm-dispatcher-request.h"
+
+#include "nm-utils/nm-test-utils.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	const char *name;
+	bool wait;
+	bool parallel;
+} TestScript;
+
+static struct {
+	char *tmpdir;
+	GMainLoop *loop;
+	GHashTable *results;
+	guint request_id_counter;
+} gl;
+
+static void
+_complete_cb (Request *request, GVariant *results)
+{
+	g_assert (!g_hash_table_contains (gl.results, GUINT_TO_POINTER (request->request_id)));
+	g_hash_table_insert (gl.results,
+	                     GUINT_TO_POINTER (request->request_id),
+	                     g_variant_ref_sink (results));
+}
+
+static void
+_idle_cb (void)
+{
+	g_main_loop_quit (gl.loop);
+}
+
+static void
+_write_script (const char *name, const char *body)
+{
+	gs_free char *path = NULL;
+	gs_free char *content = NULL;
+
+	path = g_build_filename (gl.tmpdir, name, NULL);
+	content = g_strdup_printf ("#!/bin/sh\n%s\n", body);
+	if (!g_file_set_contents (path, content, -1, NULL))
+		g_assert_not_reached ();
+	g_assert_cmpint (chmod (path, 0755), ==, 0);
+}
+
+static void
+_setup (int max_parallel)
+{
+	gl.tmpdir = g_dir_make_tmp ("nm-test-dispatcher-XXXXXX", NULL);
+	g_assert (gl.tmpdir);
+
+	_write_script ("fast", "exit 0");
+	_write_script ("slow", "sleep 0.3; exit 0");
+	_write_script ("fail", "exit 1");
+
+	gl.loop = g_main_loop_new (NULL, FALSE);
+	gl.results = g_hash_table_new_full (nm_direct_hash, NULL, NULL, (GDestroyNotify) g_variant_unref);
+	nm_dispatcher_requests_init (max_parallel, _complete_cb, _idle_cb);
+}
+
+static void
+_teardown (void)
+{
+	const char *names[] = { "fast", "slow", "fail" };
+	guint i;
+
+	nm_dispatcher_requests_shutdown ();
+	nm_clear_pointer (&gl.results, g_hash_table_unref);
+	nm_clear_pointer (&gl.loop, g_main_loop_unref);
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		gs_free char *path = g_build_filename (gl.tmpdir, names[i], NULL);
+
+		unlink (path);
+	}
+	rmdir (gl.tmpdir);
+	nm_clear_g_free (&gl.tmpdir);
+}
+
+static guint
+_request_start (const char *iface, const TestScript *scripts, guint n_scripts)
+{
+	Request *request;
+	guint i;
+
+	request = g_slice_new0 (Request);
+	request->request_id = ++gl.request_id_counter;
+	request->action = g_strdup ("up");
+	request->iface = g_strdup (iface);
+	request->scripts = g_ptr_array_new_full (n_scripts, nm_dispatcher_script_info_free);
+
+	for (i = 0; i < n_scripts; i++) {
+		ScriptInfo *s;
+
+		s = g_slice_new0 (ScriptInfo);
+		s->request = request;
+		s->script = g_build_filename (gl.tmpdir, scripts[i].name, NULL);
+		s->wait = scripts[i].wait;
+		s->parallel = scripts[i].parallel;
+		g_ptr_array_add (request->scripts, s);
+	}
+
+	nm_dispatcher_request_start (request);
+	return request->request_id;
+}
+
+static void
+_run (void)
+{
+	if (nm_dispatcher_requests_get_num_pending () > 0)
+		g_assert (nmtst_main_loop_run (gl.loop, 5000));
+	g_assert_cmpint (nm_dispatcher_requests_get_num_pending (), ==, 0);
+}
+
+static void
+_assert_results (guint request_id, const DispatchResult *expected, guint n_expected)
+{
+	gs_unref_variant GVariant *results = NULL;
+	GVariant *value;
+	GVariantIter iter;
+	const char *script;
+	const char *error;
+	guint32 result;
+	guint i = 0;
+
+	value = g_hash_table_lookup (gl.results, GUINT_TO_POINTER (request_id));
+	g_assert (value);
+
+	results = g_variant_get_child_value (value, 0);
+	g_variant_iter_init (&iter, results);
+	while (g_variant_iter_next (&iter, "(&su&s)", &script, &result, &error)) {
+		g_assert_cmpint (i, <, n_expected);
+		g_assert_cmpint (result, ==, expected[i]);
+		i++;
+	}
+	g_assert_cmpint (i, ==, n_expected);
+}
+
+/*****************************************************************************/
+
+static void
+test_mixed_wait_nowait (void)
+{
+	static const TestScript scripts1[] = {
+		{ "slow",            FALSE, FALSE },
+		{ "fast",            TRUE,  FALSE },
+		{ "fail",            FALSE, FALSE },
+		{ "fail",            TRUE,  FALSE },
+	};
+	static const TestScript scripts2[] = {
+		{ "fast",            TRUE,  FALSE },
+		{ "slow",            FALSE, FALSE },
+	};
+	static const DispatchResult expected1[] = {
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_FAILED,
+		DISPATCH_RESULT_FAILED,
+	};
+	static const DispatchResult expected2[] = {
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+	};
+	guint id1, id2;
+
+	_setup (0);
+
+	/* both requests share the single queue. The second one must only
+	 * start its "wait" scripts after the first completed. */
+	id1 = _request_start ("eth0", scripts1, G_N_ELEMENTS (scripts1));
+	id2 = _request_start ("eth1", scripts2, G_N_ELEMENTS (scripts2));
+	_run ();
+
+	_assert_results (id1, expected1, G_N_ELEMENTS (expected1));
+	_assert_results (id2, expected2, G_N_ELEMENTS (expected2));
+
+	_teardown ();
+}
+
+static void
+test_exec_failed (void)
+{
+	static const TestScript scripts1[] = {
+		{ "slow",            FALSE, FALSE },
+		{ "does-not-exist",  TRUE,  FALSE },
+	};
+	static const TestScript scripts2[] = {
+		{ "does-not-exist",  TRUE,  FALSE },
+		{ "fast",            TRUE,  FALSE },
+	};
+	static const DispatchResult expected1[] = {
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_EXEC_FAILED,
+	};
+	static const DispatchResult expected2[] = {
+		DISPATCH_RESULT_EXEC_FAILED,
+		DISPATCH_RESULT_SUCCESS,
+	};
+	guint id1, id2;
+
+	_setup (0);
+
+	/* the last "wait" script fails to start after the "no-wait" script
+	 * completed. That completes the request and drops the queue, while
+	 * it is still in use. */
+	id1 = _request_start (NULL, scripts1, G_N_ELEMENTS (scripts1));
+	_run ();
+	_assert_results (id1, expected1, G_N_ELEMENTS (expected1));
+
+	/* the queue is re-created for the next request. */
+	id2 = _request_start (NULL, scripts2, G_N_ELEMENTS (scripts2));
+	_run ();
+	_assert_results (id2, expected2, G_N_ELEMENTS (expected2));
+
+	_teardown ();
+}
+
+static void
+test_parallel (void)
+{
+	static const TestScript scripts[] = {
+		{ "slow",            FALSE, FALSE },
+		{ "fast",            TRUE,  FALSE },
+		{ "slow",            TRUE,  TRUE  },
+		{ "fail",            TRUE,  TRUE  },
+		{ "slow",            TRUE,  TRUE  },
+		{ "fast",            TRUE,  FALSE },
+		{ "fast",            FALSE, FALSE },
+	};
+	static const DispatchResult expected[] = {
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_FAILED,
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+		DISPATCH_RESULT_SUCCESS,
+	};
+	guint ids[6];
+	guint i;
+
+	_setup (2);
+
+	/* two requests per interface, each queue runs independently. */
+	for (i = 0; i < G_N_ELEMENTS (ids); i++)
+		ids[i] = _request_start (i % 3 == 0 ? "eth0" : (i % 3 == 1 ? "eth1" : NULL),
+		                         scripts,
+		                         G_N_ELEMENTS (scripts));
+	_run ();
+
+	for (i = 0; i < G_N_ELEMENTS (ids); i++)
+		_assert_results (ids[i], expected, G_N_ELEMENTS (expected));
+
+	_teardown ();
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init (&argc, &argv, TRUE);
+
+	g_test_add_func ("/dispatcher/request/mixed-wait-nowait", test_mixed_wait_nowait);
+	g_test_add_func ("/dispatcher/request/exec-failed", test_exec_failed);
+	g_test_add_func ("/dispatcher/request/parallel", test_parallel);
+
+	return g_test_run ();
+}
@@ -525,6 +525,8 @@ typedef enum {
 
 NMBondMode _nm_setting_bond_mode_from_string (const char *str);
 gboolean _nm_setting_bond_option_supported (const char *option, NMBondMode mode);
+gboolean _nm_setting_bond_option_to_uint (const char *name, const char *value, guint *out_value);
+const char *_nm_setting_bond_option_uint_to_name (const char *name, guint value);
 
 /*****************************************************************************/
 
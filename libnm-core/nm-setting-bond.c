@@ -484,6 +484,95 @@ _nm_setting_bond_mode_from_string (const char *str)
 	return NM_BOND_MODE_UNKNOWN;
 }
 
+static const BondDefault *
+_get_default (const char *name)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (defaults); i++) {
+		if (nm_streq (defaults[i].opt, name))
+			return &defaults[i];
+	}
+	return NULL;
+}
+
+/**
+ * _nm_setting_bond_option_to_uint:
+ * @name: the name of a numeric bond option
+ * @value: the value of the option
+ * @out_value: (out): the value as understood by kernel
+ *
+ * Converts the value of an option of type %NM_BOND_OPTION_TYPE_INT
+ * or %NM_BOND_OPTION_TYPE_BOTH to the number that kernel uses for
+ * it. For options that accept a name, the kernel value is the index
+ * of the name in the list of valid values.
+ *
+ * Returns: %TRUE if @value could be converted.
+ */
+gboolean
+_nm_setting_bond_option_to_uint (const char *name, const char *value, guint *out_value)
+{
+	const BondDefault *def;
+	guint64 num;
+	guint i;
+
+	g_return_val_if_fail (name, FALSE);
+
+	if (!value || !value[0])
+		return FALSE;
+
+	def = _get_default (name);
+	if (   !def
+	    || !NM_IN_SET (def->opt_type, NM_BOND_OPTION_TYPE_INT,
+	                                  NM_BOND_OPTION_TYPE_BOTH))
+		return FALSE;
+
+	if (NM_STRCHAR_ALL (value, ch, g_ascii_isdigit (ch))) {
+		num = _nm_utils_ascii_str_to_uint64 (value, 10, def->min, def->max, G_MAXUINT64);
+		if (num == G_MAXUINT64)
+			return FALSE;
+		NM_SET_OUT (out_value, num);
+		return TRUE;
+	}
+
+	if (def->opt_type == NM_BOND_OPTION_TYPE_BOTH) {
+		for (i = 0; i < G_N_ELEMENTS (def->list) && def->list[i]; i++) {
+			if (nm_streq (def->list[i], value)) {
+				NM_SET_OUT (out_value, i);
+				return TRUE;
+			}
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * _nm_setting_bond_option_uint_to_name:
+ * @name: the name of a bond option of type %NM_BOND_OPTION_TYPE_BOTH
+ * @value: the value as reported by kernel
+ *
+ * The reverse of _nm_setting_bond_option_to_uint() for options that
+ * accept a name.
+ *
+ * Returns: the name of @value or %NULL.
+ */
+const char *
+_nm_setting_bond_option_uint_to_name (const char *name, guint value)
+{
+	const BondDefault *def;
+
+	g_return_val_if_fail (name, NULL);
+
+	def = _get_default (name);
+	if (   !def
+	    || def->opt_type != NM_BOND_OPTION_TYPE_BOTH
+	    || value >= G_N_ELEMENTS (def->list))
+		return NULL;
+
+	return def->list[value];
+}
+
 /*****************************************************************************/
 
 #define BIT(x) (1 << (x))
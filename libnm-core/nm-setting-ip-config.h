@@ -142,6 +142,17 @@ gboolean     nm_ip_route_attribute_validate  (const char *name,
 #define NM_IP_ROUTE_ATTRIBUTE_LOCK_INITCWND  "lock-initcwnd"
 #define NM_IP_ROUTE_ATTRIBUTE_LOCK_INITRWND  "lock-initrwnd"
 #define NM_IP_ROUTE_ATTRIBUTE_LOCK_MTU       "lock-mtu"
+/**
+ * NM_IP_ROUTE_ATTRIBUTE_NHID:
+ *
+ * The ID of a kernel nexthop object that the route references, like
+ * "nhid" of iproute2. The nexthop object provides the gateway and is
+ * not managed by the profile, it must be created by other means. Routes
+ * with this attribute are configured without gateway.
+ *
+ * Since: 1.22
+ */
+#define NM_IP_ROUTE_ATTRIBUTE_NHID           "nhid"
 
 /*****************************************************************************/
 
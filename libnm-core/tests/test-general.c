@@ -1061,6 +1061,50 @@ test_dedup_multi (void)
 	nm_dedup_multi_index_unref (idx);
 }
 
+static void
+test_dedup_multi_many (void)
+{
+	const guint N = 3000;
+	NMDedupMultiIndex *idx;
+	DedupIdxType IDX_10_a_stack;
+	const DedupIdxType *const IDX_10_a = DEDUP_IDX_TYPE_INIT (&IDX_10_a_stack, 10, 1000000);
+	gs_free guint *vals = NULL;
+	guint i;
+
+	idx = nm_dedup_multi_index_new ();
+
+	vals = g_new (guint, N);
+	for (i = 0; i < N; i++)
+		vals[i] = i + 1;
+
+	/* add and remove many objects in random order, to exercise resizing
+	 * and removal of the index' hash tables. */
+	for (i = 0; i < N; i++)
+		g_assert (_dedup_idx_add (idx, IDX_10_a, DEDUP_OBJ_INIT (vals[i], 1), NM_DEDUP_MULTI_IDX_MODE_APPEND, NULL));
+
+	nmtst_rand_perm (NULL, vals, NULL, sizeof (vals[0]), N);
+
+	for (i = 0; i < N; i++) {
+		g_assert (nm_dedup_multi_index_lookup_obj (idx, (NMDedupMultiIdxType *) IDX_10_a, DEDUP_OBJ_INIT (vals[i], 1)));
+		g_assert (nm_dedup_multi_index_obj_find (idx, DEDUP_OBJ_INIT (vals[i], 1)));
+	}
+
+	for (i = 0; i < N / 2; i++)
+		g_assert_cmpint (nm_dedup_multi_index_remove_obj (idx, (NMDedupMultiIdxType *) IDX_10_a, DEDUP_OBJ_INIT (vals[i], 1), NULL), ==, 1);
+
+	for (i = 0; i < N; i++) {
+		if (i < N / 2) {
+			g_assert (!nm_dedup_multi_index_lookup_obj (idx, (NMDedupMultiIdxType *) IDX_10_a, DEDUP_OBJ_INIT (vals[i], 1)));
+			g_assert (!nm_dedup_multi_index_obj_find (idx, DEDUP_OBJ_INIT (vals[i], 1)));
+		} else {
+			g_assert (nm_dedup_multi_index_lookup_obj (idx, (NMDedupMultiIdxType *) IDX_10_a, DEDUP_OBJ_INIT (vals[i], 1)));
+			g_assert (nm_dedup_multi_index_obj_find (idx, DEDUP_OBJ_INIT (vals[i], 1)));
+		}
+	}
+
+	nm_dedup_multi_index_unref (idx);
+}
+
 /*****************************************************************************/
 
 static NMConnection *
@@ -1681,6 +1725,10 @@ test_setting_ip_route_attributes (void)
 	TEST_ATTR ("lock-mtu", boolean, TRUE, AF_INET, TRUE,  TRUE);
 	TEST_ATTR ("lock-mtu", uint32,  1,    AF_INET, FALSE, TRUE);
 
+	TEST_ATTR ("nhid", uint32, 4711, AF_INET,  TRUE,  TRUE);
+	TEST_ATTR ("nhid", uint32, 4711, AF_INET6, TRUE,  TRUE);
+	TEST_ATTR ("nhid", string, "4711", AF_INET, FALSE, TRUE);
+
 	TEST_ATTR ("from", string, "fd01::1",     AF_INET6, TRUE,  TRUE);
 	TEST_ATTR ("from", string, "fd01::1/64",  AF_INET6, TRUE,  TRUE);
 	TEST_ATTR ("from", string, "fd01::1/128", AF_INET6, TRUE,  TRUE);
@@ -7928,6 +7976,18 @@ test_route_attributes_parse (void)
 	g_assert (g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING));
 	g_assert_cmpstr (g_variant_get_string (variant, NULL), ==, "fd01::42/64");
 	g_hash_table_unref (ht);
+
+	ht = nm_utils_parse_variant_attributes ("nhid=4711 mtu=1400",
+	                                        ' ', '=', FALSE,
+	                                        nm_ip_route_get_variant_attribute_spec (),
+	                                        &error);
+	g_assert_no_error (error);
+	g_assert (ht);
+	variant = g_hash_table_lookup (ht, NM_IP_ROUTE_ATTRIBUTE_NHID);
+	g_assert (variant);
+	g_assert (g_variant_is_of_type (variant, G_VARIANT_TYPE_UINT32));
+	g_assert_cmpuint (g_variant_get_uint32 (variant), ==, 4711);
+	g_hash_table_unref (ht);
 }
 
 static void
@@ -8098,6 +8158,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/general/test_nm_g_slice_free_fcn", test_nm_g_slice_free_fcn);
 	g_test_add_func ("/core/general/test_c_list_sort", test_c_list_sort);
 	g_test_add_func ("/core/general/test_dedup_multi", test_dedup_multi);
+	g_test_add_func ("/core/general/test_dedup_multi_many", test_dedup_multi_many);
 	g_test_add_func ("/core/general/test_utils_str_utf8safe", test_utils_str_utf8safe);
 	g_test_add_func ("/core/general/test_nm_utils_strsplit_set", test_nm_utils_strsplit_set);
 	g_test_add_func ("/core/general/test_nm_in_set", test_nm_in_set);
@@ -639,6 +639,56 @@ test_bond_compare (void)
 	                           ((const char *[]){ "num_unsol_na", "4", "num_grat_arp", "4", NULL }));
 }
 
+static void
+_assert_bond_option_uint (const char *name, const char *value, guint expected)
+{
+	guint v = G_MAXUINT;
+
+	g_assert (_nm_setting_bond_option_to_uint (name, value, &v));
+	g_assert_cmpuint (v, ==, expected);
+	if (!g_ascii_isdigit (value[0]))
+		g_assert_cmpstr (_nm_setting_bond_option_uint_to_name (name, expected), ==, value);
+}
+
+static void
+test_bond_option_uint (void)
+{
+	guint v;
+
+	/* the kernel's numeric values of named options are the index in our
+	 * list of valid values. Pin them, they must match the kernel's enums. */
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_MODE, "balance-rr", 0);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_MODE, "active-backup", 1);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_MODE, "802.3ad", 4);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_MODE, "balance-alb", 6);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "layer2", 0);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "layer3+4", 1);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "layer2+3", 2);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "encap3+4", 4);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_ARP_VALIDATE, "none", 0);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_ARP_VALIDATE, "filter", 4);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_ARP_VALIDATE, "filter_backup", 6);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_PRIMARY_RESELECT, "failure", 2);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_FAIL_OVER_MAC, "follow", 2);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_AD_SELECT, "count", 2);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_LACP_RATE, "fast", 1);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_ARP_ALL_TARGETS, "all", 1);
+
+	/* numeric values are accepted within the range. */
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "3", 3);
+	_assert_bond_option_uint (NM_SETTING_BOND_OPTION_MIIMON, "100", 100);
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "5", &v));
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_RESEND_IGMP, "256", &v));
+
+	/* invalid names and options that are not numeric. */
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, "layer4", &v));
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_MIIMON, "fast", &v));
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_PRIMARY, "eth0", &v));
+	g_assert (!_nm_setting_bond_option_to_uint (NM_SETTING_BOND_OPTION_MIIMON, "", &v));
+	g_assert (!_nm_setting_bond_option_uint_to_name (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY, 5));
+	g_assert (!_nm_setting_bond_option_uint_to_name (NM_SETTING_BOND_OPTION_MIIMON, 0));
+}
+
 static void
 test_bond_normalize_options (const char **opts1, const char **opts2)
 {
@@ -3608,6 +3658,7 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/libnm/settings/bond/verify", test_bond_verify);
 	g_test_add_func ("/libnm/settings/bond/compare", test_bond_compare);
+	g_test_add_func ("/libnm/settings/bond/option-uint", test_bond_option_uint);
 	g_test_add_func ("/libnm/settings/bond/normalize", test_bond_normalize);
 
 	g_test_add_func ("/libnm/settings/dcb/flags-valid", test_dcb_flags_valid);
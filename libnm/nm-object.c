@@ -740,6 +740,50 @@ out:
 	g_free (prop_name);
 }
 
+typedef struct {
+	NMObject *self;
+	GDBusProxy *proxy;
+	char **invalidated_properties;
+} InvalidatedPropertiesData;
+
+static void
+invalidated_properties_cb (GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	InvalidatedPropertiesData *data = user_data;
+	gs_unref_variant GVariant *ret = NULL;
+	gs_unref_variant GVariant *properties = NULL;
+	gs_free_error GError *error = NULL;
+	guint i;
+
+	ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (!ret) {
+		dbgmsg ("%s: failed to fetch invalidated properties of %s: %s",
+		        __func__,
+		        g_dbus_proxy_get_object_path (data->proxy),
+		        error->message);
+		goto out;
+	}
+
+	g_variant_get (ret, "(@a{sv})", &properties);
+	for (i = 0; data->invalidated_properties[i]; i++) {
+		const char *name = data->invalidated_properties[i];
+		gs_unref_variant GVariant *value = NULL;
+
+		value = g_variant_lookup_value (properties, name, NULL);
+		if (!value)
+			continue;
+
+		g_dbus_proxy_set_cached_property (data->proxy, name, value);
+		handle_property_changed (data->self, name, value);
+	}
+
+out:
+	g_strfreev (data->invalidated_properties);
+	g_object_unref (data->proxy);
+	g_object_unref (data->self);
+	g_slice_free (InvalidatedPropertiesData, data);
+}
+
 static void
 properties_changed (GDBusProxy *proxy,
                     GVariant   *changed_properties,
@@ -747,6 +791,7 @@ properties_changed (GDBusProxy *proxy,
                     gpointer    user_data)
 {
 	NMObject *self = NM_OBJECT (user_data);
+	InvalidatedPropertiesData *data;
 	GVariantIter iter;
 	const char *name;
 	GVariant *value;
@@ -756,6 +801,30 @@ properties_changed (GDBusProxy *proxy,
 		handle_property_changed (self, name, value);
 		g_variant_unref (value);
 	}
+
+	if (!invalidated_properties || !invalidated_properties[0])
+		return;
+
+	/* NetworkManager only invalidates properties whose values are too
+	 * large to send with every change (see "dbus-large-property-threshold"
+	 * in NetworkManager.conf). Fetch them, so that the object stays
+	 * up to date. */
+	data = g_slice_new (InvalidatedPropertiesData);
+	data->self = g_object_ref (self);
+	data->proxy = g_object_ref (proxy);
+	data->invalidated_properties = g_strdupv (invalidated_properties);
+	g_dbus_connection_call (g_dbus_proxy_get_connection (proxy),
+	                        g_dbus_proxy_get_name (proxy),
+	                        g_dbus_proxy_get_object_path (proxy),
+	                        DBUS_INTERFACE_PROPERTIES,
+	                        "GetAll",
+	                        g_variant_new ("(s)", g_dbus_proxy_get_interface_name (proxy)),
+	                        G_VARIANT_TYPE ("(a{sv})"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        NULL,
+	                        invalidated_properties_cb,
+	                        data);
 }
 
 #define HANDLE_TYPE(vtype, ctype, getter) \
@@ -26,12 +26,213 @@ typedef struct {
 	bool lookup_head;
 } LookupEntry;
 
+/* HSet is a minimal hash set with open addressing (linear probing) that is
+ * used for the two dictionaries of the index. Compared to GHashTable, it keeps
+ * the hash next to the key in one array (GHashTable has separate arrays for
+ * hashes, keys and values), which saves memory and most calls to the equal
+ * function. Removal uses backward-shift deletion, so there are no tombstones.
+ *
+ * The functions are inline and take the hash and equal functions as
+ * arguments, so that they get specialized for each dictionary. */
+
+typedef guint (*HSetHashFunc) (gconstpointer key);
+typedef gboolean (*HSetEqualFunc) (gconstpointer key_a, gconstpointer key_b);
+
+typedef struct {
+	gconstpointer key;
+	guint hash;
+} HSetSlot;
+
+typedef struct {
+	/* the number of slots is always a power of two (or zero). */
+	HSetSlot *slots;
+	guint n_slots;
+	guint size;
+} HSet;
+
+#define HSET_MIN_SLOTS 8u
+
+static inline gboolean
+_hset_needs_grow (const HSet *set)
+{
+	/* keep the load factor below 3/4 */
+	return ((guint64) set->size + 1u) * 4u > ((guint64) set->n_slots) * 3u;
+}
+
+static inline gboolean
+_hset_needs_shrink (const HSet *set)
+{
+	return    set->n_slots > HSET_MIN_SLOTS
+	       && set->size < set->n_slots / 8u;
+}
+
+static inline void
+_hset_insert_slot (HSetSlot *slots, guint mask, gconstpointer key, guint hash)
+{
+	guint i;
+
+	for (i = hash & mask; slots[i].key; i = (i + 1u) & mask) {
+		/* pass */
+	}
+	slots[i].key = key;
+	slots[i].hash = hash;
+}
+
+static void
+_hset_resize (HSet *set, guint n_slots)
+{
+	HSetSlot *slots_old = set->slots;
+	guint n_slots_old = set->n_slots;
+	guint i;
+
+	nm_assert (n_slots >= HSET_MIN_SLOTS);
+	nm_assert (nm_utils_is_power_of_two (n_slots));
+	nm_assert (set->size < n_slots);
+
+	set->slots = g_new0 (HSetSlot, n_slots);
+	set->n_slots = n_slots;
+
+	for (i = 0; i < n_slots_old; i++) {
+		if (slots_old[i].key)
+			_hset_insert_slot (set->slots, n_slots - 1u, slots_old[i].key, slots_old[i].hash);
+	}
+	g_free (slots_old);
+}
+
+static inline gconstpointer
+_hset_lookup (const HSet *set,
+              gconstpointer key,
+              HSetHashFunc hash_func,
+              HSetEqualFunc equal_func)
+{
+	guint mask;
+	guint hash;
+	guint i;
+
+	if (set->size == 0)
+		return NULL;
+
+	mask = set->n_slots - 1u;
+	hash = hash_func (key);
+	for (i = hash & mask; set->slots[i].key; i = (i + 1u) & mask) {
+		if (   set->slots[i].hash == hash
+		    && equal_func (set->slots[i].key, key))
+			return set->slots[i].key;
+	}
+	return NULL;
+}
+
+static inline gboolean
+_hset_add (HSet *set,
+           gconstpointer key,
+           HSetHashFunc hash_func,
+           HSetEqualFunc equal_func)
+{
+	guint mask;
+	guint hash;
+	guint i;
+
+	nm_assert (key);
+
+	if (_hset_needs_grow (set))
+		_hset_resize (set, NM_MAX (set->n_slots * 2u, HSET_MIN_SLOTS));
+
+	mask = set->n_slots - 1u;
+	hash = hash_func (key);
+	for (i = hash & mask; set->slots[i].key; i = (i + 1u) & mask) {
+		if (   set->slots[i].hash == hash
+		    && equal_func (set->slots[i].key, key))
+			return FALSE;
+	}
+	set->slots[i].key = key;
+	set->slots[i].hash = hash;
+	set->size++;
+	return TRUE;
+}
+
+static inline gboolean
+_hset_remove (HSet *set,
+              gconstpointer key,
+              HSetHashFunc hash_func,
+              HSetEqualFunc equal_func)
+{
+	guint mask;
+	guint hash;
+	guint i, j;
+
+	if (set->size == 0)
+		return FALSE;
+
+	mask = set->n_slots - 1u;
+	hash = hash_func (key);
+	for (i = hash & mask; TRUE; i = (i + 1u) & mask) {
+		if (!set->slots[i].key)
+			return FALSE;
+		if (   set->slots[i].hash == hash
+		    && equal_func (set->slots[i].key, key))
+			break;
+	}
+
+	/* backward-shift deletion: move subsequent entries of the probe
+	 * sequence into the gap, unless they are already at (or before)
+	 * their home slot. */
+	for (j = (i + 1u) & mask; set->slots[j].key; j = (j + 1u) & mask) {
+		guint home = set->slots[j].hash & mask;
+
+		if (i <= j
+		    ? (i < home && home <= j)
+		    : (i < home || home <= j))
+			continue;
+		set->slots[i] = set->slots[j];
+		i = j;
+	}
+	set->slots[i].key = NULL;
+	set->size--;
+
+	if (_hset_needs_shrink (set))
+		_hset_resize (set, set->n_slots / 2u);
+	return TRUE;
+}
+
+static void
+_hset_clear (HSet *set)
+{
+	nm_clear_g_free (&set->slots);
+	set->n_slots = 0;
+	set->size = 0;
+}
+
+/*****************************************************************************/
+
 struct _NMDedupMultiIndex {
 	int ref_count;
-	GHashTable *idx_entries;
-	GHashTable *idx_objs;
+	HSet idx_entries;
+	HSet idx_objs;
+	guint64 n_intern_hits;
+	guint64 n_intern_misses;
 };
 
+static guint _dict_idx_entries_hash (const NMDedupMultiEntry *entry);
+static gboolean _dict_idx_entries_equal (const NMDedupMultiEntry *entry_a,
+                                         const NMDedupMultiEntry *entry_b);
+static guint _dict_idx_objs_hash (const NMDedupMultiObj *obj);
+static gboolean _dict_idx_objs_equal (const NMDedupMultiObj *obj_a,
+                                      const NMDedupMultiObj *obj_b);
+
+#define _idx_entries_lookup(self, entry) \
+	((gpointer) _hset_lookup (&(self)->idx_entries, (entry), (HSetHashFunc) _dict_idx_entries_hash, (HSetEqualFunc) _dict_idx_entries_equal))
+#define _idx_entries_add(self, entry) \
+	_hset_add (&(self)->idx_entries, (entry), (HSetHashFunc) _dict_idx_entries_hash, (HSetEqualFunc) _dict_idx_entries_equal)
+#define _idx_entries_remove(self, entry) \
+	_hset_remove (&(self)->idx_entries, (entry), (HSetHashFunc) _dict_idx_entries_hash, (HSetEqualFunc) _dict_idx_entries_equal)
+
+#define _idx_objs_lookup(self, obj) \
+	((gpointer) _hset_lookup (&(self)->idx_objs, (obj), (HSetHashFunc) _dict_idx_objs_hash, (HSetEqualFunc) _dict_idx_objs_equal))
+#define _idx_objs_add(self, obj) \
+	_hset_add (&(self)->idx_objs, (obj), (HSetHashFunc) _dict_idx_objs_hash, (HSetEqualFunc) _dict_idx_objs_equal)
+#define _idx_objs_remove(self, obj) \
+	_hset_remove (&(self)->idx_objs, (obj), (HSetHashFunc) _dict_idx_objs_hash, (HSetEqualFunc) _dict_idx_objs_equal)
+
 /*****************************************************************************/
 
 static void
@@ -75,7 +276,7 @@ _entry_lookup_obj (const NMDedupMultiIndex *self,
 	};
 
 	ASSERT_idx_type (idx_type);
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _idx_entries_lookup (self, &stack_entry);
 }
 
 static NMDedupMultiHeadEntry *
@@ -99,11 +300,11 @@ _entry_lookup_head (const NMDedupMultiIndex *self,
 			nm_assert (c_list_length (&idx_type->lst_idx_head) == 1);
 			head_entry = c_list_entry (idx_type->lst_idx_head.next, NMDedupMultiHeadEntry, lst_idx);
 		}
-		nm_assert (head_entry == g_hash_table_lookup (self->idx_entries, &stack_entry));
+		nm_assert (head_entry == _idx_entries_lookup (self, &stack_entry));
 		return head_entry;
 	}
 
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _idx_entries_lookup (self, &stack_entry);
 }
 
 static void
@@ -354,10 +555,10 @@ _add (NMDedupMultiIndex *self,
 	head_entry->len++;
 
 	if (   add_head_entry
-	    && !g_hash_table_add (self->idx_entries, head_entry))
+	    && !_idx_entries_add (self, head_entry))
 		nm_assert_not_reached ();
 
-	if (!g_hash_table_add (self->idx_entries, entry))
+	if (!_idx_entries_add (self, entry))
 		nm_assert_not_reached ();
 
 	NM_SET_OUT (out_entry, entry);
@@ -481,14 +682,14 @@ _remove_entry (NMDedupMultiIndex *self,
 	nm_assert (entry->obj);
 	nm_assert (entry->head);
 	nm_assert (!c_list_is_empty (&entry->lst_entries));
-	nm_assert (g_hash_table_lookup (self->idx_entries, entry) == entry);
+	nm_assert (_idx_entries_lookup (self, entry) == entry);
 
 	head_entry = (NMDedupMultiHeadEntry *) entry->head;
 	obj = entry->obj;
 
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_idx_entries_lookup (self, head_entry) == head_entry);
 
 	idx_type = (NMDedupMultiIdxType *) head_entry->idx_type;
 	ASSERT_idx_type (idx_type);
@@ -502,11 +703,11 @@ _remove_entry (NMDedupMultiIndex *self,
 
 	NM_SET_OUT (out_head_entry_removed, head_entry != NULL);
 
-	if (!g_hash_table_remove (self->idx_entries, entry))
+	if (!_idx_entries_remove (self, entry))
 		nm_assert_not_reached ();
 
 	if (   head_entry
-	    && !g_hash_table_remove (self->idx_entries, head_entry))
+	    && !_idx_entries_remove (self, head_entry))
 		nm_assert_not_reached ();
 
 	c_list_unlink_stale (&entry->lst_entries);
@@ -535,7 +736,7 @@ _remove_head (NMDedupMultiIndex *self,
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
 	nm_assert (head_entry->len == c_list_length (&head_entry->lst_entries_head));
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_idx_entries_lookup (self, head_entry) == head_entry);
 
 	n = 0;
 	c_list_for_each_safe (iter_entry, iter_entry_safe, &head_entry->lst_entries_head) {
@@ -787,11 +988,11 @@ nm_dedup_multi_index_obj_release (NMDedupMultiIndex *self,
 {
 	nm_assert (self);
 	nm_assert (obj);
-	nm_assert (g_hash_table_lookup (self->idx_objs, obj) == obj);
+	nm_assert (_idx_objs_lookup (self, obj) == obj);
 	nm_assert (((const NMDedupMultiObj *) obj)->_multi_idx == self);
 
 	((NMDedupMultiObj *) obj)->_multi_idx = NULL;
-	if (!g_hash_table_remove (self->idx_objs, obj))
+	if (!_idx_objs_remove (self, obj))
 		nm_assert_not_reached ();
 }
 
@@ -802,7 +1003,7 @@ nm_dedup_multi_index_obj_find (NMDedupMultiIndex *self,
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (obj, NULL);
 
-	return g_hash_table_lookup (self->idx_objs, obj);
+	return _idx_objs_lookup (self, obj);
 }
 
 gconstpointer
@@ -816,20 +1017,23 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 	nm_assert (obj_new);
 
 	if (obj_new->_multi_idx == self) {
-		nm_assert (g_hash_table_lookup (self->idx_objs, obj_new) == obj_new);
+		nm_assert (_idx_objs_lookup (self, obj_new) == obj_new);
 		nm_dedup_multi_obj_ref (obj_new);
 		return obj_new;
 	}
 
-	obj_old = g_hash_table_lookup (self->idx_objs, obj_new);
+	obj_old = _idx_objs_lookup (self, obj_new);
 	nm_assert (obj_old != obj_new);
 
 	if (obj_old) {
 		nm_assert (obj_old->_multi_idx == self);
+		self->n_intern_hits++;
 		nm_dedup_multi_obj_ref (obj_old);
 		return obj_old;
 	}
 
+	self->n_intern_misses++;
+
 	if (nm_dedup_multi_obj_needs_clone (obj_new))
 		obj_new = nm_dedup_multi_obj_clone (obj_new);
 	else
@@ -838,7 +1042,7 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 	nm_assert (obj_new);
 	nm_assert (!obj_new->_multi_idx);
 
-	if (!g_hash_table_add (self->idx_objs, (gpointer) obj_new))
+	if (!_idx_objs_add (self, obj_new))
 		nm_assert_not_reached ();
 
 	((NMDedupMultiObj *) obj_new)->_multi_idx = self;
@@ -1019,11 +1223,24 @@ nm_dedup_multi_index_new (void)
 
 	self = g_slice_new0 (NMDedupMultiIndex);
 	self->ref_count = 1;
-	self->idx_entries = g_hash_table_new ((GHashFunc) _dict_idx_entries_hash, (GEqualFunc) _dict_idx_entries_equal);
-	self->idx_objs    = g_hash_table_new ((GHashFunc) _dict_idx_objs_hash,    (GEqualFunc) _dict_idx_objs_equal);
 	return self;
 }
 
+void
+nm_dedup_multi_index_get_stats (const NMDedupMultiIndex *self,
+                                NMDedupMultiIndexStats *out_stats)
+{
+	g_return_if_fail (self);
+	g_return_if_fail (out_stats);
+
+	*out_stats = (NMDedupMultiIndexStats) {
+		.n_entries       = self->idx_entries.size,
+		.n_objs          = self->idx_objs.size,
+		.n_intern_hits   = self->n_intern_hits,
+		.n_intern_misses = self->n_intern_misses,
+	};
+}
+
 NMDedupMultiIndex *
 nm_dedup_multi_index_ref (NMDedupMultiIndex *self)
 {
@@ -1037,10 +1254,12 @@ nm_dedup_multi_index_ref (NMDedupMultiIndex *self)
 NMDedupMultiIndex *
 nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 {
+	GHashTable *idx_types;
 	GHashTableIter iter;
 	const NMDedupMultiIdxType *idx_type;
 	NMDedupMultiEntry *entry;
 	const NMDedupMultiObj *obj;
+	guint i;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (self->ref_count > 0, NULL);
@@ -1048,28 +1267,36 @@ nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 	if (--self->ref_count > 0)
 		return NULL;
 
-more:
-	g_hash_table_iter_init (&iter, self->idx_entries);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL)) {
+	/* removing entries reorders the slots, so first collect the
+	 * idx-types and drop all their entries afterwards. */
+	idx_types = g_hash_table_new (nm_direct_hash, NULL);
+	for (i = 0; i < self->idx_entries.n_slots; i++) {
+		entry = (NMDedupMultiEntry *) self->idx_entries.slots[i].key;
+		if (!entry)
+			continue;
 		if (entry->is_head)
 			idx_type = ((NMDedupMultiHeadEntry *) entry)->idx_type;
 		else
 			idx_type = entry->head->idx_type;
-		_remove_idx_entry (self, (NMDedupMultiIdxType *) idx_type, TRUE, FALSE);
-		goto more;
+		g_hash_table_add (idx_types, (gpointer) idx_type);
 	}
+	g_hash_table_iter_init (&iter, idx_types);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &idx_type, NULL))
+		_remove_idx_entry (self, (NMDedupMultiIdxType *) idx_type, TRUE, FALSE);
+	g_hash_table_unref (idx_types);
 
-	nm_assert (g_hash_table_size (self->idx_entries) == 0);
+	nm_assert (self->idx_entries.size == 0);
 
-	g_hash_table_iter_init (&iter, self->idx_objs);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &obj, NULL)) {
+	for (i = 0; i < self->idx_objs.n_slots; i++) {
+		obj = self->idx_objs.slots[i].key;
+		if (!obj)
+			continue;
 		nm_assert (obj->_multi_idx == self);
 		((NMDedupMultiObj * )obj)->_multi_idx = NULL;
 	}
-	g_hash_table_remove_all (self->idx_objs);
 
-	g_hash_table_unref (self->idx_entries);
-	g_hash_table_unref (self->idx_objs);
+	_hset_clear (&self->idx_entries);
+	_hset_clear (&self->idx_objs);
 
 	g_slice_free (NMDedupMultiIndex, self);
 	return NULL;
@@ -262,6 +262,22 @@ _nm_auto_unref_dedup_multi_index (NMDedupMultiIndex **v)
 }
 #define nm_auto_unref_dedup_multi_index nm_auto(_nm_auto_unref_dedup_multi_index)
 
+typedef struct {
+	/* the number of entries (including head entries) in all indexes. */
+	guint n_entries;
+
+	/* the number of interned objects. */
+	guint n_objs;
+
+	/* how often nm_dedup_multi_index_obj_intern() found an equal object
+	 * that could be shared (hits) or had to add a new one (misses). */
+	guint64 n_intern_hits;
+	guint64 n_intern_misses;
+} NMDedupMultiIndexStats;
+
+void nm_dedup_multi_index_get_stats (const NMDedupMultiIndex *self,
+                                     NMDedupMultiIndexStats *out_stats);
+
 #define NM_DEDUP_MULTI_ENTRY_MISSING      ((const NMDedupMultiEntry *)     GUINT_TO_POINTER (1))
 #define NM_DEDUP_MULTI_HEAD_ENTRY_MISSING ((const NMDedupMultiHeadEntry *) GUINT_TO_POINTER (1))
 
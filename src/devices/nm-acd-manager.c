@@ -14,6 +14,7 @@
 #include "platform/nm-platform.h"
 #include "nm-utils.h"
 #include "NetworkManagerUtils.h"
+#include "c-list/src/c-list.h"
 #include "n-acd/src/n-acd.h"
 
 /*****************************************************************************/
@@ -25,10 +26,25 @@ typedef enum {
 	STATE_ANNOUNCING,
 } State;
 
+/* All managers for the same interface share one NAcd context, and thus
+ * one packet socket and one event source. Their probes run concurrently
+ * on that context and the events are dispatched to the manager owning
+ * the probe. */
+typedef struct {
+	int            ifindex;
+	guint8         hwaddr[ETH_ALEN];
+	int            ref_count;
+	NAcd          *acd;
+	GIOChannel    *channel;
+	guint          event_id;
+	CList          managers_lst_head;
+} AcdContext;
+
 typedef struct {
 	in_addr_t address;
 	gboolean duplicate;
 	NAcdProbe *probe;
+	NMAcdManager *manager;
 } AddressInfo;
 
 struct _NMAcdManager {
@@ -37,14 +53,17 @@ struct _NMAcdManager {
 	State          state;
 	GHashTable    *addresses;
 	guint          completed;
-	NAcd          *acd;
-	GIOChannel    *channel;
-	guint          event_id;
+	AcdContext    *context;
+	CList          context_lst;
+	bool           probe_terminated_pending:1;
 
 	NMAcdCallbacks callbacks;
 	gpointer user_data;
 };
 
+/* ifindex -> AcdContext */
+static GHashTable *acd_contexts;
+
 /*****************************************************************************/
 
 #define _NMLOG_DOMAIN         LOGD_IP4
@@ -150,88 +169,126 @@ nm_acd_manager_add_address (NMAcdManager *self, in_addr_t address)
 
 	info = g_slice_new0 (AddressInfo);
 	info->address = address;
+	info->manager = self;
 
 	g_hash_table_insert (self->addresses, GUINT_TO_POINTER (address), info);
 
 	return TRUE;
 }
 
+static AcdContext *acd_context_ref (AcdContext *context);
+static void acd_context_unref (AcdContext *context);
+
+static void
+acd_event_handle (NMAcdManager *self, NAcdEvent *event, AddressInfo *info)
+{
+	char address_str[INET_ADDRSTRLEN];
+	gs_free char *hwaddr_str = NULL;
+	gboolean check_probing_done = FALSE;
+	int r;
+
+	switch (event->event) {
+	case N_ACD_EVENT_READY:
+		info->duplicate = FALSE;
+		if (self->state == STATE_ANNOUNCING) {
+			/* fake probe ended, start announcing */
+			r = n_acd_probe_announce (info->probe, N_ACD_DEFEND_ONCE);
+			if (r) {
+				_LOGW ("couldn't announce address %s on interface '%s': %s",
+				       nm_utils_inet4_ntop (info->address, address_str),
+				       nm_platform_link_get_name (NM_PLATFORM_GET, self->ifindex),
+				       acd_error_to_string (r));
+			} else {
+				_LOGD ("announcing address %s",
+				       nm_utils_inet4_ntop (info->address, address_str));
+			}
+		}
+		check_probing_done = TRUE;
+		break;
+	case N_ACD_EVENT_USED:
+		info->duplicate = TRUE;
+		check_probing_done = TRUE;
+		break;
+	case N_ACD_EVENT_DEFENDED:
+		_LOGD ("defended address %s from host %s",
+		       nm_utils_inet4_ntop (info->address, address_str),
+		       (hwaddr_str = nm_utils_hwaddr_ntoa (event->defended.sender,
+		                                           event->defended.n_sender)));
+		break;
+	case N_ACD_EVENT_CONFLICT:
+		_LOGW ("conflict for address %s detected with host %s on interface '%s'",
+		       nm_utils_inet4_ntop (info->address, address_str),
+		       (hwaddr_str = nm_utils_hwaddr_ntoa (event->defended.sender,
+		                                           event->defended.n_sender)),
+		       nm_platform_link_get_name (NM_PLATFORM_GET, self->ifindex));
+		break;
+	default:
+		nm_assert_not_reached ();
+		break;
+	}
+
+	if (   check_probing_done
+	    && self->state == STATE_PROBING
+	    && ++self->completed == g_hash_table_size (self->addresses)) {
+		self->state = STATE_PROBE_DONE;
+		self->probe_terminated_pending = TRUE;
+	}
+}
+
 static gboolean
 acd_event (GIOChannel *source, GIOCondition condition, gpointer data)
 {
-	NMAcdManager *self = data;
+	AcdContext *context = data;
+	NMAcdManager *self;
 	NAcdEvent *event;
+	NAcdProbe *probe;
 	AddressInfo *info;
-	gboolean emit_probe_terminated = FALSE;
-	char address_str[INET_ADDRSTRLEN];
-	int r;
 
-	if (n_acd_dispatch (self->acd))
+	if (n_acd_dispatch (context->acd))
 		return G_SOURCE_CONTINUE;
 
-	while (   !n_acd_pop_event (self->acd, &event)
+	while (   !n_acd_pop_event (context->acd, &event)
 	       && event) {
-		gs_free char *hwaddr_str = NULL;
-		gboolean check_probing_done = FALSE;
-
 		switch (event->event) {
 		case N_ACD_EVENT_READY:
-			n_acd_probe_get_userdata (event->ready.probe, (void **) &info);
-			info->duplicate = FALSE;
-			if (self->state == STATE_ANNOUNCING) {
-				/* fake probe ended, start announcing */
-				r = n_acd_probe_announce (info->probe, N_ACD_DEFEND_ONCE);
-				if (r) {
-					_LOGW ("couldn't announce address %s on interface '%s': %s",
-					       nm_utils_inet4_ntop (info->address, address_str),
-					       nm_platform_link_get_name (NM_PLATFORM_GET, self->ifindex),
-					       acd_error_to_string (r));
-				} else {
-					_LOGD ("announcing address %s",
-					       nm_utils_inet4_ntop (info->address, address_str));
-				}
-			}
-			check_probing_done = TRUE;
+			probe = event->ready.probe;
 			break;
 		case N_ACD_EVENT_USED:
-			n_acd_probe_get_userdata (event->used.probe, (void **) &info);
-			info->duplicate = TRUE;
-			check_probing_done = TRUE;
+			probe = event->used.probe;
 			break;
 		case N_ACD_EVENT_DEFENDED:
-			n_acd_probe_get_userdata (event->defended.probe, (void **) &info);
-			_LOGD ("defended address %s from host %s",
-			       nm_utils_inet4_ntop (info->address, address_str),
-			       (hwaddr_str = nm_utils_hwaddr_ntoa (event->defended.sender,
-			                                           event->defended.n_sender)));
+			probe = event->defended.probe;
 			break;
 		case N_ACD_EVENT_CONFLICT:
-			n_acd_probe_get_userdata (event->conflict.probe, (void **) &info);
-			_LOGW ("conflict for address %s detected with host %s on interface '%s'",
-			       nm_utils_inet4_ntop (info->address, address_str),
-			       (hwaddr_str = nm_utils_hwaddr_ntoa (event->defended.sender,
-			                                           event->defended.n_sender)),
-			       nm_platform_link_get_name (NM_PLATFORM_GET, self->ifindex));
+			probe = event->conflict.probe;
 			break;
 		default:
-			_LOGD ("unhandled event '%s'", acd_event_to_string_a (event->event));
-			break;
+			self = NULL;
+			_LOGD ("unhandled event '%s' on ifindex %d",
+			       acd_event_to_string_a (event->event),
+			       context->ifindex);
+			continue;
 		}
 
-		if (   check_probing_done
-		    && self->state == STATE_PROBING
-		    && ++self->completed == g_hash_table_size (self->addresses)) {
-			self->state = STATE_PROBE_DONE;
-			emit_probe_terminated = TRUE;
-		}
+		n_acd_probe_get_userdata (probe, (void **) &info);
+		acd_event_handle (info->manager, event, info);
 	}
 
-	if (emit_probe_terminated) {
+	/* the callbacks may destroy any manager, including the last one
+	 * of the context. Restart the lookup after each invocation. */
+	acd_context_ref (context);
+again:
+	c_list_for_each_entry (self, &context->managers_lst_head, context_lst) {
+		if (!self->probe_terminated_pending)
+			continue;
+		self->probe_terminated_pending = FALSE;
 		if (self->callbacks.probe_terminated_callback) {
 			self->callbacks.probe_terminated_callback (self,
 			                                           self->user_data);
 		}
+		goto again;
 	}
+	acd_context_unref (context);
 
 	return G_SOURCE_CONTINUE;
 }
@@ -257,7 +314,7 @@ acd_probe_add (NMAcdManager *self,
 	n_acd_probe_config_set_ip (probe_config, (struct in_addr) { info->address });
 	n_acd_probe_config_set_timeout (probe_config, timeout);
 
-	r = n_acd_probe (self->acd, &info->probe, probe_config);
+	r = n_acd_probe (self->context->acd, &info->probe, probe_config);
 	if (r) {
 		_LOGW ("could not start probe for %s on interface '%s': %s",
 		       nm_utils_inet4_ntop (info->address, sbuf),
@@ -273,26 +330,102 @@ acd_probe_add (NMAcdManager *self,
 	return TRUE;
 }
 
+static AcdContext *
+acd_context_ref (AcdContext *context)
+{
+	nm_assert (context);
+	nm_assert (context->ref_count > 0);
+
+	context->ref_count++;
+	return context;
+}
+
+static void
+acd_context_unref (AcdContext *context)
+{
+	nm_assert (context);
+	nm_assert (context->ref_count > 0);
+
+	if (--context->ref_count > 0)
+		return;
+
+	nm_assert (c_list_is_empty (&context->managers_lst_head));
+
+	if (g_hash_table_lookup (acd_contexts, GINT_TO_POINTER (context->ifindex)) == context)
+		g_hash_table_remove (acd_contexts, GINT_TO_POINTER (context->ifindex));
+
+	nm_clear_g_source (&context->event_id);
+	nm_clear_pointer (&context->channel, g_io_channel_unref);
+	nm_clear_pointer (&context->acd, n_acd_unref);
+	g_slice_free (AcdContext, context);
+}
+
 static int
-acd_init (NMAcdManager *self)
+acd_context_acquire (int ifindex, const guint8 *hwaddr, AcdContext **out_context)
 {
+	AcdContext *context;
 	NAcdConfig *config;
+	NAcd *acd;
+	int fd;
 	int r;
 
-	if (self->acd)
+	if (G_UNLIKELY (!acd_contexts))
+		acd_contexts = g_hash_table_new (nm_direct_hash, NULL);
+
+	context = g_hash_table_lookup (acd_contexts, GINT_TO_POINTER (ifindex));
+	if (   context
+	    && memcmp (context->hwaddr, hwaddr, ETH_ALEN) == 0) {
+		*out_context = acd_context_ref (context);
 		return 0;
+	}
 
 	r = n_acd_config_new (&config);
 	if (r)
 		return r;
 
-	n_acd_config_set_ifindex (config, self->ifindex);
+	n_acd_config_set_ifindex (config, ifindex);
 	n_acd_config_set_transport (config, N_ACD_TRANSPORT_ETHERNET);
-	n_acd_config_set_mac (config, self->hwaddr, ETH_ALEN);
+	n_acd_config_set_mac (config, hwaddr, ETH_ALEN);
 
-	r = n_acd_new (&self->acd, config);
+	r = n_acd_new (&acd, config);
 	n_acd_config_free (config);
-	return r;
+	if (r)
+		return r;
+
+	context = g_slice_new0 (AcdContext);
+	context->ref_count = 1;
+	context->ifindex = ifindex;
+	memcpy (context->hwaddr, hwaddr, ETH_ALEN);
+	context->acd = acd;
+	c_list_init (&context->managers_lst_head);
+
+	n_acd_get_fd (acd, &fd);
+	context->channel = g_io_channel_unix_new (fd);
+	context->event_id = g_io_add_watch (context->channel, G_IO_IN, acd_event, context);
+
+	/* if the MAC address changed, a context with the old address might still
+	 * be in use. It is no longer found by lookup and goes away with its
+	 * last user. */
+	g_hash_table_insert (acd_contexts, GINT_TO_POINTER (ifindex), context);
+
+	*out_context = context;
+	return 0;
+}
+
+static int
+acd_init (NMAcdManager *self)
+{
+	int r;
+
+	if (self->context)
+		return 0;
+
+	r = acd_context_acquire (self->ifindex, self->hwaddr, &self->context);
+	if (r)
+		return r;
+
+	c_list_link_tail (&self->context->managers_lst_head, &self->context_lst);
+	return 0;
 }
 
 /**
@@ -312,7 +445,7 @@ nm_acd_manager_start_probe (NMAcdManager *self, guint timeout)
 	GHashTableIter iter;
 	AddressInfo *info;
 	gboolean success = FALSE;
-	int fd, r;
+	int r;
 
 	g_return_val_if_fail (self, FALSE);
 	g_return_val_if_fail (self->state == STATE_INIT, FALSE);
@@ -334,10 +467,6 @@ nm_acd_manager_start_probe (NMAcdManager *self, guint timeout)
 	if (success)
 		self->state = STATE_PROBING;
 
-	n_acd_get_fd (self->acd, &fd);
-	self->channel = g_io_channel_unix_new (fd);
-	self->event_id = g_io_add_watch (self->channel, G_IO_IN, acd_event, self);
-
 	return success ? 0 : -NME_UNSPEC;
 }
 
@@ -457,6 +586,7 @@ nm_acd_manager_new (int ifindex,
 	self->state = STATE_INIT;
 	self->ifindex = ifindex;
 	memcpy (self->hwaddr, hwaddr, ETH_ALEN);
+	c_list_init (&self->context_lst);
 	return self;
 }
 
@@ -468,10 +598,28 @@ nm_acd_manager_free (NMAcdManager *self)
 	if (self->callbacks.user_data_destroy)
 		self->callbacks.user_data_destroy (self->user_data);
 
+	/* free the probes before releasing the context. */
 	nm_clear_pointer (&self->addresses, g_hash_table_destroy);
-	nm_clear_pointer (&self->channel, g_io_channel_unref);
-	nm_clear_g_source (&self->event_id);
-	nm_clear_pointer (&self->acd, n_acd_unref);
+	c_list_unlink (&self->context_lst);
+	nm_clear_pointer (&self->context, acd_context_unref);
 
 	g_slice_free (NMAcdManager, self);
 }
+
+/*****************************************************************************/
+
+/* for testing: the fd of the NAcd context that the manager uses, or -1
+ * if it has none yet. */
+int
+_nm_acd_manager_get_fd (NMAcdManager *self)
+{
+	int fd;
+
+	g_return_val_if_fail (self, -1);
+
+	if (!self->context)
+		return -1;
+
+	n_acd_get_fd (self->context->acd, &fd);
+	return fd;
+}
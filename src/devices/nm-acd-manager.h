@@ -29,6 +29,8 @@ int nm_acd_manager_start_probe (NMAcdManager *self, guint timeout);
 gboolean nm_acd_manager_check_address (NMAcdManager *self, in_addr_t address);
 int nm_acd_manager_announce_addresses (NMAcdManager *self);
 
+int _nm_acd_manager_get_fd (NMAcdManager *self);
+
 NM_AUTO_DEFINE_FCN0 (NMAcdManager *, _nm_auto_free_acdmgr, nm_acd_manager_free);
 #define nm_auto_free_acdmgr nm_auto (_nm_auto_free_acdmgr)
 
@@ -8,6 +8,7 @@
 #include "nm-device-bond.h"
 
 #include <stdlib.h>
+#include <arpa/inet.h>
 
 #include "NetworkManagerUtils.h"
 #include "nm-device-private.h"
@@ -23,6 +24,10 @@ _LOG_DECLARE_SELF(NMDeviceBond);
 
 struct _NMDeviceBond {
 	NMDevice parent;
+
+	/* Set when some options had to be written via sysfs. The platform
+	 * cache might then not reflect them, so read them back from sysfs. */
+	bool options_via_sysfs:1;
 };
 
 struct _NMDeviceBondClass {
@@ -69,20 +74,252 @@ complete_connection (NMDevice *device,
 
 /*****************************************************************************/
 
+typedef struct {
+	const char *name;
+	char *value;
+	bool via_netlink:1;
+} BondOption;
+
+typedef struct {
+	NMPlatformLnkBond props;
+	NMPlatformLnkBondAttrs attrs;
+	GArray *options;
+} BondOptions;
+
+static void
+_bond_option_clear (gpointer data)
+{
+	BondOption *opt = data;
+
+	g_free (opt->value);
+}
+
+static void
+_bond_options_init (BondOptions *bopts)
+{
+	memset (bopts, 0, sizeof (*bopts));
+	bopts->options = g_array_new (FALSE, FALSE, sizeof (BondOption));
+	g_array_set_clear_func (bopts->options, _bond_option_clear);
+}
+
+static void
+_bond_options_clear (BondOptions *bopts)
+{
+	nm_clear_pointer (&bopts->options, g_array_unref);
+}
+
 static gboolean
-set_bond_attr (NMDevice *device, NMBondMode mode, const char *attr, const char *value)
+_bond_lnk_set_option (NMPlatform *platform,
+                      NMPlatformLnkBond *props,
+                      NMPlatformLnkBondAttrs *attrs,
+                      const char *name,
+                      const char *value)
 {
-	NMDeviceBond *self = NM_DEVICE_BOND (device);
-	gboolean ret;
-	int ifindex = nm_device_get_ifindex (device);
+	const NMPlatformLink *plink;
+	guint num;
+
+	if (nm_streq (name, NM_SETTING_BOND_OPTION_ARP_IP_TARGET)) {
+		gs_free const char **addrs = NULL;
+		gsize i;
+
+		addrs = nm_utils_strsplit_set (value, ",");
+		props->arp_ip_targets_num = 0;
+		for (i = 0; addrs && addrs[i]; i++) {
+			if (i >= NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS)
+				return FALSE;
+			if (inet_pton (AF_INET, addrs[i], &props->arp_ip_target[i]) != 1)
+				return FALSE;
+			props->arp_ip_targets_num++;
+		}
+		*attrs |= NM_PLATFORM_LNK_BOND_ATTR_ARP_IP_TARGET;
+		return TRUE;
+	}
+
+	if (NM_IN_STRSET (name, NM_SETTING_BOND_OPTION_PRIMARY,
+	                        NM_SETTING_BOND_OPTION_ACTIVE_SLAVE)) {
+		int ifindex = 0;
+
+		if (value && value[0]) {
+			/* Kernel rejects the entire request if the active slave
+			 * is not yet enslaved. Also, a primary that does not exist
+			 * yet can only be set by name. Leave those for sysfs. */
+			if (nm_streq (name, NM_SETTING_BOND_OPTION_ACTIVE_SLAVE))
+				return FALSE;
+			plink = nm_platform_link_get_by_ifname (platform, value);
+			if (!plink)
+				return FALSE;
+			ifindex = plink->ifindex;
+		}
+		if (nm_streq (name, NM_SETTING_BOND_OPTION_PRIMARY)) {
+			props->primary = ifindex;
+			*attrs |= NM_PLATFORM_LNK_BOND_ATTR_PRIMARY;
+		} else {
+			props->active_slave = ifindex;
+			*attrs |= NM_PLATFORM_LNK_BOND_ATTR_ACTIVE_SLAVE;
+		}
+		return TRUE;
+	}
+
+	if (nm_streq (name, NM_SETTING_BOND_OPTION_AD_ACTOR_SYSTEM)) {
+		if (!nm_utils_hwaddr_aton (value, props->ad_actor_system, sizeof (props->ad_actor_system)))
+			return FALSE;
+		*attrs |= NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYSTEM;
+		return TRUE;
+	}
+
+	if (!_nm_setting_bond_option_to_uint (name, value, &num))
+		return FALSE;
+
+#define _SET_NUM(opt, attr, field) \
+	if (nm_streq (name, opt)) { \
+		props->field = num; \
+		*attrs |= (attr); \
+		return TRUE; \
+	}
+
+	_SET_NUM (NM_SETTING_BOND_OPTION_MODE,              NM_PLATFORM_LNK_BOND_ATTR_MODE,              mode);
+	_SET_NUM (NM_SETTING_BOND_OPTION_MIIMON,            NM_PLATFORM_LNK_BOND_ATTR_MIIMON,            miimon);
+	_SET_NUM (NM_SETTING_BOND_OPTION_UPDELAY,           NM_PLATFORM_LNK_BOND_ATTR_UPDELAY,           updelay);
+	_SET_NUM (NM_SETTING_BOND_OPTION_DOWNDELAY,         NM_PLATFORM_LNK_BOND_ATTR_DOWNDELAY,         downdelay);
+	_SET_NUM (NM_SETTING_BOND_OPTION_USE_CARRIER,       NM_PLATFORM_LNK_BOND_ATTR_USE_CARRIER,       use_carrier);
+	_SET_NUM (NM_SETTING_BOND_OPTION_ARP_INTERVAL,      NM_PLATFORM_LNK_BOND_ATTR_ARP_INTERVAL,      arp_interval);
+	_SET_NUM (NM_SETTING_BOND_OPTION_ARP_VALIDATE,      NM_PLATFORM_LNK_BOND_ATTR_ARP_VALIDATE,      arp_validate);
+	_SET_NUM (NM_SETTING_BOND_OPTION_ARP_ALL_TARGETS,   NM_PLATFORM_LNK_BOND_ATTR_ARP_ALL_TARGETS,   arp_all_targets);
+	_SET_NUM (NM_SETTING_BOND_OPTION_PRIMARY_RESELECT,  NM_PLATFORM_LNK_BOND_ATTR_PRIMARY_RESELECT,  primary_reselect);
+	_SET_NUM (NM_SETTING_BOND_OPTION_FAIL_OVER_MAC,     NM_PLATFORM_LNK_BOND_ATTR_FAIL_OVER_MAC,     fail_over_mac);
+	_SET_NUM (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY,  NM_PLATFORM_LNK_BOND_ATTR_XMIT_HASH_POLICY,  xmit_hash_policy);
+	_SET_NUM (NM_SETTING_BOND_OPTION_RESEND_IGMP,       NM_PLATFORM_LNK_BOND_ATTR_RESEND_IGMP,       resend_igmp);
+	_SET_NUM (NM_SETTING_BOND_OPTION_NUM_GRAT_ARP,      NM_PLATFORM_LNK_BOND_ATTR_NUM_PEER_NOTIF,    num_peer_notif);
+	_SET_NUM (NM_SETTING_BOND_OPTION_NUM_UNSOL_NA,      NM_PLATFORM_LNK_BOND_ATTR_NUM_PEER_NOTIF,    num_peer_notif);
+	_SET_NUM (NM_SETTING_BOND_OPTION_ALL_SLAVES_ACTIVE, NM_PLATFORM_LNK_BOND_ATTR_ALL_SLAVES_ACTIVE, all_slaves_active);
+	_SET_NUM (NM_SETTING_BOND_OPTION_MIN_LINKS,         NM_PLATFORM_LNK_BOND_ATTR_MIN_LINKS,         min_links);
+	_SET_NUM (NM_SETTING_BOND_OPTION_LP_INTERVAL,       NM_PLATFORM_LNK_BOND_ATTR_LP_INTERVAL,       lp_interval);
+	_SET_NUM (NM_SETTING_BOND_OPTION_PACKETS_PER_SLAVE, NM_PLATFORM_LNK_BOND_ATTR_PACKETS_PER_SLAVE, packets_per_slave);
+	_SET_NUM (NM_SETTING_BOND_OPTION_LACP_RATE,         NM_PLATFORM_LNK_BOND_ATTR_AD_LACP_RATE,      lacp_rate);
+	_SET_NUM (NM_SETTING_BOND_OPTION_AD_SELECT,         NM_PLATFORM_LNK_BOND_ATTR_AD_SELECT,         ad_select);
+	_SET_NUM (NM_SETTING_BOND_OPTION_AD_ACTOR_SYS_PRIO, NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYS_PRIO, ad_actor_sys_prio);
+	_SET_NUM (NM_SETTING_BOND_OPTION_AD_USER_PORT_KEY,  NM_PLATFORM_LNK_BOND_ATTR_AD_USER_PORT_KEY,  ad_user_port_key);
+	_SET_NUM (NM_SETTING_BOND_OPTION_TLB_DYNAMIC_LB,    NM_PLATFORM_LNK_BOND_ATTR_TLB_DYNAMIC_LB,    tlb_dynamic_lb);
+
+#undef _SET_NUM
+
+	return FALSE;
+}
+
+static gboolean
+set_bond_attr (NMDevice *device, BondOptions *bopts, NMBondMode mode, const char *attr, const char *value)
+{
+	BondOption *opt;
 
 	if (!_nm_setting_bond_option_supported (attr, mode))
 		return FALSE;
 
-	ret = nm_platform_sysctl_master_set_option (nm_device_get_platform (device), ifindex, attr, value);
-	if (!ret)
+	g_array_set_size (bopts->options, bopts->options->len + 1);
+	opt = &g_array_index (bopts->options, BondOption, bopts->options->len - 1);
+	opt->name = attr;
+	opt->value = g_strdup (value);
+	opt->via_netlink = _bond_lnk_set_option (nm_device_get_platform (device),
+	                                         &bopts->props,
+	                                         &bopts->attrs,
+	                                         attr,
+	                                         value);
+	return TRUE;
+}
+
+static void
+set_bond_attr_sysfs (NMDevice *device, const char *attr, const char *value)
+{
+	NMDeviceBond *self = NM_DEVICE_BOND (device);
+
+	if (!nm_platform_sysctl_master_set_option (nm_device_get_platform (device),
+	                                           nm_device_get_ifindex (device),
+	                                           attr,
+	                                           value))
 		_LOGW (LOGD_PLATFORM, "failed to set bonding attribute '%s' to '%s'", attr, value);
-	return ret;
+}
+
+static void
+set_arp_targets (NMDevice *device,
+                 const char *value,
+                 const char *delim,
+                 const char *prefix)
+{
+	gs_free const char **value_v = NULL;
+	gsize i;
+
+	value_v = nm_utils_strsplit_set (value, delim);
+	if (!value_v)
+		return;
+	for (i = 0; value_v[i]; i++) {
+		gs_free char *tmp = NULL;
+
+		tmp = g_strdup_printf ("%s%s", prefix, value_v[i]);
+		set_bond_attr_sysfs (device, NM_SETTING_BOND_OPTION_ARP_IP_TARGET, tmp);
+	}
+}
+
+static void
+commit_bond_options (NMDevice *device, BondOptions *bopts)
+{
+	NMDeviceBond *self = NM_DEVICE_BOND (device);
+	NMPlatform *platform = nm_device_get_platform (device);
+	int ifindex = nm_device_get_ifindex (device);
+	NMPlatformLnkBondAttrs attrs;
+	gboolean mode_done = FALSE;
+	gboolean netlink_done = FALSE;
+	guint i;
+
+	/* The mode can only be changed while the bond has no slaves and the
+	 * kernel validates other options against it. Set it with a request
+	 * of its own, so that a rejected mode doesn't fail the rest. */
+	if (NM_FLAGS_HAS (bopts->attrs, NM_PLATFORM_LNK_BOND_ATTR_MODE)) {
+		mode_done = nm_platform_link_bond_change (platform,
+		                                          ifindex,
+		                                          &bopts->props,
+		                                          NM_PLATFORM_LNK_BOND_ATTR_MODE);
+		if (!mode_done)
+			_LOGD (LOGD_BOND, "failed to set bond mode via netlink, fall back to sysfs");
+	}
+
+	/* Set all other options we can express via netlink with one request.
+	 * If that fails, fall back to writing them to sysfs in order, like
+	 * we always did. */
+	attrs = bopts->attrs & ~NM_PLATFORM_LNK_BOND_ATTR_MODE;
+	if (attrs != NM_PLATFORM_LNK_BOND_ATTR_NONE) {
+		netlink_done = nm_platform_link_bond_change (platform,
+		                                             ifindex,
+		                                             &bopts->props,
+		                                             attrs);
+		if (!netlink_done)
+			_LOGD (LOGD_BOND, "failed to set bond options via netlink, fall back to sysfs");
+	}
+
+	self->options_via_sysfs = FALSE;
+
+	for (i = 0; i < bopts->options->len; i++) {
+		const BondOption *opt = &g_array_index (bopts->options, BondOption, i);
+
+		if (opt->via_netlink) {
+			if (nm_streq (opt->name, NM_SETTING_BOND_OPTION_MODE) ? mode_done : netlink_done)
+				continue;
+		}
+
+		self->options_via_sysfs = TRUE;
+
+		if (nm_streq (opt->name, NM_SETTING_BOND_OPTION_ARP_IP_TARGET)) {
+			gs_free char *contents = NULL;
+
+			/* ARP targets: clear and initialize the list */
+			contents = nm_platform_sysctl_master_get_option (platform,
+			                                                 ifindex,
+			                                                 NM_SETTING_BOND_OPTION_ARP_IP_TARGET);
+			set_arp_targets (device, contents, " \n", "-");
+			set_arp_targets (device, opt->value, ",", "+");
+			continue;
+		}
+
+		set_bond_attr_sysfs (device, opt->name, opt->value);
+	}
 }
 
 static gboolean
@@ -103,12 +340,102 @@ ignore_option (NMSettingBond *s_bond, const char *option, const char *value)
 	return nm_streq0 (value, defvalue);
 }
 
+static char *
+_bond_lnk_get_option (NMPlatform *platform,
+                      const NMPlatformLnkBond *props,
+                      const char *name)
+{
+	const NMPlatformLink *plink;
+	const char *str;
+	guint num;
+	int ifindex;
+
+	if (nm_streq (name, NM_SETTING_BOND_OPTION_ARP_IP_TARGET)) {
+		GString *targets;
+		guint i;
+
+		targets = g_string_new (NULL);
+		for (i = 0; i < props->arp_ip_targets_num; i++) {
+			char sbuf[NM_UTILS_INET_ADDRSTRLEN];
+
+			if (i > 0)
+				g_string_append_c (targets, ' ');
+			g_string_append (targets, nm_utils_inet4_ntop (props->arp_ip_target[i], sbuf));
+		}
+		return g_string_free (targets, FALSE);
+	}
+
+	if (NM_IN_STRSET (name, NM_SETTING_BOND_OPTION_PRIMARY,
+	                        NM_SETTING_BOND_OPTION_ACTIVE_SLAVE)) {
+		ifindex =   nm_streq (name, NM_SETTING_BOND_OPTION_PRIMARY)
+		          ? props->primary
+		          : props->active_slave;
+		if (ifindex <= 0)
+			return g_strdup ("");
+		plink = nm_platform_link_get (platform, ifindex);
+		return plink ? g_strdup (plink->name) : NULL;
+	}
+
+	if (nm_streq (name, NM_SETTING_BOND_OPTION_AD_ACTOR_SYSTEM)) {
+		char sbuf[sizeof (props->ad_actor_system) * 3];
+
+		return g_strdup (nm_utils_hwaddr_ntoa_buf (props->ad_actor_system,
+		                                           sizeof (props->ad_actor_system),
+		                                           FALSE,
+		                                           sbuf,
+		                                           sizeof (sbuf)));
+	}
+
+#define _GET_NUM(opt, field) \
+	if (nm_streq (name, opt)) { \
+		num = props->field; \
+		goto out_num; \
+	}
+
+	_GET_NUM (NM_SETTING_BOND_OPTION_MODE,              mode);
+	_GET_NUM (NM_SETTING_BOND_OPTION_MIIMON,            miimon);
+	_GET_NUM (NM_SETTING_BOND_OPTION_UPDELAY,           updelay);
+	_GET_NUM (NM_SETTING_BOND_OPTION_DOWNDELAY,         downdelay);
+	_GET_NUM (NM_SETTING_BOND_OPTION_USE_CARRIER,       use_carrier);
+	_GET_NUM (NM_SETTING_BOND_OPTION_ARP_INTERVAL,      arp_interval);
+	_GET_NUM (NM_SETTING_BOND_OPTION_ARP_VALIDATE,      arp_validate);
+	_GET_NUM (NM_SETTING_BOND_OPTION_ARP_ALL_TARGETS,   arp_all_targets);
+	_GET_NUM (NM_SETTING_BOND_OPTION_PRIMARY_RESELECT,  primary_reselect);
+	_GET_NUM (NM_SETTING_BOND_OPTION_FAIL_OVER_MAC,     fail_over_mac);
+	_GET_NUM (NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY,  xmit_hash_policy);
+	_GET_NUM (NM_SETTING_BOND_OPTION_RESEND_IGMP,       resend_igmp);
+	_GET_NUM (NM_SETTING_BOND_OPTION_NUM_GRAT_ARP,      num_peer_notif);
+	_GET_NUM (NM_SETTING_BOND_OPTION_NUM_UNSOL_NA,      num_peer_notif);
+	_GET_NUM (NM_SETTING_BOND_OPTION_ALL_SLAVES_ACTIVE, all_slaves_active);
+	_GET_NUM (NM_SETTING_BOND_OPTION_MIN_LINKS,         min_links);
+	_GET_NUM (NM_SETTING_BOND_OPTION_LP_INTERVAL,       lp_interval);
+	_GET_NUM (NM_SETTING_BOND_OPTION_PACKETS_PER_SLAVE, packets_per_slave);
+	_GET_NUM (NM_SETTING_BOND_OPTION_LACP_RATE,         lacp_rate);
+	_GET_NUM (NM_SETTING_BOND_OPTION_AD_SELECT,         ad_select);
+	_GET_NUM (NM_SETTING_BOND_OPTION_AD_ACTOR_SYS_PRIO, ad_actor_sys_prio);
+	_GET_NUM (NM_SETTING_BOND_OPTION_AD_USER_PORT_KEY,  ad_user_port_key);
+	_GET_NUM (NM_SETTING_BOND_OPTION_TLB_DYNAMIC_LB,    tlb_dynamic_lb);
+
+#undef _GET_NUM
+
+	return NULL;
+
+out_num:
+	str = _nm_setting_bond_option_uint_to_name (name, num);
+	if (str)
+		return g_strdup (str);
+	return g_strdup_printf ("%u", num);
+}
+
 static void
 update_connection (NMDevice *device, NMConnection *connection)
 {
+	NMDeviceBond *self = NM_DEVICE_BOND (device);
 	NMSettingBond *s_bond = nm_connection_get_setting_bond (connection);
+	NMPlatform *platform = nm_device_get_platform (device);
 	int ifindex = nm_device_get_ifindex (device);
 	NMBondMode mode = NM_BOND_MODE_UNKNOWN;
+	const NMPlatformLnkBond *lnk;
 	const char **options;
 
 	if (!s_bond) {
@@ -116,12 +443,23 @@ update_connection (NMDevice *device, NMConnection *connection)
 		nm_connection_add_setting (connection, (NMSetting *) s_bond);
 	}
 
-	/* Read bond options from sysfs and update the Bond setting to match */
+	/* Read bond options from the platform cache and update the Bond
+	 * setting to match. Options that are not known there are still
+	 * read from sysfs, and so is everything after we had to fall back
+	 * to sysfs to set them. */
+	lnk =   self->options_via_sysfs
+	      ? NULL
+	      : nm_platform_link_get_lnk_bond (platform, ifindex, NULL);
 	options = nm_setting_bond_get_valid_options (s_bond);
 	for (; *options; options++) {
-		gs_free char *value = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex, *options);
+		gs_free char *value = NULL;
 		char *p;
 
+		if (lnk)
+			value = _bond_lnk_get_option (platform, lnk, *options);
+		if (!value)
+			value = nm_platform_sysctl_master_get_option (platform, ifindex, *options);
+
 		if (   value
 		    && _nm_setting_bond_get_option_type (s_bond, *options) == NM_BOND_OPTION_TYPE_BOTH) {
 			p = strchr (value, ' ');
@@ -164,29 +502,9 @@ master_update_slave_connection (NMDevice *self,
 	return TRUE;
 }
 
-static void
-set_arp_targets (NMDevice *device,
-                 NMBondMode mode,
-                 const char *value,
-                 const char *delim,
-                 const char *prefix)
-{
-	gs_free const char **value_v = NULL;
-	gsize i;
-
-	value_v = nm_utils_strsplit_set (value, delim);
-	if (!value_v)
-		return;
-	for (i = 0; value_v[i]; i++) {
-		gs_free char *tmp = NULL;
-
-		tmp = g_strdup_printf ("%s%s", prefix, value_v[i]);
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_ARP_IP_TARGET, tmp);
-	}
-}
-
 static void
 set_simple_option (NMDevice *device,
+                   BondOptions *bopts,
                    NMBondMode mode,
                    NMSettingBond *s_bond,
                    const char *opt)
@@ -196,7 +514,7 @@ set_simple_option (NMDevice *device,
 	value = nm_setting_bond_get_option_by_name (s_bond, opt);
 	if (!value)
 		value = nm_setting_bond_get_option_default (s_bond, opt);
-	set_bond_attr (device, mode, opt, value);
+	set_bond_attr (device, bopts, mode, opt, value);
 }
 
 static gboolean
@@ -204,11 +522,10 @@ apply_bonding_config (NMDeviceBond *self)
 {
 	NMDevice *device = NM_DEVICE (self);
 	NMSettingBond *s_bond;
-	int ifindex = nm_device_get_ifindex (device);
 	const char *mode_str, *value;
-	char *contents;
 	gboolean set_arp_interval = TRUE;
 	NMBondMode mode;
+	BondOptions bopts;
 
 	/* Option restrictions:
 	 *
@@ -237,30 +554,32 @@ apply_bonding_config (NMDeviceBond *self)
 		return FALSE;
 	}
 
+	_bond_options_init (&bopts);
+
 	/* Set mode first, as some other options (e.g. arp_interval) are valid
 	 * only for certain modes.
 	 */
 
-	set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_MODE, mode_str);
+	set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_MODE, mode_str);
 
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_MIIMON);
 	if (value && atoi (value)) {
 		/* clear arp interval */
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_ARP_INTERVAL, "0");
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_ARP_INTERVAL, "0");
 		set_arp_interval = FALSE;
 
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_MIIMON, value);
-		set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_UPDELAY);
-		set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_DOWNDELAY);
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_MIIMON, value);
+		set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_UPDELAY);
+		set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_DOWNDELAY);
 	} else if (!value) {
 		/* If not given, and arp_interval is not given or disabled, default to 100 */
 		value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_ARP_INTERVAL);
 		if (_nm_utils_ascii_str_to_int64 (value, 10, 0, G_MAXUINT32, 0) == 0)
-			set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_MIIMON, "100");
+			set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_MIIMON, "100");
 	}
 
 	if (set_arp_interval) {
-		set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_ARP_INTERVAL);
+		set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_ARP_INTERVAL);
 		/* Just let miimon get cleared automatically; even setting miimon to
 		 * 0 (disabled) clears arp_interval.
 		 */
@@ -272,43 +591,39 @@ apply_bonding_config (NMDeviceBond *self)
 	    && !nm_streq (value, "0")
 	    && !nm_streq (value, "none")
 	    && mode == NM_BOND_MODE_ACTIVEBACKUP)
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_ARP_VALIDATE, value);
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_ARP_VALIDATE, value);
 	else
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_ARP_VALIDATE, "0");
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_ARP_VALIDATE, "0");
 
 	/* Primary */
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_PRIMARY);
-	set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_PRIMARY, value ?: "");
+	set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_PRIMARY, value ?: "");
 
-	/* ARP targets: clear and initialize the list */
-	contents = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex,
-	                                                 NM_SETTING_BOND_OPTION_ARP_IP_TARGET);
-	set_arp_targets (device, mode, contents, " \n", "-");
+	/* ARP targets: replace the list */
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_ARP_IP_TARGET);
-	set_arp_targets (device, mode, value, ",", "+");
-	g_free (contents);
+	set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_ARP_IP_TARGET, value ?: "");
 
 	/* AD actor system: don't set if empty */
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_AD_ACTOR_SYSTEM);
 	if (value)
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_AD_ACTOR_SYSTEM, value);
-
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_ACTIVE_SLAVE);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_AD_ACTOR_SYS_PRIO);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_AD_SELECT);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_AD_USER_PORT_KEY);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_ALL_SLAVES_ACTIVE);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_ARP_ALL_TARGETS);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_FAIL_OVER_MAC);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_LACP_RATE);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_LP_INTERVAL);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_MIN_LINKS);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_PACKETS_PER_SLAVE);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_PRIMARY_RESELECT);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_RESEND_IGMP);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_TLB_DYNAMIC_LB);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_USE_CARRIER);
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY);
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_AD_ACTOR_SYSTEM, value);
+
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_ACTIVE_SLAVE);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_AD_ACTOR_SYS_PRIO);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_AD_SELECT);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_AD_USER_PORT_KEY);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_ALL_SLAVES_ACTIVE);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_ARP_ALL_TARGETS);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_FAIL_OVER_MAC);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_LACP_RATE);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_LP_INTERVAL);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_MIN_LINKS);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_PACKETS_PER_SLAVE);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_PRIMARY_RESELECT);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_RESEND_IGMP);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_TLB_DYNAMIC_LB);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_USE_CARRIER);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_XMIT_HASH_POLICY);
 
 	/* num_grat_arp and num_unsol_na are actually the same attribute
 	 * on kernel side and their value in the bond setting is guaranteed
@@ -316,10 +631,12 @@ apply_bonding_config (NMDeviceBond *self)
 	 */
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_NUM_GRAT_ARP);
 	if (value)
-		set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_NUM_GRAT_ARP, value);
+		set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_NUM_GRAT_ARP, value);
 	else
-		set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_NUM_UNSOL_NA);
+		set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_NUM_UNSOL_NA);
 
+	commit_bond_options (device, &bopts);
+	_bond_options_clear (&bopts);
 	return TRUE;
 }
 
@@ -566,6 +883,7 @@ reapply_connection (NMDevice *device, NMConnection *con_old, NMConnection *con_n
 	const char *value;
 	NMSettingBond *s_bond;
 	NMBondMode mode;
+	BondOptions bopts;
 
 	NM_DEVICE_CLASS (nm_device_bond_parent_class)->reapply_connection (device,
 	                                                                   con_old,
@@ -582,12 +900,17 @@ reapply_connection (NMDevice *device, NMConnection *con_old, NMConnection *con_n
 	mode = _nm_setting_bond_mode_from_string (value);
 	g_return_if_fail (mode != NM_BOND_MODE_UNKNOWN);
 
+	_bond_options_init (&bopts);
+
 	/* Primary */
 	value = nm_setting_bond_get_option_by_name (s_bond, NM_SETTING_BOND_OPTION_PRIMARY);
-	set_bond_attr (device, mode, NM_SETTING_BOND_OPTION_PRIMARY, value ?: "");
+	set_bond_attr (device, &bopts, mode, NM_SETTING_BOND_OPTION_PRIMARY, value ?: "");
 
 	/* Active slave */
-	set_simple_option (device, mode, s_bond, NM_SETTING_BOND_OPTION_ACTIVE_SLAVE);
+	set_simple_option (device, &bopts, mode, s_bond, NM_SETTING_BOND_OPTION_ACTIVE_SLAVE);
+
+	commit_bond_options (device, &bopts);
+	_bond_options_clear (&bopts);
 }
 
 /*****************************************************************************/
@@ -25,6 +25,11 @@ struct _NMDeviceBridge {
 	GCancellable *bt_cancellable;
 	bool vlan_configured:1;
 	bool bt_registered:1;
+
+	/* Set when the master options had to be written via sysfs. The
+	 * platform cache might then not reflect them, so read them back
+	 * from sysfs. */
+	bool options_via_sysfs:1;
 };
 
 struct _NMDeviceBridgeClass {
@@ -212,14 +217,12 @@ static const Option slave_options[] = {
 	{ NULL, NULL }
 };
 
-static void
-commit_option (NMDevice *device, NMSetting *setting, const Option *option, gboolean slave)
+static guint32
+option_get_kernel_value (NMSetting *setting, const Option *option)
 {
-	int ifindex = nm_device_get_ifindex (device);
 	GParamSpec *pspec;
 	GValue val = G_VALUE_INIT;
 	guint32 uval = 0;
-	char value[100];
 
 	g_assert (setting);
 
@@ -255,43 +258,141 @@ commit_option (NMDevice *device, NMSetting *setting, const Option *option, gbool
 		nm_assert_not_reached ();
 	g_value_unset (&val);
 
-	nm_sprintf_buf (value, "%u", uval);
+	return uval;
+}
+
+static void
+commit_option (NMDevice *device, NMSetting *setting, const Option *option, gboolean slave)
+{
+	int ifindex = nm_device_get_ifindex (device);
+	char value[100];
+
+	nm_sprintf_buf (value, "%u", option_get_kernel_value (setting, option));
 	if (slave)
 		nm_platform_sysctl_slave_set_option (nm_device_get_platform (device), ifindex, option->sysname, value);
 	else
 		nm_platform_sysctl_master_set_option (nm_device_get_platform (device), ifindex, option->sysname, value);
 }
 
+static guint32
+lnk_bridge_get_option (const NMPlatformLnkBridge *lnk, const Option *option)
+{
+	if (nm_streq (option->sysname, "stp_state"))
+		return lnk->stp_state;
+	if (nm_streq (option->sysname, "priority"))
+		return lnk->priority;
+	if (nm_streq (option->sysname, "forward_delay"))
+		return lnk->forward_delay;
+	if (nm_streq (option->sysname, "hello_time"))
+		return lnk->hello_time;
+	if (nm_streq (option->sysname, "max_age"))
+		return lnk->max_age;
+	if (nm_streq (option->sysname, "ageing_time"))
+		return lnk->ageing_time;
+	if (nm_streq (option->sysname, "group_fwd_mask"))
+		return lnk->group_fwd_mask;
+	if (nm_streq (option->sysname, "multicast_snooping"))
+		return lnk->mcast_snooping;
+	nm_assert_not_reached ();
+	return 0;
+}
+
+static void
+lnk_bridge_set_option (NMPlatformLnkBridge *lnk, const Option *option, guint32 value)
+{
+	if (nm_streq (option->sysname, "stp_state"))
+		lnk->stp_state = !!value;
+	else if (nm_streq (option->sysname, "priority"))
+		lnk->priority = value;
+	else if (nm_streq (option->sysname, "forward_delay"))
+		lnk->forward_delay = value;
+	else if (nm_streq (option->sysname, "hello_time"))
+		lnk->hello_time = value;
+	else if (nm_streq (option->sysname, "max_age"))
+		lnk->max_age = value;
+	else if (nm_streq (option->sysname, "ageing_time"))
+		lnk->ageing_time = value;
+	else if (nm_streq (option->sysname, "group_fwd_mask"))
+		lnk->group_fwd_mask = value;
+	else if (nm_streq (option->sysname, "multicast_snooping"))
+		lnk->mcast_snooping = !!value;
+	else
+		nm_assert_not_reached ();
+}
+
+static void
+commit_master_options (NMDevice *device, NMSetting *setting)
+{
+	NMDeviceBridge *self = NM_DEVICE_BRIDGE (device);
+	NMPlatformLnkBridge props = { };
+	const Option *option;
+
+	/* Set all options with one netlink request. Older kernels don't support
+	 * changing bridge options via netlink, fall back to sysfs there. */
+	for (option = master_options; option->name; option++)
+		lnk_bridge_set_option (&props, option, option_get_kernel_value (setting, option));
+
+	if (nm_platform_link_bridge_change (nm_device_get_platform (device),
+	                                    nm_device_get_ifindex (device),
+	                                    &props)) {
+		self->options_via_sysfs = FALSE;
+		return;
+	}
+
+	_LOGD (LOGD_BRIDGE, "failed to set bridge options via netlink, fall back to sysfs");
+	self->options_via_sysfs = TRUE;
+	for (option = master_options; option->name; option++)
+		commit_option (device, setting, option, FALSE);
+}
+
 static const NMPlatformBridgeVlan **
-setting_vlans_to_platform (GPtrArray *array)
+setting_vlans_to_platform (GPtrArray *array, guint16 default_pvid)
 {
 	NMPlatformBridgeVlan **arr;
 	NMPlatformBridgeVlan *p_data;
+	guint len;
 	guint i;
+	guint j = 0;
 
-	if (!array || !array->len)
+	len = array ? array->len : 0u;
+	if (default_pvid)
+		len++;
+	if (!len)
 		return NULL;
 
 	G_STATIC_ASSERT_EXPR (_nm_alignof (NMPlatformBridgeVlan *) >= _nm_alignof (NMPlatformBridgeVlan));
-	arr = g_malloc (  (sizeof (NMPlatformBridgeVlan *) * (array->len + 1))
-	                + (sizeof (NMPlatformBridgeVlan  ) * (array->len    )));
-	p_data = (NMPlatformBridgeVlan *) &arr[array->len + 1];
+	arr = g_malloc (  (sizeof (NMPlatformBridgeVlan *) * (len + 1))
+	                + (sizeof (NMPlatformBridgeVlan  ) * (len    )));
+	p_data = (NMPlatformBridgeVlan *) &arr[len + 1];
+
+	if (default_pvid) {
+		/* the VLAN that kernel creates for the default PVID. It comes first, so
+		 * that the VLANs from the setting override it. */
+		p_data[j] = (NMPlatformBridgeVlan) {
+			.vid_start = default_pvid,
+			.vid_end   = default_pvid,
+			.pvid      = TRUE,
+			.untagged  = TRUE,
+		};
+		arr[j] = &p_data[j];
+		j++;
+	}
 
-	for (i = 0; i < array->len; i++) {
+	for (i = 0; array && i < array->len; i++, j++) {
 		NMBridgeVlan *vlan = array->pdata[i];
 		guint16 vid_start, vid_end;
 
 		nm_bridge_vlan_get_vid_range (vlan, &vid_start, &vid_end);
 
-		p_data[i] = (NMPlatformBridgeVlan) {
+		p_data[j] = (NMPlatformBridgeVlan) {
 			.vid_start = vid_start,
 			.vid_end   = vid_end,
 			.pvid      = nm_bridge_vlan_is_pvid (vlan),
 			.untagged  = nm_bridge_vlan_is_untagged (vlan),
 		};
-		arr[i] = &p_data[i];
+		arr[j] = &p_data[j];
 	}
-	arr[i] = NULL;
+	arr[j] = NULL;
 	return (const NMPlatformBridgeVlan **) arr;
 }
 
@@ -317,6 +418,7 @@ update_connection (NMDevice *device, NMConnection *connection)
 	NMDeviceBridge *self = NM_DEVICE_BRIDGE (device);
 	NMSettingBridge *s_bridge = nm_connection_get_setting_bridge (connection);
 	int ifindex = nm_device_get_ifindex (device);
+	const NMPlatformLnkBridge *lnk;
 	const Option *option;
 	gs_free char *stp = NULL;
 	int stp_value;
@@ -326,21 +428,43 @@ update_connection (NMDevice *device, NMConnection *connection)
 		nm_connection_add_setting (connection, (NMSetting *) s_bridge);
 	}
 
+	lnk =   self->options_via_sysfs
+	      ? NULL
+	      : nm_platform_link_get_lnk_bridge (nm_device_get_platform (device), ifindex, NULL);
+
 	option = master_options;
 	nm_assert (nm_streq (option->sysname, "stp_state"));
 
-	stp = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex, option->sysname);
-	stp_value = _nm_utils_ascii_str_to_int64 (stp, 10, option->nm_min, option->nm_max, option->nm_default);
+	if (lnk)
+		stp_value = lnk->stp_state;
+	else {
+		stp = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex, option->sysname);
+		stp_value = _nm_utils_ascii_str_to_int64 (stp, 10, option->nm_min, option->nm_max, option->nm_default);
+	}
 	g_object_set (s_bridge, option->name, stp_value, NULL);
 	option++;
 
 	for (; option->name; option++) {
-		gs_free char *str = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex, option->sysname);
+		gs_free char *str = NULL;
 		uint value;
 
 		if (!stp_value && option->only_with_stp)
 			continue;
 
+		if (lnk) {
+			guint32 factor = option->user_hz_compensate ? 100 : 1;
+
+			value = lnk_bridge_get_option (lnk, option);
+			if (   value < option->nm_min * factor
+			    || value > option->nm_max * factor)
+				value = option->nm_default;
+			else
+				value /= factor;
+			g_object_set (s_bridge, option->name, value, NULL);
+			continue;
+		}
+
+		str = nm_platform_sysctl_master_get_option (nm_device_get_platform (device), ifindex, option->sysname);
 		if (str) {
 			/* See comments in set_sysfs_uint() about centiseconds. */
 			if (option->user_hz_compensate) {
@@ -422,9 +546,13 @@ bridge_set_vlan_options (NMDevice *device, NMSettingBridge *s_bridge)
 	gboolean enabled;
 	guint16 pvid;
 	NMPlatform *plat;
+	const NMPlatformLnkBridge *lnk;
 	int ifindex;
 	gs_unref_ptrarray GPtrArray *vlans = NULL;
 	gs_free const NMPlatformBridgeVlan **plat_vlans = NULL;
+	gs_free char *cur_filtering = NULL;
+	gs_free char *cur_pvid = NULL;
+	char value[32];
 
 	if (self->vlan_configured)
 		return TRUE;
@@ -433,10 +561,23 @@ bridge_set_vlan_options (NMDevice *device, NMSettingBridge *s_bridge)
 	ifindex = nm_device_get_ifindex (device);
 	enabled = nm_setting_bridge_get_vlan_filtering (s_bridge);
 
+	lnk =   self->options_via_sysfs
+	      ? NULL
+	      : nm_platform_link_get_lnk_bridge (plat, ifindex, NULL);
+	if (lnk) {
+		cur_filtering = g_strdup (lnk->vlan_filtering ? "1" : "0");
+		cur_pvid = g_strdup_printf ("%u", (guint) lnk->vlan_default_pvid);
+	} else {
+		cur_filtering = nm_platform_sysctl_master_get_option (plat, ifindex, "vlan_filtering");
+		cur_pvid = nm_platform_sysctl_master_get_option (plat, ifindex, "default_pvid");
+	}
+
 	if (!enabled) {
-		nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "0");
-		nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", "1");
-		nm_platform_link_set_bridge_vlans (plat, ifindex, FALSE, NULL);
+		if (!nm_streq0 (cur_filtering, "0"))
+			nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "0");
+		if (!nm_streq0 (cur_pvid, "1"))
+			nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", "1");
+		nm_platform_link_sync_bridge_vlans (plat, ifindex, FALSE, NULL);
 		return TRUE;
 	}
 
@@ -450,39 +591,39 @@ bridge_set_vlan_options (NMDevice *device, NMSettingBridge *s_bridge)
 
 	self->vlan_configured = TRUE;
 
-	/* Filtering must be disabled to change the default PVID */
-	if (!nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "0"))
-		return FALSE;
-
-	/* Clear the default PVID so that we later can force the re-creation of
-	 * default PVID VLANs by writing the option again. */
-	if (!nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", "0"))
-		return FALSE;
+	pvid = nm_setting_bridge_get_vlan_default_pvid (s_bridge);
+	nm_sprintf_buf (value, "%u", pvid);
 
-	/* Clear all existing VLANs */
-	if (!nm_platform_link_set_bridge_vlans (plat, ifindex, FALSE, NULL))
-		return FALSE;
+	if (   !nm_streq0 (cur_filtering, "1")
+	    || !nm_streq0 (cur_pvid, value)) {
+		/* Filtering must be disabled to change the default PVID */
+		if (!nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "0"))
+			return FALSE;
 
-	/* Now set the default PVID. After this point the kernel creates
-	 * a PVID VLAN on each port, including the bridge itself. */
-	pvid = nm_setting_bridge_get_vlan_default_pvid (s_bridge);
-	if (pvid) {
-		char value[32];
+		/* Clear the default PVID so that we later can force the re-creation of
+		 * default PVID VLANs by writing the option again. */
+		if (!nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", "0"))
+			return FALSE;
 
-		nm_sprintf_buf (value, "%u", pvid);
-		if (!nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", value))
+		/* Now set the default PVID. After this point the kernel creates
+		 * a PVID VLAN on each port, including the bridge itself. */
+		if (   pvid
+		    && !nm_platform_sysctl_master_set_option (plat, ifindex, "default_pvid", value))
 			return FALSE;
+
+		nm_clear_g_free (&cur_filtering);
 	}
 
-	/* Create VLANs only after setting the default PVID, so that
-	 * any PVID VLAN overrides the bridge's default PVID. */
+	/* Only change the VLANs that differ from the desired ones. The default
+	 * PVID VLAN is part of the desired state, so that any PVID VLAN from the
+	 * setting overrides the bridge's default PVID. */
 	g_object_get (s_bridge, NM_SETTING_BRIDGE_VLANS, &vlans, NULL);
-	plat_vlans = setting_vlans_to_platform (vlans);
-	if (   plat_vlans
-	    && !nm_platform_link_set_bridge_vlans (plat, ifindex, FALSE, plat_vlans))
+	plat_vlans = setting_vlans_to_platform (vlans, pvid);
+	if (!nm_platform_link_sync_bridge_vlans (plat, ifindex, FALSE, plat_vlans))
 		return FALSE;
 
-	if (!nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "1"))
+	if (   !nm_streq0 (cur_filtering, "1")
+	    && !nm_platform_sysctl_master_set_option (plat, ifindex, "vlan_filtering", "1"))
 		return FALSE;
 
 	return TRUE;
@@ -493,7 +634,6 @@ act_stage1_prepare (NMDevice *device, NMDeviceStateReason *out_failure_reason)
 {
 	NMConnection *connection;
 	NMSetting *s_bridge;
-	const Option *option;
 
 	connection = nm_device_get_applied_connection (device);
 	g_return_val_if_fail (connection, NM_ACT_STAGE_RETURN_FAILURE);
@@ -501,8 +641,7 @@ act_stage1_prepare (NMDevice *device, NMDeviceStateReason *out_failure_reason)
 	s_bridge = (NMSetting *) nm_connection_get_setting_bridge (connection);
 	g_return_val_if_fail (s_bridge, NM_ACT_STAGE_RETURN_FAILURE);
 
-	for (option = master_options; option->name; option++)
-		commit_option (device, s_bridge, option, FALSE);
+	commit_master_options (device, s_bridge);
 
 	if (!bridge_set_vlan_options (device, (NMSettingBridge *) s_bridge)) {
 		NM_SET_OUT (out_failure_reason, NM_DEVICE_STATE_REASON_CONFIG_FAILED);
@@ -646,16 +785,16 @@ enslave_slave (NMDevice *device,
 			if (s_port)
 				g_object_get (s_port, NM_SETTING_BRIDGE_PORT_VLANS, &vlans, NULL);
 
-			plat_vlans = setting_vlans_to_platform (vlans);
-
-			/* Since the link was just enslaved, there are no existing VLANs
-			 * (except for the default one) and so there's no need to flush. */
+			/* A newly enslaved port has only the VLAN of the default PVID.
+			 * If the port was already enslaved, it might have other VLANs
+			 * from before, and only the differences get changed. */
+			plat_vlans = setting_vlans_to_platform (vlans,
+			                                        nm_setting_bridge_get_vlan_default_pvid (s_bridge));
 
-			if (   plat_vlans
-			    && !nm_platform_link_set_bridge_vlans (nm_device_get_platform (slave),
-			                                           nm_device_get_ifindex (slave),
-			                                           TRUE,
-			                                           plat_vlans))
+			if (!nm_platform_link_sync_bridge_vlans (nm_device_get_platform (slave),
+			                                         nm_device_get_ifindex (slave),
+			                                         TRUE,
+			                                         plat_vlans))
 				return FALSE;
 		}
 
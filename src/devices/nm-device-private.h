@@ -126,6 +126,9 @@ gboolean nm_device_dhcp4_renew (NMDevice *device, gboolean release);
 gboolean nm_device_dhcp6_renew (NMDevice *device, gboolean release);
 
 void nm_device_recheck_available_connections (NMDevice *device);
+void nm_device_recheck_available_connections_for (NMDevice *device,
+                                                  NMSettingsConnection *const*sett_conns,
+                                                  guint len);
 
 void nm_device_master_check_slave_physical_port (NMDevice *self, NMDevice *slave,
                                                  NMLogDomain log_domain);
@@ -92,6 +92,9 @@ typedef struct {
 	gint64 next_try_at_nsec;
 
 	guint resolv_fail_count;
+
+	/* whether @sockaddr changed since it was last configured in the kernel. */
+	bool sockaddr_dirty:1;
 } PeerEndpointResolveData;
 
 typedef struct {
@@ -759,8 +762,10 @@ _peers_resolve_cb (GObject *source_object,
 		 * anyway. Either the IP address is still good (and we would wrongly
 		 * reject it), or it isn't -- in which case it does not hurt much. */
 	} else {
-		if (nm_sock_addr_union_cmp (&peer_data->ep_resolv.sockaddr, &sockaddr) != 0)
+		if (nm_sock_addr_union_cmp (&peer_data->ep_resolv.sockaddr, &sockaddr) != 0) {
 			changed = TRUE;
+			peer_data->ep_resolv.sockaddr_dirty = TRUE;
+		}
 		peer_data->ep_resolv.sockaddr = sockaddr;
 	}
 
@@ -1023,6 +1028,12 @@ _peers_get_platform_list (NMDeviceWireGuardPrivate *priv,
 		NMPWireGuardPeer *plp = &plpeers[i_good];
 		NMSettingSecretFlags psk_secret_flags;
 
+		if (   config_mode == LINK_CONFIG_MODE_ENDPOINTS
+		    && !peer_data->ep_resolv.sockaddr_dirty) {
+			/* only peers whose endpoint changed need an update. */
+			continue;
+		}
+
 		if (!nm_utils_base64secret_decode (nm_wireguard_peer_get_public_key (peer_data->peer),
 		                                   sizeof (plp->public_key),
 		                                   plp->public_key))
@@ -1044,6 +1055,12 @@ _peers_get_platform_list (NMDeviceWireGuardPrivate *priv,
 		} else
 			*plf |= NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT;
 
+		if (config_mode == LINK_CONFIG_MODE_ENDPOINTS) {
+			/* the peer is expected to be configured already. Don't re-add it,
+			 * if it was removed in the meantime. */
+			*plf |= NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+		}
+
 		if (NM_IN_SET (config_mode, LINK_CONFIG_MODE_FULL,
 		                            LINK_CONFIG_MODE_REAPPLY)) {
 			psk_secret_flags = nm_wireguard_peer_get_preshared_key_flags (peer_data->peer);
@@ -1361,6 +1378,7 @@ link_config (NMDeviceWireGuard *self,
 	const char *setting_name;
 	gboolean peers_removed;
 	NMPlatformWireGuardChangeFlags wg_change_flags;
+	PeerData *peer_data;
 	int ifindex;
 	int r;
 
@@ -1462,6 +1480,10 @@ link_config (NMDeviceWireGuard *self,
 		return NM_ACT_STAGE_RETURN_FAILURE;
 	}
 
+	/* all resolved endpoints are now configured. */
+	c_list_for_each_entry (peer_data, &priv->lst_peers_head, lst_peers)
+		peer_data->ep_resolv.sockaddr_dirty = FALSE;
+
 	return NM_ACT_STAGE_RETURN_SUCCESS;
 }
 
@@ -232,6 +232,10 @@ typedef struct _NMDevicePrivate {
 	guint device_link_changed_id;
 	guint device_ip_link_changed_id;
 
+	/* platform change notifications for ifindex and ip-ifindex. */
+	NMPlatformIfindexListener *platform_listener;
+	NMPlatformIfindexListener *platform_ip_listener;
+
 	NMDeviceState state;
 	NMDeviceStateReason state_reason;
 	struct {
@@ -331,6 +335,9 @@ typedef struct _NMDevicePrivate {
 		ActivationHandleFunc activation_source_func_x[2];
 	};
 
+	/* links the device into the activation queue, while a source is scheduled. */
+	NMUtilsBatchIdleEntry activation_source_lnk_x[2];
+
 	guint           recheck_assume_id;
 
 	struct {
@@ -511,7 +518,20 @@ typedef struct _NMDevicePrivate {
 	};
 
 	AppliedConfig  ac_ip6_config;  /* config from IPv6 autoconfiguration */
+	NMIP4Config *  ext_ip4_config_captured; /* Configuration captured from platform. */
 	NMIP6Config *  ext_ip6_config_captured; /* Configuration captured from platform. */
+
+	/* Platform addresses and routes of the ip-ifindex that changed since
+	 * ext_ip*_config_captured was last updated, indexed by IS_IPv4. If
+	 * ext_ip_config_resync_x is set, we possibly missed changes and
+	 * the next update captures the configuration anew. */
+	GHashTable *   ext_ip_config_changed_x[2];
+	bool           ext_ip_config_resync_x[2];
+
+	/* The internal configurations possibly changed since ext_ip_config_x
+	 * was last updated. Platform changes can then no longer be applied to
+	 * it, and it gets cloned from ext_ip*_config_captured again. */
+	bool           ext_ip_config_reset_x[2];
 	NMIP6Config *  dad6_ip6_config;
 	struct in6_addr ipv6ll_addr;
 
@@ -588,6 +608,12 @@ typedef struct _NMDevicePrivate {
 		SriovOp *next;       /* next SR-IOV operation scheduled */
 	} sriov;
 
+	struct {
+		/* set while bringing the link up before committing the IP configuration. */
+		GCancellable *cancellable_x[2];
+		bool done_x[2];
+	} stage5_link_up;
+
 	struct {
 		guint timeout_id;
 		guint refresh_rate_ms;
@@ -1410,6 +1436,32 @@ nm_device_get_iface (NMDevice *self)
 	return NM_DEVICE_GET_PRIVATE (self)->iface;
 }
 
+static void
+_platform_listeners_update (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	gboolean changed = FALSE;
+	int ip_ifindex;
+
+	if (!priv->platform_listener)
+		return;
+
+	/* the platform_ip_listener is only needed if the ip-ifindex differs.
+	 * Otherwise, there would be two listeners for the same ifindex. */
+	ip_ifindex = nm_device_get_ip_ifindex (self);
+	if (nm_platform_ifindex_listener_set_ifindex (priv->platform_listener, priv->ifindex))
+		changed = TRUE;
+	if (nm_platform_ifindex_listener_set_ifindex (priv->platform_ip_listener,
+	                                              ip_ifindex != priv->ifindex ? ip_ifindex : 0))
+		changed = TRUE;
+
+	if (changed) {
+		/* we might have missed changes while not listening. */
+		priv->ext_ip_config_resync_x[0] = TRUE;
+		priv->ext_ip_config_resync_x[1] = TRUE;
+	}
+}
+
 gboolean
 nm_device_take_over_link (NMDevice *self, int ifindex, char **old_name)
 {
@@ -1445,6 +1497,7 @@ nm_device_take_over_link (NMDevice *self, int ifindex, char **old_name)
 
 	if (success) {
 		priv->ifindex = ifindex;
+		_platform_listeners_update (self);
 		_notify (self, PROP_IFINDEX);
 	}
 
@@ -1553,8 +1606,10 @@ _set_ip_ifindex (NMDevice *self,
 	if (!eq_name) {
 		g_free (priv->ip_iface);
 		priv->ip_iface = g_strdup (ifname);
-		_notify (self, PROP_IP_IFACE);
 	}
+	_platform_listeners_update (self);
+	if (!eq_name)
+		_notify (self, PROP_IP_IFACE);
 
 	if (priv->ip_ifindex > 0) {
 		platform = nm_device_get_platform (self);
@@ -4238,6 +4293,7 @@ nm_device_update_from_platform_link (NMDevice *self, const NMPlatformLink *plink
 	ifindex = plink ? plink->ifindex : 0;
 	if (priv->ifindex != ifindex) {
 		priv->ifindex = ifindex;
+		_platform_listeners_update (self);
 		_notify (self, PROP_IFINDEX);
 		NM_DEVICE_GET_CLASS (self)->link_changed (self, plink);
 	}
@@ -4723,6 +4779,7 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 	priv->ip_ifindex = 0;
 	if (nm_clear_g_free (&priv->ip_iface))
 		_notify (self, PROP_IP_IFACE);
+	_platform_listeners_update (self);
 
 	_set_mtu (self, 0);
 
@@ -6129,6 +6186,21 @@ dnsmasq_state_changed_cb (NMDnsMasqManager *manager, guint32 status, gpointer us
 
 /*****************************************************************************/
 
+/* All scheduled activation stages of all devices are queued here and
+ * dispatched by a single idle handler. That way, bringing up many devices
+ * at once processes one stage for every device per mainloop iteration,
+ * instead of creating and destroying an idle source for each. */
+static NMUtilsBatchIdle _activation_queue = NM_UTILS_BATCH_IDLE_INIT (_activation_queue);
+static guint _activation_id_counter;
+
+static void
+_activation_source_unqueue (NMDevicePrivate *priv, gboolean IS_IPv4)
+{
+	nm_utils_batch_idle_unqueue (&priv->activation_source_lnk_x[IS_IPv4]);
+	priv->activation_source_id_x[IS_IPv4] = 0;
+	priv->activation_source_func_x[IS_IPv4] = NULL;
+}
+
 static void
 activation_source_clear (NMDevice *self,
                          int addr_family)
@@ -6141,12 +6213,11 @@ activation_source_clear (NMDevice *self,
 		       _activation_func_to_string (priv->activation_source_func_x[IS_IPv4]),
 		       nm_utils_addr_family_to_char (addr_family),
 		       priv->activation_source_id_x[IS_IPv4]);
-		nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
-		priv->activation_source_func_x[IS_IPv4] = NULL;
+		_activation_source_unqueue (priv, IS_IPv4);
 	}
 }
 
-static gboolean
+static void
 activation_source_handle_cb (NMDevice *self,
                              int addr_family)
 {
@@ -6155,14 +6226,14 @@ activation_source_handle_cb (NMDevice *self,
 	ActivationHandleFunc activation_source_func;
 	guint activation_source_id;
 
-	g_return_val_if_fail (NM_IS_DEVICE (self), G_SOURCE_REMOVE);
+	g_return_if_fail (NM_IS_DEVICE (self));
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
 	activation_source_func = priv->activation_source_func_x[IS_IPv4];
 	activation_source_id = priv->activation_source_id_x[IS_IPv4];
 
-	g_return_val_if_fail (activation_source_id != 0, G_SOURCE_REMOVE);
+	g_return_if_fail (activation_source_id != 0);
 	nm_assert (activation_source_func);
 
 	priv->activation_source_func_x[IS_IPv4] = NULL;
@@ -6179,20 +6250,19 @@ activation_source_handle_cb (NMDevice *self,
 	       _activation_func_to_string (activation_source_func),
 	       nm_utils_addr_family_to_char (addr_family),
 	       activation_source_id);
-
-	return G_SOURCE_REMOVE;
 }
 
-static gboolean
+/* layer2 and IPv4 stages are dispatched first (priority 0), then IPv6. */
+static void
 activation_source_handle_cb_4 (gpointer user_data)
 {
-	return activation_source_handle_cb (user_data, AF_INET);
+	activation_source_handle_cb (user_data, AF_INET);
 }
 
-static gboolean
+static void
 activation_source_handle_cb_6 (gpointer user_data)
 {
-	return activation_source_handle_cb (user_data, AF_INET6);
+	activation_source_handle_cb (user_data, AF_INET6);
 }
 
 static void
@@ -6212,10 +6282,7 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 		return;
 	}
 
-	new_id = g_idle_add (  IS_IPv4
-	                     ? activation_source_handle_cb_4
-	                     : activation_source_handle_cb_6,
-	                     self);
+	new_id = (++_activation_id_counter) ?: (++_activation_id_counter);
 
 	if (priv->activation_source_id_x[IS_IPv4] != 0) {
 		_LOGD (LOGD_DEVICE, "activation-stage: schedule %s,v%c which replaces %s,v%c (id %u -> %u)",
@@ -6224,7 +6291,7 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 		       _activation_func_to_string (priv->activation_source_func_x[IS_IPv4]),
 		       nm_utils_addr_family_to_char (addr_family),
 		       priv->activation_source_id_x[IS_IPv4], new_id);
-		nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
+		_activation_source_unqueue (priv, IS_IPv4);
 	} else {
 		_LOGD (LOGD_DEVICE, "activation-stage: schedule %s,v%c (id %u)",
 		       _activation_func_to_string (func),
@@ -6234,6 +6301,9 @@ activation_source_schedule (NMDevice *self, ActivationHandleFunc func, int addr_
 
 	priv->activation_source_func_x[IS_IPv4] = func;
 	priv->activation_source_id_x[IS_IPv4] = new_id;
+	nm_utils_batch_idle_queue (&_activation_queue,
+	                           &priv->activation_source_lnk_x[IS_IPv4],
+	                           IS_IPv4 ? 0 : 1);
 }
 
 static void
@@ -6260,8 +6330,7 @@ activation_source_invoke_sync (NMDevice *self, ActivationHandleFunc func, int ad
 		       priv->activation_source_id_x[IS_IPv4]);
 	}
 
-	nm_clear_g_source (&priv->activation_source_id_x[IS_IPv4]);
-	priv->activation_source_func_x[IS_IPv4] = NULL;
+	_activation_source_unqueue (priv, IS_IPv4);
 
 	func (self);
 }
@@ -7511,6 +7580,7 @@ ip_config_merge_and_apply (NMDevice *self,
 	init_ip_config_dns_priority (self, composite);
 
 	if (commit) {
+		priv->ext_ip_config_reset_x[IS_IPv4] = TRUE;
 		if (priv->queued_ip_config_id_x[IS_IPv4])
 			update_ext_ip_config (self, addr_family, FALSE);
 		ensure_con_ip_config (self, addr_family);
@@ -10731,25 +10801,107 @@ nm_device_arp_announce (NMDevice *self)
 	nm_acd_manager_announce_addresses (priv->acd.announcing);
 }
 
+static void
+stage5_link_set_up_cb (GError *error, gpointer user_data)
+{
+	NMDevice *self;
+	NMDevicePrivate *priv;
+	gpointer addr_family_p;
+	int addr_family;
+
+	nm_utils_user_data_unpack (user_data, &self, &addr_family_p);
+
+	if (nm_utils_error_is_cancelled (error, FALSE))
+		return;
+
+	addr_family = GPOINTER_TO_INT (addr_family_p);
+	priv = NM_DEVICE_GET_PRIVATE (self);
+
+	if (error)
+		_LOGD (LOGD_DEVICE, "failed to bring up interface: %s", error->message);
+
+	g_clear_object (&priv->stage5_link_up.cancellable_x[addr_family == AF_INET]);
+	priv->stage5_link_up.done_x[addr_family == AF_INET] = TRUE;
+	activation_source_schedule (self,
+	                            activate_stage5_ip_config_result_x[addr_family == AF_INET],
+	                            addr_family);
+}
+
+/*
+ * stage5_link_set_up:
+ *
+ * The interface must be IFF_UP before IP config can be applied. Bringing
+ * it up is done asynchronously, so that activating many devices at once
+ * doesn't block on a netlink round trip for each of them.
+ *
+ * Returns: %TRUE if stage 5 can proceed. Otherwise, the link is being
+ *   brought up and stage 5 gets re-invoked afterwards.
+ */
+static gboolean
+stage5_link_set_up (NMDevice *self, int addr_family)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	int ip_ifindex;
+
+	ip_ifindex = nm_device_get_ip_ifindex (self);
+	if (ip_ifindex <= 0) {
+		/* there is no link to bring up. Let the caller fail committing
+		 * the configuration, like it did before. */
+		priv->stage5_link_up.done_x[IS_IPv4] = FALSE;
+		return TRUE;
+	}
+
+	if (   nm_platform_link_is_up (nm_device_get_platform (self), ip_ifindex)
+	    || nm_device_sys_iface_state_is_external_or_assume (self)) {
+		priv->stage5_link_up.done_x[IS_IPv4] = FALSE;
+		return TRUE;
+	}
+
+	if (priv->stage5_link_up.cancellable_x[IS_IPv4]) {
+		/* already in progress. */
+		return FALSE;
+	}
+
+	if (priv->stage5_link_up.done_x[IS_IPv4]) {
+		priv->stage5_link_up.done_x[IS_IPv4] = FALSE;
+		_LOGW (LOGD_DEVICE, "interface %s not up for IP configuration", nm_device_get_ip_iface (self));
+		return TRUE;
+	}
+
+	priv->stage5_link_up.cancellable_x[IS_IPv4] = g_cancellable_new ();
+	nm_platform_link_set_up_async (nm_device_get_platform (self),
+	                               ip_ifindex,
+	                               stage5_link_set_up_cb,
+	                               nm_utils_user_data_pack (self, GINT_TO_POINTER (addr_family)),
+	                               priv->stage5_link_up.cancellable_x[IS_IPv4]);
+	return FALSE;
+}
+
+static void
+stage5_link_set_up_cancel (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	nm_clear_g_cancellable (&priv->stage5_link_up.cancellable_x[0]);
+	nm_clear_g_cancellable (&priv->stage5_link_up.cancellable_x[1]);
+	priv->stage5_link_up.done_x[0] = FALSE;
+	priv->stage5_link_up.done_x[1] = FALSE;
+}
+
 static void
 activate_stage5_ip_config_result_4 (NMDevice *self)
 {
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	NMActRequest *req;
 	const char *method;
-	int ip_ifindex;
 	gboolean do_announce = FALSE;
 
 	req = nm_device_get_act_request (self);
 	g_assert (req);
 
-	/* Interface must be IFF_UP before IP config can be applied */
-	ip_ifindex = nm_device_get_ip_ifindex (self);
-	if (!nm_platform_link_is_up (nm_device_get_platform (self), ip_ifindex) && !nm_device_sys_iface_state_is_external_or_assume (self)) {
-		nm_platform_link_set_up (nm_device_get_platform (self), ip_ifindex, NULL);
-		if (!nm_platform_link_is_up (nm_device_get_platform (self), ip_ifindex))
-			_LOGW (LOGD_DEVICE, "interface %s not up for IP configuration", nm_device_get_ip_iface (self));
-	}
+	if (!stage5_link_set_up (self, AF_INET))
+		return;
 
 	if (!ip_config_merge_and_apply (self, AF_INET, TRUE)) {
 		_LOGD (LOGD_DEVICE | LOGD_IP4, "Activation: Stage 5 of 5 (IPv4 Commit) failed");
@@ -10949,21 +11101,15 @@ activate_stage5_ip_config_result_6 (NMDevice *self)
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
 	NMActRequest *req;
 	const char *method;
-	int ip_ifindex;
 	int errsv;
 
 	req = nm_device_get_act_request (self);
 	g_assert (req);
 
-	/* Interface must be IFF_UP before IP config can be applied */
-	ip_ifindex = nm_device_get_ip_ifindex (self);
-	g_return_if_fail (ip_ifindex);
+	g_return_if_fail (nm_device_get_ip_ifindex (self));
 
-	if (!nm_platform_link_is_up (nm_device_get_platform (self), ip_ifindex) && !nm_device_sys_iface_state_is_external_or_assume (self)) {
-		nm_platform_link_set_up (nm_device_get_platform (self), ip_ifindex, NULL);
-		if (!nm_platform_link_is_up (nm_device_get_platform (self), ip_ifindex))
-			_LOGW (LOGD_DEVICE, "interface %s not up for IP configuration", nm_device_get_ip_iface (self));
-	}
+	if (!stage5_link_set_up (self, AF_INET6))
+		return;
 
 	if (ip_config_merge_and_apply (self, AF_INET6, TRUE)) {
 		if (   priv->dhcp6.mode != NM_NDISC_DHCP_LEVEL_NONE
@@ -13111,8 +13257,8 @@ intersect_ext_config (NMDevice *self,
 	family = nm_ip_config_get_addr_family (config->orig);
 	penalty = default_route_metric_penalty_get (self, family);
 	ext = family == AF_INET
-	      ? (NMIPConfig *) priv->ext_ip_config_4
-	      : (NMIPConfig *) priv->ext_ip_config_6;
+	      ? (NMIPConfig *) priv->ext_ip4_config_captured
+	      : (NMIPConfig *) priv->ext_ip6_config_captured;
 
 	if (config->current) {
 		nm_ip_config_intersect (config->current,
@@ -13129,6 +13275,133 @@ intersect_ext_config (NMDevice *self,
 	}
 }
 
+static void
+_ext_ip_config_changed_add (NMDevice *self, int addr_family, const NMPObject *obj)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	GHashTable **p_changed = &priv->ext_ip_config_changed_x[addr_family == AF_INET];
+
+	if (!*p_changed) {
+		*p_changed = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+		                                    (GEqualFunc) nmp_object_id_equal,
+		                                    (GDestroyNotify) nmp_object_unref,
+		                                    NULL);
+	}
+	g_hash_table_add (*p_changed, (gpointer) nmp_object_ref (obj));
+}
+
+static void
+_ext_ip_config_changed_clear (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	g_clear_pointer (&priv->ext_ip_config_changed_x[0], g_hash_table_unref);
+	g_clear_pointer (&priv->ext_ip_config_changed_x[1], g_hash_table_unref);
+}
+
+static gboolean
+_ext_ip_config_capture_update (NMIPConfig *config,
+                               NMPlatform *platform,
+                               const NMPObject *obj,
+                               NMPlatformSignalChangeType change_type)
+{
+	if (NM_IS_IP4_CONFIG (config))
+		return nm_ip4_config_capture_update (NM_IP4_CONFIG (config), platform, obj, change_type);
+	return nm_ip6_config_capture_update (NM_IP6_CONFIG (config),
+	                                     platform,
+	                                     obj,
+	                                     change_type,
+	                                     NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+}
+
+/* Apply the pending platform changes to ext_ip*_config_captured. If that
+ * is not possible, capture the configuration anew.
+ *
+ * The same changes are applied to ext_ip_config_x, which afterwards still
+ * needs the internal configurations subtracted. Returns %FALSE if
+ * ext_ip_config_x could not be updated that way and must be cloned
+ * from the captured configuration. */
+static gboolean
+_ext_ip_config_captured_update (NMDevice *self, int addr_family, int ifindex)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	NMPlatform *platform = nm_device_get_platform (self);
+	gs_unref_hashtable GHashTable *changed = NULL;
+	NMIPConfig *captured;
+	NMIPConfig *ext;
+	GHashTableIter h_iter;
+	const NMPObject *obj;
+	gboolean resync;
+
+	changed = g_steal_pointer (&priv->ext_ip_config_changed_x[IS_IPv4]);
+	resync = priv->ext_ip_config_resync_x[IS_IPv4];
+	priv->ext_ip_config_resync_x[IS_IPv4] = FALSE;
+
+	captured =   IS_IPv4
+	           ? (NMIPConfig *) priv->ext_ip4_config_captured
+	           : (NMIPConfig *) priv->ext_ip6_config_captured;
+	ext = priv->ext_ip_config_x[IS_IPv4];
+	if (priv->ext_ip_config_reset_x[IS_IPv4]) {
+		priv->ext_ip_config_reset_x[IS_IPv4] = FALSE;
+		ext = NULL;
+	}
+
+	if (   resync
+	    || !captured
+	    || nm_ip_config_get_ifindex (captured) != ifindex)
+		goto capture;
+
+	if (!changed)
+		return !!ext;
+
+	g_hash_table_iter_init (&h_iter, changed);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &obj, NULL)) {
+		const NMPObject *plobj;
+		NMPlatformSignalChangeType change_type;
+
+		/* We only remember which objects changed. Their current state
+		 * is what the platform cache says. */
+		plobj = nm_platform_lookup_obj (platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, obj);
+		if (   plobj
+		    && nmp_object_is_visible (plobj))
+			change_type = NM_PLATFORM_SIGNAL_CHANGED;
+		else {
+			plobj = obj;
+			change_type = NM_PLATFORM_SIGNAL_REMOVED;
+		}
+
+		if (!_ext_ip_config_capture_update (captured, platform, plobj, change_type))
+			goto capture;
+
+		/* ext_ip_config_x has the same ifindex, so this can only fail
+		 * if the captured update failed too. */
+		if (   ext
+		    && !_ext_ip_config_capture_update (ext, platform, plobj, change_type))
+			nm_assert_not_reached ();
+	}
+
+	_LOGT (LOGD_DEVICE, "ip%c-config: updated captured configuration with %u changes",
+	       nm_utils_addr_family_to_char (addr_family),
+	       g_hash_table_size (changed));
+	return !!ext;
+
+capture:
+	if (IS_IPv4) {
+		g_clear_object (&priv->ext_ip4_config_captured);
+		priv->ext_ip4_config_captured = nm_ip4_config_capture (nm_device_get_multi_index (self),
+		                                                       platform,
+		                                                       ifindex);
+	} else {
+		g_clear_object (&priv->ext_ip6_config_captured);
+		priv->ext_ip6_config_captured = nm_ip6_config_capture (nm_device_get_multi_index (self),
+		                                                       platform,
+		                                                       ifindex,
+		                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	}
+	return FALSE;
+}
+
 static gboolean
 update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_configs)
 {
@@ -13147,18 +13420,20 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 
 	if (addr_family == AF_INET) {
 
-		g_clear_object (&priv->ext_ip_config_4);
-		priv->ext_ip_config_4 = nm_ip4_config_capture (nm_device_get_multi_index (self),
-		                                              nm_device_get_platform (self),
-		                                              ifindex);
-		if (priv->ext_ip_config_4) {
+		if (!_ext_ip_config_captured_update (self, AF_INET, ifindex)) {
+			g_clear_object (&priv->ext_ip_config_4);
+			if (priv->ext_ip4_config_captured)
+				priv->ext_ip_config_4 = nm_ip4_config_clone (priv->ext_ip4_config_captured);
+		}
+		if (priv->ext_ip4_config_captured) {
+
 			if (intersect_configs) {
 				/* This function was called upon external changes. Remove the configuration
 				 * (addresses,routes) that is no longer present externally from the internal
 				 * config. This way, we don't re-add addresses that were manually removed
 				 * by the user. */
 				if (priv->con_ip_config_4) {
-					nm_ip4_config_intersect (priv->con_ip_config_4, priv->ext_ip_config_4,
+					nm_ip4_config_intersect (priv->con_ip_config_4, priv->ext_ip4_config_captured,
 					                         TRUE,
 					                         is_up,
 					                         default_route_metric_penalty_get (self, AF_INET));
@@ -13168,7 +13443,7 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				intersect_ext_config (self, &priv->dev2_ip_config_4, TRUE, is_up);
 
 				for (iter = priv->vpn_configs_4; iter; iter = iter->next)
-					nm_ip4_config_intersect (iter->data, priv->ext_ip_config_4, TRUE, is_up, 0);
+					nm_ip4_config_intersect (iter->data, priv->ext_ip4_config_captured, TRUE, is_up, 0);
 			}
 
 			/* Remove parts from ext_ip_config_4 to only contain the information that
@@ -13195,23 +13470,20 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 	} else {
 		nm_assert (addr_family == AF_INET6);
 
-		g_clear_object (&priv->ext_ip_config_6);
-		g_clear_object (&priv->ext_ip6_config_captured);
-		priv->ext_ip6_config_captured = nm_ip6_config_capture (nm_device_get_multi_index (self),
-		                                                       nm_device_get_platform (self),
-		                                                       ifindex,
-		                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+		if (!_ext_ip_config_captured_update (self, AF_INET6, ifindex)) {
+			g_clear_object (&priv->ext_ip_config_6);
+			if (priv->ext_ip6_config_captured)
+				priv->ext_ip_config_6 = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+		}
 		if (priv->ext_ip6_config_captured) {
 
-			priv->ext_ip_config_6 = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
-
 			if (intersect_configs) {
 				/* This function was called upon external changes. Remove the configuration
 				 * (addresses,routes) that is no longer present externally from the internal
 				 * config. This way, we don't re-add addresses that were manually removed
 				 * by the user. */
 				if (priv->con_ip_config_6) {
-					nm_ip6_config_intersect (priv->con_ip_config_6, priv->ext_ip_config_6,
+					nm_ip6_config_intersect (priv->con_ip_config_6, priv->ext_ip6_config_captured,
 					                         is_up,
 					                         is_up,
 					                         default_route_metric_penalty_get (self, AF_INET6));
@@ -13222,11 +13494,11 @@ update_ext_ip_config (NMDevice *self, int addr_family, gboolean intersect_config
 				intersect_ext_config (self, &priv->dev2_ip_config_6, is_up, is_up);
 
 				for (iter = priv->vpn_configs_6; iter; iter = iter->next)
-					nm_ip6_config_intersect (iter->data, priv->ext_ip_config_6, is_up, is_up, 0);
+					nm_ip6_config_intersect (iter->data, priv->ext_ip6_config_captured, is_up, is_up, 0);
 
 				if (   is_up
 				    && priv->ipv6ll_has
-				    && !nm_ip6_config_lookup_address (priv->ext_ip_config_6, &priv->ipv6ll_addr))
+				    && !nm_ip6_config_lookup_address (priv->ext_ip6_config_captured, &priv->ipv6ll_addr))
 					priv->ipv6ll_has = FALSE;
 			}
 
@@ -13430,15 +13702,23 @@ device_ipx_changed (NMPlatform *platform,
 	if (nm_device_get_ip_ifindex (self) != ifindex)
 		return;
 
-	if (!nm_device_is_real (self))
-		return;
+	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	if (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
-		/* ignore all platform signals until the link is initialized in platform. */
+	if (   !nm_device_is_real (self)
+	    || nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT)) {
+		/* ignore all platform signals until the link is initialized in platform.
+		 * The captured configuration is now outdated. */
+		priv->ext_ip_config_resync_x[NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+		                                                  NMP_OBJECT_TYPE_IP4_ROUTE)] = TRUE;
 		return;
 	}
 
-	priv = NM_DEVICE_GET_PRIVATE (self);
+	_ext_ip_config_changed_add (self,
+	                            NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                                 NMP_OBJECT_TYPE_IP4_ROUTE)
+	                              ? AF_INET
+	                              : AF_INET6,
+	                            NMP_OBJECT_UP_CAST (platform_object));
 
 	switch (obj_type) {
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
@@ -13470,6 +13750,34 @@ device_ipx_changed (NMPlatform *platform,
 	}
 }
 
+static void
+platform_changed_cb (NMPlatform *platform,
+                     NMPObjectType obj_type,
+                     int ifindex,
+                     gconstpointer platform_object,
+                     NMPlatformSignalChangeType change_type,
+                     gpointer user_data)
+{
+	NMDevice *self = user_data;
+
+	if (obj_type == NMP_OBJECT_TYPE_LINK) {
+		link_changed_cb (platform,
+		                 obj_type,
+		                 ifindex,
+		                 (NMPlatformLink *) platform_object,
+		                 change_type,
+		                 self);
+		return;
+	}
+
+	device_ipx_changed (platform,
+	                    obj_type,
+	                    ifindex,
+	                    platform_object,
+	                    change_type,
+	                    self);
+}
+
 /*****************************************************************************/
 
 NM_UTILS_FLAGS2STR_DEFINE (nm_unmanaged_flags2str, NMUnmanagedFlags,
@@ -14396,6 +14704,47 @@ nm_device_recheck_available_connections (NMDevice *self)
 	available_connections_check_delete_unrealized (self);
 }
 
+/**
+ * nm_device_recheck_available_connections_for:
+ * @self: the #NMDevice
+ * @sett_conns: the connections to recheck
+ * @len: the number of connections in @sett_conns
+ *
+ * Like nm_device_recheck_available_connections(), but only reevaluates
+ * the availability of @sett_conns. This is for device types that know
+ * which connections can be affected by a change.
+ */
+void
+nm_device_recheck_available_connections_for (NMDevice *self,
+                                             NMSettingsConnection *const*sett_conns,
+                                             guint len)
+{
+	gboolean changed = FALSE;
+	guint i;
+
+	g_return_if_fail (NM_IS_DEVICE (self));
+
+	for (i = 0; i < len; i++) {
+		NMSettingsConnection *sett_conn = sett_conns[i];
+
+		if (nm_device_check_connection_available (self,
+		                                          nm_settings_connection_get_connection (sett_conn),
+		                                          NM_DEVICE_CHECK_CON_AVAILABLE_NONE,
+		                                          NULL,
+		                                          NULL)) {
+			if (available_connections_add (self, sett_conn))
+				changed = TRUE;
+		} else {
+			if (available_connections_del (self, sett_conn))
+				changed = TRUE;
+		}
+	}
+
+	if (changed)
+		_notify (self, PROP_AVAILABLE_CONNECTIONS);
+	available_connections_check_delete_unrealized (self);
+}
+
 /**
  * nm_device_get_best_connection:
  * @self: the #NMDevice
@@ -14648,6 +14997,7 @@ _cancel_activation (NMDevice *self)
 	/* Break the activation chain */
 	activation_source_clear (self, AF_INET);
 	activation_source_clear (self, AF_INET6);
+	stage5_link_set_up_cancel (self);
 }
 
 static void
@@ -14716,7 +15066,9 @@ _cleanup_generic_post (NMDevice *self, CleanupType cleanup_type)
 	g_clear_object (&priv->con_ip_config_6);
 	applied_config_clear (&priv->ac_ip6_config);
 	g_clear_object (&priv->ext_ip_config_6);
+	g_clear_object (&priv->ext_ip4_config_captured);
 	g_clear_object (&priv->ext_ip6_config_captured);
+	_ext_ip_config_changed_clear (self);
 	applied_config_clear (&priv->dev2_ip_config_6);
 	g_clear_object (&priv->ip_config_6);
 	g_clear_object (&priv->dad6_ip6_config);
@@ -16525,6 +16877,9 @@ nm_device_init (NMDevice *self)
 	c_list_init (&self->devices_lst);
 	c_list_init (&priv->slaves);
 
+	nm_utils_batch_idle_entry_init (&priv->activation_source_lnk_x[0], activation_source_handle_cb_6, self);
+	nm_utils_batch_idle_entry_init (&priv->activation_source_lnk_x[1], activation_source_handle_cb_4, self);
+
 	priv->concheck_x[0].state = NM_CONNECTIVITY_UNKNOWN;
 	priv->concheck_x[1].state = NM_CONNECTIVITY_UNKNOWN;
 
@@ -16609,13 +16964,13 @@ constructed (GObject *object)
 	if (NM_DEVICE_GET_CLASS (self)->get_generic_capabilities)
 		priv->capabilities |= NM_DEVICE_GET_CLASS (self)->get_generic_capabilities (self);
 
-	/* Watch for external IP config changes */
+	/* Watch for link and external IP config changes. Instead of subscribing
+	 * to the platform signals, which get emitted for every interface, only
+	 * listen for the ifindexes of this device. */
 	platform = nm_device_get_platform (self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
+	priv->platform_listener = nm_platform_ifindex_listener_new (platform, platform_changed_cb, self);
+	priv->platform_ip_listener = nm_platform_ifindex_listener_new (platform, platform_changed_cb, self);
+	_platform_listeners_update (self);
 
 	priv->settings = g_object_ref (NM_SETTINGS_GET);
 	g_assert (priv->settings);
@@ -16643,7 +16998,6 @@ dispose (GObject *object)
 {
 	NMDevice *self = NM_DEVICE (object);
 	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
-	NMPlatform *platform;
 	NMDeviceConnectivityHandle *con_handle;
 	gs_free_error GError *cancelled_error = NULL;
 
@@ -16658,14 +17012,14 @@ dispose (GObject *object)
 	}
 
 	nm_clear_g_cancellable (&priv->deactivating_cancellable);
+	stage5_link_set_up_cancel (self);
 
 	nm_device_assume_state_reset (self);
 
 	_parent_set_ifindex (self, 0, FALSE);
 
-	platform = nm_device_get_platform (self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ipx_changed), self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (link_changed_cb), self);
+	g_clear_pointer (&priv->platform_listener, nm_platform_ifindex_listener_free);
+	g_clear_pointer (&priv->platform_ip_listener, nm_platform_ifindex_listener_free);
 
 	arp_cleanup (self);
 
@@ -16748,11 +17102,15 @@ finalize (GObject *object)
 
 	_LOGD (LOGD_DEVICE, "finalize(): %s", G_OBJECT_TYPE_NAME (self));
 
+	nm_assert (!nm_utils_batch_idle_entry_is_queued (&priv->activation_source_lnk_x[0]));
+	nm_assert (!nm_utils_batch_idle_entry_is_queued (&priv->activation_source_lnk_x[1]));
+
 	g_free (priv->hw_addr);
 	g_free (priv->hw_addr_perm);
 	g_free (priv->hw_addr_initial);
 	g_slist_free (priv->pending_actions);
 	g_slist_free_full (priv->dad6_failed_addrs, (GDestroyNotify) nmp_object_unref);
+	_ext_ip_config_changed_clear (self);
 	g_clear_pointer (&priv->physical_port_id, g_free);
 	g_free (priv->udi);
 	g_free (priv->iface);
@@ -27,8 +27,11 @@ typedef enum {
 	LLDP_ATTR_TYPE_NONE,
 	LLDP_ATTR_TYPE_UINT32,
 	LLDP_ATTR_TYPE_STRING,
-	LLDP_ATTR_TYPE_VARDICT,
-	LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS,
+	LLDP_ATTR_TYPE_MAC_PHY_CONF,
+	LLDP_ATTR_TYPE_POWER_VIA_MDI,
+	LLDP_ATTR_TYPE_PPVIDS,
+	LLDP_ATTR_TYPE_VLANS,
+	LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES,
 } LldpAttrType;
 
 typedef enum {
@@ -52,13 +55,52 @@ typedef enum {
 	_LLDP_ATTR_ID_COUNT,
 } LldpAttrId;
 
+/* The attributes are kept in their plain form and only converted to
+ * GVariants when the neighbors are read (via D-Bus). */
+
+typedef struct {
+	guint16 pmd_autoneg_cap;
+	guint16 operational_mau_type;
+	guint8 autoneg;
+} LldpMacPhyConf;
+
+typedef struct {
+	guint8 mdi_power_support;
+	guint8 pse_power_pair;
+	guint8 power_class;
+} LldpPowerViaMdi;
+
+typedef struct {
+	CList lst;
+	guint16 ppvid;
+	guint8 flags;
+} LldpPpvid;
+
+typedef struct {
+	CList lst;
+	char *name;
+	guint16 vid;
+} LldpVlan;
+
+typedef struct {
+	CList lst;
+	guint32 interface_number;
+	guint8 address_subtype;
+	guint8 interface_number_subtype;
+	guint8 address_len;
+	guint8 oid_len;
+	guint8 address[31];
+	guint8 oid[];
+} LldpMgmtAddr;
+
 typedef struct {
 	LldpAttrType attr_type;
 	union {
 		guint32 v_uint32;
 		char *v_string;
-		GVariant *v_variant;
-		CList v_variant_list;
+		LldpMacPhyConf v_mac_phy_conf;
+		LldpPowerViaMdi v_power_via_mdi;
+		CList v_list;
 	};
 } LldpAttrData;
 
@@ -104,6 +146,11 @@ typedef struct {
 
 	struct ether_addr destination_address;
 
+	/* the raw frame as received. If it did not change, there is no need
+	 * to parse the TLVs again. */
+	guint8 *raw;
+	gsize raw_len;
+
 	bool valid:1;
 
 	LldpAttrData attrs[_LLDP_ATTR_ID_COUNT];
@@ -180,16 +227,16 @@ _NM_UTILS_LOOKUP_DEFINE (static, _lldp_attr_id_to_type, LldpAttrId, LldpAttrType
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_SYSTEM_NAME,                 LLDP_ATTR_TYPE_STRING),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_SYSTEM_DESCRIPTION,          LLDP_ATTR_TYPE_STRING),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_SYSTEM_CAPABILITIES,         LLDP_ATTR_TYPE_UINT32),
-	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_MANAGEMENT_ADDRESSES,        LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS),
+	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_MANAGEMENT_ADDRESSES,        LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_PVID,             LLDP_ATTR_TYPE_UINT32),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_PPVID,            LLDP_ATTR_TYPE_UINT32),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_PPVID_FLAGS,      LLDP_ATTR_TYPE_UINT32),
-	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_PPVIDS,           LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS),
+	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_PPVIDS,           LLDP_ATTR_TYPE_PPVIDS),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_VID,              LLDP_ATTR_TYPE_UINT32),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_VLAN_NAME,        LLDP_ATTR_TYPE_STRING),
-	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_VLANS,            LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS),
-	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_3_MAC_PHY_CONF,     LLDP_ATTR_TYPE_VARDICT),
-	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_3_POWER_VIA_MDI,    LLDP_ATTR_TYPE_VARDICT),
+	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_1_VLANS,            LLDP_ATTR_TYPE_VLANS),
+	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_3_MAC_PHY_CONF,     LLDP_ATTR_TYPE_MAC_PHY_CONF),
+	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_3_POWER_VIA_MDI,    LLDP_ATTR_TYPE_POWER_VIA_MDI),
 	NM_UTILS_LOOKUP_ITEM (LLDP_ATTR_ID_IEEE_802_3_MAX_FRAME_SIZE,   LLDP_ATTR_TYPE_UINT32),
 	NM_UTILS_LOOKUP_ITEM_IGNORE (_LLDP_ATTR_ID_COUNT),
 );
@@ -243,40 +290,128 @@ _lldp_attr_set_uint32 (LldpAttrData *pdata, LldpAttrId attr_id, guint32 v_uint32
 }
 
 static void
-_lldp_attr_set_vardict (LldpAttrData *pdata, LldpAttrId attr_id, GVariant *variant)
+_lldp_attr_set_mac_phy_conf (LldpAttrData *pdata, LldpAttrId attr_id, const LldpMacPhyConf *v_mac_phy_conf)
 {
-
 	nm_assert (pdata);
-	nm_assert (_lldp_attr_id_to_type (attr_id) == LLDP_ATTR_TYPE_VARDICT);
+	nm_assert (_lldp_attr_id_to_type (attr_id) == LLDP_ATTR_TYPE_MAC_PHY_CONF);
 
 	pdata = &pdata[attr_id];
 
 	/* we ignore duplicate fields silently */
-	if (pdata->attr_type != LLDP_ATTR_TYPE_NONE) {
-		nm_g_variant_unref_floating (variant);
+	if (pdata->attr_type != LLDP_ATTR_TYPE_NONE)
 		return;
-	}
+	pdata->attr_type = LLDP_ATTR_TYPE_MAC_PHY_CONF;
+	pdata->v_mac_phy_conf = *v_mac_phy_conf;
+}
 
-	pdata->attr_type = LLDP_ATTR_TYPE_VARDICT;
-	pdata->v_variant = g_variant_ref_sink (variant);
+static void
+_lldp_attr_set_power_via_mdi (LldpAttrData *pdata, LldpAttrId attr_id, const LldpPowerViaMdi *v_power_via_mdi)
+{
+	nm_assert (pdata);
+	nm_assert (_lldp_attr_id_to_type (attr_id) == LLDP_ATTR_TYPE_POWER_VIA_MDI);
+
+	pdata = &pdata[attr_id];
+
+	/* we ignore duplicate fields silently */
+	if (pdata->attr_type != LLDP_ATTR_TYPE_NONE)
+		return;
+	pdata->attr_type = LLDP_ATTR_TYPE_POWER_VIA_MDI;
+	pdata->v_power_via_mdi = *v_power_via_mdi;
 }
 
 static void
-_lldp_attr_add_vardict (LldpAttrData *pdata, LldpAttrId attr_id, GVariant *variant)
+_lldp_attr_add_list (LldpAttrData *pdata, LldpAttrId attr_id, CList *elem_lst)
 {
+	LldpAttrType attr_type = _lldp_attr_id_to_type (attr_id);
+
 	nm_assert (pdata);
-	nm_assert (_lldp_attr_id_to_type (attr_id) == LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS);
+	nm_assert (NM_IN_SET (attr_type, LLDP_ATTR_TYPE_PPVIDS,
+	                                 LLDP_ATTR_TYPE_VLANS,
+	                                 LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES));
 
-	g_variant_ref_sink (variant);
 	pdata = &pdata[attr_id];
 
 	if (pdata->attr_type == LLDP_ATTR_TYPE_NONE) {
-		c_list_init (&pdata->v_variant_list);
-		pdata->attr_type = LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS;
+		c_list_init (&pdata->v_list);
+		pdata->attr_type = attr_type;
 	} else
-		nm_assert (pdata->attr_type == LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS);
+		nm_assert (pdata->attr_type == attr_type);
 
-	c_list_link_tail (&pdata->v_variant_list, &nm_c_list_elem_new_stale (variant)->lst);
+	c_list_link_tail (&pdata->v_list, elem_lst);
+}
+
+static void
+_lldp_attr_list_free (LldpAttrType attr_type, CList *lst_head)
+{
+	CList *iter, *safe;
+
+	c_list_for_each_safe (iter, safe, lst_head) {
+		c_list_unlink_stale (iter);
+		switch (attr_type) {
+		case LLDP_ATTR_TYPE_PPVIDS:
+			g_slice_free (LldpPpvid, c_list_entry (iter, LldpPpvid, lst));
+			break;
+		case LLDP_ATTR_TYPE_VLANS: {
+			LldpVlan *vlan = c_list_entry (iter, LldpVlan, lst);
+
+			g_free (vlan->name);
+			g_slice_free (LldpVlan, vlan);
+			break;
+		}
+		case LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES:
+			g_free (c_list_entry (iter, LldpMgmtAddr, lst));
+			break;
+		default:
+			nm_assert_not_reached ();
+		}
+	}
+}
+
+static GVariant *
+_lldp_attr_list_to_variant (LldpAttrType attr_type, const CList *lst_head)
+{
+	GVariantBuilder builder;
+	GVariantDict dict;
+	CList *iter;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+
+	c_list_for_each (iter, lst_head) {
+		g_variant_dict_init (&dict, NULL);
+		switch (attr_type) {
+		case LLDP_ATTR_TYPE_PPVIDS: {
+			const LldpPpvid *ppvid = c_list_entry (iter, LldpPpvid, lst);
+
+			g_variant_dict_insert (&dict, "ppvid", "u", (guint32) ppvid->ppvid);
+			g_variant_dict_insert (&dict, "flags", "u", (guint32) ppvid->flags);
+			break;
+		}
+		case LLDP_ATTR_TYPE_VLANS: {
+			const LldpVlan *vlan = c_list_entry (iter, LldpVlan, lst);
+
+			g_variant_dict_insert (&dict, "vid", "u", (guint32) vlan->vid);
+			g_variant_dict_insert (&dict, "name", "s", vlan->name);
+			break;
+		}
+		case LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES: {
+			const LldpMgmtAddr *addr = c_list_entry (iter, LldpMgmtAddr, lst);
+
+			g_variant_dict_insert (&dict, "address-subtype", "u", (guint32) addr->address_subtype);
+			g_variant_dict_insert_value (&dict, "address",
+			                             g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, addr->address, addr->address_len, 1));
+			g_variant_dict_insert (&dict, "interface-number-subtype", "u", (guint32) addr->interface_number_subtype);
+			g_variant_dict_insert (&dict, "interface-number", "u", addr->interface_number);
+			g_variant_dict_insert_value (&dict, "object-id",
+			                             g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, addr->oid, addr->oid_len, 1));
+			break;
+		}
+		default:
+			nm_assert_not_reached ();
+		}
+		g_variant_builder_add_value (&builder, g_variant_dict_end (&dict));
+	}
+
+	return g_variant_builder_end (&builder);
 }
 
 /*****************************************************************************/
@@ -329,6 +464,7 @@ lldp_neighbor_free (LldpNeighbor *neighbor)
 	if (neighbor) {
 		g_free (neighbor->chassis_id);
 		g_free (neighbor->port_id);
+		g_free (neighbor->raw);
 		for (attr_id = 0; attr_id < _LLDP_ATTR_ID_COUNT; attr_id++) {
 			attr_type = neighbor->attrs[attr_id].attr_type;
 
@@ -336,12 +472,10 @@ lldp_neighbor_free (LldpNeighbor *neighbor)
 			case LLDP_ATTR_TYPE_STRING:
 				g_free (neighbor->attrs[attr_id].v_string);
 				break;
-			case LLDP_ATTR_TYPE_VARDICT:
-				g_variant_unref (neighbor->attrs[attr_id].v_variant);
-				break;
-			case LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS:
-				nm_c_list_elem_free_all (&neighbor->attrs[attr_id].v_variant_list,
-				                         (GDestroyNotify) g_variant_unref);
+			case LLDP_ATTR_TYPE_PPVIDS:
+			case LLDP_ATTR_TYPE_VLANS:
+			case LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES:
+				_lldp_attr_list_free (attr_type, &neighbor->attrs[attr_id].v_list);
 				break;
 			default:
 				;
@@ -359,46 +493,22 @@ lldp_neighbor_freep (LldpNeighbor **ptr)
 }
 
 static gboolean
-lldp_neighbor_equal (LldpNeighbor *a, LldpNeighbor *b)
+lldp_neighbor_raw_equal (const LldpNeighbor *a, const LldpNeighbor *b)
 {
-	LldpAttrId attr_id;
-
 	nm_assert (a);
 	nm_assert (b);
 
-	if (   a->chassis_id_type != b->chassis_id_type
-	    || a->port_id_type != b->port_id_type
-	    || ether_addr_equal (&a->destination_address, &b->destination_address)
-	    || !nm_streq0 (a->chassis_id, b->chassis_id)
-	    || !nm_streq0 (a->port_id, b->port_id))
-		return FALSE;
-
-	for (attr_id = 0; attr_id < _LLDP_ATTR_ID_COUNT; attr_id++) {
-		if (a->attrs[attr_id].attr_type != b->attrs[attr_id].attr_type)
-			return FALSE;
-		switch (a->attrs[attr_id].attr_type) {
-		case LLDP_ATTR_TYPE_UINT32:
-			if (a->attrs[attr_id].v_uint32 != b->attrs[attr_id].v_uint32)
-				return FALSE;
-			break;
-		case LLDP_ATTR_TYPE_STRING:
-			if (!nm_streq (a->attrs[attr_id].v_string, b->attrs[attr_id].v_string))
-				return FALSE;
-			break;
-		default:
-			nm_assert (a->attrs[attr_id].attr_type == LLDP_ATTR_TYPE_NONE);
-			break;
-		}
-	}
-
-	return TRUE;
+	/* the raw frame includes the Ethernet header (and thus the destination
+	 * address) and all TLVs. If it is the same, the parsed neighbors are
+	 * the same too. */
+	return    a->raw_len == b->raw_len
+	       && memcmp (a->raw, b->raw, a->raw_len) == 0;
 }
 
-static GVariant *
+static LldpMgmtAddr *
 parse_management_address_tlv (uint8_t *data, gsize len)
 {
-	GVariantDict dict;
-	GVariant *variant;
+	LldpMgmtAddr *addr;
 	gsize addr_len, oid_len;
 
 	/* 802.1AB-2009 - Figure 8-11
@@ -414,7 +524,7 @@ parse_management_address_tlv (uint8_t *data, gsize len)
 	 */
 
 	if (len < 11)
-		goto err;
+		return NULL;
 
 	nm_assert ((data[0] >> 1) == SD_LLDP_TYPE_MGMT_ADDRESS);
 	nm_assert ((((data[0] & 1) << 8) + data[1]) + 2 == len);
@@ -424,43 +534,33 @@ parse_management_address_tlv (uint8_t *data, gsize len)
 	addr_len = *data; /* length of (address subtype + address) */
 
 	if (addr_len < 2 || addr_len > 32)
-		goto err;
+		return NULL;
 	if (len < (  1         /* address stringth length */
 	           + addr_len  /* address subtype + address */
 	           + 5         /* interface */
 	           + 1))       /* oid */
-		goto err;
-
-	g_variant_dict_init (&dict, NULL);
+		return NULL;
 
-	data++;
-	len--;
-	g_variant_dict_insert (&dict, "address-subtype", "u", (guint32) *data);
-	variant = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, data + 1, addr_len - 1, 1);
-	g_variant_dict_insert_value (&dict, "address", variant);
+	oid_len = data[1 + addr_len + 5];
+	if (len < (1 + addr_len + 5 + 1 + oid_len))
+		return NULL;
 
-	data += addr_len;
-	len -= addr_len;
-	g_variant_dict_insert (&dict, "interface-number-subtype", "u", (guint32) *data);
+	addr = g_malloc (sizeof (LldpMgmtAddr) + oid_len);
 
 	data++;
-	len--;
-	g_variant_dict_insert (&dict, "interface-number", "u", unaligned_read_be32 (data));
+	addr->address_subtype = data[0];
+	addr->address_len = addr_len - 1;
+	memcpy (addr->address, &data[1], addr_len - 1);
 
-	data += 4;
-	len -= 4;
-	oid_len = *data;
+	data += addr_len;
+	addr->interface_number_subtype = data[0];
+	addr->interface_number = unaligned_read_be32 (&data[1]);
 
-	if (len < (1 + oid_len))
-		goto err;
+	data += 5;
+	addr->oid_len = oid_len;
+	memcpy (addr->oid, &data[1], oid_len);
 
-	data++;
-	variant = g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, data, oid_len, 1);
-	g_variant_dict_insert_value (&dict, "object-id", variant);
-	return g_variant_dict_end (&dict);
-err:
-	g_variant_dict_clear (&dict);
-	return NULL;
+	return addr;
 }
 
 static LldpNeighbor *
@@ -468,11 +568,10 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 {
 	nm_auto (lldp_neighbor_freep) LldpNeighbor *neigh = NULL;
 	uint8_t chassis_id_type, port_id_type;
-	uint16_t data16;
-	uint8_t *data8;
 	const void *chassis_id, *port_id;
-	gsize chassis_id_len, port_id_len, len;
-	const char *str;
+	gsize chassis_id_len, port_id_len;
+	const void *raw;
+	size_t raw_len;
 	int r;
 
 	r = sd_lldp_neighbor_get_chassis_id (neighbor_sd, &chassis_id_type,
@@ -544,6 +643,34 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 		goto out;
 	}
 
+	r = sd_lldp_neighbor_get_raw (neighbor_sd, &raw, &raw_len);
+	if (r < 0) {
+		g_set_error (error, NM_UTILS_ERROR, NM_UTILS_ERROR_UNKNOWN,
+		             "failed reading raw frame: %s", nm_strerror_native (-r));
+		goto out;
+	}
+	neigh->raw = g_memdup (raw, raw_len);
+	neigh->raw_len = raw_len;
+
+	neigh->valid = TRUE;
+
+out:
+	return g_steal_pointer (&neigh);
+}
+
+/* Parses the TLVs of @neighbor_sd into @neigh. On failure, @neigh
+ * is marked as invalid. */
+static void
+lldp_neighbor_parse_attrs (LldpNeighbor *neigh, sd_lldp_neighbor *neighbor_sd, GError **error)
+{
+	uint16_t data16;
+	uint8_t *data8;
+	const char *str;
+	gsize len;
+	int r;
+
+	nm_assert (neigh->valid);
+
 	if (sd_lldp_neighbor_get_port_description (neighbor_sd, &str) == 0)
 		_lldp_attr_set_str (neigh->attrs, LLDP_ATTR_ID_PORT_DESCRIPTION, str);
 
@@ -565,7 +692,7 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 	do {
 		guint8 oui[3];
 		guint8 type, subtype;
-		GVariant *variant;
+		LldpMgmtAddr *mgmt_addr;
 
 		if (sd_lldp_neighbor_tlv_get_type (neighbor_sd, &type) < 0)
 			continue;
@@ -575,11 +702,11 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 
 		switch (type) {
 		case SD_LLDP_TYPE_MGMT_ADDRESS:
-			variant = parse_management_address_tlv (data8, len);
-			if (variant) {
-				_lldp_attr_add_vardict (neigh->attrs,
-				                        LLDP_ATTR_ID_MANAGEMENT_ADDRESSES,
-				                        variant);
+			mgmt_addr = parse_management_address_tlv (data8, len);
+			if (mgmt_addr) {
+				_lldp_attr_add_list (neigh->attrs,
+				                     LLDP_ATTR_ID_MANAGEMENT_ADDRESSES,
+				                     &mgmt_addr->lst);
 			}
 			continue;
 		case SD_LLDP_TYPE_PRIVATE:
@@ -620,8 +747,6 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 		len -= 6;
 
 		if (memcmp (oui, SD_LLDP_OUI_802_1, sizeof (oui)) == 0) {
-			GVariantDict dict;
-
 			switch (subtype) {
 			case SD_LLDP_OUI_802_1_SUBTYPE_PORT_VLAN_ID:
 				if (len != 2)
@@ -629,7 +754,9 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 				_lldp_attr_set_uint32 (neigh->attrs, LLDP_ATTR_ID_IEEE_802_1_PVID,
 				                       unaligned_read_be16 (data8));
 				break;
-			case SD_LLDP_OUI_802_1_SUBTYPE_PORT_PROTOCOL_VLAN_ID:
+			case SD_LLDP_OUI_802_1_SUBTYPE_PORT_PROTOCOL_VLAN_ID: {
+				LldpPpvid *ppvid;
+
 				if (len != 3)
 					continue;
 				_lldp_attr_set_uint32 (neigh->attrs, LLDP_ATTR_ID_IEEE_802_1_PPVID_FLAGS,
@@ -637,19 +764,20 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 				_lldp_attr_set_uint32 (neigh->attrs, LLDP_ATTR_ID_IEEE_802_1_PPVID,
 				                       unaligned_read_be16 (&data8[1]));
 
-				g_variant_dict_init (&dict, NULL);
-				g_variant_dict_insert (&dict, "ppvid", "u", (guint32) unaligned_read_be16 (&data8[1]));
-				g_variant_dict_insert (&dict, "flags", "u", (guint32) data8[0]);
-
-				_lldp_attr_add_vardict (neigh->attrs,
-				                        LLDP_ATTR_ID_IEEE_802_1_PPVIDS,
-				                        g_variant_dict_end (&dict));
+				ppvid = g_slice_new (LldpPpvid);
+				ppvid->ppvid = unaligned_read_be16 (&data8[1]);
+				ppvid->flags = data8[0];
+				_lldp_attr_add_list (neigh->attrs,
+				                     LLDP_ATTR_ID_IEEE_802_1_PPVIDS,
+				                     &ppvid->lst);
 				break;
+			}
 			case SD_LLDP_OUI_802_1_SUBTYPE_VLAN_NAME: {
 				int l;
 				guint32 vid;
 				const char *name;
 				char *name_to_free;
+				LldpVlan *vlan;
 
 				if (len <= 3)
 					continue;
@@ -663,13 +791,12 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 				name = nm_utils_buf_utf8safe_escape (&data8[3], l, 0, &name_to_free);
 				vid = unaligned_read_be16 (&data8[0]);
 
-				g_variant_dict_init (&dict, NULL);
-				g_variant_dict_insert (&dict, "vid", "u", vid);
-				g_variant_dict_insert (&dict, "name", "s", name);
-
-				_lldp_attr_add_vardict (neigh->attrs,
-				                        LLDP_ATTR_ID_IEEE_802_1_VLANS,
-				                        g_variant_dict_end (&dict));
+				vlan = g_slice_new (LldpVlan);
+				vlan->vid = vid;
+				vlan->name = g_strdup (name);
+				_lldp_attr_add_list (neigh->attrs,
+				                     LLDP_ATTR_ID_IEEE_802_1_VLANS,
+				                     &vlan->lst);
 
 				_lldp_attr_set_uint32 (neigh->attrs, LLDP_ATTR_ID_IEEE_802_1_VID, vid);
 				if (name_to_free)
@@ -682,35 +809,39 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 				continue;
 			}
 		} else if (memcmp (oui, SD_LLDP_OUI_802_3, sizeof (oui)) == 0) {
-			GVariantDict dict;
-
 			switch (subtype) {
-			case SD_LLDP_OUI_802_3_SUBTYPE_MAC_PHY_CONFIG_STATUS:
+			case SD_LLDP_OUI_802_3_SUBTYPE_MAC_PHY_CONFIG_STATUS: {
+				LldpMacPhyConf mac_phy_conf;
+
 				if (len != 5)
 					continue;
 
-				g_variant_dict_init (&dict, NULL);
-				g_variant_dict_insert (&dict, "autoneg", "u", (guint32) data8[0]);
-				g_variant_dict_insert (&dict, "pmd-autoneg-cap", "u", (guint32) unaligned_read_be16 (&data8[1]));
-				g_variant_dict_insert (&dict, "operational-mau-type", "u", (guint32) unaligned_read_be16 (&data8[3]));
-
-				_lldp_attr_set_vardict (neigh->attrs,
-				                        LLDP_ATTR_ID_IEEE_802_3_MAC_PHY_CONF,
-				                        g_variant_dict_end (&dict));
+				mac_phy_conf = (LldpMacPhyConf) {
+					.autoneg              = data8[0],
+					.pmd_autoneg_cap      = unaligned_read_be16 (&data8[1]),
+					.operational_mau_type = unaligned_read_be16 (&data8[3]),
+				};
+				_lldp_attr_set_mac_phy_conf (neigh->attrs,
+				                             LLDP_ATTR_ID_IEEE_802_3_MAC_PHY_CONF,
+				                             &mac_phy_conf);
 				break;
-			case SD_LLDP_OUI_802_3_SUBTYPE_POWER_VIA_MDI:
+			}
+			case SD_LLDP_OUI_802_3_SUBTYPE_POWER_VIA_MDI: {
+				LldpPowerViaMdi power_via_mdi;
+
 				if (len != 3)
 					continue;
 
-				g_variant_dict_init (&dict, NULL);
-				g_variant_dict_insert (&dict, "mdi-power-support", "u", (guint32) data8[0]);
-				g_variant_dict_insert (&dict, "pse-power-pair", "u", (guint32) data8[1]);
-				g_variant_dict_insert (&dict, "power-class", "u", (guint32) data8[2]);
-
-				_lldp_attr_set_vardict (neigh->attrs,
-				                        LLDP_ATTR_ID_IEEE_802_3_POWER_VIA_MDI,
-				                        g_variant_dict_end (&dict));
+				power_via_mdi = (LldpPowerViaMdi) {
+					.mdi_power_support = data8[0],
+					.pse_power_pair    = data8[1],
+					.power_class       = data8[2],
+				};
+				_lldp_attr_set_power_via_mdi (neigh->attrs,
+				                              LLDP_ATTR_ID_IEEE_802_3_POWER_VIA_MDI,
+				                              &power_via_mdi);
 				break;
+			}
 			case SD_LLDP_OUI_802_3_SUBTYPE_MAXIMUM_FRAME_SIZE:
 				if (len != 2)
 					continue;
@@ -721,10 +852,10 @@ lldp_neighbor_new (sd_lldp_neighbor *neighbor_sd, GError **error)
 		}
 	} while (sd_lldp_neighbor_tlv_next (neighbor_sd) > 0);
 
-	neigh->valid = TRUE;
+	return;
 
 out:
-	return g_steal_pointer (&neigh);
+	neigh->valid = FALSE;
 }
 
 static GVariant *
@@ -781,25 +912,37 @@ lldp_neighbor_to_variant (LldpNeighbor *neigh)
 			                       _lldp_attr_id_to_name (attr_id),
 			                       g_variant_new_string (data->v_string));
 			break;
-		case LLDP_ATTR_TYPE_VARDICT:
+		case LLDP_ATTR_TYPE_MAC_PHY_CONF: {
+			GVariantDict dict;
+
+			g_variant_dict_init (&dict, NULL);
+			g_variant_dict_insert (&dict, "autoneg", "u", (guint32) data->v_mac_phy_conf.autoneg);
+			g_variant_dict_insert (&dict, "pmd-autoneg-cap", "u", (guint32) data->v_mac_phy_conf.pmd_autoneg_cap);
+			g_variant_dict_insert (&dict, "operational-mau-type", "u", (guint32) data->v_mac_phy_conf.operational_mau_type);
 			g_variant_builder_add (&builder, "{sv}",
 			                       _lldp_attr_id_to_name (attr_id),
-			                       data->v_variant);
+			                       g_variant_dict_end (&dict));
 			break;
-		case LLDP_ATTR_TYPE_ARRAY_OF_VARDICTS: {
-			NMCListElem *elem;
-			GVariantBuilder builder2;
-
-			g_variant_builder_init (&builder2, G_VARIANT_TYPE ("aa{sv}"));
-
-			c_list_for_each_entry (elem, &data->v_variant_list, lst)
-				g_variant_builder_add_value (&builder2, elem->data);
+		}
+		case LLDP_ATTR_TYPE_POWER_VIA_MDI: {
+			GVariantDict dict;
 
+			g_variant_dict_init (&dict, NULL);
+			g_variant_dict_insert (&dict, "mdi-power-support", "u", (guint32) data->v_power_via_mdi.mdi_power_support);
+			g_variant_dict_insert (&dict, "pse-power-pair", "u", (guint32) data->v_power_via_mdi.pse_power_pair);
+			g_variant_dict_insert (&dict, "power-class", "u", (guint32) data->v_power_via_mdi.power_class);
 			g_variant_builder_add (&builder, "{sv}",
 			                       _lldp_attr_id_to_name (attr_id),
-			                       g_variant_builder_end (&builder2));
+			                       g_variant_dict_end (&dict));
 			break;
 		}
+		case LLDP_ATTR_TYPE_PPVIDS:
+		case LLDP_ATTR_TYPE_VLANS:
+		case LLDP_ATTR_TYPE_MANAGEMENT_ADDRESSES:
+			g_variant_builder_add (&builder, "{sv}",
+			                       _lldp_attr_id_to_name (attr_id),
+			                       _lldp_attr_list_to_variant (data->attr_type, &data->v_list));
+			break;
 		case LLDP_ATTR_TYPE_NONE:
 			break;
 		}
@@ -886,8 +1029,11 @@ process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboo
 			g_hash_table_remove (priv->lldp_neighbors, neigh_old);
 			changed = TRUE;
 			goto done;
-		} else if (lldp_neighbor_equal (neigh_old, neigh))
+		} else if (lldp_neighbor_raw_equal (neigh_old, neigh)) {
+			/* neighbors usually resend the same frame over and over. Only
+			 * parse the TLVs if something changed. */
 			return;
+		}
 	} else if (!neighbor_valid) {
 		if (parse_error)
 			_LOGT ("process: failed to parse neighbor: %s", parse_error->message);
@@ -901,6 +1047,22 @@ process_lldp_neighbor (NMLldpListener *self, sd_lldp_neighbor *neighbor_sd, gboo
 		return;
 	}
 
+	lldp_neighbor_parse_attrs (neigh, neighbor_sd, p_parse_error);
+	if (!neigh->valid) {
+		if (neigh_old) {
+			_LOGT ("process: %s neigh: "LOG_NEIGH_FMT"%s%s%s",
+			       "remove", LOG_NEIGH_ARG (neigh),
+			       NM_PRINT_FMT_QUOTED (parse_error, " (failed to parse: ", parse_error->message, ")", ""));
+
+			g_hash_table_remove (priv->lldp_neighbors, neigh_old);
+			changed = TRUE;
+			goto done;
+		}
+		if (parse_error)
+			_LOGT ("process: failed to parse neighbor: %s", parse_error->message);
+		return;
+	}
+
 	_LOGD ("process: %s neigh: "LOG_NEIGH_FMT,
 	        neigh_old ? "update" : "new",
 	        LOG_NEIGH_ARG (neigh));
@@ -182,6 +182,88 @@ test_acd_probe_2 (test_fixture *fixture, gconstpointer user_data)
 	test_acd_common (fixture, &info);
 }
 
+typedef struct {
+	GMainLoop *loop;
+	guint n_pending;
+} ParallelData;
+
+static void
+acd_manager_probe_terminated_parallel (NMAcdManager *acd_manager, gpointer user_data)
+{
+	ParallelData *data = user_data;
+
+	g_assert_cmpint (data->n_pending, >, 0);
+	if (--data->n_pending == 0)
+		g_main_loop_quit (data->loop);
+}
+
+static void
+test_acd_probe_parallel (test_fixture *fixture, gconstpointer user_data)
+{
+	const guint N_MANAGERS = 64;
+	static const NMAcdCallbacks callbacks = {
+		.probe_terminated_callback = acd_manager_probe_terminated_parallel,
+	};
+	nm_auto_unref_gmainloop GMainLoop *loop = NULL;
+	gs_unref_ptrarray GPtrArray *managers = NULL;
+	ParallelData data = { };
+	const guint wait_time = 1000;
+	gint64 start_msec;
+	int fd;
+	guint i;
+
+	if (_skip_acd_test ())
+		return;
+
+	nmtstp_ip4_address_add (NULL, FALSE, fixture->ifindex1, ADDR4,
+	                        24, 0, 3600, 1800, 0, NULL);
+
+	loop = g_main_loop_new (NULL, FALSE);
+	data.loop = loop;
+	managers = g_ptr_array_new_with_free_func ((GDestroyNotify) nm_acd_manager_free);
+
+	/* start many independent managers on the same interface. They share one
+	 * NAcd context and run concurrently, so all of them terminate within
+	 * a single probe window. */
+	for (i = 0; i < N_MANAGERS; i++) {
+		NMAcdManager *manager;
+
+		manager = nm_acd_manager_new (fixture->ifindex0,
+		                              fixture->hwaddr0,
+		                              fixture->hwaddr0_len,
+		                              &callbacks,
+		                              &data);
+		g_assert (manager);
+		g_ptr_array_add (managers, manager);
+
+		g_assert (nm_acd_manager_add_address (manager, htonl (0x0a000001u + i)));
+		if (i % 8 == 0)
+			g_assert (nm_acd_manager_add_address (manager, ADDR4));
+	}
+
+	start_msec = g_get_monotonic_time () / 1000;
+	for (i = 0; i < N_MANAGERS; i++) {
+		g_assert_cmpint (nm_acd_manager_start_probe (managers->pdata[i], wait_time), ==, 0);
+		data.n_pending++;
+	}
+
+	/* all managers use the same NAcd context, with a single socket. */
+	fd = _nm_acd_manager_get_fd (managers->pdata[0]);
+	g_assert_cmpint (fd, >=, 0);
+	for (i = 1; i < N_MANAGERS; i++)
+		g_assert_cmpint (_nm_acd_manager_get_fd (managers->pdata[i]), ==, fd);
+
+	g_assert (nmtst_main_loop_run (loop, 5000));
+	g_assert_cmpint (data.n_pending, ==, 0);
+	g_assert_cmpint (g_get_monotonic_time () / 1000 - start_msec, <, 3 * wait_time);
+
+	for (i = 0; i < N_MANAGERS; i++) {
+		g_assert (nm_acd_manager_check_address (managers->pdata[i], htonl (0x0a000001u + i)));
+		if (i % 8 == 0)
+			g_assert (!nm_acd_manager_check_address (managers->pdata[i], ADDR4));
+	}
+}
+
 static void
 test_acd_announce (test_fixture *fixture, gconstpointer user_data)
 {
@@ -228,5 +310,6 @@ _nmtstp_setup_tests (void)
 {
 	g_test_add ("/acd/probe/1", test_fixture, NULL, fixture_setup, test_acd_probe_1, fixture_teardown);
 	g_test_add ("/acd/probe/2", test_fixture, NULL, fixture_setup, test_acd_probe_2, fixture_teardown);
+	g_test_add ("/acd/probe/parallel", test_fixture, NULL, fixture_setup, test_acd_probe_parallel, fixture_teardown);
 	g_test_add ("/acd/announce", test_fixture, NULL, fixture_setup, test_acd_announce, fixture_teardown);
 }
@@ -504,6 +504,89 @@ test_recv (TestRecvFixture *fixture, gconstpointer user_data)
 	g_clear_pointer (&loop, g_main_loop_unref);
 }
 
+TEST_RECV_FRAME_DEFINE (_test_recv_changed_frame1,
+	/* Ethernet header */
+	0x01, 0x80, 0xc2, 0x00, 0x00, 0x03,     /* Destination MAC */
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06,     /* Source MAC */
+	0x88, 0xcc,                             /* Ethertype */
+	/* LLDP mandatory TLVs */
+	0x02, 0x07, 0x04, 0x00, 0x01, 0x02,     /* Chassis: MAC, 00:01:02:03:04:05 */
+	0x03, 0x04, 0x05,
+	0x04, 0x04, 0x05, 0x31, 0x2f, 0x33,     /* Port: interface name, "1/3" */
+	0x06, 0x02, 0x00, 0x78,                 /* TTL: 120 seconds */
+	/* LLDP optional TLVs */
+	0x08, 0x04, 0x50, 0x6f, 0x72, 0x74,     /* Port Description: "Port" */
+	0x0a, 0x03, 0x53, 0x57, 0x32,           /* System Name: "SW2" */
+	0x0c, 0x04, 0x66, 0x6f, 0x6f, 0x00,     /* System Description: "foo" (NULL-terminated) */
+	0x00, 0x00                              /* End Of LLDPDU */
+);
+
+static void
+test_recv_changed (TestRecvFixture *fixture, gconstpointer user_data)
+{
+	gs_unref_object NMLldpListener *listener = NULL;
+	gs_unref_variant GVariant *neighbor = NULL;
+	gs_unref_variant GVariant *attr = NULL;
+	GMainLoop *loop;
+	TestRecvCallbackInfo info = { };
+	GVariant *neighbors;
+	gulong notify_id;
+	GError *error = NULL;
+	guint sd_id;
+
+	if (fixture->ifindex == 0) {
+		g_test_skip ("Tun device not available");
+		return;
+	}
+
+	listener = nm_lldp_listener_new ();
+	g_assert (listener != NULL);
+	g_assert (nm_lldp_listener_start (listener, fixture->ifindex, &error));
+	g_assert_no_error (error);
+
+	notify_id = g_signal_connect (listener, "notify::" NM_LLDP_LISTENER_NEIGHBORS,
+	                              (GCallback) lldp_neighbors_changed, &info);
+	loop = g_main_loop_new (NULL, FALSE);
+	sd_id = nm_sd_event_attach_default ();
+
+	/* the first frame adds the neighbor. */
+	g_assert (write (fixture->fd, _test_recv_data0_frame0.frame, _test_recv_data0_frame0.frame_len) == _test_recv_data0_frame0.frame_len);
+	if (nmtst_main_loop_run (loop, 500))
+		g_assert_not_reached ();
+	g_assert_cmpint (info.num_called, ==, 1);
+	_test_recv_data0_check (loop, listener);
+
+	/* the same frame again is no change. Wait longer than the rate limit
+	 * of the listener, so that a delayed notification would be seen too. */
+	g_assert (write (fixture->fd, _test_recv_data0_frame0.frame, _test_recv_data0_frame0.frame_len) == _test_recv_data0_frame0.frame_len);
+	if (nmtst_main_loop_run (loop, 2500))
+		g_assert_not_reached ();
+	g_assert_cmpint (info.num_called, ==, 1);
+
+	/* a changed frame from the same neighbor notifies once. */
+	g_assert (write (fixture->fd, _test_recv_changed_frame1.frame, _test_recv_changed_frame1.frame_len) == _test_recv_changed_frame1.frame_len);
+	if (nmtst_main_loop_run (loop, 2500))
+		g_assert_not_reached ();
+	g_assert_cmpint (info.num_called, ==, 2);
+
+	nm_clear_g_signal_handler (listener, &notify_id);
+
+	neighbors = nm_lldp_listener_get_neighbors (listener);
+	nmtst_assert_variant_is_of_type (neighbors, G_VARIANT_TYPE ("aa{sv}"));
+	g_assert_cmpint (g_variant_n_children (neighbors), ==, 1);
+
+	neighbor = get_lldp_neighbor (neighbors,
+	                              SD_LLDP_CHASSIS_SUBTYPE_MAC_ADDRESS, "00:01:02:03:04:05",
+	                              SD_LLDP_PORT_SUBTYPE_INTERFACE_NAME, "1/3");
+	g_assert (neighbor);
+
+	attr = g_variant_lookup_value (neighbor, NM_LLDP_ATTR_SYSTEM_NAME, G_VARIANT_TYPE_STRING);
+	nmtst_assert_variant_string (attr, "SW2");
+
+	nm_clear_g_source (&sd_id);
+	g_clear_pointer (&loop, g_main_loop_unref);
+}
+
 static void
 _test_recv_fixture_teardown (TestRecvFixture *fixture, gconstpointer user_data)
 {
@@ -530,4 +613,6 @@ _nmtstp_setup_tests (void)
 	_TEST_ADD_RECV ("/lldp/recv/0_twice", &_test_recv_data0_twice);
 	_TEST_ADD_RECV ("/lldp/recv/1",       &_test_recv_data1);
 	_TEST_ADD_RECV ("/lldp/recv/2_ttl1",  &_test_recv_data2_ttl1);
+
+	g_test_add ("/lldp/recv/changed", TestRecvFixture, NULL, _test_recv_fixture_setup, test_recv_changed, _test_recv_fixture_teardown);
 }
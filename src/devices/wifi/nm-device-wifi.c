@@ -74,6 +74,20 @@ typedef struct {
 	gint8             invalid_strength_counter;
 
 	CList             aps_lst_head;
+	GHashTable       *aps_idx_by_supplicant_path;
+
+	/* the APs by SSID (a GPtrArray of NMWifiAP for each SSID). An AP is only
+	 * compatible with profiles that have the same SSID. */
+	GHashTable       *aps_idx_by_ssid;
+
+	/* the SSIDs of the APs that were added or removed since the available
+	 * connections were last rechecked. */
+	GHashTable       *aps_changed_ssids;
+
+	/* the Wi-Fi profiles by SSID (a GPtrArray of NMSettingsConnection for
+	 * each SSID). It is created on demand and dropped whenever the
+	 * profiles change. */
+	GHashTable       *profiles_idx_by_ssid;
 
 	NMWifiAP *        current_ap;
 	guint32           rate;
@@ -89,6 +103,9 @@ typedef struct {
 	guint             pending_scan_id;
 	guint             ap_dump_id;
 
+	NMWifiAPsChanged  aps_changed;
+	bool              aps_changed_recheck_all:1;
+
 	NMSupplicantManager   *sup_mgr;
 	NMSupplicantInterface *sup_iface;
 	guint                  sup_timeout_id; /* supplicant association timeout */
@@ -465,6 +482,159 @@ periodic_update_cb (gpointer user_data)
 	return TRUE;
 }
 
+static NMWifiAP *
+_aps_find_by_supplicant_path (NMDeviceWifi *self, const char *path)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	nm_assert (path);
+	nm_assert (   g_hash_table_lookup (priv->aps_idx_by_supplicant_path, path)
+	           == nm_wifi_aps_find_by_supplicant_path (&priv->aps_lst_head, path));
+
+	return g_hash_table_lookup (priv->aps_idx_by_supplicant_path, path);
+}
+
+static NMWifiAP *
+_aps_find_first_compatible (NMDeviceWifi *self, NMConnection *connection)
+{
+	return nm_wifi_aps_idx_by_ssid_find_first_compatible (NM_DEVICE_WIFI_GET_PRIVATE (self)->aps_idx_by_ssid,
+	                                                      connection);
+}
+
+static void
+_aps_changed_ssids_add (NMDeviceWifi *self, GBytes *ssid)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	/* an AP without SSID is not compatible with any profile. */
+	if (!ssid)
+		return;
+
+	if (!priv->aps_changed_ssids)
+		priv->aps_changed_ssids = g_hash_table_new_full (g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref, NULL);
+	if (!g_hash_table_contains (priv->aps_changed_ssids, ssid))
+		g_hash_table_add (priv->aps_changed_ssids, g_bytes_ref (ssid));
+}
+
+static void
+_profiles_idx_clear (NMDeviceWifi *self)
+{
+	nm_clear_pointer (&NM_DEVICE_WIFI_GET_PRIVATE (self)->profiles_idx_by_ssid, g_hash_table_unref);
+}
+
+static GHashTable *
+_profiles_idx_get (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	NMSettingsConnection *const*connections;
+	guint i;
+
+	if (priv->profiles_idx_by_ssid)
+		return priv->profiles_idx_by_ssid;
+
+	priv->profiles_idx_by_ssid = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+	                                                    (GDestroyNotify) g_bytes_unref,
+	                                                    (GDestroyNotify) g_ptr_array_unref);
+
+	connections = nm_settings_get_connections (nm_device_get_settings ((NMDevice *) self), NULL);
+	for (i = 0; connections[i]; i++) {
+		NMSettingsConnection *sett_conn = connections[i];
+		NMSettingWireless *s_wifi;
+		GPtrArray *sett_conns;
+		GBytes *ssid;
+
+		s_wifi = nm_connection_get_setting_wireless (nm_settings_connection_get_connection (sett_conn));
+		if (!s_wifi)
+			continue;
+		ssid = nm_setting_wireless_get_ssid (s_wifi);
+		if (!ssid)
+			continue;
+
+		sett_conns = g_hash_table_lookup (priv->profiles_idx_by_ssid, ssid);
+		if (!sett_conns) {
+			sett_conns = g_ptr_array_new ();
+			g_hash_table_insert (priv->profiles_idx_by_ssid, g_bytes_ref (ssid), sett_conns);
+		}
+		g_ptr_array_add (sett_conns, sett_conn);
+	}
+
+	return priv->profiles_idx_by_ssid;
+}
+
+static void
+settings_connection_added_or_removed_cb (NMSettings *settings,
+                                         NMSettingsConnection *sett_conn,
+                                         gpointer user_data)
+{
+	_profiles_idx_clear (user_data);
+}
+
+static void
+settings_connection_updated_cb (NMSettings *settings,
+                                NMSettingsConnection *sett_conn,
+                                guint update_reason_u,
+                                gpointer user_data)
+{
+	_profiles_idx_clear (user_data);
+}
+
+static void
+_aps_changed_cb (gpointer user_data)
+{
+	NMDeviceWifi *self = user_data;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	gs_unref_hashtable GHashTable *changed_ssids = NULL;
+	gboolean recheck_all;
+
+	recheck_all = priv->aps_changed_recheck_all;
+	priv->aps_changed_recheck_all = FALSE;
+	changed_ssids = g_steal_pointer (&priv->aps_changed_ssids);
+
+	_notify (self, PROP_ACCESS_POINTS);
+
+	if (recheck_all)
+		nm_device_recheck_available_connections (NM_DEVICE (self));
+	else if (changed_ssids) {
+		gs_unref_ptrarray GPtrArray *sett_conns = NULL;
+		GHashTable *profiles_idx;
+		GHashTableIter iter;
+		GBytes *ssid;
+
+		/* only the availability of profiles with the SSID of an added or removed
+		 * AP can change. Collect (and reference) them first, because rechecking
+		 * emits signals and the index might get dropped meanwhile. */
+		profiles_idx = _profiles_idx_get (self);
+		sett_conns = g_ptr_array_new_with_free_func (g_object_unref);
+		g_hash_table_iter_init (&iter, changed_ssids);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &ssid, NULL)) {
+			GPtrArray *arr;
+			guint i;
+
+			arr = g_hash_table_lookup (profiles_idx, ssid);
+			for (i = 0; arr && i < arr->len; i++)
+				g_ptr_array_add (sett_conns, g_object_ref (arr->pdata[i]));
+		}
+		nm_device_recheck_available_connections_for (NM_DEVICE (self),
+		                                             (NMSettingsConnection *const*) sett_conns->pdata,
+		                                             sett_conns->len);
+	}
+
+	nm_device_emit_recheck_auto_activate (NM_DEVICE (self));
+}
+
+static void
+_aps_changed_schedule (NMDeviceWifi *self, GBytes *ssid, gboolean recheck_available_connections)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	/* during a scan, supplicant reports the BSS one by one. Only notify
+	 * about the changed list and recheck the connections once, after all
+	 * pending BSS signals were processed. */
+	if (recheck_available_connections)
+		_aps_changed_ssids_add (self, ssid);
+	nm_wifi_aps_changed_schedule (&priv->aps_changed);
+}
+
 static void
 ap_add_remove (NMDeviceWifi *self,
                gboolean is_adding, /* or else removing */
@@ -472,30 +642,36 @@ ap_add_remove (NMDeviceWifi *self,
                gboolean recheck_available_connections)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	const char *supplicant_path;
+
+	supplicant_path = nm_wifi_ap_get_supplicant_path (ap);
 
 	if (is_adding) {
 		g_object_ref (ap);
 		ap->wifi_device = NM_DEVICE (self);
 		c_list_link_tail (&priv->aps_lst_head, &ap->aps_lst);
+		if (supplicant_path) {
+			nm_assert (!g_hash_table_contains (priv->aps_idx_by_supplicant_path, supplicant_path));
+			g_hash_table_insert (priv->aps_idx_by_supplicant_path, (gpointer) supplicant_path, ap);
+		}
+		nm_wifi_aps_idx_by_ssid_add (priv->aps_idx_by_ssid, ap);
 		nm_dbus_object_export (NM_DBUS_OBJECT (ap));
 		_ap_dump (self, LOGL_DEBUG, ap, "added", 0);
 		nm_device_wifi_emit_signal_access_point (NM_DEVICE (self), ap, TRUE);
 	} else {
 		ap->wifi_device = NULL;
 		c_list_unlink (&ap->aps_lst);
+		if (supplicant_path)
+			g_hash_table_remove (priv->aps_idx_by_supplicant_path, supplicant_path);
+		nm_wifi_aps_idx_by_ssid_remove (priv->aps_idx_by_ssid, ap, nm_wifi_ap_get_ssid (ap));
 		_ap_dump (self, LOGL_DEBUG, ap, "removed", 0);
+		nm_device_wifi_emit_signal_access_point (NM_DEVICE (self), ap, FALSE);
 	}
 
-	_notify (self, PROP_ACCESS_POINTS);
+	_aps_changed_schedule (self, nm_wifi_ap_get_ssid (ap), recheck_available_connections);
 
-	if (!is_adding) {
-		nm_device_wifi_emit_signal_access_point (NM_DEVICE (self), ap, FALSE);
+	if (!is_adding)
 		nm_dbus_object_clear_and_unexport (&ap);
-	}
-
-	nm_device_emit_recheck_auto_activate (NM_DEVICE (self));
-	if (recheck_available_connections)
-		nm_device_recheck_available_connections (NM_DEVICE (self));
 }
 
 static void
@@ -512,7 +688,8 @@ remove_all_aps (NMDeviceWifi *self)
 	while ((ap = c_list_first_entry (&priv->aps_lst_head, NMWifiAP, aps_lst)))
 		ap_add_remove (self, FALSE, ap, FALSE);
 
-	nm_device_recheck_available_connections (NM_DEVICE (self));
+	priv->aps_changed_recheck_all = TRUE;
+	nm_wifi_aps_changed_flush (&priv->aps_changed);
 }
 
 static gboolean
@@ -731,7 +908,6 @@ check_connection_available (NMDevice *device,
                             GError **error)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (device);
-	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	NMSettingWireless *s_wifi;
 	const char *mode;
 
@@ -779,7 +955,7 @@ check_connection_available (NMDevice *device,
 	    || NM_FLAGS_HAS (flags, _NM_DEVICE_CHECK_CON_AVAILABLE_FOR_USER_REQUEST_IGNORE_AP))
 		return TRUE;
 
-	if (!nm_wifi_aps_find_first_compatible (&priv->aps_lst_head, connection)) {
+	if (!_aps_find_first_compatible (self, connection)) {
 		nm_utils_error_set_literal (error, NM_UTILS_ERROR_CONNECTION_AVAILABLE_TEMPORARY,
 		                            "no compatible access point found");
 		return FALSE;
@@ -796,7 +972,6 @@ complete_connection (NMDevice *device,
                      GError **error)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (device);
-	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	NMSettingWireless *s_wifi;
 	gs_free char *ssid_utf8 = NULL;
 	NMWifiAP *ap;
@@ -830,7 +1005,7 @@ complete_connection (NMDevice *device,
 
 		if (!nm_streq0 (mode, NM_SETTING_WIRELESS_MODE_AP)) {
 			/* Find a compatible AP in the scan list */
-			ap = nm_wifi_aps_find_first_compatible (&priv->aps_lst_head, connection);
+			ap = _aps_find_first_compatible (self, connection);
 
 			/* If we still don't have an AP, then the WiFI settings needs to be
 			 * fully specified by the client.  Might not be able to find an AP
@@ -958,7 +1133,6 @@ can_auto_connect (NMDevice *device,
                   char **specific_object)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (device);
-	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	NMConnection *connection;
 	NMSettingWireless *s_wifi;
 	NMWifiAP *ap;
@@ -1001,7 +1175,7 @@ can_auto_connect (NMDevice *device,
 			return FALSE;
 	}
 
-	ap = nm_wifi_aps_find_first_compatible (&priv->aps_lst_head, connection);
+	ap = _aps_find_first_compatible (self, connection);
 	if (ap) {
 		/* All good; connection is usable */
 		NM_SET_OUT (specific_object, g_strdup (nm_dbus_object_get_path (NM_DBUS_OBJECT (ap))));
@@ -1563,11 +1737,25 @@ supplicant_iface_bss_updated_cb (NMSupplicantInterface *iface,
 	if (NM_DEVICE_WIFI_GET_PRIVATE (self)->mode == NM_802_11_MODE_AP)
 		return;
 
-	found_ap = nm_wifi_aps_find_by_supplicant_path (&priv->aps_lst_head, object_path);
+	found_ap = _aps_find_by_supplicant_path (self, object_path);
 	if (found_ap) {
+		gs_unref_bytes GBytes *old_ssid = NULL;
+		GBytes *new_ssid;
+
+		old_ssid = nm_wifi_ap_get_ssid (found_ap);
+		if (old_ssid)
+			g_bytes_ref (old_ssid);
 		if (!nm_wifi_ap_update_from_properties (found_ap, object_path, properties))
 			return;
 		_ap_dump (self, LOGL_DEBUG, found_ap, "updated", 0);
+
+		new_ssid = nm_wifi_ap_get_ssid (found_ap);
+		if (!nm_gbytes_equal0 (old_ssid, new_ssid)) {
+			nm_wifi_aps_idx_by_ssid_remove (priv->aps_idx_by_ssid, found_ap, old_ssid);
+			nm_wifi_aps_idx_by_ssid_add (priv->aps_idx_by_ssid, found_ap);
+			_aps_changed_schedule (self, old_ssid, TRUE);
+			_aps_changed_schedule (self, new_ssid, TRUE);
+		}
 	} else {
 		gs_unref_object NMWifiAP *ap = NULL;
 
@@ -1623,7 +1811,7 @@ supplicant_iface_bss_removed_cb (NMSupplicantInterface *iface,
 	g_return_if_fail (object_path != NULL);
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	ap = nm_wifi_aps_find_by_supplicant_path (&priv->aps_lst_head, object_path);
+	ap = _aps_find_by_supplicant_path (self, object_path);
 	if (!ap)
 		return;
 
@@ -2192,7 +2380,7 @@ supplicant_iface_notify_current_bss (NMSupplicantInterface *iface,
 
 	current_bss = nm_supplicant_interface_get_current_bss (iface);
 	if (current_bss)
-		new_ap = nm_wifi_aps_find_by_supplicant_path (&priv->aps_lst_head, current_bss);
+		new_ap = _aps_find_by_supplicant_path (self, current_bss);
 
 	if (new_ap != priv->current_ap) {
 		const char *new_bssid = NULL;
@@ -2660,7 +2848,7 @@ act_stage1_prepare (NMDevice *device, NMDeviceStateReason *out_failure_reason)
 		     : NULL;
 	}
 	if (!ap)
-		ap = nm_wifi_aps_find_first_compatible (&priv->aps_lst_head, connection);
+		ap = _aps_find_first_compatible (self, connection);
 
 	if (!ap) {
 		/* If the user is trying to connect to an AP that NM doesn't yet know about
@@ -3286,6 +3474,12 @@ nm_device_wifi_init (NMDeviceWifi *self)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	c_list_init (&priv->aps_lst_head);
+	priv->aps_idx_by_supplicant_path = g_hash_table_new (nm_str_hash, g_str_equal);
+	priv->aps_idx_by_ssid = nm_wifi_aps_idx_by_ssid_new ();
+	priv->aps_changed = (NMWifiAPsChanged) {
+		.func      = _aps_changed_cb,
+		.user_data = self,
+	};
 
 	priv->hidden_probe_scan_warn = TRUE;
 	priv->mode = NM_802_11_MODE_INFRA;
@@ -3305,6 +3499,19 @@ constructed (GObject *object)
 
 	/* Connect to the supplicant manager */
 	priv->sup_mgr = g_object_ref (nm_supplicant_manager_get ());
+
+	g_signal_connect (nm_device_get_settings ((NMDevice *) self),
+	                  NM_SETTINGS_SIGNAL_CONNECTION_ADDED,
+	                  G_CALLBACK (settings_connection_added_or_removed_cb),
+	                  self);
+	g_signal_connect (nm_device_get_settings ((NMDevice *) self),
+	                  NM_SETTINGS_SIGNAL_CONNECTION_UPDATED,
+	                  G_CALLBACK (settings_connection_updated_cb),
+	                  self);
+	g_signal_connect (nm_device_get_settings ((NMDevice *) self),
+	                  NM_SETTINGS_SIGNAL_CONNECTION_REMOVED,
+	                  G_CALLBACK (settings_connection_added_or_removed_cb),
+	                  self);
 }
 
 NMDevice *
@@ -3337,6 +3544,14 @@ dispose (GObject *object)
 	g_clear_object (&priv->sup_mgr);
 
 	remove_all_aps (self);
+	nm_wifi_aps_changed_clear (&priv->aps_changed);
+	nm_clear_pointer (&priv->aps_changed_ssids, g_hash_table_unref);
+
+	if (nm_device_get_settings ((NMDevice *) self)) {
+		g_signal_handlers_disconnect_by_func (nm_device_get_settings ((NMDevice *) self), settings_connection_added_or_removed_cb, self);
+		g_signal_handlers_disconnect_by_func (nm_device_get_settings ((NMDevice *) self), settings_connection_updated_cb, self);
+	}
+	_profiles_idx_clear (self);
 
 	if (priv->p2p_device) {
 		/* Destroy the P2P device. */
@@ -3354,6 +3569,11 @@ finalize (GObject *object)
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
 	nm_assert (c_list_is_empty (&priv->aps_lst_head));
+	nm_assert (g_hash_table_size (priv->aps_idx_by_supplicant_path) == 0);
+	nm_assert (g_hash_table_size (priv->aps_idx_by_ssid) == 0);
+
+	g_hash_table_unref (priv->aps_idx_by_supplicant_path);
+	g_hash_table_unref (priv->aps_idx_by_ssid);
 
 	G_OBJECT_CLASS (nm_device_wifi_parent_class)->finalize (object);
 }
@@ -1531,6 +1531,148 @@ nm_wifi_aps_find_by_supplicant_path (const CList *aps_lst_head, const char *path
 
 /*****************************************************************************/
 
+/**
+ * nm_wifi_aps_idx_by_ssid_new:
+ *
+ * An index of access points by SSID, with a #GPtrArray of #NMWifiAP for
+ * each SSID. An AP can only be compatible with profiles that have the
+ * same SSID, so looking up a compatible AP only needs to check those.
+ * APs without SSID are not indexed. The index does not take references
+ * to the APs.
+ *
+ * Returns: (transfer full): the new index.
+ */
+GHashTable *
+nm_wifi_aps_idx_by_ssid_new (void)
+{
+	return g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+	                              (GDestroyNotify) g_bytes_unref,
+	                              (GDestroyNotify) g_ptr_array_unref);
+}
+
+void
+nm_wifi_aps_idx_by_ssid_add (GHashTable *aps_idx, NMWifiAP *ap)
+{
+	GBytes *ssid;
+	GPtrArray *aps;
+
+	ssid = nm_wifi_ap_get_ssid (ap);
+	if (!ssid)
+		return;
+
+	aps = g_hash_table_lookup (aps_idx, ssid);
+	if (!aps) {
+		aps = g_ptr_array_new ();
+		g_hash_table_insert (aps_idx, g_bytes_ref (ssid), aps);
+	}
+	g_ptr_array_add (aps, ap);
+}
+
+/**
+ * nm_wifi_aps_idx_by_ssid_remove:
+ * @aps_idx: the index
+ * @ap: the AP to remove
+ * @ssid: (allow-none): the SSID under which @ap was added. It differs
+ *   from the current SSID of @ap if that changed meanwhile.
+ */
+void
+nm_wifi_aps_idx_by_ssid_remove (GHashTable *aps_idx, NMWifiAP *ap, GBytes *ssid)
+{
+	GPtrArray *aps;
+
+	if (!ssid)
+		return;
+
+	aps = g_hash_table_lookup (aps_idx, ssid);
+	if (!aps)
+		g_return_if_reached ();
+
+	if (!g_ptr_array_remove (aps, ap))
+		g_return_if_reached ();
+	if (aps->len == 0)
+		g_hash_table_remove (aps_idx, ssid);
+}
+
+NMWifiAP *
+nm_wifi_aps_idx_by_ssid_find_first_compatible (GHashTable *aps_idx,
+                                               NMConnection *connection)
+{
+	NMSettingWireless *s_wifi;
+	GBytes *ssid;
+	GPtrArray *aps;
+	guint i;
+
+	s_wifi = nm_connection_get_setting_wireless (connection);
+	if (!s_wifi)
+		return NULL;
+
+	ssid = nm_setting_wireless_get_ssid (s_wifi);
+	if (!ssid)
+		return NULL;
+
+	aps = g_hash_table_lookup (aps_idx, ssid);
+	if (!aps)
+		return NULL;
+
+	for (i = 0; i < aps->len; i++) {
+		if (nm_wifi_ap_check_compatible (aps->pdata[i], connection))
+			return aps->pdata[i];
+	}
+	return NULL;
+}
+
+/*****************************************************************************/
+
+static gboolean
+_aps_changed_idle_cb (gpointer user_data)
+{
+	NMWifiAPsChanged *changed = user_data;
+
+	changed->idle_id = 0;
+	changed->func (changed->user_data);
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * nm_wifi_aps_changed_schedule:
+ * @changed: the #NMWifiAPsChanged
+ *
+ * Records that the list of access points changed. The callback gets
+ * invoked once from an idle handler, no matter how often the list
+ * changed meanwhile.
+ */
+void
+nm_wifi_aps_changed_schedule (NMWifiAPsChanged *changed)
+{
+	nm_assert (changed->func);
+
+	if (!changed->idle_id)
+		changed->idle_id = g_idle_add (_aps_changed_idle_cb, changed);
+}
+
+/**
+ * nm_wifi_aps_changed_flush:
+ * @changed: the #NMWifiAPsChanged
+ *
+ * Invokes the callback right away and cancels the pending idle handler.
+ */
+void
+nm_wifi_aps_changed_flush (NMWifiAPsChanged *changed)
+{
+	nm_assert (changed->func);
+
+	nm_clear_g_source (&changed->idle_id);
+	changed->func (changed->user_data);
+}
+
+void
+nm_wifi_aps_changed_clear (NMWifiAPsChanged *changed)
+{
+	nm_clear_g_source (&changed->idle_id);
+}
+
+/*****************************************************************************/
+
 NMWifiAP *
 nm_wifi_ap_lookup_for_device (NMDevice *device, const char *exported_path)
 {
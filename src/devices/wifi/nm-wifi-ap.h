@@ -96,6 +96,24 @@ NMWifiAP         *nm_wifi_aps_find_first_compatible (const CList *aps_lst_head,
 
 NMWifiAP         *nm_wifi_aps_find_by_supplicant_path (const CList *aps_lst_head, const char *path);
 
+GHashTable       *nm_wifi_aps_idx_by_ssid_new (void);
+void              nm_wifi_aps_idx_by_ssid_add (GHashTable *aps_idx, NMWifiAP *ap);
+void              nm_wifi_aps_idx_by_ssid_remove (GHashTable *aps_idx, NMWifiAP *ap, GBytes *ssid);
+NMWifiAP         *nm_wifi_aps_idx_by_ssid_find_first_compatible (GHashTable *aps_idx,
+                                                                 NMConnection *connection);
+
+/* Coalesces the changes to a list of access points. During a scan, supplicant
+ * reports the BSS one by one, but the list should only be handled once. */
+typedef struct {
+	void (*func) (gpointer user_data);
+	gpointer user_data;
+	guint idle_id;
+} NMWifiAPsChanged;
+
+void              nm_wifi_aps_changed_schedule (NMWifiAPsChanged *changed);
+void              nm_wifi_aps_changed_flush    (NMWifiAPsChanged *changed);
+void              nm_wifi_aps_changed_clear    (NMWifiAPsChanged *changed);
+
 NMWifiAP         *nm_wifi_ap_lookup_for_device (NMDevice *device, const char *exported_path);
 
 #endif /* __NM_WIFI_AP_H__ */
@@ -6,6 +6,7 @@
 #include "nm-default.h"
 
 #include "devices/wifi/nm-wifi-utils.h"
+#include "devices/wifi/nm-wifi-ap.h"
 #include "nm-core-internal.h"
 
 #include "nm-test-utils-core.h"
@@ -1337,6 +1338,153 @@ test_strength_all (void)
 
 /*****************************************************************************/
 
+static void
+_aps_changed_cb (gpointer user_data)
+{
+	guint *n_called = user_data;
+
+	(*n_called)++;
+}
+
+static void
+_iterate_main_context (void)
+{
+	while (g_main_context_iteration (NULL, FALSE)) {
+	}
+}
+
+static void
+test_aps_changed (void)
+{
+	guint n_called = 0;
+	NMWifiAPsChanged changed = {
+		.func      = _aps_changed_cb,
+		.user_data = &n_called,
+	};
+	guint i;
+
+	/* many changes are handled once, from an idle handler. */
+	for (i = 0; i < 100; i++)
+		nm_wifi_aps_changed_schedule (&changed);
+	g_assert_cmpint (n_called, ==, 0);
+	_iterate_main_context ();
+	g_assert_cmpint (n_called, ==, 1);
+	g_assert_cmpint (changed.idle_id, ==, 0);
+
+	_iterate_main_context ();
+	g_assert_cmpint (n_called, ==, 1);
+
+	/* changes after the callback get handled again. */
+	nm_wifi_aps_changed_schedule (&changed);
+	_iterate_main_context ();
+	g_assert_cmpint (n_called, ==, 2);
+
+	/* flushing handles pending changes right away. */
+	nm_wifi_aps_changed_schedule (&changed);
+	nm_wifi_aps_changed_flush (&changed);
+	g_assert_cmpint (n_called, ==, 3);
+	g_assert_cmpint (changed.idle_id, ==, 0);
+	_iterate_main_context ();
+	g_assert_cmpint (n_called, ==, 3);
+
+	/* clearing drops pending changes. */
+	nm_wifi_aps_changed_schedule (&changed);
+	nm_wifi_aps_changed_clear (&changed);
+	_iterate_main_context ();
+	g_assert_cmpint (n_called, ==, 3);
+}
+
+/*****************************************************************************/
+
+static NMConnection *
+_create_aps_idx_connection (const char *ssid, const char *key_mgmt)
+{
+	NMConnection *connection;
+
+	connection = create_basic (ssid, NULL, NM_802_11_MODE_INFRA);
+	if (key_mgmt) {
+		const KeyData wsec[] = {
+			{ NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, key_mgmt, 0 },
+			{ NULL } };
+
+		fill_wsec (connection, wsec);
+	}
+	return connection;
+}
+
+#define _assert_aps_idx_compatible(aps_idx, aps_lst_head, connection, expected_ap) \
+	G_STMT_START { \
+		NMConnection *const _connection = (connection); \
+		NMWifiAP *const _ap = nm_wifi_aps_idx_by_ssid_find_first_compatible ((aps_idx), _connection); \
+		\
+		g_assert (_ap == (expected_ap)); \
+		g_assert (_ap == nm_wifi_aps_find_first_compatible ((aps_lst_head), _connection)); \
+	} G_STMT_END
+
+static void
+test_aps_idx_by_ssid (void)
+{
+	gs_unref_hashtable GHashTable *aps_idx = nm_wifi_aps_idx_by_ssid_new ();
+	gs_unref_object NMConnection *conn_a_open = _create_aps_idx_connection ("a", NULL);
+	gs_unref_object NMConnection *conn_a_psk = _create_aps_idx_connection ("a", "wpa-psk");
+	gs_unref_object NMConnection *conn_b_psk = _create_aps_idx_connection ("b", "wpa-psk");
+	gs_unref_object NMConnection *conn_c = _create_aps_idx_connection ("c", NULL);
+	gs_unref_bytes GBytes *ssid_b = g_bytes_new_static ("b", 1);
+	gs_unref_bytes GBytes *ssid_c = g_bytes_new_static ("c", 1);
+	CList aps_lst_head = C_LIST_INIT (aps_lst_head);
+	NMWifiAP *ap_a1;
+	NMWifiAP *ap_a2;
+	NMWifiAP *ap_b;
+	NMWifiAP *ap;
+
+	ap_a1 = nm_wifi_ap_new_fake_from_connection (conn_a_open);
+	ap_a2 = nm_wifi_ap_new_fake_from_connection (conn_a_psk);
+	ap_b = nm_wifi_ap_new_fake_from_connection (conn_b_psk);
+	g_assert (ap_a1 && ap_a2 && ap_b);
+
+	c_list_link_tail (&aps_lst_head, &ap_a1->aps_lst);
+	c_list_link_tail (&aps_lst_head, &ap_a2->aps_lst);
+	c_list_link_tail (&aps_lst_head, &ap_b->aps_lst);
+	nm_wifi_aps_idx_by_ssid_add (aps_idx, ap_a1);
+	nm_wifi_aps_idx_by_ssid_add (aps_idx, ap_a2);
+	nm_wifi_aps_idx_by_ssid_add (aps_idx, ap_b);
+	g_assert_cmpint (g_hash_table_size (aps_idx), ==, 2);
+
+	/* only the APs with the SSID of the profile are checked, and among
+	 * them only the ones with compatible security. */
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_a_open, ap_a1);
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_a_psk, ap_a2);
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_b_psk, ap_b);
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_c, NULL);
+
+	c_list_unlink (&ap_a2->aps_lst);
+	nm_wifi_aps_idx_by_ssid_remove (aps_idx, ap_a2, nm_wifi_ap_get_ssid (ap_a2));
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_a_open, ap_a1);
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_a_psk, NULL);
+
+	/* when the SSID of an AP changes, it gets removed with the old SSID
+	 * and indexed again with the new one. */
+	g_assert (nm_wifi_ap_set_ssid (ap_b, ssid_c));
+	nm_wifi_aps_idx_by_ssid_remove (aps_idx, ap_b, ssid_b);
+	nm_wifi_aps_idx_by_ssid_add (aps_idx, ap_b);
+	g_assert (!g_hash_table_contains (aps_idx, ssid_b));
+	g_assert (g_hash_table_contains (aps_idx, ssid_c));
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_b_psk, NULL);
+	_assert_aps_idx_compatible (aps_idx, &aps_lst_head, conn_c, NULL);
+
+	c_list_for_each_entry (ap, &aps_lst_head, aps_lst)
+		nm_wifi_aps_idx_by_ssid_remove (aps_idx, ap, nm_wifi_ap_get_ssid (ap));
+	c_list_unlink (&ap_a1->aps_lst);
+	c_list_unlink (&ap_b->aps_lst);
+	g_assert_cmpint (g_hash_table_size (aps_idx), ==, 0);
+
+	g_object_unref (ap_a1);
+	g_object_unref (ap_a2);
+	g_object_unref (ap_b);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -1501,5 +1649,10 @@ main (int argc, char **argv)
 	g_test_add_func ("/wifi/strength/all",
 	                 test_strength_all);
 
+	g_test_add_func ("/wifi/aps_changed",
+	                 test_aps_changed);
+	g_test_add_func ("/wifi/aps_idx_by_ssid",
+	                 test_aps_idx_by_ssid);
+
 	return g_test_run ();
 }
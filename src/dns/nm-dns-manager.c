@@ -62,6 +62,12 @@ typedef struct {
 	GPtrArray *options;
 	const char *nis_domain;
 	GPtrArray *nis_servers;
+
+	/* indexes for the arrays above, to find duplicates without
+	 * scanning the arrays. */
+	GHashTable *nameservers_idx;
+	GHashTable *searches_idx;
+	GHashTable *nis_servers_idx;
 } NMResolvConfData;
 
 /*****************************************************************************/
@@ -156,6 +162,14 @@ static void _ip_config_dns_priority_changed (gpointer config,
                                              GParamSpec *pspec,
                                              NMDnsIPConfigData *ip_data);
 
+static void _ip_config_addrroute_changed (gpointer config,
+                                          GParamSpec *pspec,
+                                          NMDnsIPConfigData *ip_data);
+
+static void _ip_config_dns_changed (gpointer config,
+                                    GParamSpec *pspec,
+                                    NMDnsIPConfigData *ip_data);
+
 /*****************************************************************************/
 
 static gboolean
@@ -240,6 +254,31 @@ _ip_config_data_new (NMDnsConfigData *data,
 	                    ? "notify::" NM_IP4_CONFIG_DNS_PRIORITY
 	                    : "notify::" NM_IP6_CONFIG_DNS_PRIORITY,
 	                  (GCallback) _ip_config_dns_priority_changed, ip_data);
+	g_signal_connect (ip_config,
+	                  NM_IS_IP4_CONFIG (ip_config)
+	                    ? "notify::" NM_IP4_CONFIG_ADDRESS_DATA
+	                    : "notify::" NM_IP6_CONFIG_ADDRESS_DATA,
+	                  (GCallback) _ip_config_addrroute_changed, ip_data);
+	g_signal_connect (ip_config,
+	                  NM_IS_IP4_CONFIG (ip_config)
+	                    ? "notify::" NM_IP4_CONFIG_ROUTE_DATA
+	                    : "notify::" NM_IP6_CONFIG_ROUTE_DATA,
+	                  (GCallback) _ip_config_addrroute_changed, ip_data);
+	g_signal_connect (ip_config,
+	                  NM_IS_IP4_CONFIG (ip_config)
+	                    ? "notify::" NM_IP4_CONFIG_NAMESERVER_DATA
+	                    : "notify::" NM_IP6_CONFIG_NAMESERVERS,
+	                  (GCallback) _ip_config_dns_changed, ip_data);
+	g_signal_connect (ip_config,
+	                  NM_IS_IP4_CONFIG (ip_config)
+	                    ? "notify::" NM_IP4_CONFIG_DOMAINS
+	                    : "notify::" NM_IP6_CONFIG_DOMAINS,
+	                  (GCallback) _ip_config_dns_changed, ip_data);
+	g_signal_connect (ip_config,
+	                  NM_IS_IP4_CONFIG (ip_config)
+	                    ? "notify::" NM_IP4_CONFIG_SEARCHES
+	                    : "notify::" NM_IP6_CONFIG_SEARCHES,
+	                  (GCallback) _ip_config_dns_changed, ip_data);
 
 	_ASSERT_ip_config_data (ip_data);
 	return ip_data;
@@ -255,10 +294,18 @@ _ip_config_data_free (NMDnsIPConfigData *ip_data)
 
 	g_free (ip_data->domains.search);
 	g_strfreev (ip_data->domains.reverse);
+	g_strfreev (ip_data->contrib.nameservers);
+	g_strfreev (ip_data->contrib.searches);
 
 	g_signal_handlers_disconnect_by_func (ip_data->ip_config,
 	                                      _ip_config_dns_priority_changed,
 	                                      ip_data);
+	g_signal_handlers_disconnect_by_func (ip_data->ip_config,
+	                                      _ip_config_addrroute_changed,
+	                                      ip_data);
+	g_signal_handlers_disconnect_by_func (ip_data->ip_config,
+	                                      _ip_config_dns_changed,
+	                                      ip_data);
 
 	g_object_unref (ip_data->ip_config);
 	g_slice_free (NMDnsIPConfigData, ip_data);
@@ -346,23 +393,32 @@ nm_dns_manager_has_systemd_resolved (NMDnsManager *self)
 /*****************************************************************************/
 
 static void
-add_string_item (GPtrArray *array, const char *str, gboolean dup)
+add_string_item (GPtrArray *array, GHashTable *idx, const char *str, gboolean dup)
 {
+	char *item;
 	int i;
 
 	g_return_if_fail (array != NULL);
 	g_return_if_fail (str != NULL);
 
 	/* Check for dupes before adding */
-	for (i = 0; i < array->len; i++) {
-		const char *candidate = g_ptr_array_index (array, i);
-
-		if (candidate && !strcmp (candidate, str))
+	if (idx) {
+		if (g_hash_table_contains (idx, str))
 			return;
+	} else {
+		for (i = 0; i < array->len; i++) {
+			const char *candidate = g_ptr_array_index (array, i);
+
+			if (candidate && !strcmp (candidate, str))
+				return;
+		}
 	}
 
 	/* No dupes, add the new item */
-	g_ptr_array_add (array, dup ? g_strdup (str): (gpointer) str);
+	item = dup ? g_strdup (str) : (char *) str;
+	g_ptr_array_add (array, item);
+	if (idx)
+		g_hash_table_add (idx, item);
 }
 
 static void
@@ -373,7 +429,7 @@ add_dns_option_item (GPtrArray *array, const char *str)
 }
 
 static void
-add_dns_domains (GPtrArray *array, const NMIPConfig *ip_config,
+add_dns_domains (GPtrArray *array, GHashTable *idx, const NMIPConfig *ip_config,
                  gboolean include_routing, gboolean dup)
 {
 	guint num_domains, num_searches, i;
@@ -388,7 +444,7 @@ add_dns_domains (GPtrArray *array, const NMIPConfig *ip_config,
 			continue;
 		if (!domain_is_valid (nm_utils_parse_dns_domain (str, NULL), FALSE))
 			continue;
-		add_string_item (array, str, dup);
+		add_string_item (array, idx, str, dup);
 	}
 	if (num_domains > 1 || !num_searches) {
 		for (i = 0; i < num_domains; i++) {
@@ -397,20 +453,27 @@ add_dns_domains (GPtrArray *array, const NMIPConfig *ip_config,
 				continue;
 			if (!domain_is_valid (nm_utils_parse_dns_domain (str, NULL), FALSE))
 				continue;
-			add_string_item (array, str, dup);
+			add_string_item (array, idx, str, dup);
 		}
 	}
 }
 
 static void
-merge_one_ip_config (NMResolvConfData *rc,
-                     int ifindex,
-                     const NMIPConfig *ip_config)
+_ip_config_data_update_contrib (NMDnsIPConfigData *ip_data)
 {
+	const NMIPConfig *ip_config = ip_data->ip_config;
+	int ifindex = ip_data->data->ifindex;
+	gs_unref_ptrarray GPtrArray *nameservers = NULL;
+	gs_unref_ptrarray GPtrArray *searches = NULL;
+	gboolean has_scoped = FALSE;
 	int addr_family;
 	guint num, i;
 	char buf[NM_UTILS_INET_ADDRSTRLEN + 50];
 
+	if (   ip_data->contrib.valid
+	    && !ip_data->contrib.has_scoped)
+		return;
+
 	addr_family = nm_ip_config_get_addr_family (ip_config);
 
 	nm_assert_addr_family (addr_family);
@@ -418,6 +481,7 @@ merge_one_ip_config (NMResolvConfData *rc,
 	nm_assert (ifindex == nm_ip_config_get_ifindex (ip_config));
 
 	num = nm_ip_config_get_num_nameservers (ip_config);
+	nameservers = g_ptr_array_new_full (num + 1, g_free);
 	for (i = 0; i < num; i++) {
 		const NMIPAddr *addr;
 
@@ -431,6 +495,7 @@ merge_one_ip_config (NMResolvConfData *rc,
 			if (IN6_IS_ADDR_LINKLOCAL (addr)) {
 				const char *ifname;
 
+				has_scoped = TRUE;
 				ifname = nm_platform_link_get_name (NM_PLATFORM_GET, ifindex);
 				if (ifname) {
 					g_strlcat (buf, "%", sizeof (buf));
@@ -439,10 +504,40 @@ merge_one_ip_config (NMResolvConfData *rc,
 			}
 		}
 
-		add_string_item (rc->nameservers, buf, TRUE);
+		add_string_item (nameservers, NULL, buf, TRUE);
+	}
+	g_ptr_array_add (nameservers, NULL);
+
+	if (   !ip_data->contrib.valid
+	    || !ip_data->contrib.searches) {
+		searches = g_ptr_array_new_with_free_func (g_free);
+		add_dns_domains (searches, NULL, ip_config, FALSE, TRUE);
+		g_ptr_array_add (searches, NULL);
+		g_strfreev (ip_data->contrib.searches);
+		ip_data->contrib.searches = (char **) g_ptr_array_free (g_steal_pointer (&searches), FALSE);
 	}
 
-	add_dns_domains (rc->searches, ip_config, FALSE, TRUE);
+	g_strfreev (ip_data->contrib.nameservers);
+	ip_data->contrib.nameservers = (char **) g_ptr_array_free (g_steal_pointer (&nameservers), FALSE);
+	ip_data->contrib.has_scoped = has_scoped;
+	ip_data->contrib.valid = TRUE;
+}
+
+static void
+merge_one_ip_config (NMResolvConfData *rc,
+                     NMDnsIPConfigData *ip_data)
+{
+	const NMIPConfig *ip_config = ip_data->ip_config;
+	guint num, i;
+	char buf[NM_UTILS_INET_ADDRSTRLEN];
+
+	_ip_config_data_update_contrib (ip_data);
+
+	for (i = 0; ip_data->contrib.nameservers[i]; i++)
+		add_string_item (rc->nameservers, rc->nameservers_idx, ip_data->contrib.nameservers[i], TRUE);
+
+	for (i = 0; ip_data->contrib.searches[i]; i++)
+		add_string_item (rc->searches, rc->searches_idx, ip_data->contrib.searches[i], TRUE);
 
 	num = nm_ip_config_get_num_dns_options (ip_config);
 	for (i = 0; i < num; i++) {
@@ -450,13 +545,14 @@ merge_one_ip_config (NMResolvConfData *rc,
 		                     nm_ip_config_get_dns_option (ip_config, i));
 	}
 
-	if (addr_family == AF_INET) {
+	if (nm_ip_config_get_addr_family (ip_config) == AF_INET) {
 		const NMIP4Config *ip4_config = (const NMIP4Config *) ip_config;
 
 		/* NIS stuff */
 		num = nm_ip4_config_get_num_nis_servers (ip4_config);
 		for (i = 0; i < num; i++) {
 			add_string_item (rc->nis_servers,
+			                 rc->nis_servers_idx,
 			                 nm_utils_inet4_ntop (nm_ip4_config_get_nis_server (ip4_config, i), buf),
 			                 TRUE);
 		}
@@ -1035,14 +1131,14 @@ merge_global_dns_config (NMResolvConfData *rc, NMGlobalDnsConfig *global_conf)
 				continue;
 			if (!domain_is_valid (searches[i], FALSE))
 				continue;
-			add_string_item (rc->searches, searches[i], TRUE);
+			add_string_item (rc->searches, rc->searches_idx, searches[i], TRUE);
 		}
 	}
 
 	options = nm_global_dns_config_get_options (global_conf);
 	if (options) {
 		for (i = 0; options[i]; i++)
-			add_string_item (rc->options, options[i], TRUE);
+			add_string_item (rc->options, NULL, options[i], TRUE);
 	}
 
 	default_domain = nm_global_dns_config_lookup_domain (global_conf, "*");
@@ -1051,7 +1147,7 @@ merge_global_dns_config (NMResolvConfData *rc, NMGlobalDnsConfig *global_conf)
 	servers = nm_global_dns_domain_get_servers (default_domain);
 	if (servers) {
 		for (i = 0; servers[i]; i++)
-			add_string_item (rc->nameservers, servers[i], TRUE);
+			add_string_item (rc->nameservers, rc->nameservers_idx, servers[i], TRUE);
 	}
 
 	return TRUE;
@@ -1101,12 +1197,18 @@ _collect_resolv_conf_data (NMDnsManager *self,
                            const char **out_nis_domain)
 {
 	NMDnsManagerPrivate *priv;
+	gs_unref_hashtable GHashTable *nameservers_idx = g_hash_table_new (nm_str_hash, g_str_equal);
+	gs_unref_hashtable GHashTable *searches_idx = g_hash_table_new (nm_str_hash, g_str_equal);
+	gs_unref_hashtable GHashTable *nis_servers_idx = g_hash_table_new (nm_str_hash, g_str_equal);
 	NMResolvConfData rc = {
 		.nameservers = g_ptr_array_new (),
 		.searches = g_ptr_array_new (),
 		.options = g_ptr_array_new (),
 		.nis_domain = NULL,
 		.nis_servers = g_ptr_array_new (),
+		.nameservers_idx = nameservers_idx,
+		.searches_idx = searches_idx,
+		.nis_servers_idx = nis_servers_idx,
 	};
 
 	priv = NM_DNS_MANAGER_GET_PRIVATE (self);
@@ -1116,7 +1218,7 @@ _collect_resolv_conf_data (NMDnsManager *self,
 	else {
 		nm_auto_free_gstring GString *tmp_gstring = NULL;
 		int prio, first_prio = 0;
-		const NMDnsIPConfigData *ip_data;
+		NMDnsIPConfigData *ip_data;
 		const CList *head;
 		gboolean is_first = TRUE;
 
@@ -1146,7 +1248,7 @@ _collect_resolv_conf_data (NMDnsManager *self,
 			}
 
 			if (!skip)
-				merge_one_ip_config (&rc, ip_data->data->ifindex, ip_data->ip_config);
+				merge_one_ip_config (&rc, ip_data);
 		}
 	}
 
@@ -1164,9 +1266,9 @@ _collect_resolv_conf_data (NMDnsManager *self,
 		    && !nm_utils_ipaddr_valid (AF_UNSPEC, priv->hostname)) {
 			hostdomain++;
 			if (domain_is_valid (hostdomain, TRUE))
-				add_string_item (rc.searches, hostdomain, TRUE);
+				add_string_item (rc.searches, rc.searches_idx, hostdomain, TRUE);
 			else if (domain_is_valid (priv->hostname, TRUE))
-				add_string_item (rc.searches, priv->hostname, TRUE);
+				add_string_item (rc.searches, rc.searches_idx, priv->hostname, TRUE);
 		}
 	}
 
@@ -1350,8 +1452,11 @@ rebuild_domain_lists (NMDnsManager *self)
 		}
 		domains[n] = NULL;
 
-		g_strfreev (ip_data->domains.reverse);
-		ip_data->domains.reverse = get_ip_rdns_domains (ip_config);
+		if (!ip_data->domains.reverse_valid) {
+			g_strfreev (ip_data->domains.reverse);
+			ip_data->domains.reverse = get_ip_rdns_domains (ip_config);
+			ip_data->domains.reverse_valid = TRUE;
+		}
 	}
 }
 
@@ -1361,11 +1466,11 @@ clear_domain_lists (NMDnsManager *self)
 	NMDnsIPConfigData *ip_data;
 	CList *head;
 
+	/* only the search domains point to strings owned by the IP configurations.
+	 * The reverse domains are kept until the addresses or routes change. */
 	head = _ip_config_lst_head (self);
-	c_list_for_each_entry (ip_data, head, ip_config_lst) {
+	c_list_for_each_entry (ip_data, head, ip_config_lst)
 		g_clear_pointer (&ip_data->domains.search, g_free);
-		g_clear_pointer (&ip_data->domains.reverse, g_strfreev);
-	}
 }
 
 static gboolean
@@ -1563,6 +1668,26 @@ _ip_config_dns_priority_changed (gpointer config,
 	NM_DNS_MANAGER_GET_PRIVATE (ip_data->data->self)->ip_config_lst_need_sort = TRUE;
 }
 
+static void
+_ip_config_addrroute_changed (gpointer config,
+                              GParamSpec *pspec,
+                              NMDnsIPConfigData *ip_data)
+{
+	_ASSERT_ip_config_data (ip_data);
+
+	ip_data->domains.reverse_valid = FALSE;
+}
+
+static void
+_ip_config_dns_changed (gpointer config,
+                        GParamSpec *pspec,
+                        NMDnsIPConfigData *ip_data)
+{
+	_ASSERT_ip_config_data (ip_data);
+
+	ip_data->contrib.valid = FALSE;
+}
+
 gboolean
 nm_dns_manager_set_ip_config (NMDnsManager *self,
                               NMIPConfig *ip_config,
@@ -2183,7 +2308,7 @@ _get_config_variant (NMDnsManager *self)
 			else
 				g_ptr_array_set_size (array_domains, 0);
 
-			add_dns_domains (array_domains, ip_config, TRUE, FALSE);
+			add_dns_domains (array_domains, NULL, ip_config, TRUE, FALSE);
 			if (array_domains->len) {
 				g_variant_builder_init (&strv_builder, G_VARIANT_TYPE ("as"));
 				for (i = 0; i < array_domains->len; i++) {
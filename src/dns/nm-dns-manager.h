@@ -37,7 +37,25 @@ typedef struct {
 	struct {
 		const char **search;
 		char **reverse;
+
+		/* the reverse domains depend on all addresses and routes of the
+		 * configuration. They are kept across updates and only regenerated
+		 * after the addresses or routes change. */
+		bool reverse_valid:1;
 	} domains;
+	struct {
+		/* the formatted nameservers and the valid search domains that the
+		 * configuration contributes to resolv.conf. They are kept across
+		 * updates and only regenerated after the configuration notifies
+		 * about changed nameservers, domains or searches. */
+		char **nameservers;
+		char **searches;
+		bool valid:1;
+
+		/* link-local nameservers are scoped by the interface name, which
+		 * can change without notification by the configuration. */
+		bool has_scoped:1;
+	} contrib;
 } NMDnsIPConfigData;
 
 typedef struct _NMDnsConfigData {
@@ -41,18 +41,50 @@ typedef struct {
 	CList configs_lst_head;
 } InterfaceConfig;
 
+typedef enum {
+	LINK_OP_DNS,
+	LINK_OP_DOMAINS,
+	LINK_OP_MDNS,
+	LINK_OP_LLMNR,
+	_LINK_OP_NUM,
+} LinkOp;
+
 typedef struct {
 	CList request_queue_lst;
-	const char *operation;
+	int ifindex;
+	LinkOp op;
 	GVariant *argument;
 } RequestItem;
 
+static const char *const link_op_names[_LINK_OP_NUM] = {
+	[LINK_OP_DNS]     = "SetLinkDNS",
+	[LINK_OP_DOMAINS] = "SetLinkDomains",
+	[LINK_OP_MDNS]    = "SetLinkMulticastDNS",
+	[LINK_OP_LLMNR]   = "SetLinkLLMNR",
+};
+
+/* The arguments of the calls for a link that systemd-resolved acknowledged,
+ * and of the calls last sent that did not yet reply. */
+typedef struct {
+	int ifindex;
+	GVariant *arguments[_LINK_OP_NUM];
+	GVariant *pending[_LINK_OP_NUM];
+} LinkState;
+
+typedef struct {
+	NMDnsSystemdResolved *self;
+	int ifindex;
+	LinkOp op;
+	GVariant *argument;
+} CallData;
+
 /*****************************************************************************/
 
 typedef struct {
 	GDBusConnection *dbus_connection;
 	GCancellable *cancellable;
 	CList request_queue_lst_head;
+	GHashTable *link_states;
 	guint name_owner_changed_id;
 	bool send_updates_warn_ratelimited:1;
 	bool try_start_blocked:1;
@@ -90,17 +122,38 @@ _request_item_free (RequestItem *request_item)
 
 static void
 _request_item_append (CList *request_queue_lst_head,
-                      const char *operation,
+                      int ifindex,
+                      LinkOp op,
                       GVariant *argument)
 {
 	RequestItem *request_item;
 
 	request_item = g_slice_new (RequestItem);
-	request_item->operation = operation;
+	request_item->ifindex = ifindex;
+	request_item->op = op;
 	request_item->argument = g_variant_ref_sink (argument);
 	c_list_link_tail (request_queue_lst_head, &request_item->request_queue_lst);
 }
 
+static void
+_link_state_free (gpointer ptr)
+{
+	LinkState *link_state = ptr;
+	guint i;
+
+	for (i = 0; i < _LINK_OP_NUM; i++) {
+		nm_clear_g_variant (&link_state->arguments[i]);
+		nm_clear_g_variant (&link_state->pending[i]);
+	}
+	g_slice_free (LinkState, link_state);
+}
+
+static GVariant *
+_link_state_get_argument (const LinkState *link_state, LinkOp op)
+{
+	return link_state->pending[op] ?: link_state->arguments[op];
+}
+
 /*****************************************************************************/
 
 static void
@@ -115,24 +168,49 @@ call_done (GObject *source, GAsyncResult *r, gpointer user_data)
 {
 	gs_unref_variant GVariant *v = NULL;
 	gs_free_error GError *error = NULL;
-	NMDnsSystemdResolved *self = (NMDnsSystemdResolved *) user_data;
+	CallData *call_data = user_data;
+	gs_unref_variant GVariant *argument = g_steal_pointer (&call_data->argument);
+	NMDnsSystemdResolved *self = call_data->self;
 	NMDnsSystemdResolvedPrivate *priv;
+	LinkState *link_state;
+	LinkOp op = call_data->op;
+	int ifindex = call_data->ifindex;
+
+	g_slice_free (CallData, call_data);
 
 	v = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), r, &error);
 	if (   !v
-	    && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	    && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		/* the calls are only cancelled when the instance gets destroyed,
+		 * together with the link states. */
 		return;
+	}
 
 	priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 
-	if (!v) {
+	if (v) {
+		priv->send_updates_warn_ratelimited = FALSE;
+
+		/* only record the argument if it is the one we sent last. Otherwise,
+		 * a newer call is still pending, or the link state was dropped in the
+		 * meantime. */
+		link_state = g_hash_table_lookup (priv->link_states, GINT_TO_POINTER (ifindex));
+		if (   link_state
+		    && link_state->pending[op] == argument) {
+			nm_clear_g_variant (&link_state->arguments[op]);
+			link_state->arguments[op] = g_steal_pointer (&link_state->pending[op]);
+		}
+	} else {
 		if (!priv->send_updates_warn_ratelimited) {
 			priv->send_updates_warn_ratelimited = TRUE;
 			_LOGW ("send-updates failed to update systemd-resolved: %s", error->message);
 		} else
 			_LOGD ("send-updates failed: %s", error->message);
-	} else
-		priv->send_updates_warn_ratelimited = FALSE;
+
+		/* we don't know what state systemd-resolved has now. Forget
+		 * what we sent, so that the next update sends everything again. */
+		g_hash_table_remove_all (priv->link_states);
+	}
 }
 
 static void
@@ -185,9 +263,45 @@ free_pending_updates (NMDnsSystemdResolved *self)
 }
 
 static void
+requeue_all_links (NMDnsSystemdResolved *self)
+{
+	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
+	gs_free gpointer *ifindexes = NULL;
+	guint ifindexes_len;
+	guint i, j;
+
+	/* systemd-resolved (re)appeared on the bus. It does not know any of the
+	 * links we configured so far, so queue the full state again. */
+	free_pending_updates (self);
+
+	ifindexes = nm_utils_hash_keys_to_array (priv->link_states,
+	                                         nm_cmp_int2ptr_p_with_data,
+	                                         NULL,
+	                                         &ifindexes_len);
+	for (i = 0; i < ifindexes_len; i++) {
+		LinkState *link_state = g_hash_table_lookup (priv->link_states, ifindexes[i]);
+
+		for (j = 0; j < _LINK_OP_NUM; j++) {
+			GVariant *argument = _link_state_get_argument (link_state, j);
+
+			if (argument) {
+				_request_item_append (&priv->request_queue_lst_head,
+				                      link_state->ifindex,
+				                      j,
+				                      argument);
+			}
+		}
+	}
+}
+
+static guint
 prepare_one_interface (NMDnsSystemdResolved *self, InterfaceConfig *ic)
 {
 	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
+	GVariant *arguments[_LINK_OP_NUM];
+	LinkState *link_state;
+	guint n_requests = 0;
+	guint i;
 	GVariantBuilder dns, domains;
 	NMCListElem *elem;
 	NMSettingConnectionMdns mdns = NM_SETTING_CONNECTION_MDNS_DEFAULT;
@@ -249,18 +363,36 @@ prepare_one_interface (NMDnsSystemdResolved *self, InterfaceConfig *ic)
 	}
 	nm_assert (llmnr_arg);
 
-	_request_item_append (&priv->request_queue_lst_head,
-	                      "SetLinkDNS",
-	                      g_variant_builder_end (&dns));
-	_request_item_append (&priv->request_queue_lst_head,
-	                      "SetLinkDomains",
-	                      g_variant_builder_end (&domains));
-	_request_item_append (&priv->request_queue_lst_head,
-	                      "SetLinkMulticastDNS",
-	                      g_variant_new ("(is)", ic->ifindex, mdns_arg ?: ""));
-	_request_item_append (&priv->request_queue_lst_head,
-	                      "SetLinkLLMNR",
-	                      g_variant_new ("(is)", ic->ifindex, llmnr_arg ?: ""));
+	arguments[LINK_OP_DNS]     = g_variant_builder_end (&dns);
+	arguments[LINK_OP_DOMAINS] = g_variant_builder_end (&domains);
+	arguments[LINK_OP_MDNS]    = g_variant_new ("(is)", ic->ifindex, mdns_arg ?: "");
+	arguments[LINK_OP_LLMNR]   = g_variant_new ("(is)", ic->ifindex, llmnr_arg ?: "");
+
+	link_state = g_hash_table_lookup (priv->link_states, GINT_TO_POINTER (ic->ifindex));
+	if (!link_state) {
+		link_state = g_slice_new0 (LinkState);
+		link_state->ifindex = ic->ifindex;
+		g_hash_table_insert (priv->link_states, GINT_TO_POINTER (ic->ifindex), link_state);
+	}
+
+	/* only send the calls whose arguments differ from what systemd-resolved
+	 * acknowledged, or from what we already sent and wait for. The link state
+	 * is only updated once the calls get sent and reply. */
+	for (i = 0; i < _LINK_OP_NUM; i++) {
+		gs_unref_variant GVariant *argument = g_variant_ref_sink (arguments[i]);
+		GVariant *old = _link_state_get_argument (link_state, i);
+
+		if (   old
+		    && g_variant_equal (old, argument))
+			continue;
+		_request_item_append (&priv->request_queue_lst_head,
+		                      ic->ifindex,
+		                      i,
+		                      argument);
+		n_requests++;
+	}
+
+	return n_requests;
 }
 
 static void
@@ -268,6 +400,8 @@ send_updates (NMDnsSystemdResolved *self)
 {
 	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 	RequestItem *request_item;
+	LinkState *link_state;
+	CallData *call_data;
 
 	if (c_list_is_empty (&priv->request_queue_lst_head)) {
 		/* nothing to do. */
@@ -302,13 +436,32 @@ send_updates (NMDnsSystemdResolved *self)
 	_LOGT ("send-updates: start %lu requests",
 	       c_list_length (&priv->request_queue_lst_head));
 
-	nm_clear_g_cancellable (&priv->cancellable);
-
-	priv->cancellable = g_cancellable_new ();
+	/* don't cancel the calls that are still in flight. Their replies tell
+	 * us what systemd-resolved has configured, and systemd-resolved handles
+	 * the calls of our connection in order. */
+	if (!priv->cancellable)
+		priv->cancellable = g_cancellable_new ();
 
 	while ((request_item = c_list_first_entry (&priv->request_queue_lst_head,
 	                                           RequestItem,
 	                                           request_queue_lst))) {
+		link_state = g_hash_table_lookup (priv->link_states, GINT_TO_POINTER (request_item->ifindex));
+		if (!link_state) {
+			link_state = g_slice_new0 (LinkState);
+			link_state->ifindex = request_item->ifindex;
+			g_hash_table_insert (priv->link_states, GINT_TO_POINTER (link_state->ifindex), link_state);
+		}
+		nm_clear_g_variant (&link_state->pending[request_item->op]);
+		link_state->pending[request_item->op] = g_variant_ref (request_item->argument);
+
+		call_data = g_slice_new (CallData);
+		*call_data = (CallData) {
+			.self     = self,
+			.ifindex  = request_item->ifindex,
+			.op       = request_item->op,
+			.argument = g_variant_ref (request_item->argument),
+		};
+
 		/* Above we explicitly call "StartServiceByName" trying to avoid D-Bus activating systmd-resolved
 		 * multiple times. There is still a race, were we might hit this line although actually
 		 * the service just quit this very moment. In that case, we would try to D-Bus activate the
@@ -321,14 +474,14 @@ send_updates (NMDnsSystemdResolved *self)
 		                        SYSTEMD_RESOLVED_DBUS_SERVICE,
 		                        SYSTEMD_RESOLVED_DBUS_PATH,
 		                        SYSTEMD_RESOLVED_MANAGER_IFACE,
-		                        request_item->operation,
+		                        link_op_names[request_item->op],
 		                        request_item->argument,
 		                        NULL,
 		                        G_DBUS_CALL_FLAGS_NONE,
 		                        -1,
 		                        priv->cancellable,
 		                        call_done,
-		                        self);
+		                        call_data);
 		_request_item_free (request_item);
 	}
 }
@@ -341,11 +494,16 @@ update (NMDnsPlugin *plugin,
         GError **error)
 {
 	NMDnsSystemdResolved *self = NM_DNS_SYSTEMD_RESOLVED (plugin);
+	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 	gs_unref_hashtable GHashTable *interfaces = NULL;
 	gs_free gpointer *interfaces_keys = NULL;
 	guint interfaces_len;
+	guint n_requests = 0;
+	guint n_links_changed = 0;
 	guint i;
 	NMDnsIPConfigData *ip_data;
+	GHashTableIter iter;
+	gpointer ifindex_ptr;
 
 	interfaces = g_hash_table_new_full (nm_direct_hash, NULL,
 	                                    NULL, (GDestroyNotify) _interface_config_free);
@@ -371,16 +529,33 @@ update (NMDnsPlugin *plugin,
 
 	free_pending_updates (self);
 
+	/* forget the state of links that we no longer configure. */
+	g_hash_table_iter_init (&iter, priv->link_states);
+	while (g_hash_table_iter_next (&iter, &ifindex_ptr, NULL)) {
+		if (!g_hash_table_contains (interfaces, ifindex_ptr))
+			g_hash_table_iter_remove (&iter);
+	}
+
 	interfaces_keys = nm_utils_hash_keys_to_array (interfaces,
 	                                               nm_cmp_int2ptr_p_with_data,
 	                                               NULL,
 	                                               &interfaces_len);
 	for (i = 0; i < interfaces_len; i++) {
 		InterfaceConfig *ic = g_hash_table_lookup (interfaces, GINT_TO_POINTER (interfaces_keys[i]));
+		guint n;
 
-		prepare_one_interface (self, ic);
+		n = prepare_one_interface (self, ic);
+		if (n > 0) {
+			n_requests += n;
+			n_links_changed++;
+		}
 	}
 
+	_LOGD ("update: %u requests for %u of %u links",
+	       n_requests,
+	       n_links_changed,
+	       interfaces_len);
+
 	send_updates (self);
 
 	return TRUE;
@@ -402,8 +577,10 @@ name_owner_changed (NMDnsSystemdResolved *self,
 		_LOGT ("D-Bus name for systemd-resolved has owner %s", owner);
 
 	priv->dbus_has_owner = !!owner;
-	if (owner)
+	if (owner) {
 		priv->try_start_blocked = FALSE;
+		requeue_all_links (self);
+	}
 
 	send_updates (self);
 }
@@ -486,6 +663,7 @@ nm_dns_systemd_resolved_init (NMDnsSystemdResolved *self)
 	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 
 	c_list_init (&priv->request_queue_lst_head);
+	priv->link_states = g_hash_table_new_full (nm_direct_hash, NULL, NULL, _link_state_free);
 
 	priv->dbus_connection = nm_g_object_ref (NM_MAIN_DBUS_CONNECTION_GET);
 	if (!priv->dbus_connection) {
@@ -520,6 +698,7 @@ dispose (GObject *object)
 	NMDnsSystemdResolvedPrivate *priv = NM_DNS_SYSTEMD_RESOLVED_GET_PRIVATE (self);
 
 	free_pending_updates (self);
+	nm_clear_pointer (&priv->link_states, g_hash_table_unref);
 
 	nm_clear_g_dbus_connection_signal (priv->dbus_connection,
 	                                   &priv->name_owner_changed_id);
@@ -124,6 +124,7 @@ nm_main_config_reload (int signal)
 		break;
 	case SIGUSR2:
 		reload_flags = NM_CONFIG_CHANGE_CAUSE_SIGUSR2;
+		nm_logging_flight_recorder_dump (0);
 		break;
 	default:
 		g_return_if_reached ();
@@ -368,6 +369,26 @@ main (int argc, char *argv[])
 		nm_logging_init (v, nm_config_get_is_debug (config));
 	}
 
+	{
+		gs_free char *v = NULL;
+
+		v = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+		                              NM_CONFIG_KEYFILE_GROUP_LOGGING,
+		                              NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_LEVEL,
+		                              NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		nm_logging_init_flight_recorder (nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA_ORIG,
+		                                                                 NM_CONFIG_KEYFILE_GROUP_LOGGING,
+		                                                                 NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER,
+		                                                                 10, 0, G_MAXUINT32, 0),
+		                                 v);
+	}
+
+	if (nm_config_data_get_value_boolean (NM_CONFIG_GET_DATA_ORIG,
+	                                      NM_CONFIG_KEYFILE_GROUP_LOGGING,
+	                                      NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC,
+	                                      FALSE))
+		nm_logging_init_async_writer ();
+
 	nm_log_info (LOGD_CORE, "NetworkManager (version " NM_DIST_VERSION ") is starting... (%s)",
 	             nm_config_get_first_start (config) ? "for the first time" : "after a restart");
 
@@ -419,6 +440,12 @@ main (int argc, char *argv[])
 
 	manager = nm_manager_setup ();
 
+	nm_dbus_manager_set_large_property_threshold (nm_dbus_manager_get (),
+	                                              nm_config_data_get_value_int64 (NM_CONFIG_GET_DATA_ORIG,
+	                                                                              NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                                                              NM_CONFIG_KEYFILE_KEY_MAIN_DBUS_LARGE_PROPERTY_THRESHOLD,
+	                                                                              10, 0, G_MAXUINT32, 0));
+
 	nm_dbus_manager_start (nm_dbus_manager_get(),
 	                       nm_manager_dbus_set_property_handle,
 	                       manager);
@@ -477,5 +504,7 @@ done_no_manager:
 
 	nm_clear_g_source (&sd_id);
 
+	nm_logging_shutdown ();
+
 	exit (success ? 0 : 1);
 }
@@ -763,6 +763,7 @@ static const ConfigGroup config_groups[] = {
 			NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT,
 			NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT,
 			NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT,
+			NM_CONFIG_KEYFILE_KEY_MAIN_DBUS_LARGE_PROPERTY_THRESHOLD,
 			NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG,
 			NM_CONFIG_KEYFILE_KEY_MAIN_DHCP,
 			NM_CONFIG_KEYFILE_KEY_MAIN_DNS,
@@ -779,9 +780,12 @@ static const ConfigGroup config_groups[] = {
 	{
 		.group = NM_CONFIG_KEYFILE_GROUP_LOGGING,
 		.keys = NM_MAKE_STRV (
+			NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS,
+			NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER,
+			NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_LEVEL,
 			NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL,
 		),
 	},
@@ -813,6 +817,7 @@ static const ConfigGroup config_groups[] = {
 		.is_prefix = TRUE,
 		.keys = NM_MAKE_STRV (
 			NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_WAIT_TIMEOUT,
+			NM_CONFIG_KEYFILE_KEY_DEVICE_DISPATCHER_COALESCE_TIMEOUT,
 			NM_CONFIG_KEYFILE_KEY_DEVICE_IGNORE_CARRIER,
 			NM_CONFIG_KEYFILE_KEY_DEVICE_MANAGED,
 			NM_CONFIG_KEYFILE_KEY_DEVICE_SRIOV_NUM_VFS,
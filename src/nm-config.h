@@ -46,6 +46,7 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTH_POLKIT              "auth-polkit"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_AUTOCONNECT_RETRIES_DEFAULT "autoconnect-retries-default"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT       "configure-and-quit"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DBUS_LARGE_PROPERTY_THRESHOLD "dbus-large-property-threshold"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                    "debug"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                     "dhcp"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DNS                      "dns"
@@ -59,8 +60,11 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED         "systemd-resolved"
 
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT                 "audit"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_ASYNC                 "async"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND               "backend"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS               "domains"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER       "flight-recorder"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_FLIGHT_RECORDER_LEVEL "flight-recorder-level"
 #define NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL                 "level"
 
 #define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED          "enabled"
@@ -86,6 +90,7 @@
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_BACKEND           "wifi.backend"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_RAND_MAC_ADDRESS "wifi.scan-rand-mac-address"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_WAIT_TIMEOUT   "carrier-wait-timeout"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_DISPATCHER_COALESCE_TIMEOUT "dispatcher.coalesce-timeout"
 
 #define NM_CONFIG_KEYFILE_KEY_MATCH_DEVICE           "match-device"
 #define NM_CONFIG_KEYFILE_KEY_STOP_MATCH             "stop-match"
@@ -4261,3 +4261,78 @@ NM_UTILS_LOOKUP_STR_DEFINE (nm_activation_type_to_string, NMActivationType,
 	NM_UTILS_LOOKUP_STR_ITEM (NM_ACTIVATION_TYPE_ASSUME,   "assume"),
 	NM_UTILS_LOOKUP_STR_ITEM (NM_ACTIVATION_TYPE_EXTERNAL, "external"),
 )
+
+/*****************************************************************************/
+
+static gboolean
+_batch_idle_dispatch_cb (gpointer user_data)
+{
+	NMUtilsBatchIdle *batch = user_data;
+	CList lst[G_N_ELEMENTS (batch->lst_heads)];
+	NMUtilsBatchIdleEntry *entry;
+	guint i;
+
+	batch->idle_id = 0;
+
+	/* Only dispatch the entries that are queued right now. Entries that get
+	 * queued while dispatching are handled in the next batch, so that
+	 * all users progress evenly. */
+	for (i = 0; i < G_N_ELEMENTS (lst); i++) {
+		c_list_init (&lst[i]);
+		c_list_splice (&lst[i], &batch->lst_heads[i]);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (lst); i++) {
+		while ((entry = c_list_first_entry (&lst[i], NMUtilsBatchIdleEntry, lst))) {
+			/* the callback (or any other callback) may unqueue or requeue
+			 * the entry, which unlinks it from our list. */
+			c_list_unlink (&entry->lst);
+			entry->func (entry->user_data);
+		}
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+/**
+ * nm_utils_batch_idle_queue:
+ * @batch: the batch
+ * @entry: the entry to queue. If it is already queued, it gets
+ *   moved to the end of the queue for @prio.
+ * @prio: 0 or 1. In each batch, all entries with priority 0 are
+ *   invoked before the entries with priority 1.
+ *
+ * Queue @entry to be invoked from a single idle handler, together
+ * with all other entries queued on @batch. When many users schedule
+ * work at once, that avoids creating and destroying an idle source
+ * for each of them.
+ */
+void
+nm_utils_batch_idle_queue (NMUtilsBatchIdle *batch,
+                           NMUtilsBatchIdleEntry *entry,
+                           guint prio)
+{
+	nm_assert (batch);
+	nm_assert (entry);
+	nm_assert (entry->func);
+	nm_assert (prio < G_N_ELEMENTS (batch->lst_heads));
+
+	c_list_unlink (&entry->lst);
+	c_list_link_tail (&batch->lst_heads[prio], &entry->lst);
+	if (!batch->idle_id)
+		batch->idle_id = g_idle_add (_batch_idle_dispatch_cb, batch);
+}
+
+void
+nm_utils_batch_idle_clear (NMUtilsBatchIdle *batch)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (batch->lst_heads); i++) {
+		NMUtilsBatchIdleEntry *entry;
+
+		while ((entry = c_list_first_entry (&batch->lst_heads[i], NMUtilsBatchIdleEntry, lst)))
+			c_list_unlink (&entry->lst);
+	}
+	nm_clear_g_source (&batch->idle_id);
+}
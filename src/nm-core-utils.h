@@ -12,6 +12,7 @@
 
 #include "nm-connection.h"
 
+#include "c-list/src/c-list.h"
 #include "nm-glib-aux/nm-time-utils.h"
 
 /*****************************************************************************/
@@ -480,6 +481,57 @@ const char *nm_utils_parse_dns_domain (const char *domain, gboolean *is_routing)
 
 /*****************************************************************************/
 
+typedef void (*NMUtilsBatchIdleFunc) (gpointer user_data);
+
+typedef struct {
+	CList lst;
+	NMUtilsBatchIdleFunc func;
+	gpointer user_data;
+} NMUtilsBatchIdleEntry;
+
+typedef struct {
+	CList lst_heads[2];
+	guint idle_id;
+} NMUtilsBatchIdle;
+
+#define NM_UTILS_BATCH_IDLE_INIT(batch) \
+	{ \
+		.lst_heads = { \
+			C_LIST_INIT ((batch).lst_heads[0]), \
+			C_LIST_INIT ((batch).lst_heads[1]), \
+		}, \
+	}
+
+static inline void
+nm_utils_batch_idle_entry_init (NMUtilsBatchIdleEntry *entry,
+                                NMUtilsBatchIdleFunc func,
+                                gpointer user_data)
+{
+	c_list_init (&entry->lst);
+	entry->func = func;
+	entry->user_data = user_data;
+}
+
+static inline gboolean
+nm_utils_batch_idle_entry_is_queued (const NMUtilsBatchIdleEntry *entry)
+{
+	return c_list_is_linked (&entry->lst);
+}
+
+static inline void
+nm_utils_batch_idle_unqueue (NMUtilsBatchIdleEntry *entry)
+{
+	c_list_unlink (&entry->lst);
+}
+
+void nm_utils_batch_idle_queue (NMUtilsBatchIdle *batch,
+                                NMUtilsBatchIdleEntry *entry,
+                                guint prio);
+
+void nm_utils_batch_idle_clear (NMUtilsBatchIdle *batch);
+
+/*****************************************************************************/
+
 #define NM_VPN_ROUTE_METRIC_DEFAULT     50
 
 #define NM_UTILS_ERROR_MSG_REQ_AUTH_FAILED   "Unable to authenticate the request"
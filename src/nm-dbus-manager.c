@@ -80,6 +80,11 @@ typedef struct {
 	CList caller_info_lst_head;
 
 	guint objmgr_registration_id;
+
+	/* properties with more elements are only invalidated in PropertiesChanged.
+	 * Zero means no limit. */
+	guint large_property_threshold;
+
 	bool started:1;
 	bool shutting_down:1;
 } NMDBusManagerPrivate;
@@ -1140,6 +1145,26 @@ _nm_dbus_manager_obj_unexport (NMDBusObject *obj)
 	c_list_unlink (&obj->internal.objects_lst);
 }
 
+static gboolean
+_obj_property_is_large (NMDBusManager *self,
+                        NMDBusObject *obj,
+                        const NMDBusPropertyInfoExtended *property_info)
+{
+	NMDBusManagerPrivate *priv = NM_DBUS_MANAGER_GET_PRIVATE (self);
+	NMDBusObjectClass *klass;
+
+	nm_assert (property_info->maybe_large);
+
+	if (priv->large_property_threshold == 0)
+		return FALSE;
+
+	klass = NM_DBUS_OBJECT_GET_CLASS (obj);
+	if (!klass->get_property_n_elements)
+		return FALSE;
+
+	return klass->get_property_n_elements (obj, property_info->property_name) > priv->large_property_threshold;
+}
+
 void
 _nm_dbus_manager_obj_notify (NMDBusObject *obj,
                              guint n_pspecs,
@@ -1186,6 +1211,7 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 	c_list_for_each_entry (reg_data, &obj->internal.registration_lst_head, registration_lst) {
 		const NMDBusInterfaceInfoExtended *interface_info = _reg_data_get_interface_info (reg_data);
 		gboolean has_properties = FALSE;
+		gboolean has_invalidated = FALSE;
 		GVariantBuilder builder;
 		GVariantBuilder invalidated_builder;
 		GVariant *args;
@@ -1203,6 +1229,19 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 				if (!nm_streq (property_info->property_name, pspec->name))
 					continue;
 
+				if (   property_info->maybe_large
+				    && _obj_property_is_large (self, obj, property_info)) {
+					/* don't build the value. Clients that care can fetch it
+					 * with Get/GetAll. The legacy signal has no invalidation,
+					 * so it is omitted there too. */
+					if (!has_invalidated) {
+						has_invalidated = TRUE;
+						g_variant_builder_init (&invalidated_builder, G_VARIANT_TYPE ("as"));
+					}
+					g_variant_builder_add (&invalidated_builder, "s", property_info->parent.name);
+					continue;
+				}
+
 				value = _obj_get_property (reg_data, i, TRUE);
 
 				if (   property_info->include_in_legacy_property_changed
@@ -1223,19 +1262,25 @@ _nm_dbus_manager_obj_notify (NMDBusObject *obj,
 			}
 		}
 
-		if (!has_properties)
+		if (   !has_properties
+		    && !has_invalidated)
 			continue;
 
-		args = g_variant_builder_end (&builder);
+		if (has_properties)
+			args = g_variant_builder_end (&builder);
+		else
+			args = g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0);
 
-		if (G_UNLIKELY (interface_info == &nm_interface_info_device_statistics)) {
+		if (   G_UNLIKELY (interface_info == &nm_interface_info_device_statistics)
+		    && has_properties) {
 			/* we treat the Device.Statistics signal special, because we need to
 			 * emit a signal also for it (below). */
 			nm_assert (!device_statistics_args);
 			device_statistics_args = g_variant_ref_sink (args);
 		}
 
-		g_variant_builder_init (&invalidated_builder, G_VARIANT_TYPE ("as"));
+		if (!has_invalidated)
+			g_variant_builder_init (&invalidated_builder, G_VARIANT_TYPE ("as"));
 		g_dbus_connection_emit_signal (priv->main_dbus_connection,
 		                               NULL,
 		                               obj->internal.path,
@@ -1500,6 +1545,24 @@ nm_dbus_manager_start (NMDBusManager *self,
 		_obj_register (self, obj);
 }
 
+/**
+ * nm_dbus_manager_set_large_property_threshold:
+ * @self: the #NMDBusManager
+ * @threshold: the maximum number of elements, or zero for no limit
+ *
+ * Properties that are flagged as possibly large and that have more than
+ * @threshold elements are no longer sent with PropertiesChanged. Instead,
+ * they are only listed as invalidated.
+ */
+void
+nm_dbus_manager_set_large_property_threshold (NMDBusManager *self,
+                                              guint threshold)
+{
+	g_return_if_fail (NM_IS_DBUS_MANAGER (self));
+
+	NM_DBUS_MANAGER_GET_PRIVATE (self)->large_property_threshold = threshold;
+}
+
 gboolean
 nm_dbus_manager_acquire_bus (NMDBusManager *self,
                              gboolean request_name)
@@ -47,6 +47,9 @@ void nm_dbus_manager_start (NMDBusManager *self,
 
 void nm_dbus_manager_stop (NMDBusManager *self);
 
+void nm_dbus_manager_set_large_property_threshold (NMDBusManager *self,
+                                                   guint threshold);
+
 gboolean nm_dbus_manager_is_stopping (NMDBusManager *self);
 
 gpointer nm_dbus_manager_lookup_object (NMDBusManager *self, const char *path);
@@ -100,6 +100,10 @@ typedef struct {
 
 	const NMDBusInterfaceInfoExtended *const*interface_infos;
 
+	/* for properties with the maybe_large flag, return the number of elements
+	 * in the property's value. This must be cheap, without building the value. */
+	guint (*get_property_n_elements) (NMDBusObject *obj, const char *property_name);
+
 	bool export_on_construction;
 } NMDBusObjectClass;
 
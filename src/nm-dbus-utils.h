@@ -19,6 +19,12 @@ struct _NMDBusPropertyInfoExtendedBase {
 	 * PropertyChanged signal. This is only to preserve API, new
 	 * properties should not use this. */
 	bool include_in_legacy_property_changed;
+
+	/* Whether the property can grow large. If the object reports more
+	 * elements than the configured threshold, PropertiesChanged only
+	 * invalidates the property instead of sending its value. See
+	 * NMDBusObjectClass.get_property_n_elements. */
+	bool maybe_large;
 };
 
 struct _NMDBusPropertyInfoExtendedReadWritable {
@@ -49,14 +55,17 @@ typedef struct {
 			 * PropertyChanged signal. This is only to preserve API, new
 			 * properties should not use this. */
 			bool include_in_legacy_property_changed;
+
+			bool maybe_large;
 		};
 	};
 } NMDBusPropertyInfoExtended;
 
 G_STATIC_ASSERT (G_STRUCT_OFFSET (NMDBusPropertyInfoExtended, property_name) == G_STRUCT_OFFSET (struct _NMDBusPropertyInfoExtendedBase, property_name));
 G_STATIC_ASSERT (G_STRUCT_OFFSET (NMDBusPropertyInfoExtended, include_in_legacy_property_changed) == G_STRUCT_OFFSET (struct _NMDBusPropertyInfoExtendedBase, include_in_legacy_property_changed));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (NMDBusPropertyInfoExtended, maybe_large) == G_STRUCT_OFFSET (struct _NMDBusPropertyInfoExtendedBase, maybe_large));
 
-#define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL(m_name, m_signature, m_property_name, m_include_in_legacy_property_changed) \
+#define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL(m_name, m_signature, m_property_name, m_include_in_legacy_property_changed, m_maybe_large) \
 	((GDBusPropertyInfo *) &((const struct _NMDBusPropertyInfoExtendedBase) { \
 		._parent = { \
 			.ref_count = -1, \
@@ -66,14 +75,19 @@ G_STATIC_ASSERT (G_STRUCT_OFFSET (NMDBusPropertyInfoExtended, include_in_legacy_
 		}, \
 		.property_name = m_property_name, \
 		.include_in_legacy_property_changed = m_include_in_legacy_property_changed, \
+		.maybe_large = m_maybe_large, \
 	}))
 
 #define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE(m_name, m_signature, m_property_name) \
-	NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL (m_name, m_signature, m_property_name, FALSE)
+	NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL (m_name, m_signature, m_property_name, FALSE, FALSE)
 
 /* define a legacy property. Do not use for new code. */
 #define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L(m_name, m_signature, m_property_name) \
-	NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL (m_name, m_signature, m_property_name, TRUE)
+	NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL (m_name, m_signature, m_property_name, TRUE, FALSE)
+
+/* define a legacy property that can grow large. */
+#define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE(m_name, m_signature, m_property_name) \
+	NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_FULL (m_name, m_signature, m_property_name, TRUE, TRUE)
 
 #define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READWRITABLE_FULL(m_name, m_signature, m_property_name, m_permission, m_audit_op, m_include_in_legacy_property_changed) \
 	((GDBusPropertyInfo *) &((const struct _NMDBusPropertyInfoExtendedReadWritable) { \
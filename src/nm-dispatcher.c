@@ -8,6 +8,8 @@
 
 #include "nm-dispatcher.h"
 
+#include <sys/stat.h>
+
 #include "nm-libnm-core-aux/nm-dispatcher-api.h"
 #include "NetworkManagerUtils.h"
 #include "nm-utils.h"
@@ -20,6 +22,7 @@
 #include "nm-ip4-config.h"
 #include "nm-ip6-config.h"
 #include "nm-manager.h"
+#include "nm-config.h"
 #include "settings/nm-settings-connection.h"
 #include "platform/nm-platform.h"
 #include "nm-core-internal.h"
@@ -74,9 +77,31 @@ struct NMDispatcherCallId {
 static struct {
 	GDBusConnection *dbus_connection;
 	GHashTable *requests;
+	GHashTable *coalesce;
 	guint request_id_counter;
+
+	/* statistics about events sent to the dispatcher service and
+	 * events that were dropped, either because they got coalesced
+	 * or because there are no scripts for the action. */
+	guint num_sent;
+	guint num_dropped;
+
+	NMDispatcherPreUpFunc pre_up_func;
+	gpointer pre_up_user_data;
 } gl;
 
+typedef struct {
+	NMDevice *device;
+	NMDispatcherAction action;
+	guint timeout_id;
+} CoalesceData;
+
+typedef struct {
+	struct timespec mtimes[6];
+	bool initialized:1;
+	bool has_scripts:1;
+} ScriptDirState;
+
 /*****************************************************************************/
 
 static NMDispatcherCallId *
@@ -131,11 +156,43 @@ dispatcher_call_id_free (NMDispatcherCallId *call_id)
 /*****************************************************************************/
 
 
+static guint
+_coalesce_data_hash (gconstpointer ptr)
+{
+	const CoalesceData *data = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 1839175591u);
+	nm_hash_update_vals (&h, data->device, data->action);
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_coalesce_data_equal (gconstpointer a, gconstpointer b)
+{
+	const CoalesceData *data_a = a;
+	const CoalesceData *data_b = b;
+
+	return    data_a->device == data_b->device
+	       && data_a->action == data_b->action;
+}
+
+static void
+_coalesce_data_free (gpointer ptr)
+{
+	CoalesceData *data = ptr;
+
+	nm_clear_g_source (&data->timeout_id);
+	g_object_unref (data->device);
+	g_slice_free (CoalesceData, data);
+}
+
 static void
 _init_dispatcher (void)
 {
 	if (G_UNLIKELY (gl.requests == NULL)) {
 		gl.requests = g_hash_table_new (nm_direct_hash, NULL);
+		gl.coalesce = g_hash_table_new_full (_coalesce_data_hash, _coalesce_data_equal, _coalesce_data_free, NULL);
 		gl.dbus_connection = nm_g_object_ref (NM_MAIN_DBUS_CONNECTION_GET);
 
 		if (!gl.dbus_connection)
@@ -145,6 +202,115 @@ _init_dispatcher (void)
 
 /*****************************************************************************/
 
+static gboolean
+_script_dir_has_scripts (const char *dirname)
+{
+	const char *filename;
+	gboolean has_scripts = FALSE;
+	GDir *dir;
+
+	dir = g_dir_open (dirname, 0, NULL);
+	if (!dir)
+		return FALSE;
+
+	while ((filename = g_dir_read_name (dir))) {
+		gs_free char *path = NULL;
+		struct stat st;
+
+		if (filename[0] == '.')
+			continue;
+
+		/* The dispatcher service only runs regular files. This also skips
+		 * the subdirectories like "pre-up.d" and scripts that are masked
+		 * by a symlink to /dev/null. The remaining checks are left to
+		 * the dispatcher service, we only need to know whether there is
+		 * possibly anything to run. */
+		path = g_build_filename (dirname, filename, NULL);
+		if (   stat (path, &st) == 0
+		    && S_ISREG (st.st_mode)) {
+			has_scripts = TRUE;
+			break;
+		}
+	}
+
+	g_dir_close (dir);
+	return has_scripts;
+}
+
+/* _dispatcher_has_scripts:
+ * @action: the dispatcher action
+ *
+ * Checks whether there are any scripts installed for @action. The result is cached
+ * and only re-evaluated when the modification time of the script directories changes.
+ * Scripts are usually symlinks into the "no-wait.d" and "parallel.d" directories,
+ * whose targets can be created or replaced later without touching the script
+ * directory. So the modification times of these directories are part of the cache
+ * key too, and this costs six stat() calls per event. */
+static gboolean
+_dispatcher_has_scripts (NMDispatcherAction action)
+{
+#define _SCRIPT_DIRS(subdir) { NMLIBDIR "/dispatcher.d" subdir, NMCONFDIR "/dispatcher.d" subdir }
+	static const char *const script_dirs[3][2] = {
+		_SCRIPT_DIRS (""),
+		_SCRIPT_DIRS ("/pre-up.d"),
+		_SCRIPT_DIRS ("/pre-down.d"),
+	};
+	static const char *const link_dirs[4] = {
+		NMLIBDIR "/dispatcher.d/no-wait.d",
+		NMLIBDIR "/dispatcher.d/parallel.d",
+		NMCONFDIR "/dispatcher.d/no-wait.d",
+		NMCONFDIR "/dispatcher.d/parallel.d",
+	};
+	static ScriptDirState states[3];
+	ScriptDirState *state;
+	gboolean changed;
+	guint idx;
+	guint i;
+
+	if (NM_IN_SET (action, NM_DISPATCHER_ACTION_PRE_UP,
+	                       NM_DISPATCHER_ACTION_VPN_PRE_UP))
+		idx = 1;
+	else if (NM_IN_SET (action, NM_DISPATCHER_ACTION_PRE_DOWN,
+	                            NM_DISPATCHER_ACTION_VPN_PRE_DOWN))
+		idx = 2;
+	else
+		idx = 0;
+
+	state = &states[idx];
+	changed = !state->initialized;
+
+	G_STATIC_ASSERT_EXPR (G_N_ELEMENTS (state->mtimes) == G_N_ELEMENTS (script_dirs[0]) + G_N_ELEMENTS (link_dirs));
+
+	for (i = 0; i < G_N_ELEMENTS (state->mtimes); i++) {
+		const char *dirname;
+		struct timespec mtime = { 0 };
+		struct stat st;
+
+		if (i < G_N_ELEMENTS (script_dirs[0]))
+			dirname = script_dirs[idx][i];
+		else
+			dirname = link_dirs[i - G_N_ELEMENTS (script_dirs[0])];
+
+		if (stat (dirname, &st) == 0)
+			mtime = st.st_mtim;
+		if (   mtime.tv_sec != state->mtimes[i].tv_sec
+		    || mtime.tv_nsec != state->mtimes[i].tv_nsec) {
+			state->mtimes[i] = mtime;
+			changed = TRUE;
+		}
+	}
+
+	if (changed) {
+		state->initialized = TRUE;
+		state->has_scripts =    _script_dir_has_scripts (script_dirs[idx][0])
+		                     || _script_dir_has_scripts (script_dirs[idx][1]);
+	}
+
+	return state->has_scripts;
+}
+
+/*****************************************************************************/
+
 static void
 dump_proxy_to_props (NMProxyConfig *proxy, GVariantBuilder *builder)
 {
@@ -540,6 +706,28 @@ _dispatcher_call (NMDispatcherAction action,
 	log_ifname = device ? nm_device_get_iface (device) : NULL;
 	log_con_uuid = settings_connection ? nm_settings_connection_get_uuid (settings_connection) : NULL;
 
+	if (!_dispatcher_has_scripts (action)) {
+		/* don't bother building the parameters and waking up the
+		 * dispatcher service, if it has nothing to do. */
+		gl.num_dropped++;
+		nm_log (LOGL_DEBUG,
+		        _NMLOG2_DOMAIN,
+		        log_ifname,
+		        log_con_uuid,
+		        "dispatcher: skip action '%s' without scripts (%u sent, %u dropped)",
+		        action_to_string (action),
+		        gl.num_sent,
+		        gl.num_dropped);
+		return FALSE;
+	}
+
+	if (   action == NM_DISPATCHER_ACTION_UP
+	    && gl.pre_up_func) {
+		/* "up" scripts expect routing and DNS to be configured. Give the
+		 * policy a chance to run its pending deferred update. */
+		gl.pre_up_func (gl.pre_up_user_data);
+	}
+
 	request_id = ++gl.request_id_counter;
 	if (G_UNLIKELY (!request_id))
 		request_id = ++gl.request_id_counter;
@@ -628,6 +816,8 @@ _dispatcher_call (NMDispatcherAction action,
 
 	connectivity_state_string = nm_connectivity_state_to_string (connectivity_state);
 
+	gl.num_sent++;
+
 	parameters_floating = g_variant_new ("(s@a{sa{sv}}a{sv}a{sv}a{sv}a{sv}a{sv}@a{sv}@a{sv}ssa{sv}a{sv}a{sv}b)",
 	                                     action_to_string (action),
 	                                     connection_dict,
@@ -643,7 +833,7 @@ _dispatcher_call (NMDispatcherAction action,
 	                                     &vpn_proxy_props,
 	                                     &vpn_ip4_props,
 	                                     &vpn_ip6_props,
-	                                     nm_logging_enabled (LOGL_DEBUG, LOGD_DISPATCH));
+	                                     nm_logging_output_enabled (LOGL_DEBUG, LOGD_DISPATCH));
 
 	/* Send the action to the dispatcher */
 	if (blocking) {
@@ -717,6 +907,149 @@ nm_dispatcher_call_hostname (NMDispatcherFunc callback,
 	                         callback, user_data, out_call_id);
 }
 
+static gboolean
+_dispatcher_call_device (NMDispatcherAction action,
+                         NMDevice *device,
+                         NMActRequest *act_request,
+                         NMDispatcherFunc callback,
+                         gpointer user_data,
+                         NMDispatcherCallId **out_call_id)
+{
+	if (!act_request) {
+		act_request = nm_device_get_act_request (device);
+		if (!act_request)
+			return FALSE;
+	}
+	nm_assert (NM_IN_SET (nm_active_connection_get_device (NM_ACTIVE_CONNECTION (act_request)), NULL, device));
+	return _dispatcher_call (action, FALSE,
+	                         device,
+	                         nm_act_request_get_settings_connection (act_request),
+	                         nm_act_request_get_applied_connection (act_request),
+	                         nm_active_connection_get_activation_type (NM_ACTIVE_CONNECTION (act_request)) == NM_ACTIVATION_TYPE_EXTERNAL,
+	                         NM_CONNECTIVITY_UNKNOWN,
+	                         NULL, NULL, NULL, NULL,
+	                         callback, user_data, out_call_id);
+}
+
+/*****************************************************************************/
+
+static guint
+_coalesce_get_timeout_ms (NMDevice *device)
+{
+	gs_free char *value = NULL;
+
+	value = nm_config_data_get_device_config (NM_CONFIG_GET_DATA,
+	                                          NM_CONFIG_KEYFILE_KEY_DEVICE_DISPATCHER_COALESCE_TIMEOUT,
+	                                          device,
+	                                          NULL);
+	return _nm_utils_ascii_str_to_int64 (value, 10, 0, G_MAXINT32, 0);
+}
+
+static gboolean
+_coalesce_timeout_cb (gpointer user_data)
+{
+	CoalesceData *data = user_data;
+	gs_unref_object NMDevice *device = g_object_ref (data->device);
+	NMDispatcherAction action = data->action;
+
+	data->timeout_id = 0;
+	g_hash_table_remove (gl.coalesce, data);
+
+	/* the parameters are only built now, so that the scripts see the
+	 * latest state of the device. If the event gets skipped, _dispatcher_call()
+	 * accounts for it. */
+	_dispatcher_call_device (action, device, NULL, NULL, NULL, NULL);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* _coalesce_schedule:
+ * @action: the dispatcher action
+ * @device: the device
+ *
+ * Delays the event by the "dispatcher.coalesce-timeout" of the device,
+ * and merges it with an already pending event of the same kind.
+ *
+ * Returns: %TRUE if the event is pending. %FALSE if coalescing is
+ *   not enabled and the event must be sent right away.
+ */
+static gboolean
+_coalesce_schedule (NMDispatcherAction action, NMDevice *device)
+{
+	const CoalesceData needle = {
+		.device = device,
+		.action = action,
+	};
+	CoalesceData *data;
+	guint timeout_ms;
+
+	if (!gl.dbus_connection)
+		return FALSE;
+
+	if (g_hash_table_contains (gl.coalesce, &needle)) {
+		gl.num_dropped++;
+		_LOGT ("(%s) coalesce action '%s' with pending event (%u sent, %u dropped)",
+		       nm_device_get_iface (device),
+		       action_to_string (action),
+		       gl.num_sent,
+		       gl.num_dropped);
+		return TRUE;
+	}
+
+	timeout_ms = _coalesce_get_timeout_ms (device);
+	if (timeout_ms == 0)
+		return FALSE;
+
+	data = g_slice_new (CoalesceData);
+	*data = (CoalesceData) {
+		.device     = g_object_ref (device),
+		.action     = action,
+		.timeout_id = g_timeout_add (timeout_ms, _coalesce_timeout_cb, data),
+	};
+	g_hash_table_add (gl.coalesce, data);
+	return TRUE;
+}
+
+/* _coalesce_flush:
+ * @device: the device
+ * @drop: whether to drop the pending events
+ *
+ * Before any other event is sent for @device, the pending coalesced
+ * events are either sent first (to preserve the order), or dropped
+ * because the device is going down and they are superseded. */
+static void
+_coalesce_flush (NMDevice *device, gboolean drop)
+{
+	static const NMDispatcherAction actions[] = {
+		NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+		NM_DISPATCHER_ACTION_DHCP6_CHANGE,
+	};
+	guint i;
+
+	if (g_hash_table_size (gl.coalesce) == 0)
+		return;
+
+	for (i = 0; i < G_N_ELEMENTS (actions); i++) {
+		const CoalesceData needle = {
+			.device = device,
+			.action = actions[i],
+		};
+
+		if (!g_hash_table_remove (gl.coalesce, &needle))
+			continue;
+
+		if (drop) {
+			gl.num_dropped++;
+			_LOGT ("(%s) drop pending action '%s' (%u sent, %u dropped)",
+			       nm_device_get_iface (device),
+			       action_to_string (actions[i]),
+			       gl.num_sent,
+			       gl.num_dropped);
+		} else
+			_dispatcher_call_device (actions[i], device, NULL, NULL, NULL, NULL);
+	}
+}
+
 /**
  * nm_dispatcher_call_device:
  * @action: the %NMDispatcherAction
@@ -731,6 +1064,10 @@ nm_dispatcher_call_hostname (NMDispatcherFunc callback,
  * This method always invokes the device dispatcher action asynchronously.  To ignore
  * the result, pass %NULL to @callback.
  *
+ * "dhcp4-change" and "dhcp6-change" actions without @act_request and @callback
+ * may get delayed and coalesced, according to the "dispatcher.coalesce-timeout"
+ * device setting.
+ *
  * Returns: %TRUE if the action was dispatched, %FALSE on failure
  */
 gboolean
@@ -742,20 +1079,23 @@ nm_dispatcher_call_device (NMDispatcherAction action,
                            NMDispatcherCallId **out_call_id)
 {
 	nm_assert (NM_IS_DEVICE (device));
-	if (!act_request) {
-		act_request = nm_device_get_act_request (device);
-		if (!act_request)
-			return FALSE;
+
+	_init_dispatcher ();
+
+	if (   NM_IN_SET (action, NM_DISPATCHER_ACTION_DHCP4_CHANGE,
+	                          NM_DISPATCHER_ACTION_DHCP6_CHANGE)
+	    && !act_request
+	    && !callback
+	    && !out_call_id) {
+		if (_coalesce_schedule (action, device))
+			return TRUE;
+	} else {
+		_coalesce_flush (device,
+		                 NM_IN_SET (action, NM_DISPATCHER_ACTION_PRE_DOWN,
+		                                    NM_DISPATCHER_ACTION_DOWN));
 	}
-	nm_assert (NM_IN_SET (nm_active_connection_get_device (NM_ACTIVE_CONNECTION (act_request)), NULL, device));
-	return _dispatcher_call (action, FALSE,
-	                         device,
-	                         nm_act_request_get_settings_connection (act_request),
-	                         nm_act_request_get_applied_connection (act_request),
-	                         nm_active_connection_get_activation_type (NM_ACTIVE_CONNECTION (act_request)) == NM_ACTIVATION_TYPE_EXTERNAL,
-	                         NM_CONNECTIVITY_UNKNOWN,
-	                         NULL, NULL, NULL, NULL,
-	                         callback, user_data, out_call_id);
+
+	return _dispatcher_call_device (action, device, act_request, callback, user_data, out_call_id);
 }
 
 /**
@@ -776,6 +1116,12 @@ nm_dispatcher_call_device_sync (NMDispatcherAction action,
                                 NMActRequest *act_request)
 {
 	nm_assert (NM_IS_DEVICE (device));
+
+	_init_dispatcher ();
+	_coalesce_flush (device,
+	                 NM_IN_SET (action, NM_DISPATCHER_ACTION_PRE_DOWN,
+	                                    NM_DISPATCHER_ACTION_DOWN));
+
 	if (!act_request) {
 		act_request = nm_device_get_act_request (device);
 		if (!act_request)
@@ -896,6 +1242,24 @@ nm_dispatcher_call_connectivity (NMConnectivityState connectivity_state,
 	                         callback, user_data, out_call_id);
 }
 
+/**
+ * nm_dispatcher_set_pre_up_func:
+ * @func: (allow-none): the function to call before an "up" event
+ *   is sent to the dispatcher service.
+ * @user_data: user data for @func.
+ *
+ * Only one function can be registered. Pass %NULL to unregister it.
+ */
+void
+nm_dispatcher_set_pre_up_func (NMDispatcherPreUpFunc func,
+                               gpointer user_data)
+{
+	nm_assert (!func || !gl.pre_up_func);
+
+	gl.pre_up_func = func;
+	gl.pre_up_user_data = func ? user_data : NULL;
+}
+
 void
 nm_dispatcher_call_cancel (NMDispatcherCallId *call_id)
 {
@@ -71,4 +71,9 @@ gboolean nm_dispatcher_call_connectivity (NMConnectivityState state,
 
 void nm_dispatcher_call_cancel (NMDispatcherCallId *call_id);
 
+typedef void (*NMDispatcherPreUpFunc) (gpointer user_data);
+
+void nm_dispatcher_set_pre_up_func (NMDispatcherPreUpFunc func,
+                                    gpointer user_data);
+
 #endif /* __NM_DISPATCHER_H__ */
@@ -640,6 +640,76 @@ nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	return self;
 }
 
+/**
+ * nm_ip4_config_capture_update:
+ * @self: a configuration created by nm_ip4_config_capture()
+ * @platform: the platform instance
+ * @obj: the IPv4 address or route that changed in @platform
+ * @change_type: how @obj changed
+ *
+ * Applies a single change of the platform cache to the captured configuration,
+ * so that @self afterwards contains the same addresses and routes as a
+ * configuration captured anew. Only the order of the routes may differ.
+ *
+ * Returns: %FALSE if the change cannot be applied incrementally. In that
+ *   case, @self is unchanged and the caller must capture the configuration
+ *   again with nm_ip4_config_capture().
+ */
+gboolean
+nm_ip4_config_capture_update (NMIP4Config *self,
+                              NMPlatform *platform,
+                              const NMPObject *obj,
+                              NMPlatformSignalChangeType change_type)
+{
+	NMIP4ConfigPrivate *priv;
+
+	g_return_val_if_fail (NM_IS_IP4_CONFIG (self), FALSE);
+	nm_assert (NM_IN_SET (change_type, NM_PLATFORM_SIGNAL_ADDED,
+	                                   NM_PLATFORM_SIGNAL_CHANGED,
+	                                   NM_PLATFORM_SIGNAL_REMOVED));
+
+	priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+
+	if (NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj)->ifindex != priv->ifindex)
+		return FALSE;
+
+	/* Slaves have no IP configuration. nm_ip4_config_capture() would
+	 * return %NULL. */
+	if (nm_platform_link_get_master (platform, priv->ifindex) > 0)
+		return FALSE;
+
+	switch (NMP_OBJECT_GET_TYPE (obj)) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		if (change_type == NM_PLATFORM_SIGNAL_REMOVED) {
+			nm_ip4_config_nmpobj_remove (self, obj);
+			return TRUE;
+		}
+		if (_nm_ip_config_add_obj (priv->multi_idx,
+		                           &priv->idx_ip4_addresses_,
+		                           priv->ifindex,
+		                           obj,
+		                           NULL,
+		                           FALSE,
+		                           TRUE,
+		                           NULL,
+		                           NULL)) {
+			nm_dedup_multi_head_entry_sort (nm_ip4_config_lookup_addresses (self),
+			                                sort_captured_addresses,
+			                                NULL);
+			_notify_addresses (self);
+		}
+		return TRUE;
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+		if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+			nm_ip4_config_nmpobj_remove (self, obj);
+		else
+			_add_route (self, obj, NULL, NULL);
+		return TRUE;
+	default:
+		g_return_val_if_reached (FALSE);
+	}
+}
+
 void
 nm_ip4_config_update_routes_metric (NMIP4Config *self, gint64 metric)
 {
@@ -869,6 +939,16 @@ _nm_ip_config_merge_route_attributes (int addr_family,
 	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITCWND,  r->lock_initcwnd,  BOOLEAN,  boolean, FALSE);
 	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_INITRWND,  r->lock_initrwnd,  BOOLEAN,  boolean, FALSE);
 	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_LOCK_MTU,       r->lock_mtu,       BOOLEAN,  boolean, FALSE);
+	GET_ATTR (NM_IP_ROUTE_ATTRIBUTE_NHID,           r->nhid,           UINT32,   uint32, 0);
+
+	if (r->nhid) {
+		/* the gateway is configured on the nexthop object that the route
+		 * references. Kernel rejects routes that have both. */
+		if (addr_family == AF_INET)
+			r4->gateway = 0;
+		else
+			r6->gateway = in6addr_any;
+	}
 
 	if (   (variant = nm_ip_route_get_attribute (s_route, NM_IP_ROUTE_ATTRIBUTE_SRC))
 	    && g_variant_is_of_type (variant, G_VARIANT_TYPE_STRING)) {
@@ -3338,6 +3418,22 @@ finalize (GObject *object)
 	nm_dedup_multi_index_unref (priv->multi_idx);
 }
 
+static guint
+get_property_n_elements (NMDBusObject *obj, const char *property_name)
+{
+	NMIP4Config *self = NM_IP4_CONFIG (obj);
+
+	if (NM_IN_STRSET (property_name, NM_IP4_CONFIG_ROUTE_DATA,
+	                                 NM_IP4_CONFIG_ROUTES))
+		return nm_ip4_config_get_num_routes (self);
+	if (NM_IN_STRSET (property_name, NM_IP4_CONFIG_ADDRESS_DATA,
+	                                 NM_IP4_CONFIG_ADDRESSES))
+		return nm_ip4_config_get_num_addresses (self);
+
+	nm_assert_not_reached ();
+	return 0;
+}
+
 static const NMDBusInterfaceInfoExtended interface_info_ip4_config = {
 	.parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT (
 		NM_DBUS_INTERFACE_IP4_CONFIG,
@@ -3345,19 +3441,19 @@ static const NMDBusInterfaceInfoExtended interface_info_ip4_config = {
 			&nm_signal_info_property_changed_legacy,
 		),
 		.properties = NM_DEFINE_GDBUS_PROPERTY_INFOS (
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Addresses",      "aau",    NM_IP4_CONFIG_ADDRESSES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("AddressData",    "aa{sv}", NM_IP4_CONFIG_ADDRESS_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Gateway",        "s",      NM_IP4_CONFIG_GATEWAY),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Routes",         "aau",    NM_IP4_CONFIG_ROUTES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("RouteData",      "aa{sv}", NM_IP4_CONFIG_ROUTE_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE   ("NameserverData", "aa{sv}", NM_IP4_CONFIG_NAMESERVER_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Nameservers",    "au",     NM_IP4_CONFIG_NAMESERVERS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Domains",        "as",     NM_IP4_CONFIG_DOMAINS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Searches",       "as",     NM_IP4_CONFIG_SEARCHES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("DnsOptions",     "as",     NM_IP4_CONFIG_DNS_OPTIONS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("DnsPriority",    "i",      NM_IP4_CONFIG_DNS_PRIORITY),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE   ("WinsServerData", "as",     NM_IP4_CONFIG_WINS_SERVER_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("WinsServers",    "au",     NM_IP4_CONFIG_WINS_SERVERS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("Addresses",      "aau",    NM_IP4_CONFIG_ADDRESSES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("AddressData",    "aa{sv}", NM_IP4_CONFIG_ADDRESS_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Gateway",        "s",      NM_IP4_CONFIG_GATEWAY),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("Routes",         "aau",    NM_IP4_CONFIG_ROUTES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("RouteData",      "aa{sv}", NM_IP4_CONFIG_ROUTE_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE         ("NameserverData", "aa{sv}", NM_IP4_CONFIG_NAMESERVER_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Nameservers",    "au",     NM_IP4_CONFIG_NAMESERVERS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Domains",        "as",     NM_IP4_CONFIG_DOMAINS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Searches",       "as",     NM_IP4_CONFIG_SEARCHES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("DnsOptions",     "as",     NM_IP4_CONFIG_DNS_OPTIONS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("DnsPriority",    "i",      NM_IP4_CONFIG_DNS_PRIORITY),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE         ("WinsServerData", "as",     NM_IP4_CONFIG_WINS_SERVER_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("WinsServers",    "au",     NM_IP4_CONFIG_WINS_SERVERS),
 		),
 	),
 	.legacy_property_changed = TRUE,
@@ -3371,6 +3467,7 @@ nm_ip4_config_class_init (NMIP4ConfigClass *config_class)
 
 	dbus_object_class->export_path = NM_DBUS_EXPORT_PATH_NUMBERED (NM_DBUS_PATH"/IP4Config");
 	dbus_object_class->interface_infos = NM_DBUS_INTERFACE_INFOS (&interface_info_ip4_config);
+	dbus_object_class->get_property_n_elements = get_property_n_elements;
 
 	object_class->get_property = get_property;
 	object_class->set_property = set_property;
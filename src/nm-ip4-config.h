@@ -147,6 +147,10 @@ int nm_ip4_config_get_ifindex (const NMIP4Config *self);
 NMDedupMultiIndex *nm_ip4_config_get_multi_idx (const NMIP4Config *self);
 
 NMIP4Config *nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex);
+gboolean nm_ip4_config_capture_update (NMIP4Config *self,
+                                       NMPlatform *platform,
+                                       const NMPObject *obj,
+                                       NMPlatformSignalChangeType change_type);
 
 void nm_ip4_config_add_dependent_routes (NMIP4Config *self,
                                          guint32 route_table,
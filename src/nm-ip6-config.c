@@ -424,6 +424,85 @@ nm_ip6_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	return self;
 }
 
+/**
+ * nm_ip6_config_capture_update:
+ * @self: a configuration created by nm_ip6_config_capture()
+ * @platform: the platform instance
+ * @obj: the IPv6 address or route that changed in @platform
+ * @change_type: how @obj changed
+ * @use_temporary: the same value that was passed to nm_ip6_config_capture()
+ *
+ * Applies a single change of the platform cache to the captured configuration,
+ * so that @self afterwards contains the same addresses and routes as a
+ * configuration captured anew. Only the order of the routes may differ.
+ *
+ * Returns: %FALSE if the change cannot be applied incrementally. In that
+ *   case, @self is unchanged and the caller must capture the configuration
+ *   again with nm_ip6_config_capture().
+ */
+gboolean
+nm_ip6_config_capture_update (NMIP6Config *self,
+                              NMPlatform *platform,
+                              const NMPObject *obj,
+                              NMPlatformSignalChangeType change_type,
+                              NMSettingIP6ConfigPrivacy use_temporary)
+{
+	NMIP6ConfigPrivate *priv;
+	char ifname[IFNAMSIZ];
+	char *path;
+
+	g_return_val_if_fail (NM_IS_IP6_CONFIG (self), FALSE);
+	nm_assert (NM_IN_SET (change_type, NM_PLATFORM_SIGNAL_ADDED,
+	                                   NM_PLATFORM_SIGNAL_CHANGED,
+	                                   NM_PLATFORM_SIGNAL_REMOVED));
+
+	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+
+	if (NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (obj)->ifindex != priv->ifindex)
+		return FALSE;
+
+	/* Slaves have no IP configuration. nm_ip6_config_capture() would
+	 * return %NULL. */
+	if (nm_platform_link_get_master (platform, priv->ifindex) > 0)
+		return FALSE;
+
+	switch (NMP_OBJECT_GET_TYPE (obj)) {
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+			nm_ip6_config_nmpobj_remove (self, obj);
+		else if (_nm_ip_config_add_obj (priv->multi_idx,
+		                                &priv->idx_ip6_addresses_,
+		                                priv->ifindex,
+		                                obj,
+		                                NULL,
+		                                FALSE,
+		                                TRUE,
+		                                NULL,
+		                                NULL)) {
+			nm_dedup_multi_head_entry_sort (nm_ip6_config_lookup_addresses (self),
+			                                sort_captured_addresses,
+			                                GINT_TO_POINTER (use_temporary));
+			_notify_addresses (self);
+		}
+
+		/* Toggling disable_ipv6 adds or removes addresses. Only re-read
+		 * the sysctl on address changes, not for every route. */
+		if (nm_platform_if_indextoname (platform, priv->ifindex, ifname)) {
+			path = nm_sprintf_bufa (128, "/proc/sys/net/ipv6/conf/%s/disable_ipv6", ifname);
+			priv->ipv6_disabled = (nm_platform_sysctl_get_int32 (platform, NMP_SYSCTL_PATHID_ABSOLUTE (path), 0) != 0);
+		}
+		return TRUE;
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+			nm_ip6_config_nmpobj_remove (self, obj);
+		else
+			_add_route (self, obj, NULL, NULL);
+		return TRUE;
+	default:
+		g_return_val_if_reached (FALSE);
+	}
+}
+
 void
 nm_ip6_config_update_routes_metric (NMIP6Config *self, gint64 metric)
 {
@@ -2763,6 +2842,22 @@ finalize (GObject *object)
 	nm_dedup_multi_index_unref (priv->multi_idx);
 }
 
+static guint
+get_property_n_elements (NMDBusObject *obj, const char *property_name)
+{
+	NMIP6Config *self = NM_IP6_CONFIG (obj);
+
+	if (NM_IN_STRSET (property_name, NM_IP6_CONFIG_ROUTE_DATA,
+	                                 NM_IP6_CONFIG_ROUTES))
+		return nm_ip6_config_get_num_routes (self);
+	if (NM_IN_STRSET (property_name, NM_IP6_CONFIG_ADDRESS_DATA,
+	                                 NM_IP6_CONFIG_ADDRESSES))
+		return nm_ip6_config_get_num_addresses (self);
+
+	nm_assert_not_reached ();
+	return 0;
+}
+
 static const NMDBusInterfaceInfoExtended interface_info_ip6_config = {
 	.parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT (
 		NM_DBUS_INTERFACE_IP6_CONFIG,
@@ -2770,16 +2865,16 @@ static const NMDBusInterfaceInfoExtended interface_info_ip6_config = {
 			&nm_signal_info_property_changed_legacy,
 		),
 		.properties = NM_DEFINE_GDBUS_PROPERTY_INFOS (
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Addresses",   "a(ayuay)",  NM_IP6_CONFIG_ADDRESSES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("AddressData", "aa{sv}",    NM_IP6_CONFIG_ADDRESS_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Gateway",     "s",         NM_IP6_CONFIG_GATEWAY),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Routes",      "a(ayuayu)", NM_IP6_CONFIG_ROUTES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("RouteData",   "aa{sv}",    NM_IP6_CONFIG_ROUTE_DATA),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Nameservers", "aay",       NM_IP6_CONFIG_NAMESERVERS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Domains",     "as",        NM_IP6_CONFIG_DOMAINS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("Searches",    "as",        NM_IP6_CONFIG_SEARCHES),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("DnsOptions",  "as",        NM_IP6_CONFIG_DNS_OPTIONS),
-			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L ("DnsPriority", "i",         NM_IP6_CONFIG_DNS_PRIORITY),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("Addresses",   "a(ayuay)",  NM_IP6_CONFIG_ADDRESSES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("AddressData", "aa{sv}",    NM_IP6_CONFIG_ADDRESS_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Gateway",     "s",         NM_IP6_CONFIG_GATEWAY),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("Routes",      "a(ayuayu)", NM_IP6_CONFIG_ROUTES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L_LARGE ("RouteData",   "aa{sv}",    NM_IP6_CONFIG_ROUTE_DATA),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Nameservers", "aay",       NM_IP6_CONFIG_NAMESERVERS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Domains",     "as",        NM_IP6_CONFIG_DOMAINS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("Searches",    "as",        NM_IP6_CONFIG_SEARCHES),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("DnsOptions",  "as",        NM_IP6_CONFIG_DNS_OPTIONS),
+			NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_L       ("DnsPriority", "i",         NM_IP6_CONFIG_DNS_PRIORITY),
 		),
 	),
 	.legacy_property_changed = TRUE,
@@ -2793,6 +2888,7 @@ nm_ip6_config_class_init (NMIP6ConfigClass *config_class)
 
 	dbus_object_class->export_path = NM_DBUS_EXPORT_PATH_NUMBERED (NM_DBUS_PATH"/IP6Config");
 	dbus_object_class->interface_infos = NM_DBUS_INTERFACE_INFOS (&interface_info_ip6_config);
+	dbus_object_class->get_property_n_elements = get_property_n_elements;
 
 	object_class->get_property = get_property;
 	object_class->set_property = set_property;
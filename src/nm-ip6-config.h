@@ -91,6 +91,11 @@ struct _NMDedupMultiIndex *nm_ip6_config_get_multi_idx (const NMIP6Config *self)
 
 NMIP6Config *nm_ip6_config_capture (struct _NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex,
                                     NMSettingIP6ConfigPrivacy use_temporary);
+gboolean nm_ip6_config_capture_update (NMIP6Config *self,
+                                       NMPlatform *platform,
+                                       const NMPObject *obj,
+                                       NMPlatformSignalChangeType change_type,
+                                       NMSettingIP6ConfigPrivacy use_temporary);
 
 void nm_ip6_config_add_dependent_routes (NMIP6Config *self,
                                          guint32 route_table,
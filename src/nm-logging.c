@@ -49,6 +49,12 @@
  * set @mt_require_locking. That means, by default %NM_THREAD_SAFE_ON_MAIN_THREAD is "1",
  * and code that only runs on the main-thread (which is the majority), can get away
  * without locking.
+ *
+ * The flight recorder and the writer thread are optional. The flight recorder
+ * is a ring buffer where each message claims a slot with an atomic increment.
+ * The writer thread receives the messages via a GAsyncQueue and is the only
+ * thread that writes them to the backend (except for those that are written
+ * synchronously, see _nm_log_impl()).
  */
 
 /*****************************************************************************/
@@ -120,8 +126,49 @@ typedef struct {
 	 * Afterwards, the backend is either SYSLOG or JOURNAL. From that point, also
 	 * g_log() is redirected to this backend via a logging handler. */
 	LogBackend log_backend;
+
+	/* the minimal level that is recorded by the flight recorder, or %_LOGL_OFF
+	 * if the flight recorder is disabled. */
+	NMLogLevel flight_recorder_level;
+
+	/* whether messages less important than LOGL_INFO are handed over to
+	 * the writer thread, instead of writing them on the calling thread. */
+	bool async_writer:1;
 } Global;
 
+typedef struct {
+	const char *file;
+	const char *func;
+	const char *ifname;
+	const char *conn_uuid;
+	const char *msg;
+	gint64 realtime_usec;
+	gint64 monotonic_nsec;
+	NMLogDomain domain;
+	NMLogLevel level;
+	guint line;
+	int error;
+} LogMsg;
+
+/* A record in the flight recorder. The message is stored as a fixed-size
+ * buffer so that recording does not allocate. Everything else (the timestamps,
+ * the domains) is kept in binary form and only formatted when dumping. */
+typedef struct {
+	/* the sequence number of the record. It is odd while the record is
+	 * being written and allows a reader to detect torn records. */
+	int seq;
+	int error;
+	NMLogLevel level;
+	NMLogDomain domain;
+	gint64 realtime_usec;
+	gint64 monotonic_nsec;
+	const char *file;
+	const char *func;
+	guint line;
+	char ifname[16];
+	char msg[224];
+} FlightRecord;
+
 /*****************************************************************************/
 
 G_LOCK_DEFINE_STATIC (log);
@@ -141,6 +188,7 @@ static union {
 		/* nm_logging_setup ("INFO", LOGD_DEFAULT_STRING, NULL, NULL); */
 		.log_level = LOGL_INFO,
 		.log_backend = LOG_BACKEND_GLIB,
+		.flight_recorder_level = _LOGL_OFF,
 		.syslog_identifier = "SYSLOG_IDENTIFIER="G_LOG_DOMAIN,
 		.prefix = "",
 	},
@@ -156,6 +204,40 @@ NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL] = {
 	[LOGL_ERR]  = LOGD_DEFAULT,
 };
 
+/* The logging state as configured via nm_logging_setup(), that is, which messages
+ * get written to the logging backend. It differs from _nm_logging_enabled_state
+ * only by the levels that are enabled solely for the flight recorder.
+ *
+ * Protected by the same lock as _nm_logging_enabled_state. */
+NMLogDomain _nm_logging_output_state[_LOGL_N_REAL] = {
+	[LOGL_INFO] = LOGD_DEFAULT,
+	[LOGL_WARN] = LOGD_DEFAULT,
+	[LOGL_ERR]  = LOGD_DEFAULT,
+};
+
+/* The flight recorder is a ring buffer of the most recent logging messages.
+ * It gets allocated once by nm_logging_init_flight_recorder() and is never
+ * freed. Writers claim a slot by atomically incrementing @head, so recording
+ * a message does not require the logging lock. */
+static struct {
+	FlightRecord *records;
+	guint mask;
+	int head;
+} gl_fr;
+
+#define FLIGHT_RECORDER_MAX_RECORDS  65536
+
+/* The writer thread only gets started by nm_logging_init_async_writer(). */
+static struct {
+	GThread *thread;
+	GAsyncQueue *queue;
+	int n_dropped;
+} gl_async;
+
+/* the maximum number of queued messages. If the writer thread cannot keep
+ * up, further messages get dropped (and counted). */
+#define ASYNC_WRITER_MAX_QUEUED  8192
+
 /*****************************************************************************/
 
 static const LogLevelDesc level_desc[_LOGL_N] = {
@@ -285,6 +367,30 @@ match_log_level (const char  *level,
 	return FALSE;
 }
 
+static NMLogDomain
+_flight_recorder_domains (NMLogLevel flight_recorder_level, NMLogLevel level)
+{
+	if (level < flight_recorder_level)
+		return LOGD_NONE;
+
+	/* like for "ALL", the flight recorder does not capture the verbose
+	 * levels of LOGD_VPN_PLUGIN. */
+	if (level < LOGL_INFO)
+		return LOGD_ALL & ~LOGD_VPN_PLUGIN;
+	return LOGD_ALL;
+}
+
+static void
+_logging_enabled_state_update_locked (void)
+{
+	int i;
+
+	for (i = 0; i < G_N_ELEMENTS (_nm_logging_enabled_state); i++) {
+		_nm_logging_enabled_state[i] =   _nm_logging_output_state[i]
+		                               | _flight_recorder_domains (gl.imm.flight_recorder_level, i);
+	}
+}
+
 gboolean
 nm_logging_setup (const char  *level,
                   const char  *domains,
@@ -308,7 +414,7 @@ nm_logging_setup (const char  *level,
 	g_return_val_if_fail (!error || !*error, FALSE);
 
 	cur_log_level = gl.imm.log_level;
-	memcpy (cur_log_state, _nm_logging_enabled_state, sizeof (cur_log_state));
+	memcpy (cur_log_state, _nm_logging_output_state, sizeof (cur_log_state));
 
 	new_log_level = cur_log_level;
 
@@ -429,7 +535,8 @@ nm_logging_setup (const char  *level,
 
 	gl.mut.log_level = new_log_level;
 	for (i = 0; i < G_N_ELEMENTS (new_log_state); i++)
-		_nm_logging_enabled_state[i] = new_log_state[i];
+		_nm_logging_output_state[i] = new_log_state[i];
+	_logging_enabled_state_update_locked ();
 
 	G_UNLOCK (log);
 
@@ -482,7 +589,7 @@ nm_logging_domains_to_string (void)
 	if (G_UNLIKELY (!gl_main.logging_domains_to_string)) {
 		gl_main.logging_domains_to_string = _domains_to_string (TRUE,
 		                                                        gl.imm.log_level,
-		                                                        _nm_logging_enabled_state);
+		                                                        _nm_logging_output_state);
 	}
 
 	return gl_main.logging_domains_to_string;
@@ -596,7 +703,7 @@ nm_logging_get_level (NMLogDomain domain)
 
 	G_STATIC_ASSERT (LOGL_TRACE == 0);
 	while (   sl > LOGL_TRACE
-	       && _nm_logging_enabled_lockfree (sl - 1, domain))
+	       && NM_FLAGS_ANY (_nm_logging_output_state[sl - 1], domain))
 		sl--;
 	return sl;
 }
@@ -679,6 +786,357 @@ _iovec_set_format (struct iovec *iov, char **iov_free, const char *format, ...)
 
 #endif
 
+#define MESSAGE_FMT "%s%-7s [%ld.%04ld] %s"
+#define MESSAGE_ARG(prefix, realtime_usec, msg) \
+    prefix, \
+    level_desc[level].level_str, \
+    (long) ((realtime_usec) / G_USEC_PER_SEC), \
+    (long) (((realtime_usec) % G_USEC_PER_SEC) / 100), \
+    (msg)
+
+static void
+_domains_to_strbuf (NMLogDomain domain, char **buf, gsize *len)
+{
+	const LogDesc *diter;
+	NMLogDomain dom_all = domain;
+
+	for (diter = &domain_desc[0]; dom_all != 0 && diter->name; diter++) {
+		if (!NM_FLAGS_ANY (dom_all, diter->num))
+			continue;
+		if (dom_all != domain)
+			nm_utils_strbuf_append_c (buf, len, ',');
+		nm_utils_strbuf_append_str (buf, len, diter->name);
+		dom_all &= ~diter->num;
+	}
+}
+
+static void
+_log_emit (const Global *g, const LogMsg *m)
+{
+	const NMLogLevel level = m->level;
+
+	switch (g->log_backend) {
+#if SYSTEMD_JOURNAL
+	case LOG_BACKEND_JOURNAL:
+		{
+			gint64 now, boottime;
+			struct iovec iov_data[15];
+			struct iovec *iov = iov_data;
+			char *iov_free_data[5];
+			char **iov_free = iov_free_data;
+
+			now = m->monotonic_nsec ?: nm_utils_get_monotonic_timestamp_ns ();
+			boottime = nm_utils_monotonic_timestamp_as_boottime (now, 1);
+
+			_iovec_set_format_a (iov++, 30, "PRIORITY=%d", level_desc[level].syslog_level);
+			_iovec_set_format (iov++, iov_free++, "MESSAGE="MESSAGE_FMT, MESSAGE_ARG (g->prefix, m->realtime_usec, m->msg));
+			_iovec_set_string (iov++, syslog_identifier_full (g->syslog_identifier));
+			_iovec_set_format_a (iov++, 30, "SYSLOG_PID=%ld", (long) getpid ());
+			{
+				char s_log_domains_buf[NM_STRLEN ("NM_LOG_DOMAINS=") + sizeof (_all_logging_domains_to_str)];
+				char *s_log_domains = s_log_domains_buf;
+				gsize l_log_domains = sizeof (s_log_domains_buf);
+
+				nm_utils_strbuf_append_str (&s_log_domains, &l_log_domains, "NM_LOG_DOMAINS=");
+				_domains_to_strbuf (m->domain, &s_log_domains, &l_log_domains);
+				nm_assert (l_log_domains > 0);
+				_iovec_set (iov++, s_log_domains_buf, s_log_domains - s_log_domains_buf);
+			}
+			G_STATIC_ASSERT_EXPR (LOG_FAC (LOG_DAEMON) == 3);
+			_iovec_set_string_literal (iov++, "SYSLOG_FACILITY=3");
+			_iovec_set_format_str_a (iov++, 15, "NM_LOG_LEVEL=%s", level_desc[level].name);
+			if (m->func)
+				_iovec_set_format (iov++, iov_free++, "CODE_FUNC=%s", m->func);
+			_iovec_set_format (iov++, iov_free++, "CODE_FILE=%s", m->file ?: "");
+			_iovec_set_format_a (iov++, 20, "CODE_LINE=%u", m->line);
+			_iovec_set_format_a (iov++, 60, "TIMESTAMP_MONOTONIC=%lld.%06lld", (long long) (now / NM_UTILS_NS_PER_SECOND), (long long) ((now % NM_UTILS_NS_PER_SECOND) / 1000));
+			_iovec_set_format_a (iov++, 60, "TIMESTAMP_BOOTTIME=%lld.%06lld", (long long) (boottime / NM_UTILS_NS_PER_SECOND), (long long) ((boottime % NM_UTILS_NS_PER_SECOND) / 1000));
+			if (m->error != 0)
+				_iovec_set_format_a (iov++, 30, "ERRNO=%d", m->error);
+			if (m->ifname)
+				_iovec_set_format (iov++, iov_free++, "NM_DEVICE=%s", m->ifname);
+			if (m->conn_uuid)
+				_iovec_set_format (iov++, iov_free++, "NM_CONNECTION=%s", m->conn_uuid);
+
+			nm_assert (iov <= &iov_data[G_N_ELEMENTS (iov_data)]);
+			nm_assert (iov_free <= &iov_free_data[G_N_ELEMENTS (iov_free_data)]);
+
+			sd_journal_sendv (iov_data, iov - iov_data);
+
+			for (; --iov_free >= iov_free_data; )
+				g_free (*iov_free);
+		}
+		break;
+#endif
+	case LOG_BACKEND_SYSLOG:
+		syslog (level_desc[level].syslog_level,
+		        MESSAGE_FMT, MESSAGE_ARG (g->prefix, m->realtime_usec, m->msg));
+		break;
+	default:
+		g_log (syslog_identifier_domain (g->syslog_identifier), level_desc[level].g_log_level,
+		       MESSAGE_FMT, MESSAGE_ARG (g->prefix, m->realtime_usec, m->msg));
+		break;
+	}
+}
+
+/*****************************************************************************/
+
+static FlightRecord *
+_flight_recorder_begin (const LogMsg *m, int *out_seq)
+{
+	FlightRecord *r;
+	guint id;
+
+	nm_assert (gl_fr.records);
+
+	/* claim the next slot. If the ring buffer wraps around while the record is
+	 * still being written, the slot gets reused. A reader detects that by the
+	 * changed sequence number and skips the record. */
+	id = (guint) g_atomic_int_add (&gl_fr.head, 1);
+	r = &gl_fr.records[id & gl_fr.mask];
+
+	*out_seq = (int) ((id << 1) + 2u);
+	g_atomic_int_set (&r->seq, (int) ((id << 1) + 1u));
+
+	r->file = m->file;
+	r->func = m->func;
+	r->line = m->line;
+	r->level = m->level;
+	r->domain = m->domain;
+	r->error = m->error;
+	r->realtime_usec = m->realtime_usec;
+	r->monotonic_nsec = m->monotonic_nsec;
+	if (m->ifname)
+		g_strlcpy (r->ifname, m->ifname, sizeof (r->ifname));
+	else
+		r->ifname[0] = '\0';
+	return r;
+}
+
+static void
+_flight_recorder_add (const LogMsg *m)
+{
+	FlightRecord *r;
+	int seq;
+
+	r = _flight_recorder_begin (m, &seq);
+	g_strlcpy (r->msg, m->msg, sizeof (r->msg));
+	g_atomic_int_set (&r->seq, seq);
+}
+
+static void
+_flight_recorder_add_v (const LogMsg *m, const char *fmt, va_list args)
+{
+	FlightRecord *r;
+	int seq;
+
+	r = _flight_recorder_begin (m, &seq);
+	g_vsnprintf (r->msg, sizeof (r->msg), fmt, args);
+	g_atomic_int_set (&r->seq, seq);
+}
+
+static gboolean
+_flight_recorder_get (guint id, FlightRecord *out)
+{
+	const FlightRecord *r = &gl_fr.records[id & gl_fr.mask];
+	const int seq = (int) ((id << 1) + 2u);
+
+	if (g_atomic_int_get (&r->seq) != seq)
+		return FALSE;
+	memcpy (out, r, sizeof (*out));
+	if (g_atomic_int_get (&r->seq) != seq)
+		return FALSE;
+
+	out->ifname[sizeof (out->ifname) - 1] = '\0';
+	out->msg[sizeof (out->msg) - 1] = '\0';
+	return TRUE;
+}
+
+_nm_printf (1, 2)
+static void
+_flight_recorder_log_info (const char *fmt, ...)
+{
+	const NMLogLevel level = LOGL_INFO;
+	gs_free char *msg = NULL;
+	va_list args;
+	LogMsg m;
+
+	/* messages about the dump bypass the flight recorder. Otherwise, they
+	 * would overwrite the oldest records while dumping them. */
+	va_start (args, fmt);
+	msg = g_strdup_vprintf (fmt, args);
+	va_end (args);
+
+	m = (LogMsg) {
+		.file           = __FILE__,
+		.func           = G_STRFUNC,
+		.line           = __LINE__,
+		.level          = level,
+		.domain         = LOGD_CORE,
+		.msg            = msg,
+		.realtime_usec  = g_get_real_time (),
+		.monotonic_nsec = nm_utils_get_monotonic_timestamp_ns (),
+	};
+
+	if (gl.imm.debug_stderr)
+		g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (gl.imm.prefix, m.realtime_usec, msg));
+	_log_emit (&gl.imm, &m);
+}
+
+/**
+ * nm_logging_flight_recorder_dump:
+ * @n_records: the number of records to dump, or 0 for all.
+ *
+ * Writes the most recent records of the flight recorder to the
+ * logging backend (regardless of the configured logging level).
+ */
+void
+nm_logging_flight_recorder_dump (guint n_records)
+{
+	guint n_available;
+	guint n_lost = 0;
+	guint head;
+	guint id;
+
+	NM_ASSERT_ON_MAIN_THREAD ();
+
+	if (!gl_fr.records) {
+		nm_log_info (LOGD_CORE, "flight-recorder: not enabled, nothing to dump");
+		return;
+	}
+
+	head = (guint) g_atomic_int_get (&gl_fr.head);
+	n_available = MIN (head, gl_fr.mask + 1u);
+	if (   n_records == 0
+	    || n_records > n_available)
+		n_records = n_available;
+
+	_flight_recorder_log_info ("flight-recorder: dump the last %u records", n_records);
+
+	for (id = head - n_records; id != head; id++) {
+		char s_domains_buf[sizeof (_all_logging_domains_to_str)];
+		char *s_domains = s_domains_buf;
+		gsize l_domains = sizeof (s_domains_buf);
+		gs_free char *msg = NULL;
+		FlightRecord rec;
+		NMLogLevel level;
+		LogMsg m;
+
+		if (!_flight_recorder_get (id, &rec)) {
+			n_lost++;
+			continue;
+		}
+
+		s_domains_buf[0] = '\0';
+		_domains_to_strbuf (rec.domain, &s_domains, &l_domains);
+		msg = g_strdup_printf ("flight-recorder[%s]: %s", s_domains_buf, rec.msg);
+
+		level = rec.level;
+		m = (LogMsg) {
+			.file           = rec.file,
+			.func           = rec.func,
+			.line           = rec.line,
+			.level          = level,
+			.domain         = rec.domain,
+			.error          = rec.error,
+			.ifname         = rec.ifname[0] ? rec.ifname : NULL,
+			.msg            = msg,
+			.realtime_usec  = rec.realtime_usec,
+			.monotonic_nsec = rec.monotonic_nsec,
+		};
+
+		if (gl.imm.debug_stderr)
+			g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (gl.imm.prefix, m.realtime_usec, msg));
+		_log_emit (&gl.imm, &m);
+	}
+
+	if (n_lost > 0)
+		_flight_recorder_log_info ("flight-recorder: %u records were overwritten while dumping", n_lost);
+}
+
+/*****************************************************************************/
+
+/* a sentinel that tells the writer thread to quit. */
+static LogMsg _async_writer_quit;
+
+static gpointer
+_async_writer_thread (gpointer user_data)
+{
+	GAsyncQueue *queue = user_data;
+	LogMsg *m;
+
+	/* while the writer thread runs, nm_logging_init() is refused. Hence, the fields
+	 * of the global state that are used by _log_emit() don't change, and we can
+	 * access them without lock. */
+	while ((m = g_async_queue_pop (queue)) != &_async_writer_quit) {
+		int n_dropped;
+
+		n_dropped = g_atomic_int_get (&gl_async.n_dropped);
+		if (n_dropped > 0) {
+			gs_free char *msg = NULL;
+			LogMsg m_dropped;
+
+			g_atomic_int_add (&gl_async.n_dropped, -n_dropped);
+
+			msg = g_strdup_printf ("logging: dropped %d messages because the writer thread could not keep up",
+			                       n_dropped);
+			m_dropped = (LogMsg) {
+				.file           = __FILE__,
+				.func           = G_STRFUNC,
+				.line           = __LINE__,
+				.level          = LOGL_WARN,
+				.domain         = LOGD_CORE,
+				.msg            = msg,
+				.realtime_usec  = m->realtime_usec,
+				.monotonic_nsec = m->monotonic_nsec,
+			};
+			_log_emit (&gl.imm, &m_dropped);
+		}
+
+		_log_emit (&gl.imm, m);
+		g_free (m);
+	}
+
+	return NULL;
+}
+
+static void
+_async_writer_push (const LogMsg *m)
+{
+	gsize l_msg;
+	gsize l_ifname;
+	gsize l_conn_uuid;
+	LogMsg *m2;
+	char *p;
+
+	if (g_async_queue_length (gl_async.queue) >= ASYNC_WRITER_MAX_QUEUED) {
+		g_atomic_int_inc (&gl_async.n_dropped);
+		return;
+	}
+
+	l_msg = strlen (m->msg) + 1;
+	l_ifname = m->ifname ? strlen (m->ifname) + 1 : 0;
+	l_conn_uuid = m->conn_uuid ? strlen (m->conn_uuid) + 1 : 0;
+
+	/* the message and the strings are allocated in one chunk. @file and
+	 * @func are string literals and don't need to be cloned. */
+	m2 = g_malloc (sizeof (LogMsg) + l_msg + l_ifname + l_conn_uuid);
+	*m2 = *m;
+	p = (char *) &m2[1];
+	m2->msg = memcpy (p, m->msg, l_msg);
+	p += l_msg;
+	if (m->ifname) {
+		m2->ifname = memcpy (p, m->ifname, l_ifname);
+		p += l_ifname;
+	}
+	if (m->conn_uuid)
+		m2->conn_uuid = memcpy (p, m->conn_uuid, l_conn_uuid);
+
+	g_async_queue_push (gl_async.queue, m2);
+}
+
+/*****************************************************************************/
+
 void
 _nm_log_impl (const char *file,
               guint line,
@@ -694,12 +1152,12 @@ _nm_log_impl (const char *file,
 {
 	va_list args;
 	char *msg;
-	GTimeVal tv;
 	int errsv;
-	const NMLogDomain *cur_log_state;
-	NMLogDomain cur_log_state_copy[_LOGL_N_REAL];
+	gboolean do_output;
+	gboolean do_record;
 	Global g_copy;
 	const Global *g;
+	LogMsg m;
 
 	if (G_UNLIKELY (mt_require_locking)) {
 		G_LOCK (log);
@@ -711,19 +1169,18 @@ _nm_log_impl (const char *file,
 			return;
 		}
 		g_copy = gl.imm;
-		memcpy (cur_log_state_copy, _nm_logging_enabled_state, sizeof (cur_log_state_copy));
+		do_output = NM_FLAGS_ANY (_nm_logging_output_state[level], domain);
 		G_UNLOCK (log);
 		g = &g_copy;
-		cur_log_state = cur_log_state_copy;
 	} else {
 		NM_ASSERT_ON_MAIN_THREAD ();
 		if (!_nm_logging_enabled_lockfree (level, domain))
 			return;
 		g = &gl.imm;
-		cur_log_state = _nm_logging_enabled_state;
+		do_output = NM_FLAGS_ANY (_nm_logging_output_state[level], domain);
 	}
 
-	(void) cur_log_state;
+	do_record = NM_FLAGS_ANY (_flight_recorder_domains (g->flight_recorder_level, level), domain);
 
 	errsv = errno;
 
@@ -734,94 +1191,52 @@ _nm_log_impl (const char *file,
 		errno = error;
 	}
 
+	m = (LogMsg) {
+		.file           = file,
+		.func           = func,
+		.line           = line,
+		.level          = level,
+		.domain         = domain,
+		.error          = error,
+		.ifname         = ifname,
+		.conn_uuid      = conn_uuid,
+		.realtime_usec  = g_get_real_time (),
+		.monotonic_nsec =   (do_record || g->async_writer)
+		                  ? nm_utils_get_monotonic_timestamp_ns ()
+		                  : 0,
+	};
+
+	if (!do_output) {
+		/* the message is only enabled for the flight recorder. Format it
+		 * right into the ring buffer, without allocating. */
+		nm_assert (do_record);
+		va_start (args, fmt);
+		_flight_recorder_add_v (&m, fmt, args);
+		va_end (args);
+		errno = errsv;
+		return;
+	}
+
 	va_start (args, fmt);
 	msg = g_strdup_vprintf (fmt, args);
 	va_end (args);
 
-#define MESSAGE_FMT "%s%-7s [%ld.%04ld] %s"
-#define MESSAGE_ARG(prefix, tv, msg) \
-    prefix, \
-    level_desc[level].level_str, \
-    (tv).tv_sec, \
-    ((tv).tv_usec / 100), \
-    (msg)
+	m.msg = msg;
 
-	g_get_current_time (&tv);
+	if (do_record)
+		_flight_recorder_add (&m);
 
 	if (g->debug_stderr)
-		g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (g->prefix, tv, msg));
-
-	switch (g->log_backend) {
-#if SYSTEMD_JOURNAL
-	case LOG_BACKEND_JOURNAL:
-		{
-			gint64 now, boottime;
-			struct iovec iov_data[15];
-			struct iovec *iov = iov_data;
-			char *iov_free_data[5];
-			char **iov_free = iov_free_data;
-
-			now = nm_utils_get_monotonic_timestamp_ns ();
-			boottime = nm_utils_monotonic_timestamp_as_boottime (now, 1);
-
-			_iovec_set_format_a (iov++, 30, "PRIORITY=%d", level_desc[level].syslog_level);
-			_iovec_set_format (iov++, iov_free++, "MESSAGE="MESSAGE_FMT, MESSAGE_ARG (g->prefix, tv, msg));
-			_iovec_set_string (iov++, syslog_identifier_full (g->syslog_identifier));
-			_iovec_set_format_a (iov++, 30, "SYSLOG_PID=%ld", (long) getpid ());
-			{
-				const LogDesc *diter;
-				NMLogDomain dom_all = domain;
-				char s_log_domains_buf[NM_STRLEN ("NM_LOG_DOMAINS=") + sizeof (_all_logging_domains_to_str)];
-				char *s_log_domains = s_log_domains_buf;
-				gsize l_log_domains = sizeof (s_log_domains_buf);
-
-				nm_utils_strbuf_append_str (&s_log_domains, &l_log_domains, "NM_LOG_DOMAINS=");
-				for (diter = &domain_desc[0]; dom_all != 0 && diter->name; diter++) {
-					if (!NM_FLAGS_ANY (dom_all, diter->num))
-						continue;
-					if (dom_all != domain)
-						nm_utils_strbuf_append_c (&s_log_domains, &l_log_domains, ',');
-					nm_utils_strbuf_append_str (&s_log_domains, &l_log_domains, diter->name);
-					dom_all &= ~diter->num;
-				}
-				nm_assert (l_log_domains > 0);
-				_iovec_set (iov++, s_log_domains_buf, s_log_domains - s_log_domains_buf);
-			}
-			G_STATIC_ASSERT_EXPR (LOG_FAC (LOG_DAEMON) == 3);
-			_iovec_set_string_literal (iov++, "SYSLOG_FACILITY=3");
-			_iovec_set_format_str_a (iov++, 15, "NM_LOG_LEVEL=%s", level_desc[level].name);
-			if (func)
-				_iovec_set_format (iov++, iov_free++, "CODE_FUNC=%s", func);
-			_iovec_set_format (iov++, iov_free++, "CODE_FILE=%s", file ?: "");
-			_iovec_set_format_a (iov++, 20, "CODE_LINE=%u", line);
-			_iovec_set_format_a (iov++, 60, "TIMESTAMP_MONOTONIC=%lld.%06lld", (long long) (now / NM_UTILS_NS_PER_SECOND), (long long) ((now % NM_UTILS_NS_PER_SECOND) / 1000));
-			_iovec_set_format_a (iov++, 60, "TIMESTAMP_BOOTTIME=%lld.%06lld", (long long) (boottime / NM_UTILS_NS_PER_SECOND), (long long) ((boottime % NM_UTILS_NS_PER_SECOND) / 1000));
-			if (error != 0)
-				_iovec_set_format_a (iov++, 30, "ERRNO=%d", error);
-			if (ifname)
-				_iovec_set_format (iov++, iov_free++, "NM_DEVICE=%s", ifname);
-			if (conn_uuid)
-				_iovec_set_format (iov++, iov_free++, "NM_CONNECTION=%s", conn_uuid);
-
-			nm_assert (iov <= &iov_data[G_N_ELEMENTS (iov_data)]);
-			nm_assert (iov_free <= &iov_free_data[G_N_ELEMENTS (iov_free_data)]);
-
-			sd_journal_sendv (iov_data, iov - iov_data);
-
-			for (; --iov_free >= iov_free_data; )
-				g_free (*iov_free);
-		}
-		break;
-#endif
-	case LOG_BACKEND_SYSLOG:
-		syslog (level_desc[level].syslog_level,
-		        MESSAGE_FMT, MESSAGE_ARG (g->prefix, tv, msg));
-		break;
-	default:
-		g_log (syslog_identifier_domain (g->syslog_identifier), level_desc[level].g_log_level,
-		       MESSAGE_FMT, MESSAGE_ARG (g->prefix, tv, msg));
-		break;
-	}
+		g_printerr (MESSAGE_FMT"\n", MESSAGE_ARG (g->prefix, m.realtime_usec, msg));
+
+	if (   g->async_writer
+	    && level < LOGL_INFO) {
+		/* only the verbose levels are handed over to the writer thread. They are
+		 * the bulk of the messages, while the important ones are still written
+		 * right away and are not lost if we crash. */
+		_async_writer_push (&m);
+	} else
+		_log_emit (g, &m);
 
 	g_free (msg);
 
@@ -977,7 +1392,8 @@ nm_logging_init (const char *logging_backend, gboolean debug)
 	                         NM_LOG_CONFIG_BACKEND_JOURNAL,
 	                         NM_LOG_CONFIG_BACKEND_SYSLOG));
 
-	if (gl.imm.init_done)
+	if (   gl.imm.init_done
+	    || gl_async.thread)
 		g_return_if_reached ();
 
 	if (!logging_backend)
@@ -1050,3 +1466,113 @@ nm_logging_init (const char *logging_backend, gboolean debug)
 		             );
 	}
 }
+
+/**
+ * nm_logging_init_flight_recorder:
+ * @n_records: the number of records to keep. It gets rounded up to
+ *   a power of two. 0 disables the flight recorder.
+ * @level: (allow-none): the minimal level to record. Defaults to "TRACE".
+ *
+ * Enables the flight recorder, which keeps the most recent logging messages
+ * in memory, including those that are more verbose than the configured
+ * logging level. They can be written out with nm_logging_flight_recorder_dump().
+ *
+ * This function may be called only once.
+ */
+void
+nm_logging_init_flight_recorder (guint n_records, const char *level)
+{
+	gs_free_error GError *error = NULL;
+	NMLogLevel fr_level = LOGL_TRACE;
+	guint n;
+
+	NM_ASSERT_ON_MAIN_THREAD ();
+
+	if (gl_fr.records)
+		g_return_if_reached ();
+
+	if (n_records == 0)
+		return;
+
+	if (   level
+	    && !match_log_level (level, &fr_level, &error)) {
+		nm_log_warn (LOGD_CORE, "config: invalid flight-recorder level: %s", error->message);
+		fr_level = LOGL_TRACE;
+	}
+	if (fr_level >= _LOGL_OFF)
+		return;
+
+	n_records = MIN (n_records, FLIGHT_RECORDER_MAX_RECORDS);
+	n = 1;
+	while (n < n_records)
+		n <<= 1;
+
+	gl_fr.records = g_new0 (FlightRecord, n);
+	gl_fr.mask = n - 1;
+
+	/* recording messages requires the monotonic timestamp. Reading it the first
+	 * time causes a logging message, which we don't want during _nm_log_impl(). */
+	nm_utils_get_monotonic_timestamp_ns ();
+
+	G_LOCK (log);
+	gl.mut.flight_recorder_level = fr_level;
+	_logging_enabled_state_update_locked ();
+	G_UNLOCK (log);
+
+	nm_log_dbg (LOGD_CORE, "flight-recorder: keep the last %u records of level %s and above",
+	            n, level_desc[fr_level].name);
+}
+
+/**
+ * nm_logging_init_async_writer:
+ *
+ * Starts a writer thread. Afterwards, messages less important than
+ * %LOGL_INFO are no longer written to the logging backend on the calling
+ * thread, but handed over to the writer thread. Call nm_logging_shutdown()
+ * to flush them before exiting.
+ *
+ * The writer thread accesses the logging backend without lock, so
+ * nm_logging_init() must not be called while it runs.
+ */
+void
+nm_logging_init_async_writer (void)
+{
+	NM_ASSERT_ON_MAIN_THREAD ();
+
+	if (gl_async.thread)
+		g_return_if_reached ();
+
+	/* the writer thread needs the monotonic timestamp too. */
+	nm_utils_get_monotonic_timestamp_ns ();
+
+	gl_async.queue = g_async_queue_new ();
+	gl_async.thread = g_thread_new ("nm-log-writer", _async_writer_thread, gl_async.queue);
+
+	G_LOCK (log);
+	gl.mut.async_writer = TRUE;
+	G_UNLOCK (log);
+}
+
+/**
+ * nm_logging_shutdown:
+ *
+ * Stops the writer thread (if any), after it wrote all pending
+ * messages. Afterwards, all messages are written synchronously.
+ */
+void
+nm_logging_shutdown (void)
+{
+	NM_ASSERT_ON_MAIN_THREAD ();
+
+	if (!gl_async.thread)
+		return;
+
+	G_LOCK (log);
+	gl.mut.async_writer = FALSE;
+	G_UNLOCK (log);
+
+	/* the queue is not freed, in case another thread still pushes a message
+	 * that it evaluated before we disabled the writer. */
+	g_async_queue_push (gl_async.queue, &_async_writer_quit);
+	g_thread_join (g_steal_pointer (&gl_async.thread));
+}
@@ -156,6 +156,21 @@ nm_logging_enabled_mt (gboolean mt_require_locking, NMLogLevel level, NMLogDomai
 #define nm_logging_enabled(level, domain) \
 	nm_logging_enabled_mt (!(NM_THREAD_SAFE_ON_MAIN_THREAD), level, domain)
 
+extern NMLogDomain _nm_logging_output_state[_LOGL_N_REAL];
+
+/* Whether messages for @level and @domain get written to the logging backend.
+ * Unlike nm_logging_enabled(), this ignores the levels that are only enabled
+ * for the flight recorder. Use it to decide whether to make helper programs
+ * verbose, because their output only ends up in the logging backend. */
+static inline gboolean
+nm_logging_output_enabled (NMLogLevel level, NMLogDomain domain)
+{
+	NM_ASSERT_ON_MAIN_THREAD ();
+	nm_assert (((guint) level) < G_N_ELEMENTS (_nm_logging_output_state));
+	return    (((guint) level) < G_N_ELEMENTS (_nm_logging_output_state))
+	       && !!(_nm_logging_output_state[level] & domain);
+}
+
 /*****************************************************************************/
 
 NMLogLevel nm_logging_get_level (NMLogDomain domain);
@@ -172,6 +187,11 @@ void nm_logging_init_pre (const char *syslog_identifier,
                           char *prefix_take);
 
 void     nm_logging_init (const char *logging_backend, gboolean debug);
+void     nm_logging_init_flight_recorder (guint n_records, const char *level);
+void     nm_logging_init_async_writer (void);
+void     nm_logging_shutdown (void);
+
+void     nm_logging_flight_recorder_dump (guint n_records);
 
 gboolean nm_logging_syslog_enabled (void);
 
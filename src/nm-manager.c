@@ -1109,9 +1109,48 @@ active_connection_get_by_path (NMManager *self, const char *path)
 
 /*****************************************************************************/
 
+static void
+_statistics_log (NMManager *self)
+{
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	NMPCacheStats stats;
+	NMPObjectType obj_type;
+	gsize n_bytes = 0;
+	guint n_connections;
+
+	nm_platform_get_cache_stats (priv->platform, &stats);
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		if (stats.obj_types[obj_type - 1].n_objs == 0)
+			continue;
+		_LOGI (LOGD_CORE, "statistics: platform cache: %s: %u objects, %"G_GSIZE_FORMAT" bytes",
+		       nmp_class_from_type (obj_type)->obj_type_name,
+		       stats.obj_types[obj_type - 1].n_objs,
+		       stats.obj_types[obj_type - 1].n_bytes);
+		n_bytes += stats.obj_types[obj_type - 1].n_bytes;
+	}
+	_LOGI (LOGD_CORE, "statistics: platform cache: %"G_GSIZE_FORMAT" bytes in total, %u route destinations indexed",
+	       n_bytes,
+	       stats.n_route_dst_buckets);
+	_LOGI (LOGD_CORE, "statistics: dedup index: %u entries, %u objects, %"G_GUINT64_FORMAT" hits, %"G_GUINT64_FORMAT" misses",
+	       stats.multi_idx.n_entries,
+	       stats.multi_idx.n_objs,
+	       stats.multi_idx.n_intern_hits,
+	       stats.multi_idx.n_intern_misses);
+
+	nm_settings_get_connections (priv->settings, &n_connections);
+	_LOGI (LOGD_CORE, "statistics: %u settings connections, %u devices, %u active connections",
+	       n_connections,
+	       c_list_length (&priv->devices_lst_head),
+	       c_list_length (&priv->active_connections_lst_head));
+}
+
 static void
 _config_changed_cb (NMConfig *config, NMConfigData *config_data, NMConfigChangeFlags changes, NMConfigData *old_data, NMManager *self)
 {
+	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_CAUSE_SIGUSR1))
+		_statistics_log (self);
+
 	g_object_freeze_notify (G_OBJECT (self));
 
 	if (NM_FLAGS_HAS (changes, NM_CONFIG_CHANGE_GLOBAL_DNS_CONFIG))
@@ -6330,6 +6369,72 @@ impl_manager_get_logging (NMDBusObject *obj,
 	                                                      nm_logging_domains_to_string ()));
 }
 
+static void
+impl_manager_get_statistics (NMDBusObject *obj,
+                             const NMDBusInterfaceInfoExtended *interface_info,
+                             const NMDBusMethodInfoExtended *method_info,
+                             GDBusConnection *connection,
+                             const char *sender,
+                             GDBusMethodInvocation *invocation,
+                             GVariant *parameters)
+{
+	NMManager *self = NM_MANAGER (obj);
+	NMManagerPrivate *priv = NM_MANAGER_GET_PRIVATE (self);
+	GVariantBuilder builder;
+	NMPCacheStats stats;
+	NMPObjectType obj_type;
+	guint n_connections;
+
+	nm_platform_get_cache_stats (priv->platform, &stats);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+	for (obj_type = 1; obj_type <= NMP_OBJECT_TYPE_MAX; obj_type++) {
+		const char *name;
+		char key[100];
+
+		if (stats.obj_types[obj_type - 1].n_objs == 0)
+			continue;
+
+		name = nmp_class_from_type (obj_type)->obj_type_name;
+		g_variant_builder_add (&builder, "{sv}",
+		                       nm_sprintf_buf (key, "platform.%s.objects", name),
+		                       g_variant_new_uint32 (stats.obj_types[obj_type - 1].n_objs));
+		g_variant_builder_add (&builder, "{sv}",
+		                       nm_sprintf_buf (key, "platform.%s.bytes", name),
+		                       g_variant_new_uint64 (stats.obj_types[obj_type - 1].n_bytes));
+	}
+	g_variant_builder_add (&builder, "{sv}",
+	                       "platform.route-destinations",
+	                       g_variant_new_uint32 (stats.n_route_dst_buckets));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "dedup.entries",
+	                       g_variant_new_uint32 (stats.multi_idx.n_entries));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "dedup.objects",
+	                       g_variant_new_uint32 (stats.multi_idx.n_objs));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "dedup.hits",
+	                       g_variant_new_uint64 (stats.multi_idx.n_intern_hits));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "dedup.misses",
+	                       g_variant_new_uint64 (stats.multi_idx.n_intern_misses));
+
+	nm_settings_get_connections (priv->settings, &n_connections);
+	g_variant_builder_add (&builder, "{sv}",
+	                       "settings.connections",
+	                       g_variant_new_uint32 (n_connections));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "devices",
+	                       g_variant_new_uint32 (c_list_length (&priv->devices_lst_head)));
+	g_variant_builder_add (&builder, "{sv}",
+	                       "active-connections",
+	                       g_variant_new_uint32 (c_list_length (&priv->active_connections_lst_head)));
+
+	g_dbus_method_invocation_return_value (invocation,
+	                                       g_variant_new ("(a{sv})", &builder));
+}
+
 typedef struct {
 	NMManager *self;
 	GDBusMethodInvocation *context;
@@ -7967,6 +8072,15 @@ static const NMDBusInterfaceInfoExtended interface_info_manager = {
 				),
 				.handle = impl_manager_get_logging,
 			),
+			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
+				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
+					"GetStatistics",
+					.out_args = NM_DEFINE_GDBUS_ARG_INFOS (
+						NM_DEFINE_GDBUS_ARG_INFO ("statistics", "a{sv}"),
+					),
+				),
+				.handle = impl_manager_get_statistics,
+			),
 			NM_DEFINE_DBUS_METHOD_INFO_EXTENDED (
 				NM_DEFINE_GDBUS_METHOD_INFO_INIT (
 					"CheckConnectivity",
@@ -79,6 +79,8 @@ typedef struct {
 
 	guint schedule_activate_all_id; /* idle handler for schedule_activate_all(). */
 
+	guint update_routing_and_dns_id; /* idle handler for a deferred update_routing_and_dns(). */
+
 	NMPolicyHostnameMode hostname_mode;
 	char *orig_hostname; /* hostname at NM start time */
 	char *cur_hostname;  /* hostname we want to assign */
@@ -1119,6 +1121,10 @@ static void
 update_routing_and_dns (NMPolicy *self, gboolean force_update)
 {
 	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+	gboolean was_scheduled;
+
+	/* we do it right now, the deferred update is no longer needed. */
+	was_scheduled = nm_clear_g_source (&priv->update_routing_and_dns_id);
 
 	nm_dns_manager_begin_updates (priv->dns_manager, __func__);
 
@@ -1132,6 +1138,61 @@ update_routing_and_dns (NMPolicy *self, gboolean force_update)
 	update_system_hostname (self, "routing and dns");
 
 	nm_dns_manager_end_updates (priv->dns_manager, __func__);
+	if (was_scheduled)
+		nm_dns_manager_end_updates (priv->dns_manager, "update_routing_and_dns_schedule");
+}
+
+static gboolean
+update_routing_and_dns_cb (gpointer user_data)
+{
+	NMPolicy *self = user_data;
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	priv->update_routing_and_dns_id = 0;
+
+	update_routing_and_dns (self, FALSE);
+	nm_dns_manager_end_updates (priv->dns_manager, "update_routing_and_dns_schedule");
+	return G_SOURCE_REMOVE;
+}
+
+/*
+ * update_routing_and_dns_schedule:
+ *
+ * Device state changes come in bursts when many devices activate at
+ * once. Instead of recomputing the best device, the routing, DNS and
+ * the hostname after each of them, do it once for the whole burst.
+ *
+ * The idle handler has a lower priority than the activation stages of
+ * the devices, so it runs once all pending stages were handled. Until
+ * then, DNS updates are queued so that resolv.conf is written only once.
+ *
+ * The "up" dispatcher scripts expect routing and DNS to be already
+ * configured, so before such an event is sent, the pending update
+ * runs right away (see _dispatcher_pre_up_cb()).
+ */
+static void
+update_routing_and_dns_schedule (NMPolicy *self)
+{
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	if (priv->update_routing_and_dns_id)
+		return;
+
+	nm_dns_manager_begin_updates (priv->dns_manager, __func__);
+	priv->update_routing_and_dns_id = g_idle_add_full (G_PRIORITY_LOW,
+	                                                   update_routing_and_dns_cb,
+	                                                   self,
+	                                                   NULL);
+}
+
+static void
+_dispatcher_pre_up_cb (gpointer user_data)
+{
+	NMPolicy *self = user_data;
+	NMPolicyPrivate *priv = NM_POLICY_GET_PRIVATE (self);
+
+	if (priv->update_routing_and_dns_id)
+		update_routing_and_dns (self, FALSE);
 }
 
 static void
@@ -1857,14 +1918,14 @@ device_state_changed (NMDevice *device,
 		if (ip6_config)
 			_dns_manager_set_ip_config (priv->dns_manager, NM_IP_CONFIG_CAST (ip6_config), NM_DNS_IP_CONFIG_TYPE_DEFAULT, device);
 
-		update_routing_and_dns (self, FALSE);
+		update_routing_and_dns_schedule (self);
 
 		nm_dns_manager_end_updates (priv->dns_manager, __func__);
 		break;
 	case NM_DEVICE_STATE_UNMANAGED:
 	case NM_DEVICE_STATE_UNAVAILABLE:
 		if (old_state > NM_DEVICE_STATE_DISCONNECTED)
-			update_routing_and_dns (self, FALSE);
+			update_routing_and_dns_schedule (self);
 		break;
 	case NM_DEVICE_STATE_DEACTIVATING:
 		if (sett_conn) {
@@ -1899,7 +1960,7 @@ device_state_changed (NMDevice *device,
 			reset_autoconnect_all (self, device, FALSE);
 
 		if (old_state > NM_DEVICE_STATE_DISCONNECTED)
-			update_routing_and_dns (self, FALSE);
+			update_routing_and_dns_schedule (self);
 
 		/* Device is now available for auto-activation */
 		schedule_activate_check (self, device);
@@ -2636,6 +2697,8 @@ constructed (GObject *object)
 
 	g_signal_connect (priv->agent_mgr, NM_AGENT_MANAGER_AGENT_REGISTERED, G_CALLBACK (secret_agent_registered), self);
 
+	nm_dispatcher_set_pre_up_func (_dispatcher_pre_up_cb, self);
+
 	G_OBJECT_CLASS (nm_policy_parent_class)->constructed (object);
 
 	_LOGD (LOGD_DNS, "hostname-mode: %s", _hostname_mode_to_string (priv->hostname_mode));
@@ -2662,6 +2725,11 @@ dispose (GObject *object)
 	NMDevice *device;
 	ActivateData *data, *data_safe;
 
+	nm_dispatcher_set_pre_up_func (NULL, NULL);
+
+	if (nm_clear_g_source (&priv->update_routing_and_dns_id))
+		nm_dns_manager_end_updates (priv->dns_manager, "update_routing_and_dns_schedule");
+
 	nm_clear_g_cancellable (&priv->lookup.cancellable);
 	g_clear_object (&priv->lookup.addr);
 	g_clear_object (&priv->lookup.resolver);
@@ -1168,16 +1168,97 @@ ipx_route_delete (NMPlatform *platform,
 	return TRUE;
 }
 
+static gboolean
+nexthop_delete (NMPlatform *platform, const NMPObject *obj)
+{
+	gs_unref_ptrarray GPtrArray *objs = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	NMPCache *cache = nm_platform_get_cache (platform);
+	guint32 nhid = NMP_OBJECT_CAST_NEXTHOP (obj)->id;
+	NMDedupMultiIter iter;
+	const NMPObject *o = NULL;
+	const NMPObject *obj_old = NULL;
+	guint i;
+
+	if (nmp_cache_remove (cache, obj, FALSE, FALSE, &obj_old) != NMP_CACHE_OPS_REMOVED)
+		return FALSE;
+	g_ptr_array_add (objs, (gpointer) obj_old);
+
+	/* like kernel, also delete the routes that reference the nexthop. */
+	for (i = 0; i < 2; i++) {
+		nmp_cache_iter_for_each (&iter,
+		                         nm_platform_lookup_obj_type (platform,
+		                                                      i == 0
+		                                                        ? NMP_OBJECT_TYPE_IP4_ROUTE
+		                                                        : NMP_OBJECT_TYPE_IP6_ROUTE),
+		                         &o) {
+			if (NMP_OBJECT_CAST_IP_ROUTE (o)->nhid == nhid)
+				g_ptr_array_add (objs, (gpointer) nmp_object_ref (o));
+		}
+	}
+
+	for (i = 1; i < objs->len; i++) {
+		if (nmp_cache_remove (cache,
+		                      objs->pdata[i],
+		                      TRUE,
+		                      FALSE,
+		                      NULL) != NMP_CACHE_OPS_REMOVED)
+			g_assert_not_reached ();
+	}
+
+	for (i = 0; i < objs->len; i++) {
+		nm_platform_cache_update_emit_signal (platform,
+		                                      NMP_CACHE_OPS_REMOVED,
+		                                      objs->pdata[i],
+		                                      NULL);
+	}
+	return TRUE;
+}
+
 static gboolean
 object_delete (NMPlatform *platform, const NMPObject *obj)
 {
 	g_assert (NM_IS_FAKE_PLATFORM (platform));
 	g_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE,
-	                                                NMP_OBJECT_TYPE_IP6_ROUTE));
+	                                                NMP_OBJECT_TYPE_IP6_ROUTE,
+	                                                NMP_OBJECT_TYPE_NEXTHOP));
+
+	if (NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_NEXTHOP)
+		return nexthop_delete (platform, obj);
 
 	return ipx_route_delete (platform, AF_UNSPEC, -1, obj);
 }
 
+static int
+nexthop_add (NMPlatform *platform,
+             NMPNlmFlags flags,
+             const NMPlatformNexthop *nexthop)
+{
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	nm_auto_nmpobj const NMPObject *obj_old = NULL;
+	nm_auto_nmpobj const NMPObject *obj_new = NULL;
+	NMPCacheOpsType cache_op;
+	NMPCache *cache = nm_platform_get_cache (platform);
+
+	if (   !nexthop->blackhole
+	    && !nm_platform_link_get (platform, nexthop->ifindex)) {
+		nm_log_warn (LOGD_PLATFORM, "Fake platform: failure adding nexthop %u: link %d does not exist",
+		             nexthop->id, nexthop->ifindex);
+		return -NME_PL_NOT_FOUND;
+	}
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (const NMPlatformObject *) nexthop);
+	if (!obj->nexthop.protocol)
+		obj->nexthop.protocol = RTPROT_STATIC;
+
+	if (   nmp_cache_lookup_obj (cache, obj)
+	    && !NM_FLAGS_HAS (flags, NMP_NLM_FLAG_F_REPLACE))
+		return -NME_PL_EXISTS;
+
+	cache_op = nmp_cache_update_netlink (cache, obj, FALSE, &obj_old, &obj_new);
+	nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, obj_new);
+	return 0;
+}
+
 static int
 ip_route_add (NMPlatform *platform,
               NMPNlmFlags flags,
@@ -1229,6 +1310,19 @@ ip_route_add (NMPlatform *platform,
 		nm_assert_not_reached ();
 	}
 
+	if (r->nhid) {
+		NMPObject needle;
+
+		nmp_object_stackinit (&needle,
+		                      NMP_OBJECT_TYPE_NEXTHOP,
+		                      &((const NMPlatformNexthop) { .id = r->nhid, }));
+		if (!nmp_cache_lookup_obj (cache, &needle)) {
+			nm_log_warn (LOGD_PLATFORM, "Fake platform: failure adding route via nexthop %u: nexthop does not exist",
+			             r->nhid);
+			return -NME_UNSPEC;
+		}
+	}
+
 	if (has_gateway) {
 		gboolean has_route_to_gw = FALSE;
 
@@ -1446,4 +1540,5 @@ nm_fake_platform_class_init (NMFakePlatformClass *klass)
 
 	platform_class->ip_route_add = ip_route_add;
 	platform_class->object_delete = object_delete;
+	platform_class->nexthop_add = nexthop_add;
 }
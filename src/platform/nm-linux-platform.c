@@ -139,8 +139,9 @@ enum {
 
 G_STATIC_ASSERT (RTA_MAX == (__RTA_MAX - 1));
 #define RTA_PREF                        20
+#define RTA_NH_ID                       30
 #undef  RTA_MAX
-#define RTA_MAX                        (MAX ((__RTA_MAX - 1), RTA_PREF))
+#define RTA_MAX                        (MAX ((__RTA_MAX - 1), RTA_NH_ID))
 
 #ifndef MACVLAN_FLAG_NOPROMISC
 #define MACVLAN_FLAG_NOPROMISC          1
@@ -172,6 +173,34 @@ G_STATIC_ASSERT (RTA_MAX == (__RTA_MAX - 1));
 
 /*****************************************************************************/
 
+/* Nexthop objects appeared in kernel 5.3 dated September 15, 2019 */
+
+#ifndef RTNLGRP_NEXTHOP
+#define RTNLGRP_NEXTHOP                 32
+#endif
+
+#define NHA_UNSPEC                      0
+#define NHA_ID                          1
+#define NHA_GROUP                       2
+#define NHA_GROUP_TYPE                  3
+#define NHA_BLACKHOLE                   4
+#define NHA_OIF                         5
+#define NHA_GATEWAY                     6
+#define NHA_ENCAP_TYPE                  7
+#define NHA_ENCAP                       8
+#define NHA_GROUPS                      9
+#define NHA_MASTER                      10
+
+struct _nhmsg {
+	guint8 nh_family;
+	guint8 nh_scope;
+	guint8 nh_protocol;
+	guint8 resvd;
+	guint32 nh_flags;
+};
+
+/*****************************************************************************/
+
 #define IFLA_MACSEC_UNSPEC              0
 #define IFLA_MACSEC_SCI                 1
 #define IFLA_MACSEC_PORT                2
@@ -198,6 +227,7 @@ G_STATIC_ASSERT (RTA_MAX == (__RTA_MAX - 1));
 
 #define WGPEER_F_REMOVE_ME                     ((guint32) (1U << 0))
 #define WGPEER_F_REPLACE_ALLOWEDIPS            ((guint32) (1U << 1))
+#define WGPEER_F_UPDATE_ONLY                   ((guint32) (1U << 2))
 
 
 #define WGDEVICE_A_UNSPEC                      0
@@ -277,6 +307,29 @@ struct _ifla_vf_vlan_info {
 #define BRIDGE_VLAN_INFO_RANGE_END      (1 << 4) /* VLAN is end of vlan range */
 #endif
 
+/* Appeared in in kernel 3.19 dated February 8, 2015 */
+#ifndef RTEXT_FILTER_BRVLAN_COMPRESSED
+#define RTEXT_FILTER_BRVLAN_COMPRESSED  (1 << 2)
+#endif
+
+/* The bridge VLAN database messages appeared in kernel 5.8 dated August 2, 2020 */
+#ifndef RTM_NEWVLAN
+#define RTM_NEWVLAN                     112
+#define RTM_GETVLAN                     114
+#endif
+
+#define BRIDGE_VLANDB_ENTRY             1
+
+#define BRIDGE_VLANDB_ENTRY_INFO        1
+#define BRIDGE_VLANDB_ENTRY_RANGE       2
+
+struct _br_vlan_msg {
+	guint8 family;
+	guint8 reserved1;
+	guint16 reserved2;
+	guint32 ifindex;
+};
+
 /*****************************************************************************/
 
 typedef enum {
@@ -311,6 +364,7 @@ typedef enum {
 	REFRESH_ALL_TYPE_ROUTING_RULES_IP6 = 6,
 	REFRESH_ALL_TYPE_QDISCS            = 7,
 	REFRESH_ALL_TYPE_TFILTERS          = 8,
+	REFRESH_ALL_TYPE_NEXTHOPS          = 9,
 
 	_REFRESH_ALL_TYPE_NUM,
 } RefreshAllType;
@@ -335,12 +389,13 @@ typedef enum {
 	DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_IP6 = 1 << F (6, REFRESH_ALL_TYPE_ROUTING_RULES_IP6),
 	DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS            = 1 << F (7, REFRESH_ALL_TYPE_QDISCS),
 	DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS          = 1 << F (8, REFRESH_ALL_TYPE_TFILTERS),
+	DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS          = 1 << F (9, REFRESH_ALL_TYPE_NEXTHOPS),
 #undef F
 
-	DELAYED_ACTION_TYPE_REFRESH_LINK                  = 1 <<  9,
-	DELAYED_ACTION_TYPE_MASTER_CONNECTED              = 1 << 10,
-	DELAYED_ACTION_TYPE_READ_NETLINK                  = 1 << 11,
-	DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE          = 1 << 12,
+	DELAYED_ACTION_TYPE_REFRESH_LINK                  = 1 << 10,
+	DELAYED_ACTION_TYPE_MASTER_CONNECTED              = 1 << 11,
+	DELAYED_ACTION_TYPE_READ_NETLINK                  = 1 << 12,
+	DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE          = 1 << 13,
 
 	__DELAYED_ACTION_TYPE_MAX,
 
@@ -354,7 +409,8 @@ typedef enum {
 	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
 	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
 	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS |
+	                                                    DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,
 
 	DELAYED_ACTION_TYPE_MAX                           = __DELAYED_ACTION_TYPE_MAX -1,
 } DelayedActionType;
@@ -396,8 +452,17 @@ typedef enum {
 	DELAYED_ACTION_RESPONSE_TYPE_VOID                       = 0,
 	DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS    = 1,
 	DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET                  = 2,
+	DELAYED_ACTION_RESPONSE_TYPE_BRIDGE_VLANS               = 3,
 } DelayedActionWaitForNlResponseType;
 
+typedef struct {
+	int ifindex;
+	GArray *vlans;
+	bool found:1;
+	bool invalid:1;
+	bool use_vlandb:1;
+} BridgeVlansGetData;
+
 typedef struct {
 	guint32 seq_number;
 	WaitForNlResponseResult seq_result;
@@ -408,10 +473,26 @@ typedef struct {
 	union {
 		int *out_refresh_all_in_progress;
 		NMPObject **out_route_get;
+		BridgeVlansGetData *out_bridge_vlans;
 		gpointer out_data;
 	} response;
 } DelayedActionWaitForNlResponseData;
 
+typedef struct {
+	CList change_link_async_lst;
+	NMPlatform *platform;
+	struct nl_msg *nlmsg;
+	GCancellable *cancellable;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+	char *errmsg;
+	guint timeout_id;
+	guint32 seq_number;
+	WaitForNlResponseResult seq_result;
+	ChangeLinkType change_link_type;
+	int ifindex;
+} ChangeLinkAsyncData;
+
 /*****************************************************************************/
 
 typedef struct {
@@ -426,6 +507,18 @@ typedef struct {
 	GIOChannel *event_channel;
 	guint event_id;
 
+	/* the buffer for receiving netlink messages on @nlh. It is reused
+	 * for all datagrams and grows together with the message buffer
+	 * size of the socket. */
+	struct {
+		unsigned char *buf;
+		gsize len;
+
+		/* processing a message might recurse into reading from the
+		 * socket. Only the outermost reader uses the buffer. */
+		bool in_use:1;
+	} netlink_recv_buf;
+
 	guint32 pruning[_REFRESH_ALL_TYPE_NUM];
 
 	GHashTable *sysctl_get_prev_values;
@@ -448,6 +541,19 @@ typedef struct {
 
 		int is_handling;
 	} delayed_action;
+
+	/* Pending asynchronous change-link requests. Contrary to
+	 * @list_wait_for_nl_response, nobody blocks waiting for them. The
+	 * response is picked up by the regular netlink event handler and the
+	 * callbacks get invoked from an idle handler. */
+	struct {
+		CList lst_head;
+		guint idle_id;
+	} change_link_async;
+
+	/* whether the kernel rejected a RTM_GETVLAN request. Then we fall
+	 * back to dumping the VLANs of all bridge ports. */
+	bool bridge_vlandb_unsupported:1;
 } NMLinuxPlatformPrivate;
 
 struct _NMLinuxPlatform {
@@ -1157,6 +1263,176 @@ _parse_af_inet6 (NMPlatform *platform,
 
 /*****************************************************************************/
 
+static NMPObject *
+_parse_lnk_bond (const char *kind, struct nlattr *info_data)
+{
+	static const struct nla_policy policy[] = {
+		[IFLA_BOND_MODE]              = { .type = NLA_U8 },
+		[IFLA_BOND_ACTIVE_SLAVE]      = { .type = NLA_U32 },
+		[IFLA_BOND_MIIMON]            = { .type = NLA_U32 },
+		[IFLA_BOND_UPDELAY]           = { .type = NLA_U32 },
+		[IFLA_BOND_DOWNDELAY]         = { .type = NLA_U32 },
+		[IFLA_BOND_USE_CARRIER]       = { .type = NLA_U8 },
+		[IFLA_BOND_ARP_INTERVAL]      = { .type = NLA_U32 },
+		[IFLA_BOND_ARP_IP_TARGET]     = { .type = NLA_NESTED },
+		[IFLA_BOND_ARP_VALIDATE]      = { .type = NLA_U32 },
+		[IFLA_BOND_ARP_ALL_TARGETS]   = { .type = NLA_U32 },
+		[IFLA_BOND_PRIMARY]           = { .type = NLA_U32 },
+		[IFLA_BOND_PRIMARY_RESELECT]  = { .type = NLA_U8 },
+		[IFLA_BOND_FAIL_OVER_MAC]     = { .type = NLA_U8 },
+		[IFLA_BOND_XMIT_HASH_POLICY]  = { .type = NLA_U8 },
+		[IFLA_BOND_RESEND_IGMP]       = { .type = NLA_U32 },
+		[IFLA_BOND_NUM_PEER_NOTIF]    = { .type = NLA_U8 },
+		[IFLA_BOND_ALL_SLAVES_ACTIVE] = { .type = NLA_U8 },
+		[IFLA_BOND_MIN_LINKS]         = { .type = NLA_U32 },
+		[IFLA_BOND_LP_INTERVAL]       = { .type = NLA_U32 },
+		[IFLA_BOND_PACKETS_PER_SLAVE] = { .type = NLA_U32 },
+		[IFLA_BOND_AD_LACP_RATE]      = { .type = NLA_U8 },
+		[IFLA_BOND_AD_SELECT]         = { .type = NLA_U8 },
+		[IFLA_BOND_AD_ACTOR_SYS_PRIO] = { .type = NLA_U16 },
+		[IFLA_BOND_AD_USER_PORT_KEY]  = { .type = NLA_U16 },
+		[IFLA_BOND_AD_ACTOR_SYSTEM]   = { .minlen = ETH_ALEN },
+		[IFLA_BOND_TLB_DYNAMIC_LB]    = { .type = NLA_U8 },
+	};
+	NMPlatformLnkBond *props;
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	NMPObject *obj;
+
+	if (   !info_data
+	    || !nm_streq0 (kind, "bond"))
+		return NULL;
+
+	if (nla_parse_nested_arr (tb, info_data, policy) < 0)
+		return NULL;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LNK_BOND, NULL);
+
+	props = &obj->lnk_bond;
+
+	if (tb[IFLA_BOND_MODE])
+		props->mode = nla_get_u8 (tb[IFLA_BOND_MODE]);
+	if (tb[IFLA_BOND_ACTIVE_SLAVE])
+		props->active_slave = nla_get_u32 (tb[IFLA_BOND_ACTIVE_SLAVE]);
+	if (tb[IFLA_BOND_MIIMON])
+		props->miimon = nla_get_u32 (tb[IFLA_BOND_MIIMON]);
+	if (tb[IFLA_BOND_UPDELAY])
+		props->updelay = nla_get_u32 (tb[IFLA_BOND_UPDELAY]);
+	if (tb[IFLA_BOND_DOWNDELAY])
+		props->downdelay = nla_get_u32 (tb[IFLA_BOND_DOWNDELAY]);
+	if (tb[IFLA_BOND_USE_CARRIER])
+		props->use_carrier = !!nla_get_u8 (tb[IFLA_BOND_USE_CARRIER]);
+	if (tb[IFLA_BOND_ARP_INTERVAL])
+		props->arp_interval = nla_get_u32 (tb[IFLA_BOND_ARP_INTERVAL]);
+	if (tb[IFLA_BOND_ARP_IP_TARGET]) {
+		struct nlattr *attr;
+		int rem;
+
+		nla_for_each_nested (attr, tb[IFLA_BOND_ARP_IP_TARGET], rem) {
+			if (props->arp_ip_targets_num >= NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS)
+				break;
+			if (nla_len (attr) < (int) sizeof (in_addr_t))
+				continue;
+			props->arp_ip_target[props->arp_ip_targets_num++] = nla_get_u32 (attr);
+		}
+	}
+	if (tb[IFLA_BOND_ARP_VALIDATE])
+		props->arp_validate = nla_get_u32 (tb[IFLA_BOND_ARP_VALIDATE]);
+	if (tb[IFLA_BOND_ARP_ALL_TARGETS])
+		props->arp_all_targets = nla_get_u32 (tb[IFLA_BOND_ARP_ALL_TARGETS]);
+	if (tb[IFLA_BOND_PRIMARY])
+		props->primary = nla_get_u32 (tb[IFLA_BOND_PRIMARY]);
+	if (tb[IFLA_BOND_PRIMARY_RESELECT])
+		props->primary_reselect = nla_get_u8 (tb[IFLA_BOND_PRIMARY_RESELECT]);
+	if (tb[IFLA_BOND_FAIL_OVER_MAC])
+		props->fail_over_mac = nla_get_u8 (tb[IFLA_BOND_FAIL_OVER_MAC]);
+	if (tb[IFLA_BOND_XMIT_HASH_POLICY])
+		props->xmit_hash_policy = nla_get_u8 (tb[IFLA_BOND_XMIT_HASH_POLICY]);
+	if (tb[IFLA_BOND_RESEND_IGMP])
+		props->resend_igmp = nla_get_u32 (tb[IFLA_BOND_RESEND_IGMP]);
+	if (tb[IFLA_BOND_NUM_PEER_NOTIF])
+		props->num_peer_notif = nla_get_u8 (tb[IFLA_BOND_NUM_PEER_NOTIF]);
+	if (tb[IFLA_BOND_ALL_SLAVES_ACTIVE])
+		props->all_slaves_active = nla_get_u8 (tb[IFLA_BOND_ALL_SLAVES_ACTIVE]);
+	if (tb[IFLA_BOND_MIN_LINKS])
+		props->min_links = nla_get_u32 (tb[IFLA_BOND_MIN_LINKS]);
+	if (tb[IFLA_BOND_LP_INTERVAL])
+		props->lp_interval = nla_get_u32 (tb[IFLA_BOND_LP_INTERVAL]);
+	if (tb[IFLA_BOND_PACKETS_PER_SLAVE])
+		props->packets_per_slave = nla_get_u32 (tb[IFLA_BOND_PACKETS_PER_SLAVE]);
+	if (tb[IFLA_BOND_AD_LACP_RATE])
+		props->lacp_rate = nla_get_u8 (tb[IFLA_BOND_AD_LACP_RATE]);
+	if (tb[IFLA_BOND_AD_SELECT])
+		props->ad_select = nla_get_u8 (tb[IFLA_BOND_AD_SELECT]);
+	if (tb[IFLA_BOND_AD_ACTOR_SYS_PRIO])
+		props->ad_actor_sys_prio = nla_get_u16 (tb[IFLA_BOND_AD_ACTOR_SYS_PRIO]);
+	if (tb[IFLA_BOND_AD_USER_PORT_KEY])
+		props->ad_user_port_key = nla_get_u16 (tb[IFLA_BOND_AD_USER_PORT_KEY]);
+	if (tb[IFLA_BOND_AD_ACTOR_SYSTEM])
+		memcpy (props->ad_actor_system, nla_data (tb[IFLA_BOND_AD_ACTOR_SYSTEM]), ETH_ALEN);
+	if (tb[IFLA_BOND_TLB_DYNAMIC_LB])
+		props->tlb_dynamic_lb = !!nla_get_u8 (tb[IFLA_BOND_TLB_DYNAMIC_LB]);
+
+	return obj;
+}
+
+/*****************************************************************************/
+
+static NMPObject *
+_parse_lnk_bridge (const char *kind, struct nlattr *info_data)
+{
+	static const struct nla_policy policy[] = {
+		[IFLA_BR_FORWARD_DELAY]     = { .type = NLA_U32 },
+		[IFLA_BR_HELLO_TIME]        = { .type = NLA_U32 },
+		[IFLA_BR_MAX_AGE]           = { .type = NLA_U32 },
+		[IFLA_BR_AGEING_TIME]       = { .type = NLA_U32 },
+		[IFLA_BR_STP_STATE]         = { .type = NLA_U32 },
+		[IFLA_BR_PRIORITY]          = { .type = NLA_U16 },
+		[IFLA_BR_VLAN_FILTERING]    = { .type = NLA_U8 },
+		[IFLA_BR_GROUP_FWD_MASK]    = { .type = NLA_U16 },
+		[IFLA_BR_MCAST_SNOOPING]    = { .type = NLA_U8 },
+		[IFLA_BR_VLAN_DEFAULT_PVID] = { .type = NLA_U16 },
+	};
+	NMPlatformLnkBridge *props;
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	NMPObject *obj;
+
+	if (   !info_data
+	    || !nm_streq0 (kind, "bridge"))
+		return NULL;
+
+	if (nla_parse_nested_arr (tb, info_data, policy) < 0)
+		return NULL;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LNK_BRIDGE, NULL);
+
+	props = &obj->lnk_bridge;
+
+	if (tb[IFLA_BR_FORWARD_DELAY])
+		props->forward_delay = nla_get_u32 (tb[IFLA_BR_FORWARD_DELAY]);
+	if (tb[IFLA_BR_HELLO_TIME])
+		props->hello_time = nla_get_u32 (tb[IFLA_BR_HELLO_TIME]);
+	if (tb[IFLA_BR_MAX_AGE])
+		props->max_age = nla_get_u32 (tb[IFLA_BR_MAX_AGE]);
+	if (tb[IFLA_BR_AGEING_TIME])
+		props->ageing_time = nla_get_u32 (tb[IFLA_BR_AGEING_TIME]);
+	if (tb[IFLA_BR_STP_STATE])
+		props->stp_state = !!nla_get_u32 (tb[IFLA_BR_STP_STATE]);
+	if (tb[IFLA_BR_PRIORITY])
+		props->priority = nla_get_u16 (tb[IFLA_BR_PRIORITY]);
+	if (tb[IFLA_BR_VLAN_FILTERING])
+		props->vlan_filtering = !!nla_get_u8 (tb[IFLA_BR_VLAN_FILTERING]);
+	if (tb[IFLA_BR_GROUP_FWD_MASK])
+		props->group_fwd_mask = nla_get_u16 (tb[IFLA_BR_GROUP_FWD_MASK]);
+	if (tb[IFLA_BR_MCAST_SNOOPING])
+		props->mcast_snooping = !!nla_get_u8 (tb[IFLA_BR_MCAST_SNOOPING]);
+	if (tb[IFLA_BR_VLAN_DEFAULT_PVID])
+		props->vlan_default_pvid = nla_get_u16 (tb[IFLA_BR_VLAN_DEFAULT_PVID]);
+
+	return obj;
+}
+
+/*****************************************************************************/
+
 static NMPObject *
 _parse_lnk_gre (const char *kind, struct nlattr *info_data)
 {
@@ -2220,18 +2496,59 @@ _wireguard_get_family_id (NMPlatform *platform, int ifindex_try)
 	return wireguard_family_id;
 }
 
+static const NMPObject *
+_wireguard_update_cache (NMPlatform *platform,
+                         const NMPObject *plink,
+                         int wireguard_family_id,
+                         const NMPObject *lnk_new_take)
+{
+	nm_auto_nmpobj const NMPObject *obj_old = NULL;
+	nm_auto_nmpobj const NMPObject *obj_new = NULL;
+	nm_auto_nmpobj const NMPObject *lnk_new = lnk_new_take;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	NMPCacheOpsType cache_op;
+
+	if (   plink->_link.wireguard_family_id == wireguard_family_id
+	    && plink->_link.netlink.lnk == lnk_new)
+		return plink;
+
+	/* we use nmp_cache_update_netlink() to re-inject the new object into the cache.
+	 * For that, we need to clone it, and tweak it so that it's suitable. It's a bit
+	 * of a hack, in particular that we need to clear driver and udev-device. */
+	obj = nmp_object_clone (plink, FALSE);
+	obj->_link.wireguard_family_id = wireguard_family_id;
+	nmp_object_unref (obj->_link.netlink.lnk);
+	obj->_link.netlink.lnk = g_steal_pointer (&lnk_new);
+	obj->link.driver = NULL;
+	nm_clear_pointer (&obj->_link.udev.device, udev_device_unref);
+
+	cache_op = nmp_cache_update_netlink (nm_platform_get_cache (platform),
+	                                     obj,
+	                                     FALSE,
+	                                     &obj_old,
+	                                     &obj_new);
+	nm_assert (NM_IN_SET (cache_op, NMP_CACHE_OPS_UPDATED));
+	if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
+		cache_on_change (platform, cache_op, obj_old, obj_new);
+		nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, obj_new);
+	}
+
+	nm_assert (   !obj_new
+	           || (   NMP_OBJECT_GET_TYPE (obj_new) == NMP_OBJECT_TYPE_LINK
+	               && obj_new->link.type == NM_LINK_TYPE_WIREGUARD
+	               && (   !obj_new->_link.netlink.lnk
+	                   || NMP_OBJECT_GET_TYPE (obj_new->_link.netlink.lnk) == NMP_OBJECT_TYPE_LNK_WIREGUARD)));
+	return obj_new;
+}
+
 static const NMPObject *
 _wireguard_refresh_link (NMPlatform *platform,
                          int wireguard_family_id,
                          int ifindex)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	nm_auto_nmpobj const NMPObject *obj_old = NULL;
-	nm_auto_nmpobj const NMPObject *obj_new = NULL;
 	nm_auto_nmpobj const NMPObject *lnk_new = NULL;
-	NMPCacheOpsType cache_op;
 	const NMPObject *plink = NULL;
-	nm_auto_nmpobj NMPObject *obj = NULL;
 
 	nm_assert (wireguard_family_id >= 0);
 	nm_assert (ifindex > 0);
@@ -2263,37 +2580,7 @@ _wireguard_refresh_link (NMPlatform *platform,
 		}
 	}
 
-	if (   plink->_link.wireguard_family_id == wireguard_family_id
-	    && plink->_link.netlink.lnk == lnk_new)
-		return plink;
-
-	/* we use nmp_cache_update_netlink() to re-inject the new object into the cache.
-	 * For that, we need to clone it, and tweak it so that it's suitable. It's a bit
-	 * of a hack, in particular that we need to clear driver and udev-device. */
-	obj = nmp_object_clone (plink, FALSE);
-	obj->_link.wireguard_family_id = wireguard_family_id;
-	nmp_object_unref (obj->_link.netlink.lnk);
-	obj->_link.netlink.lnk = g_steal_pointer (&lnk_new);
-	obj->link.driver = NULL;
-	nm_clear_pointer (&obj->_link.udev.device, udev_device_unref);
-
-	cache_op = nmp_cache_update_netlink (nm_platform_get_cache (platform),
-	                                     obj,
-	                                     FALSE,
-	                                     &obj_old,
-	                                     &obj_new);
-	nm_assert (NM_IN_SET (cache_op, NMP_CACHE_OPS_UPDATED));
-	if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
-		cache_on_change (platform, cache_op, obj_old, obj_new);
-		nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, obj_new);
-	}
-
-	nm_assert (   !obj_new
-	           || (   NMP_OBJECT_GET_TYPE (obj_new) == NMP_OBJECT_TYPE_LINK
-	               && obj_new->link.type == NM_LINK_TYPE_WIREGUARD
-	               && (   !obj_new->_link.netlink.lnk
-	                   || NMP_OBJECT_GET_TYPE (obj_new->_link.netlink.lnk) == NMP_OBJECT_TYPE_LNK_WIREGUARD)));
-	return obj_new;
+	return _wireguard_update_cache (platform, plink, wireguard_family_id, g_steal_pointer (&lnk_new));
 }
 
 static int
@@ -2392,7 +2679,8 @@ again:
 			                            | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)) {
 				/* no flags set. We take that as indication to skip configuring the peer
 				 * entirely. */
-				nm_assert (p_flags == NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE);
+				nm_assert (NM_IN_SET (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE,
+				                               NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY));
 				continue;
 			}
 		}
@@ -2410,6 +2698,12 @@ again:
 				goto toobig_peers;
 		} else {
 
+			if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY)
+			    && (   idx_allowed_ips_curr != IDX_NIL
+			        || !NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS))
+			    && nla_put_uint32 (msg, WGPEER_A_FLAGS, WGPEER_F_UPDATE_ONLY) < 0)
+				goto toobig_peers;
+
 			if (idx_allowed_ips_curr == IDX_NIL) {
 				if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY)
 				    && nla_put (msg, WGPEER_A_PRESHARED_KEY, sizeof (p->preshared_key), p->preshared_key) < 0)
@@ -2420,7 +2714,12 @@ again:
 					goto toobig_peers;
 
 				if (   NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)
-				    && nla_put_uint32 (msg, WGPEER_A_FLAGS, WGPEER_F_REPLACE_ALLOWEDIPS) < 0)
+				    && nla_put_uint32 (msg,
+				                       WGPEER_A_FLAGS,
+				                         WGPEER_F_REPLACE_ALLOWEDIPS
+				                       | (  NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY)
+				                          ? WGPEER_F_UPDATE_ONLY
+				                          : 0u)) < 0)
 					goto toobig_peers;
 
 				if (NM_FLAGS_HAS (p_flags, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT)) {
@@ -2517,6 +2816,54 @@ nla_put_failure:
 #undef _nla_nest_end
 }
 
+/* the number of requests sent, before waiting for their acknowledgments. */
+#define WIREGUARD_CHANGE_NLMSGS_WINDOW 16
+
+static int
+_wireguard_send_change_nlmsgs (NMPlatform *platform,
+                               GPtrArray *msgs)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint n_sent = 0;
+	guint n_acked = 0;
+	int r_first = 0;
+	int r;
+
+	/* Don't wait for the acknowledgment of each message before sending the
+	 * next one. Keep a window of requests in flight, so that a large number
+	 * of peers doesn't cost a round trip per message. On failure, we still
+	 * collect the acknowledgments of all sent messages. */
+	while (n_acked < n_sent || (n_sent < msgs->len && r_first == 0)) {
+		while (   r_first == 0
+		       && n_sent < msgs->len
+		       && n_sent - n_acked < WIREGUARD_CHANGE_NLMSGS_WINDOW) {
+			r = nl_send_auto (priv->genl, msgs->pdata[n_sent]);
+			if (r < 0) {
+				_LOGW ("wireguard: set-device, send netlink message #%u failed: %s", n_sent, nm_strerror (r));
+				r_first = r;
+				break;
+			}
+			n_sent++;
+		}
+
+		if (n_acked == n_sent)
+			break;
+
+		do {
+			r = nl_recvmsgs (priv->genl, NULL);
+		} while (r == -EAGAIN);
+		if (r < 0) {
+			_LOGW ("wireguard: set-device, message #%u was rejected: %s", n_acked, nm_strerror (r));
+			if (r_first == 0)
+				r_first = r;
+		} else
+			_LOGT ("wireguard: set-device, message #%u sent and confirmed", n_acked);
+		n_acked++;
+	}
+
+	return r_first;
+}
+
 static int
 link_wireguard_change (NMPlatform *platform,
                        int ifindex,
@@ -2526,8 +2873,13 @@ link_wireguard_change (NMPlatform *platform,
                        guint peers_len,
                        NMPlatformWireGuardChangeFlags change_flags)
 {
-	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	gs_free NMPlatformWireGuardChangePeerFlags *peer_flags_reduced = NULL;
+	nm_auto_nmpobj const NMPObject *plink = NULL;
+	const NMPObject *lnk_cached = NULL;
+	NMPObject *lnk_patched = NULL;
+	gboolean has_update_only = FALSE;
+	gboolean retried = FALSE;
 	int wireguard_family_id;
 	guint i;
 	int r;
@@ -2536,6 +2888,47 @@ link_wireguard_change (NMPlatform *platform,
 	if (wireguard_family_id < 0)
 		return -NME_PL_NO_FIRMWARE;
 
+	plink = nmp_object_ref (nm_platform_link_get_obj (platform, ifindex, TRUE));
+	if (   plink
+	    && plink->link.type == NM_LINK_TYPE_WIREGUARD
+	    && NMP_OBJECT_GET_TYPE (plink->_link.netlink.lnk) == NMP_OBJECT_TYPE_LNK_WIREGUARD)
+		lnk_cached = plink->_link.netlink.lnk;
+
+	if (   lnk_cached
+	    && !NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS)) {
+		/* Only send what differs from the cached configuration. The cache
+		 * is kept up to date by the changes we do (see below), so there is
+		 * no need to dump all peers of the device first. When replacing all
+		 * peers, there is nothing to reduce. */
+		peer_flags_reduced = g_new (NMPlatformWireGuardChangePeerFlags, NM_MAX (peers_len, 1u));
+		for (i = 0; i < peers_len; i++) {
+			peer_flags_reduced[i] =   peer_flags
+			                        ? peer_flags[i]
+			                        : NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT;
+		}
+		peer_flags = peer_flags_reduced;
+
+		if (!nmp_wireguard_reduce_change (&lnk_cached->_lnk_wireguard,
+		                                  lnk_wireguard,
+		                                  peers,
+		                                  peer_flags_reduced,
+		                                  peers_len,
+		                                  &change_flags)) {
+			_LOGT ("wireguard: set-device, nothing to change");
+			return 0;
+		}
+	}
+
+	if (peer_flags) {
+		for (i = 0; i < peers_len; i++) {
+			if (NM_FLAGS_HAS (peer_flags[i], NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY)) {
+				has_update_only = TRUE;
+				break;
+			}
+		}
+	}
+
+again:
 	r = _wireguard_create_change_nlmsgs (platform,
 	                                     ifindex,
 	                                     wireguard_family_id,
@@ -2550,27 +2943,54 @@ link_wireguard_change (NMPlatform *platform,
 		return r;
 	}
 
-	for (i = 0; i < msgs->len; i++) {
-		r = nl_send_auto (priv->genl, msgs->pdata[i]);
-		if (r < 0) {
-			_LOGW ("wireguard: set-device, send netlink message #%u failed: %s", i, nm_strerror (r));
-			return r;
-		}
-
-		do {
-			r = nl_recvmsgs (priv->genl, NULL);
-		} while (r == -EAGAIN);
-		if (r < 0) {
-			_LOGW ("wireguard: set-device, message #%u was rejected: %s", i, nm_strerror (r));
-			return r;
+	r = _wireguard_send_change_nlmsgs (platform, msgs);
+	if (   r == -EOPNOTSUPP
+	    && has_update_only) {
+		/* WGPEER_F_UPDATE_ONLY is not supported by older versions of the
+		 * module. Retry without. */
+		_LOGD ("wireguard: set-device, retry without update-only flag");
+		if (peer_flags != peer_flags_reduced) {
+			peer_flags_reduced = nm_memdup (peer_flags, sizeof (peer_flags[0]) * NM_MAX (peers_len, 1u));
+			peer_flags = peer_flags_reduced;
 		}
-
-		_LOGT ("wireguard: set-device, message #%u sent and confirmed", i);
+		for (i = 0; i < peers_len; i++)
+			peer_flags_reduced[i] &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+		has_update_only = FALSE;
+		retried = TRUE;
+		g_clear_pointer (&msgs, g_ptr_array_unref);
+		goto again;
 	}
 
-	_wireguard_refresh_link (platform, wireguard_family_id, ifindex);
+	if (   r >= 0
+	    && !retried
+	    && lnk_cached) {
+		/* If we know the resulting configuration, patch the cache instead
+		 * of dumping all peers of the device again. */
+		lnk_patched = nmp_wireguard_patch_change (lnk_cached,
+		                                          lnk_wireguard,
+		                                          peers,
+		                                          peer_flags,
+		                                          peers_len,
+		                                          change_flags);
+	}
+
+	if (lnk_patched) {
+		const NMPObject *plink_now;
+
+		/* the link might have changed in the meantime. Only patch it, if it
+		 * still has the configuration that we reduced against. */
+		plink_now = nm_platform_link_get_obj (platform, ifindex, TRUE);
+		if (   plink_now
+		    && plink_now->_link.netlink.lnk == lnk_cached)
+			_wireguard_update_cache (platform, plink_now, wireguard_family_id, lnk_patched);
+		else {
+			nmp_object_unref (lnk_patched);
+			_wireguard_refresh_link (platform, wireguard_family_id, ifindex);
+		}
+	} else
+		_wireguard_refresh_link (platform, wireguard_family_id, ifindex);
 
-	return 0;
+	return r < 0 ? r : 0;
 }
 
 /*****************************************************************************/
@@ -2764,6 +3184,12 @@ _new_from_nl_link (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr
 	}
 
 	switch (obj->link.type) {
+	case NM_LINK_TYPE_BOND:
+		lnk_data = _parse_lnk_bond (nl_info_kind, nl_info_data);
+		break;
+	case NM_LINK_TYPE_BRIDGE:
+		lnk_data = _parse_lnk_bridge (nl_info_kind, nl_info_data);
+		break;
 	case NM_LINK_TYPE_GRE:
 	case NM_LINK_TYPE_GRETAP:
 		lnk_data = _parse_lnk_gre (nl_info_kind, nl_info_data);
@@ -3052,6 +3478,7 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 		[RTA_CACHEINFO] = { .minlen = nm_offsetofend (struct rta_cacheinfo, rta_tsage) },
 		[RTA_METRICS]   = { .type = NLA_NESTED },
 		[RTA_MULTIPATH] = { .type = NLA_NESTED },
+		[RTA_NH_ID]     = { .type = NLA_U32 },
 	};
 	const struct rtmsg *rtm;
 	struct nlattr *tb[G_N_ELEMENTS (policy)];
@@ -3065,6 +3492,7 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	} nh = {
 		.is_present = FALSE,
 	};
+	guint32 nhid = 0;
 	guint32 mss;
 	guint32 window = 0;
 	guint32 cwnd = 0;
@@ -3108,6 +3536,21 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	 * parse nexthops. Only handle routes with one nh.
 	 *****************************************************************/
 
+	if (tb[RTA_NH_ID]) {
+		/* The route references a nexthop object. The gateway is tracked by
+		 * the nexthop object, we only take the device that kernel reports
+		 * for routes with a single nexthop. Like multipath routes, routes
+		 * referencing a nexthop group have no device and are ignored. */
+		if (!tb[RTA_OIF])
+			return NULL;
+		nhid = nla_get_u32 (tb[RTA_NH_ID]);
+		nh.is_present = TRUE;
+		nh.ifindex = nla_get_u32 (tb[RTA_OIF]);
+		if (nh.ifindex <= 0)
+			return NULL;
+		goto nexthop_done;
+	}
+
 	if (tb[RTA_MULTIPATH]) {
 		size_t tlen = nla_len (tb[RTA_MULTIPATH]);
 		struct rtnexthop *rtnh;
@@ -3180,6 +3623,8 @@ rta_multipath_done:
 	} else if (!nh.is_present)
 		return NULL;
 
+nexthop_done:
+
 	/*****************************************************************/
 
 	mss = 0;
@@ -3223,6 +3668,7 @@ rta_multipath_done:
 	                                                              : (guint32) rtm->rtm_table);
 
 	obj->ip_route.ifindex = nh.ifindex;
+	obj->ip_route.nhid = nhid;
 
 	if (_check_addr_or_return_null (tb, RTA_DST, addr_len))
 		memcpy (obj->ip_route.network_ptr, nla_data (tb[RTA_DST]), addr_len);
@@ -3594,6 +4040,60 @@ _new_from_nl_tfilter (struct nlmsghdr *nlh, gboolean id_only)
 	return obj;
 }
 
+static NMPObject *
+_new_from_nl_nexthop (struct nlmsghdr *nlh, gboolean id_only)
+{
+	static const struct nla_policy policy[] = {
+		[NHA_ID]        = { .type = NLA_U32 },
+		[NHA_BLACKHOLE] = { .type = NLA_FLAG },
+		[NHA_OIF]       = { .type = NLA_U32 },
+		[NHA_GATEWAY]   = { },
+	};
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	const struct _nhmsg *nhm;
+	NMPObject *obj;
+	guint32 id;
+
+	if (nlmsg_parse_arr (nlh, sizeof (*nhm), tb, policy) < 0)
+		return NULL;
+
+	if (!tb[NHA_ID])
+		return NULL;
+
+	id = nla_get_u32 (tb[NHA_ID]);
+	if (id == 0)
+		return NULL;
+
+	nhm = nlmsg_data (nlh);
+
+	if (tb[NHA_GROUP]) {
+		/* nexthop groups are not supported (yet). */
+		return NULL;
+	}
+
+	if (!NM_IN_SET (nhm->nh_family, AF_INET, AF_INET6))
+		return NULL;
+
+	_check_addr_or_return_null (tb, NHA_GATEWAY, nm_utils_addr_family_to_size (nhm->nh_family));
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, NULL);
+
+	obj->nexthop.id = id;
+	obj->nexthop.addr_family = nhm->nh_family;
+
+	if (!id_only) {
+		obj->nexthop.protocol = nhm->nh_protocol;
+		obj->nexthop.flags = nhm->nh_flags;
+		obj->nexthop.blackhole = !!tb[NHA_BLACKHOLE];
+		if (tb[NHA_OIF])
+			obj->nexthop.ifindex = nla_get_u32 (tb[NHA_OIF]);
+		if (tb[NHA_GATEWAY])
+			memcpy (&obj->nexthop.gateway, nla_data (tb[NHA_GATEWAY]), nla_len (tb[NHA_GATEWAY]));
+	}
+
+	return obj;
+}
+
 /**
  * nmp_object_new_from_nl:
  * @platform: (allow-none): for creating certain objects, the constructor wants to check
@@ -3607,14 +4107,14 @@ _new_from_nl_tfilter (struct nlmsghdr *nlh, gboolean id_only)
  * Returns: %NULL or a newly created NMPObject instance.
  **/
 static NMPObject *
-nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_msg *msg, gboolean id_only)
+nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, const struct nl_msg_lite *msg, gboolean id_only)
 {
 	struct nlmsghdr *msghdr;
 
-	if (nlmsg_get_proto (msg) != NETLINK_ROUTE)
+	if (msg->nm_protocol != NETLINK_ROUTE)
 		return NULL;
 
-	msghdr = nlmsg_hdr (msg);
+	msghdr = msg->nm_nlh;
 
 	switch (msghdr->nlmsg_type) {
 	case RTM_NEWLINK:
@@ -3642,6 +4142,10 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	case RTM_DELTFILTER:
 	case RTM_GETTFILTER:
 		return _new_from_nl_tfilter (msghdr, id_only);
+	case RTM_NEWNEXTHOP:
+	case RTM_DELNEXTHOP:
+	case RTM_GETNEXTHOP:
+		return _new_from_nl_nexthop (msghdr, id_only);
 	default:
 		return NULL;
 	}
@@ -3837,24 +4341,152 @@ nla_put_failure:
 	g_return_val_if_reached (FALSE);
 }
 
-static struct nl_msg *
-_nl_msg_new_link_full (int nlmsg_type,
-                       int nlmsg_flags,
-                       int ifindex,
-                       const char *ifname,
-                       guint8 family,
-                       unsigned flags_mask,
-                       unsigned flags_set)
+static gboolean
+_nl_msg_new_link_set_linkinfo_bond (struct nl_msg *msg,
+                                    const NMPlatformLnkBond *props,
+                                    NMPlatformLnkBondAttrs attrs)
 {
-	nm_auto_nlmsg struct nl_msg *msg = NULL;
-	const struct ifinfomsg ifi = {
-		.ifi_family = family,
-		.ifi_change = flags_mask,
-		.ifi_flags = flags_set,
-		.ifi_index = ifindex,
-	};
+	struct nlattr *info;
+	struct nlattr *data;
+	guint i;
 
-	nm_assert (NM_IN_SET (nlmsg_type, RTM_DELLINK, RTM_NEWLINK, RTM_GETLINK, RTM_SETLINK));
+	nm_assert (msg);
+	nm_assert (props);
+
+	if (attrs == NM_PLATFORM_LNK_BOND_ATTR_NONE)
+		return TRUE;
+
+	if (!(info = nla_nest_start (msg, IFLA_LINKINFO)))
+		goto nla_put_failure;
+
+	NLA_PUT_STRING (msg, IFLA_INFO_KIND, "bond");
+
+	if (!(data = nla_nest_start (msg, IFLA_INFO_DATA)))
+		goto nla_put_failure;
+
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_MODE))
+		NLA_PUT_U8 (msg, IFLA_BOND_MODE, props->mode);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ACTIVE_SLAVE))
+		NLA_PUT_U32 (msg, IFLA_BOND_ACTIVE_SLAVE, props->active_slave);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_MIIMON))
+		NLA_PUT_U32 (msg, IFLA_BOND_MIIMON, props->miimon);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_UPDELAY))
+		NLA_PUT_U32 (msg, IFLA_BOND_UPDELAY, props->updelay);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_DOWNDELAY))
+		NLA_PUT_U32 (msg, IFLA_BOND_DOWNDELAY, props->downdelay);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_USE_CARRIER))
+		NLA_PUT_U8 (msg, IFLA_BOND_USE_CARRIER, !!props->use_carrier);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ARP_INTERVAL))
+		NLA_PUT_U32 (msg, IFLA_BOND_ARP_INTERVAL, props->arp_interval);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ARP_IP_TARGET)) {
+		struct nlattr *targets;
+
+		/* kernel replaces the entire list of targets, an empty
+		 * nest clears it. */
+		if (!(targets = nla_nest_start (msg, IFLA_BOND_ARP_IP_TARGET)))
+			goto nla_put_failure;
+		for (i = 0; i < props->arp_ip_targets_num && i < NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS; i++)
+			NLA_PUT_U32 (msg, i, props->arp_ip_target[i]);
+		nla_nest_end (msg, targets);
+	}
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ARP_VALIDATE))
+		NLA_PUT_U32 (msg, IFLA_BOND_ARP_VALIDATE, props->arp_validate);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ARP_ALL_TARGETS))
+		NLA_PUT_U32 (msg, IFLA_BOND_ARP_ALL_TARGETS, props->arp_all_targets);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_PRIMARY))
+		NLA_PUT_U32 (msg, IFLA_BOND_PRIMARY, props->primary);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_PRIMARY_RESELECT))
+		NLA_PUT_U8 (msg, IFLA_BOND_PRIMARY_RESELECT, props->primary_reselect);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_FAIL_OVER_MAC))
+		NLA_PUT_U8 (msg, IFLA_BOND_FAIL_OVER_MAC, props->fail_over_mac);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_XMIT_HASH_POLICY))
+		NLA_PUT_U8 (msg, IFLA_BOND_XMIT_HASH_POLICY, props->xmit_hash_policy);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_RESEND_IGMP))
+		NLA_PUT_U32 (msg, IFLA_BOND_RESEND_IGMP, props->resend_igmp);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_NUM_PEER_NOTIF))
+		NLA_PUT_U8 (msg, IFLA_BOND_NUM_PEER_NOTIF, props->num_peer_notif);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_ALL_SLAVES_ACTIVE))
+		NLA_PUT_U8 (msg, IFLA_BOND_ALL_SLAVES_ACTIVE, props->all_slaves_active);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_MIN_LINKS))
+		NLA_PUT_U32 (msg, IFLA_BOND_MIN_LINKS, props->min_links);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_LP_INTERVAL))
+		NLA_PUT_U32 (msg, IFLA_BOND_LP_INTERVAL, props->lp_interval);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_PACKETS_PER_SLAVE))
+		NLA_PUT_U32 (msg, IFLA_BOND_PACKETS_PER_SLAVE, props->packets_per_slave);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_AD_LACP_RATE))
+		NLA_PUT_U8 (msg, IFLA_BOND_AD_LACP_RATE, props->lacp_rate);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_AD_SELECT))
+		NLA_PUT_U8 (msg, IFLA_BOND_AD_SELECT, props->ad_select);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYS_PRIO))
+		NLA_PUT_U16 (msg, IFLA_BOND_AD_ACTOR_SYS_PRIO, props->ad_actor_sys_prio);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_AD_USER_PORT_KEY))
+		NLA_PUT_U16 (msg, IFLA_BOND_AD_USER_PORT_KEY, props->ad_user_port_key);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYSTEM))
+		NLA_PUT (msg, IFLA_BOND_AD_ACTOR_SYSTEM, sizeof (props->ad_actor_system), props->ad_actor_system);
+	if (NM_FLAGS_HAS (attrs, NM_PLATFORM_LNK_BOND_ATTR_TLB_DYNAMIC_LB))
+		NLA_PUT_U8 (msg, IFLA_BOND_TLB_DYNAMIC_LB, !!props->tlb_dynamic_lb);
+
+	nla_nest_end (msg, data);
+	nla_nest_end (msg, info);
+
+	return TRUE;
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
+}
+
+static gboolean
+_nl_msg_new_link_set_linkinfo_bridge (struct nl_msg *msg,
+                                      const NMPlatformLnkBridge *props)
+{
+	struct nlattr *info;
+	struct nlattr *data;
+
+	nm_assert (msg);
+	nm_assert (props);
+
+	if (!(info = nla_nest_start (msg, IFLA_LINKINFO)))
+		goto nla_put_failure;
+
+	NLA_PUT_STRING (msg, IFLA_INFO_KIND, "bridge");
+
+	if (!(data = nla_nest_start (msg, IFLA_INFO_DATA)))
+		goto nla_put_failure;
+
+	NLA_PUT_U32 (msg, IFLA_BR_STP_STATE, !!props->stp_state);
+	NLA_PUT_U16 (msg, IFLA_BR_PRIORITY, props->priority);
+	NLA_PUT_U32 (msg, IFLA_BR_FORWARD_DELAY, props->forward_delay);
+	NLA_PUT_U32 (msg, IFLA_BR_HELLO_TIME, props->hello_time);
+	NLA_PUT_U32 (msg, IFLA_BR_MAX_AGE, props->max_age);
+	NLA_PUT_U32 (msg, IFLA_BR_AGEING_TIME, props->ageing_time);
+	NLA_PUT_U16 (msg, IFLA_BR_GROUP_FWD_MASK, props->group_fwd_mask);
+	NLA_PUT_U8 (msg, IFLA_BR_MCAST_SNOOPING, !!props->mcast_snooping);
+
+	nla_nest_end (msg, data);
+	nla_nest_end (msg, info);
+
+	return TRUE;
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
+}
+
+static struct nl_msg *
+_nl_msg_new_link_full (int nlmsg_type,
+                       int nlmsg_flags,
+                       int ifindex,
+                       const char *ifname,
+                       guint8 family,
+                       unsigned flags_mask,
+                       unsigned flags_set)
+{
+	nm_auto_nlmsg struct nl_msg *msg = NULL;
+	const struct ifinfomsg ifi = {
+		.ifi_family = family,
+		.ifi_change = flags_mask,
+		.ifi_flags = flags_set,
+		.ifi_index = ifindex,
+	};
+
+	nm_assert (NM_IN_SET (nlmsg_type, RTM_DELLINK, RTM_NEWLINK, RTM_GETLINK, RTM_SETLINK));
 
 	msg = nlmsg_alloc_simple (nlmsg_type, nlmsg_flags);
 
@@ -4078,14 +4710,19 @@ _nl_msg_new_route (int nlmsg_type,
 		nla_nest_end (msg, metrics);
 	}
 
-	/* We currently don't have need for multi-hop routes... */
-	if (is_v4) {
-		NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip4_route.gateway);
+	if (obj->ip_route.nhid) {
+		/* kernel rejects RTA_NH_ID together with RTA_OIF or RTA_GATEWAY. */
+		NLA_PUT_U32 (msg, RTA_NH_ID, obj->ip_route.nhid);
 	} else {
-		if (!IN6_IS_ADDR_UNSPECIFIED (&obj->ip6_route.gateway))
-			NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip6_route.gateway);
+		/* We currently don't have need for multi-hop routes... */
+		if (is_v4) {
+			NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip4_route.gateway);
+		} else {
+			if (!IN6_IS_ADDR_UNSPECIFIED (&obj->ip6_route.gateway))
+				NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip6_route.gateway);
+		}
+		NLA_PUT_U32 (msg, RTA_OIF, obj->ip_route.ifindex);
 	}
-	NLA_PUT_U32 (msg, RTA_OIF, obj->ip_route.ifindex);
 
 	if (   !is_v4
 	    && obj->ip6_route.rt_pref != NM_ICMPV6_ROUTER_PREF_MEDIUM)
@@ -4210,6 +4847,50 @@ nla_put_failure:
 	g_return_val_if_reached (NULL);
 }
 
+static struct nl_msg *
+_nl_msg_new_nexthop (int nlmsg_type,
+                     int nlmsg_flags,
+                     const NMPlatformNexthop *nexthop)
+{
+	nm_auto_nlmsg struct nl_msg *msg = NULL;
+	const struct _nhmsg nhm = {
+		.nh_family = nexthop->addr_family,
+		.nh_protocol = nlmsg_type == RTM_NEWNEXTHOP
+		               ? (nexthop->protocol ?: RTPROT_STATIC)
+		               : 0,
+		.nh_flags = nexthop->flags & ((guint32) RTNH_F_ONLINK),
+	};
+
+	nm_assert (NM_IN_SET (nlmsg_type, RTM_NEWNEXTHOP, RTM_DELNEXTHOP));
+	nm_assert (nexthop->id > 0);
+
+	msg = nlmsg_alloc_simple (nlmsg_type, nlmsg_flags);
+
+	if (nlmsg_append_struct (msg, &nhm) < 0)
+		goto nla_put_failure;
+
+	NLA_PUT_U32 (msg, NHA_ID, nexthop->id);
+
+	if (nlmsg_type == RTM_DELNEXTHOP)
+		return g_steal_pointer (&msg);
+
+	if (nexthop->blackhole)
+		NLA_PUT_FLAG (msg, NHA_BLACKHOLE);
+	else {
+		NLA_PUT_U32 (msg, NHA_OIF, nexthop->ifindex);
+		if (!nm_ip_addr_is_null (nexthop->addr_family, &nexthop->gateway)) {
+			NLA_PUT (msg, NHA_GATEWAY,
+			         nm_utils_addr_family_to_size (nexthop->addr_family),
+			         &nexthop->gateway);
+		}
+	}
+
+	return g_steal_pointer (&msg);
+
+nla_put_failure:
+	g_return_val_if_reached (NULL);
+}
+
 static struct nl_msg *
 _nl_msg_new_qdisc (int nlmsg_type,
                    int nlmsg_flags,
@@ -4898,6 +5579,7 @@ refresh_all_type_get_info (RefreshAllType refresh_all_type)
 		R (REFRESH_ALL_TYPE_ROUTING_RULES_IP6, NMP_OBJECT_TYPE_ROUTING_RULE, AF_INET6),
 		R (REFRESH_ALL_TYPE_QDISCS,            NMP_OBJECT_TYPE_QDISC,        AF_UNSPEC),
 		R (REFRESH_ALL_TYPE_TFILTERS,          NMP_OBJECT_TYPE_TFILTER,      AF_UNSPEC),
+		R (REFRESH_ALL_TYPE_NEXTHOPS,          NMP_OBJECT_TYPE_NEXTHOP,      AF_UNSPEC),
 #undef R
 	};
 
@@ -4919,6 +5601,7 @@ _NM_UTILS_LOOKUP_DEFINE (static, delayed_action_type_to_refresh_all_type, Delaye
 	NM_UTILS_LOOKUP_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_IP6, REFRESH_ALL_TYPE_ROUTING_RULES_IP6),
 	NM_UTILS_LOOKUP_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS,            REFRESH_ALL_TYPE_QDISCS),
 	NM_UTILS_LOOKUP_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,          REFRESH_ALL_TYPE_TFILTERS),
+	NM_UTILS_LOOKUP_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,          REFRESH_ALL_TYPE_NEXTHOPS),
 	NM_UTILS_LOOKUP_ITEM_IGNORE_OTHER (),
 );
 
@@ -4947,6 +5630,7 @@ refresh_all_type_from_needle_object (const NMPObject *obj_needle)
 	case NMP_OBJECT_TYPE_IP6_ROUTE:   return REFRESH_ALL_TYPE_IP6_ROUTES;
 	case NMP_OBJECT_TYPE_QDISC:       return REFRESH_ALL_TYPE_QDISCS;
 	case NMP_OBJECT_TYPE_TFILTER:     return REFRESH_ALL_TYPE_TFILTERS;
+	case NMP_OBJECT_TYPE_NEXTHOP:     return REFRESH_ALL_TYPE_NEXTHOPS;
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
 		switch (NMP_OBJECT_CAST_ROUTING_RULE (obj_needle)->addr_family) {
 		case AF_INET:  return REFRESH_ALL_TYPE_ROUTING_RULES_IP4;
@@ -5002,6 +5686,7 @@ NM_UTILS_LOOKUP_STR_DEFINE_STATIC (delayed_action_to_string, DelayedActionType,
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_IP6, "refresh-all-routing-rules-ip6"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS,            "refresh-all-qdiscs"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,          "refresh-all-tfilters"),
+	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,          "refresh-all-nexthops"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_LINK,                  "refresh-link"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_MASTER_CONNECTED,              "master-connected"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_READ_NETLINK,                  "read-netlink"),
@@ -5115,6 +5800,9 @@ delayed_action_wait_for_nl_response_complete (NMPlatform *platform,
 			data->response.out_route_get = NULL;
 		}
 		break;
+	case DELAYED_ACTION_RESPONSE_TYPE_BRIDGE_VLANS:
+		data->response.out_bridge_vlans = NULL;
+		break;
 	}
 
 	g_array_remove_index_fast (priv->delayed_action.list_wait_for_nl_response, idx);
@@ -5429,6 +6117,53 @@ cache_prune_all (NMPlatform *platform)
 	}
 }
 
+static void
+cache_remove_routes_by_nhid (NMPlatform *platform, guint32 nhid)
+{
+	NMPCache *cache = nm_platform_get_cache (platform);
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	NMDedupMultiIter iter;
+	NMPLookup lookup;
+	const NMPObject *obj;
+	guint i;
+
+	nm_assert (nhid > 0);
+
+	for (i = 0; i < 2; i++) {
+		nmp_lookup_init_obj_type (&lookup,
+		                          i == 0
+		                            ? NMP_OBJECT_TYPE_IP4_ROUTE
+		                            : NMP_OBJECT_TYPE_IP6_ROUTE);
+		nmp_cache_iter_for_each (&iter,
+		                         nmp_cache_lookup (cache, &lookup),
+		                         &obj) {
+			if (obj->ip_route.nhid != nhid)
+				continue;
+			if (!routes)
+				routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (routes, (gpointer) nmp_object_ref (obj));
+		}
+	}
+
+	if (!routes)
+		return;
+
+	for (i = 0; i < routes->len; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+		NMPCacheOpsType cache_op;
+
+		obj = routes->pdata[i];
+		_LOGt ("cache-prune: route %s references deleted nexthop %u",
+		       nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_ALL, NULL, 0),
+		       nhid);
+		cache_op = nmp_cache_remove (cache, obj, TRUE, FALSE, &obj_old);
+		if (cache_op == NMP_CACHE_OPS_UNCHANGED)
+			continue;
+		cache_on_change (platform, cache_op, obj_old, NULL);
+		nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, NULL);
+	}
+}
+
 static void
 cache_on_change (NMPlatform *platform,
                  NMPCacheOpsType cache_op,
@@ -5481,7 +6216,7 @@ cache_on_change (NMPlatform *platform,
 		{
 			int ifindex = 0;
 
-			/* if we remove a link (from netlink), we must refresh the addresses, routes, qdiscs and tfilters */
+			/* if we remove a link (from netlink), we must refresh the addresses, routes, qdiscs, tfilters and nexthops */
 			if (   cache_op == NMP_CACHE_OPS_REMOVED
 			    && obj_old /* <-- nonsensical, make coverity happy */)
 				ifindex = obj_old->link.ifindex;
@@ -5499,7 +6234,8 @@ cache_on_change (NMPlatform *platform,
 				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
 				                         DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
 				                         DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+				                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS |
+				                         DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,
 				                         NULL);
 			}
 		}
@@ -5651,6 +6387,14 @@ cache_on_change (NMPlatform *platform,
 			}
 		}
 		break;
+	case NMP_OBJECT_TYPE_NEXTHOP:
+		{
+			/* Kernel silently removes the routes that reference a deleted nexthop.
+			 * Drop them from the cache too, instead of dumping all routes again. */
+			if (cache_op == NMP_CACHE_OPS_REMOVED)
+				cache_remove_routes_by_nhid (platform, obj_old->nexthop.id);
+		}
+		break;
 	default:
 		break;
 	}
@@ -5849,6 +6593,16 @@ _nl_msg_new_dump (NMPObjectType obj_type,
 				g_return_val_if_reached (NULL);
 		}
 		break;
+	case NMP_OBJECT_TYPE_NEXTHOP:
+		{
+			const struct _nhmsg nhmsg = {
+				.nh_family = preferred_addr_family,
+			};
+
+			if (nlmsg_append_struct (nlmsg, &nhmsg) < 0)
+				g_return_val_if_reached (NULL);
+		}
+		break;
 	case NMP_OBJECT_TYPE_LINK:
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
@@ -5992,11 +6746,17 @@ event_seq_check_refresh_all (NMPlatform *platform, guint32 seq_number)
 	priv->nlh_seq_last_seen = seq_number;
 }
 
+static void _change_link_async_schedule_complete (NMPlatform *platform);
+
+static void _bridge_vlans_handle_response (NMPlatform *platform,
+                                           const struct nlmsghdr *nlh);
+
 static void
 event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResult seq_result, const char *msg)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	DelayedActionWaitForNlResponseData *data;
+	ChangeLinkAsyncData *async_data;
 	guint i;
 
 	if (seq_number == 0)
@@ -6024,6 +6784,20 @@ event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResu
 		}
 	}
 
+	c_list_for_each_entry (async_data, &priv->change_link_async.lst_head, change_link_async_lst) {
+		if (async_data->seq_number != seq_number)
+			continue;
+		if (async_data->seq_result < 0) {
+			/* preserve the first error. */
+		} else if (   seq_result != WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN
+		           || async_data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
+			async_data->seq_result = seq_result;
+		if (!async_data->errmsg)
+			async_data->errmsg = g_strdup (msg);
+		_change_link_async_schedule_complete (platform);
+		return;
+	}
+
 #if NM_MORE_LOGGING
 	if (seq_number != priv->nlh_seq_last_handled)
 		_LOGt ("netlink: recvmsg: unwaited sequence number %u", seq_number);
@@ -6032,7 +6806,7 @@ event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResu
 }
 
 static void
-event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
+event_valid_msg (NMPlatform *platform, const struct nl_msg_lite *msg, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv;
 	nm_auto_nmpobj NMPObject *obj = NULL;
@@ -6043,7 +6817,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	gboolean is_dump = FALSE;
 	NMPCache *cache = nm_platform_get_cache (platform);
 
-	msghdr = nlmsg_hdr (msg);
+	msghdr = msg->nm_nlh;
 
 	if (   !_nm_platform_kernel_support_detected (NM_PLATFORM_KERNEL_SUPPORT_TYPE_EXTENDED_IFA_FLAGS)
 	    && msghdr->nlmsg_type == RTM_NEWADDR) {
@@ -6070,12 +6844,20 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	if (!handle_events)
 		return;
 
+	if (   NM_IN_SET (msghdr->nlmsg_type, RTM_NEWLINK, RTM_NEWVLAN)
+	    && NM_FLAGS_HAS (msghdr->nlmsg_flags, NLM_F_MULTI)) {
+		/* AF_BRIDGE link messages and bridge VLAN database entries are not
+		 * cached, but they might be the response to a bridge VLAN request. */
+		_bridge_vlans_handle_response (platform, msghdr);
+	}
+
 	if (NM_IN_SET (msghdr->nlmsg_type, RTM_DELLINK,
 	                                   RTM_DELADDR,
 	                                   RTM_DELROUTE,
 	                                   RTM_DELRULE,
 	                                   RTM_DELQDISC,
-	                                   RTM_DELTFILTER)) {
+	                                   RTM_DELTFILTER,
+	                                   RTM_DELNEXTHOP)) {
 		/* The event notifies about a deleted object. We don't need to initialize all
 		 * fields of the object. */
 		is_del = TRUE;
@@ -6094,7 +6876,8 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	                                      RTM_NEWROUTE,
 	                                      RTM_NEWRULE,
 	                                      RTM_NEWQDISC,
-	                                      RTM_NEWTFILTER)) {
+	                                      RTM_NEWTFILTER,
+	                                      RTM_NEWNEXTHOP)) {
 		is_dump = delayed_action_refresh_all_in_progress (platform,
 		                                                  delayed_action_refresh_from_needle_object (obj));
 	}
@@ -6118,6 +6901,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		case RTM_NEWQDISC:
 		case RTM_NEWRULE:
 		case RTM_NEWTFILTER:
+		case RTM_NEWNEXTHOP:
 			cache_op = nmp_cache_update_netlink (cache, obj, is_dump, &obj_old, &obj_new);
 			if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
 				cache_on_change (platform, cache_op, obj_old, obj_new);
@@ -6147,7 +6931,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 						if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET
 						    && data->response.out_route_get) {
 							nm_assert (!*data->response.out_route_get);
-							if (data->seq_number == nlmsg_hdr (msg)->nlmsg_seq) {
+							if (data->seq_number == msghdr->nlmsg_seq) {
 								*data->response.out_route_get = nmp_object_clone (obj, FALSE);
 								data->response.out_route_get = NULL;
 								break;
@@ -6217,6 +7001,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 		case RTM_DELROUTE:
 		case RTM_DELRULE:
 		case RTM_DELTFILTER:
+		case RTM_DELNEXTHOP:
 			cache_op = nmp_cache_remove_netlink (cache, obj, &obj_old, &obj_new);
 			if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
 				cache_on_change (platform, cache_op, obj_old, obj_new);
@@ -6397,6 +7182,57 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	return success;
 }
 
+static int
+_change_link_result_to_nmerr (NMPlatform *platform,
+                              ChangeLinkType change_link_type,
+                              int ifindex,
+                              WaitForNlResponseResult seq_result,
+                              const ChangeLinkData *data,
+                              NMLogLevel *out_log_level,
+                              const char **out_log_result,
+                              const char **out_log_detail)
+{
+	const NMPObject *obj_cache;
+
+	*out_log_level = LOGL_DEBUG;
+	*out_log_result = "failure";
+	*out_log_detail = "";
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+		*out_log_result = "success";
+		return 0;
+	}
+	if (NM_IN_SET (-((int) seq_result), EEXIST, EADDRINUSE))
+		return 0;
+	if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT)) {
+		*out_log_detail = ", firmware not found";
+		return -NME_PL_NO_FIRMWARE;
+	}
+	if (   NM_IN_SET (-((int) seq_result), ERANGE)
+	    && change_link_type == CHANGE_LINK_TYPE_SET_MTU) {
+		*out_log_detail = ", setting MTU to requested size is not possible";
+		return -NME_PL_CANT_SET_MTU;
+	}
+	if (   NM_IN_SET (-((int) seq_result), ENFILE)
+	    && change_link_type == CHANGE_LINK_TYPE_SET_ADDRESS
+	    && (obj_cache = nmp_cache_lookup_link (nm_platform_get_cache (platform), ifindex))
+	    && obj_cache->link.l_address.len == data->set_address.length
+	    && memcmp (obj_cache->link.l_address.data, data->set_address.address, data->set_address.length) == 0) {
+		/* workaround ENFILE which may be wrongly returned (bgo #770456).
+		 * If the MAC address is as expected, assume success? */
+		*out_log_result = "success";
+		*out_log_detail = " (assume success changing address)";
+		return 0;
+	}
+	if (NM_IN_SET (-((int) seq_result), ENODEV))
+		return -NME_PL_NOT_FOUND;
+	if (-((int) seq_result) == EAFNOSUPPORT)
+		return -NME_PL_OPNOTSUPP;
+
+	*out_log_level = LOGL_WARN;
+	return -NME_UNSPEC;
+}
+
 static int
 do_change_link (NMPlatform *platform,
                 ChangeLinkType change_link_type,
@@ -6414,7 +7250,6 @@ do_change_link (NMPlatform *platform,
 	const char *log_result = "failure";
 	const char *log_detail = "";
 	gs_free char *log_detail_free = NULL;
-	const NMPObject *obj_cache;
 
 	if (!nm_platform_netns_push (platform, &netns)) {
 		log_level = LOGL_ERR;
@@ -6446,37 +7281,14 @@ retry:
 		goto retry;
 	}
 
-	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
-		log_result = "success";
-	} else if (NM_IN_SET (-((int) seq_result), EEXIST, EADDRINUSE)) {
-		/* */
-	} else if (NM_IN_SET (-((int) seq_result), ESRCH, ENOENT)) {
-		log_detail = ", firmware not found";
-		result = -NME_PL_NO_FIRMWARE;
-	} else if (   NM_IN_SET (-((int) seq_result), ERANGE)
-	           && change_link_type == CHANGE_LINK_TYPE_SET_MTU) {
-		log_detail = ", setting MTU to requested size is not possible";
-		result = -NME_PL_CANT_SET_MTU;
-	} else if (   NM_IN_SET (-((int) seq_result), ENFILE)
-	           && change_link_type == CHANGE_LINK_TYPE_SET_ADDRESS
-	           && (obj_cache = nmp_cache_lookup_link (nm_platform_get_cache (platform), ifindex))
-	           && obj_cache->link.l_address.len == data->set_address.length
-	           && memcmp (obj_cache->link.l_address.data, data->set_address.address, data->set_address.length) == 0) {
-		/* workaround ENFILE which may be wrongly returned (bgo #770456).
-		 * If the MAC address is as expected, assume success? */
-		log_result = "success";
-		log_detail = " (assume success changing address)";
-		result = 0;
-	} else if (NM_IN_SET (-((int) seq_result), ENODEV)) {
-		log_level = LOGL_DEBUG;
-		result = -NME_PL_NOT_FOUND;
-	} else if (-((int) seq_result) == EAFNOSUPPORT) {
-		log_level = LOGL_DEBUG;
-		result = -NME_PL_OPNOTSUPP;
-	} else {
-		log_level = LOGL_WARN;
-		result = -NME_UNSPEC;
-	}
+	result = _change_link_result_to_nmerr (platform,
+	                                       change_link_type,
+	                                       ifindex,
+	                                       seq_result,
+	                                       data,
+	                                       &log_level,
+	                                       &log_result,
+	                                       &log_detail);
 
 out:
 	_NMLOG (log_level,
@@ -6488,109 +7300,363 @@ out:
 	return result;
 }
 
-static int
-link_add (NMPlatform *platform,
-          const char *name,
-          NMLinkType type,
-          const char *veth_peer,
-          const void *address,
-          size_t address_len,
-          const NMPlatformLink **out_link)
-{
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+/*****************************************************************************/
 
-	if (type == NM_LINK_TYPE_BOND) {
-		/* When the kernel loads the bond module, either via explicit modprobe
-		 * or automatically in response to creating a bond master, it will also
-		 * create a 'bond0' interface.  Since the bond we're about to create may
-		 * or may not be named 'bond0' prevent potential confusion about a bond
-		 * that the user didn't want by telling the bonding module not to create
-		 * bond0 automatically.
-		 */
-		if (!g_file_test ("/sys/class/net/bonding_masters", G_FILE_TEST_EXISTS))
-			(void) nm_utils_modprobe (NULL, TRUE, "bonding", "max_bonds=0", NULL);
-	}
+/* How long to wait for the kernel to acknowledge an asynchronous request.
+ * This is longer than for the synchronous requests, because the response
+ * is only read once the mainloop gets around to it. */
+#define CHANGE_LINK_ASYNC_TIMEOUT_MSEC 2000
 
-	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
-	                          NLM_F_CREATE | NLM_F_EXCL,
-	                          0,
-	                          name);
-	if (!nlmsg)
-		return -NME_UNSPEC;
+static void
+_change_link_async_data_free (ChangeLinkAsyncData *data)
+{
+	nm_assert (c_list_is_empty (&data->change_link_async_lst));
 
-	if (address && address_len)
-		NLA_PUT (nlmsg, IFLA_ADDRESS, address_len, address);
+	nm_clear_g_source (&data->timeout_id);
+	nm_clear_pointer (&data->nlmsg, nlmsg_free);
+	g_clear_object (&data->cancellable);
+	g_free (data->errmsg);
+	nm_g_slice_free (data);
+}
 
-	if (!_nl_msg_new_link_set_linkinfo (nlmsg, type, veth_peer))
-		return -NME_UNSPEC;
+static gboolean
+_change_link_async_timeout_cb (gpointer user_data)
+{
+	ChangeLinkAsyncData *data = user_data;
 
-	return do_add_link_with_lookup (platform, type, name, nlmsg, out_link);
-nla_put_failure:
-	g_return_val_if_reached (-NME_BUG);
+	data->timeout_id = 0;
+	if (!data->seq_result)
+		data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_FAILED_TIMEOUT;
+	_change_link_async_schedule_complete (data->platform);
+	return G_SOURCE_REMOVE;
 }
 
-static gboolean
-link_delete (NMPlatform *platform, int ifindex)
+static void
+_change_link_async_send (NMPlatform *platform,
+                         ChangeLinkAsyncData *data)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-	NMPObject obj_id;
-	const NMPObject *obj;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	int nle;
 
-	obj = nmp_cache_lookup_link (nm_platform_get_cache (platform), ifindex);
-	if (!obj || !obj->_link.netlink.is_in_netlink)
-		return FALSE;
+	nm_assert (data->nlmsg);
+	nm_assert (data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN);
+	nm_assert (!data->timeout_id);
 
-	nlmsg = _nl_msg_new_link (RTM_DELLINK,
-	                          0,
-	                          ifindex,
-	                          NULL);
+	/* the socket is already bound to the right namespace, there is
+	 * no need to switch namespaces just to send the request. */
+	data->seq_number = _nlh_seq_next_get (priv);
+	nlmsg_hdr (data->nlmsg)->nlmsg_seq = data->seq_number;
 
-	nmp_object_stackinit_id_link (&obj_id, ifindex);
-	return do_delete_object (platform, &obj_id, nlmsg);
-}
+	nle = nl_send_auto (priv->nlh, data->nlmsg);
+	if (nle < 0) {
+		_LOGD ("do-change-link-async[%d]: failure sending netlink request: %s (%d)",
+		       data->ifindex,
+		       nm_strerror (nle), -nle);
+		data->seq_number = 0;
+		data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN;
+		_change_link_async_schedule_complete (platform);
+		return;
+	}
 
-static gboolean
-link_refresh (NMPlatform *platform, int ifindex)
-{
-	do_request_link (platform, ifindex, NULL);
-	return !!nm_platform_link_get_obj (platform, ifindex, TRUE);
+	data->timeout_id = g_timeout_add (CHANGE_LINK_ASYNC_TIMEOUT_MSEC,
+	                                  _change_link_async_timeout_cb,
+	                                  data);
 }
 
-static gboolean
-link_set_netns (NMPlatform *platform,
-                int ifindex,
-                int netns_fd)
+static void
+_change_link_async_invoke_idle_cb (gpointer user_data,
+                                   GCancellable *cancellable)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+	gs_free_error GError *error = NULL;
+	GError *cancelled_error = NULL;
 
-	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
-	                          0,
-	                          ifindex,
-	                          NULL);
-	if (!nlmsg)
-		return FALSE;
+	nm_utils_user_data_unpack (user_data, &callback, &callback_data, &error);
 
-	NLA_PUT (nlmsg, IFLA_NET_NS_FD, 4, &netns_fd);
-	return (do_change_link (platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
+	if (g_cancellable_set_error_if_cancelled (cancellable, &cancelled_error)) {
+		g_clear_error (&error);
+		error = cancelled_error;
+	}
 
-nla_put_failure:
-	g_return_val_if_reached (FALSE);
+	callback (error, callback_data);
 }
 
-static int
-link_change_flags (NMPlatform *platform,
-                   int ifindex,
-                   unsigned flags_mask,
-                   unsigned flags_set)
+static void
+_change_link_async_invoke (NMPlatform *platform,
+                           ChangeLinkAsyncData *data,
+                           gboolean on_idle)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-	char s_flags[100];
+	gs_free_error GError *error = NULL;
+	NMLogLevel log_level;
+	const char *log_result;
+	const char *log_detail;
+	char s_buf[256];
+	int r;
 
-	_LOGD ("link: change %d: flags: set 0x%x/0x%x ([%s] / [%s])",
-	       ifindex,
-	       flags_set,
-	       flags_mask,
-	       nm_platform_link_flags2str (flags_set, s_flags, sizeof (s_flags)),
+	r = _change_link_result_to_nmerr (platform,
+	                                  data->change_link_type,
+	                                  data->ifindex,
+	                                  data->seq_result,
+	                                  NULL,
+	                                  &log_level,
+	                                  &log_result,
+	                                  &log_detail);
+	_NMLOG (log_level,
+	        "do-change-link-async[%d]: %s changing link: %s%s",
+	        data->ifindex,
+	        log_result,
+	        wait_for_nl_response_to_string (data->seq_result, data->errmsg, s_buf, sizeof (s_buf)),
+	        log_detail);
+
+	if (   !g_cancellable_set_error_if_cancelled (data->cancellable, &error)
+	    && r < 0) {
+		g_set_error (&error,
+		             NM_UTILS_ERROR,
+		             NM_UTILS_ERROR_UNKNOWN,
+		             "failure changing link %d: %s",
+		             data->ifindex,
+		             nm_strerror (r));
+	}
+
+	if (data->callback) {
+		if (on_idle) {
+			/* the platform instance is going away. Still, don't invoke
+			 * the callback synchronously from the caller's context. */
+			nm_utils_invoke_on_idle (_change_link_async_invoke_idle_cb,
+			                         nm_utils_user_data_pack (data->callback,
+			                                                  data->callback_data,
+			                                                  g_steal_pointer (&error)),
+			                         data->cancellable);
+		} else
+			data->callback (error, data->callback_data);
+	}
+
+	_change_link_async_data_free (data);
+}
+
+static void
+_change_link_async_complete_all (NMPlatform *platform,
+                                 WaitForNlResponseResult force_result)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	CList lst_done = C_LIST_INIT (lst_done);
+	ChangeLinkAsyncData *data;
+	ChangeLinkAsyncData *data_safe;
+
+	c_list_for_each_entry_safe (data, data_safe, &priv->change_link_async.lst_head, change_link_async_lst) {
+		if (data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			if (force_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN)
+				continue;
+			data->seq_result = force_result;
+		}
+
+		nm_clear_g_source (&data->timeout_id);
+
+		if (   force_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN
+		    && NM_IN_SET (-((int) data->seq_result), EOPNOTSUPP)
+		    && nlmsg_hdr (data->nlmsg)->nlmsg_type == RTM_NEWLINK) {
+			/* like do_change_link(), retry with RTM_SETLINK. */
+			nlmsg_hdr (data->nlmsg)->nlmsg_type = RTM_SETLINK;
+			data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+			nm_clear_g_free (&data->errmsg);
+			_change_link_async_send (platform, data);
+			continue;
+		}
+
+		c_list_unlink (&data->change_link_async_lst);
+		c_list_link_tail (&lst_done, &data->change_link_async_lst);
+	}
+
+	/* invoke the callbacks only after iterating the list, they might
+	 * well start new requests. When disposing, they are invoked later
+	 * from an idle handler, like any other completion. */
+	while ((data = c_list_first_entry (&lst_done, ChangeLinkAsyncData, change_link_async_lst))) {
+		c_list_unlink (&data->change_link_async_lst);
+		_change_link_async_invoke (platform,
+		                           data,
+		                           force_result == WAIT_FOR_NL_RESPONSE_RESULT_FAILED_DISPOSING);
+	}
+}
+
+static gboolean
+_change_link_async_complete_cb (gpointer user_data)
+{
+	NMPlatform *platform = user_data;
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	priv->change_link_async.idle_id = 0;
+	_change_link_async_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+_change_link_async_schedule_complete (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	/* never invoke the callbacks synchronously. We might be called while
+	 * reading netlink events, somewhere deep inside a platform operation. */
+	if (!priv->change_link_async.idle_id)
+		priv->change_link_async.idle_id = g_idle_add (_change_link_async_complete_cb, platform);
+}
+
+static void
+_change_link_async_fail_all (NMPlatform *platform,
+                             WaitForNlResponseResult seq_result)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	ChangeLinkAsyncData *data;
+	gboolean any = FALSE;
+
+	c_list_for_each_entry (data, &priv->change_link_async.lst_head, change_link_async_lst) {
+		if (data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			data->seq_result = seq_result;
+			any = TRUE;
+		}
+	}
+	if (any)
+		_change_link_async_schedule_complete (platform);
+}
+
+static void
+_change_link_async (NMPlatform *platform,
+                    ChangeLinkType change_link_type,
+                    int ifindex,
+                    struct nl_msg *nlmsg,
+                    NMPlatformAsyncCallback callback,
+                    gpointer callback_data,
+                    GCancellable *cancellable)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	ChangeLinkAsyncData *data;
+
+	data = g_slice_new (ChangeLinkAsyncData);
+	*data = (ChangeLinkAsyncData) {
+		.platform         = platform,
+		.nlmsg            = nlmsg,
+		.cancellable      = nm_g_object_ref (cancellable),
+		.callback         = callback,
+		.callback_data    = callback_data,
+		.change_link_type = change_link_type,
+		.ifindex          = ifindex,
+	};
+	c_list_link_tail (&priv->change_link_async.lst_head, &data->change_link_async_lst);
+
+	if (!nlmsg) {
+		data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN;
+		_change_link_async_schedule_complete (platform);
+		return;
+	}
+
+	_change_link_async_send (platform, data);
+}
+
+/*****************************************************************************/
+
+static int
+link_add (NMPlatform *platform,
+          const char *name,
+          NMLinkType type,
+          const char *veth_peer,
+          const void *address,
+          size_t address_len,
+          const NMPlatformLink **out_link)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	if (type == NM_LINK_TYPE_BOND) {
+		/* When the kernel loads the bond module, either via explicit modprobe
+		 * or automatically in response to creating a bond master, it will also
+		 * create a 'bond0' interface.  Since the bond we're about to create may
+		 * or may not be named 'bond0' prevent potential confusion about a bond
+		 * that the user didn't want by telling the bonding module not to create
+		 * bond0 automatically.
+		 */
+		if (!g_file_test ("/sys/class/net/bonding_masters", G_FILE_TEST_EXISTS))
+			(void) nm_utils_modprobe (NULL, TRUE, "bonding", "max_bonds=0", NULL);
+	}
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          NLM_F_CREATE | NLM_F_EXCL,
+	                          0,
+	                          name);
+	if (!nlmsg)
+		return -NME_UNSPEC;
+
+	if (address && address_len)
+		NLA_PUT (nlmsg, IFLA_ADDRESS, address_len, address);
+
+	if (!_nl_msg_new_link_set_linkinfo (nlmsg, type, veth_peer))
+		return -NME_UNSPEC;
+
+	return do_add_link_with_lookup (platform, type, name, nlmsg, out_link);
+nla_put_failure:
+	g_return_val_if_reached (-NME_BUG);
+}
+
+static gboolean
+link_delete (NMPlatform *platform, int ifindex)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NMPObject obj_id;
+	const NMPObject *obj;
+
+	obj = nmp_cache_lookup_link (nm_platform_get_cache (platform), ifindex);
+	if (!obj || !obj->_link.netlink.is_in_netlink)
+		return FALSE;
+
+	nlmsg = _nl_msg_new_link (RTM_DELLINK,
+	                          0,
+	                          ifindex,
+	                          NULL);
+
+	nmp_object_stackinit_id_link (&obj_id, ifindex);
+	return do_delete_object (platform, &obj_id, nlmsg);
+}
+
+static gboolean
+link_refresh (NMPlatform *platform, int ifindex)
+{
+	do_request_link (platform, ifindex, NULL);
+	return !!nm_platform_link_get_obj (platform, ifindex, TRUE);
+}
+
+static gboolean
+link_set_netns (NMPlatform *platform,
+                int ifindex,
+                int netns_fd)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          0,
+	                          ifindex,
+	                          NULL);
+	if (!nlmsg)
+		return FALSE;
+
+	NLA_PUT (nlmsg, IFLA_NET_NS_FD, 4, &netns_fd);
+	return (do_change_link (platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
+
+nla_put_failure:
+	g_return_val_if_reached (FALSE);
+}
+
+static int
+link_change_flags (NMPlatform *platform,
+                   int ifindex,
+                   unsigned flags_mask,
+                   unsigned flags_set)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	char s_flags[100];
+
+	_LOGD ("link: change %d: flags: set 0x%x/0x%x ([%s] / [%s])",
+	       ifindex,
+	       flags_set,
+	       flags_mask,
+	       nm_platform_link_flags2str (flags_set, s_flags, sizeof (s_flags)),
 	       nm_platform_link_flags2str (flags_mask, NULL, 0));
 
 	nlmsg = _nl_msg_new_link_full (RTM_NEWLINK,
@@ -6615,6 +7681,30 @@ link_set_up (NMPlatform *platform, int ifindex, gboolean *out_no_firmware)
 	return r >= 0;
 }
 
+static void
+link_set_up_async (NMPlatform *platform,
+                   int ifindex,
+                   NMPlatformAsyncCallback callback,
+                   gpointer callback_data,
+                   GCancellable *cancellable)
+{
+	_LOGD ("link: change %d: flags: set up (async)", ifindex);
+
+	_change_link_async (platform,
+	                    CHANGE_LINK_TYPE_UNSPEC,
+	                    ifindex,
+	                    _nl_msg_new_link_full (RTM_NEWLINK,
+	                                           0,
+	                                           ifindex,
+	                                           NULL,
+	                                           AF_UNSPEC,
+	                                           IFF_UP,
+	                                           IFF_UP),
+	                    callback,
+	                    callback_data,
+	                    cancellable);
+}
+
 static gboolean
 link_set_down (NMPlatform *platform, int ifindex)
 {
@@ -7063,17 +8153,18 @@ nla_put_failure:
 }
 
 static gboolean
-link_set_bridge_vlans (NMPlatform *platform,
-                       int ifindex,
-                       gboolean on_master,
-                       const NMPlatformBridgeVlan *const *vlans)
+_link_change_bridge_vlans (NMPlatform *platform,
+                           int ifindex,
+                           gboolean on_master,
+                           gboolean is_del,
+                           const NMPlatformBridgeVlan *const *vlans)
 {
 	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
 	struct nlattr *list;
 	struct bridge_vlan_info vinfo = { };
 	guint i;
 
-	nlmsg = _nl_msg_new_link_full (vlans ? RTM_SETLINK : RTM_DELLINK,
+	nlmsg = _nl_msg_new_link_full (is_del ? RTM_DELLINK : RTM_SETLINK,
 	                               0,
 	                               ifindex,
 	                               NULL,
@@ -7091,7 +8182,6 @@ link_set_bridge_vlans (NMPlatform *platform,
 	             on_master ? BRIDGE_FLAGS_MASTER : BRIDGE_FLAGS_SELF);
 
 	if (vlans) {
-		/* Add VLANs */
 		for (i = 0; vlans[i]; i++) {
 			const NMPlatformBridgeVlan *vlan = vlans[i];
 			gboolean is_range = vlan->vid_start != vlan->vid_end;
@@ -7113,6 +8203,8 @@ link_set_bridge_vlans (NMPlatform *platform,
 			}
 		}
 	} else {
+		nm_assert (is_del);
+
 		/* Flush existing VLANs */
 		vinfo.vid = 1;
 		vinfo.flags = BRIDGE_VLAN_INFO_RANGE_BEGIN;
@@ -7130,6 +8222,278 @@ nla_put_failure:
 	g_return_val_if_reached (FALSE);
 }
 
+static gboolean
+link_set_bridge_vlans (NMPlatform *platform,
+                       int ifindex,
+                       gboolean on_master,
+                       const NMPlatformBridgeVlan *const *vlans)
+{
+	return _link_change_bridge_vlans (platform, ifindex, on_master, !vlans, vlans);
+}
+
+static gboolean
+link_del_bridge_vlans (NMPlatform *platform,
+                       int ifindex,
+                       gboolean on_master,
+                       const NMPlatformBridgeVlan *const *vlans)
+{
+	g_return_val_if_fail (vlans, FALSE);
+
+	return _link_change_bridge_vlans (platform, ifindex, on_master, TRUE, vlans);
+}
+
+static void
+_bridge_vlans_parse_vlandb (BridgeVlansGetData *get_data,
+                            const struct nlmsghdr *nlh)
+{
+	static const struct nla_policy policy[] = {
+		[BRIDGE_VLANDB_ENTRY_INFO]  = { .minlen = sizeof (struct bridge_vlan_info) },
+		[BRIDGE_VLANDB_ENTRY_RANGE] = { .type = NLA_U16 },
+	};
+	const struct _br_vlan_msg *bvm;
+	struct nlattr *attr;
+	int remaining;
+
+	if (!nlmsg_valid_hdr (nlh, sizeof (*bvm)))
+		return;
+	bvm = nlmsg_data (nlh);
+	if (   bvm->family != AF_BRIDGE
+	    || bvm->ifindex != (guint32) get_data->ifindex)
+		return;
+
+	/* a large VLAN database can be split over several messages. */
+	get_data->found = TRUE;
+
+	nla_for_each_attr (attr, nlmsg_attrdata (nlh, sizeof (*bvm)), nlmsg_attrlen (nlh, sizeof (*bvm)), remaining) {
+		struct nlattr *tb[G_N_ELEMENTS (policy)];
+		const struct bridge_vlan_info *vinfo;
+		guint16 vid_end;
+
+		if (nla_type (attr) != BRIDGE_VLANDB_ENTRY)
+			continue;
+
+		if (   nla_parse_nested_arr (tb, attr, policy) < 0
+		    || !tb[BRIDGE_VLANDB_ENTRY_INFO]) {
+			get_data->invalid = TRUE;
+			return;
+		}
+
+		vinfo = nla_data (tb[BRIDGE_VLANDB_ENTRY_INFO]);
+		vid_end =   tb[BRIDGE_VLANDB_ENTRY_RANGE]
+		          ? nla_get_u16 (tb[BRIDGE_VLANDB_ENTRY_RANGE])
+		          : vinfo->vid;
+		if (vid_end < vinfo->vid) {
+			get_data->invalid = TRUE;
+			return;
+		}
+
+		g_array_append_val (get_data->vlans,
+		                    ((NMPlatformBridgeVlan) {
+		                        .vid_start = vinfo->vid,
+		                        .vid_end   = vid_end,
+		                        .untagged  = NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_UNTAGGED),
+		                        .pvid      = NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_PVID),
+		                    }));
+	}
+}
+
+static void
+_bridge_vlans_parse_link (BridgeVlansGetData *get_data,
+                          const struct nlmsghdr *nlh)
+{
+	static const struct nla_policy policy[] = {
+		[IFLA_AF_SPEC]          = { .type = NLA_NESTED },
+	};
+	struct nlattr *tb[G_N_ELEMENTS (policy)];
+	const struct ifinfomsg *ifi;
+	NMPlatformBridgeVlan range = { };
+	gboolean in_range = FALSE;
+	struct nlattr *attr;
+	int remaining;
+
+	if (!nlmsg_valid_hdr (nlh, sizeof (*ifi)))
+		return;
+	ifi = nlmsg_data (nlh);
+	if (   ifi->ifi_family != AF_BRIDGE
+	    || ifi->ifi_index != get_data->ifindex)
+		return;
+
+	/* the dump might contain a message for the port and for the port's "self"
+	 * entry. Only take the first. */
+	if (get_data->found)
+		return;
+	get_data->found = TRUE;
+
+	if (nlmsg_parse_arr (nlh, sizeof (*ifi), tb, policy) < 0) {
+		get_data->invalid = TRUE;
+		return;
+	}
+	if (!tb[IFLA_AF_SPEC])
+		return;
+
+	nla_for_each_nested (attr, tb[IFLA_AF_SPEC], remaining) {
+		const struct bridge_vlan_info *vinfo;
+
+		if (nla_type (attr) != IFLA_BRIDGE_VLAN_INFO)
+			continue;
+		if (nla_len (attr) < (int) sizeof (*vinfo)) {
+			get_data->invalid = TRUE;
+			return;
+		}
+		vinfo = nla_data (attr);
+
+		if (NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_RANGE_END)) {
+			if (!in_range) {
+				get_data->invalid = TRUE;
+				return;
+			}
+			range.vid_end = vinfo->vid;
+			g_array_append_val (get_data->vlans, range);
+			in_range = FALSE;
+			continue;
+		}
+
+		range = (NMPlatformBridgeVlan) {
+			.vid_start = vinfo->vid,
+			.vid_end   = vinfo->vid,
+			.untagged  = NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_UNTAGGED),
+			.pvid      = NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_PVID),
+		};
+		if (NM_FLAGS_HAS (vinfo->flags, BRIDGE_VLAN_INFO_RANGE_BEGIN))
+			in_range = TRUE;
+		else
+			g_array_append_val (get_data->vlans, range);
+	}
+
+	if (in_range)
+		get_data->invalid = TRUE;
+}
+
+static void
+_bridge_vlans_handle_response (NMPlatform *platform,
+                               const struct nlmsghdr *nlh)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	BridgeVlansGetData *get_data = NULL;
+	guint i;
+
+	if (!NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE))
+		return;
+
+	for (i = 0; i < priv->delayed_action.list_wait_for_nl_response->len; i++) {
+		DelayedActionWaitForNlResponseData *data = &g_array_index (priv->delayed_action.list_wait_for_nl_response, DelayedActionWaitForNlResponseData, i);
+
+		if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_BRIDGE_VLANS
+		    && data->seq_number == nlh->nlmsg_seq
+		    && data->response.out_bridge_vlans) {
+			get_data = data->response.out_bridge_vlans;
+			break;
+		}
+	}
+	if (!get_data)
+		return;
+
+	if (get_data->use_vlandb) {
+		if (nlh->nlmsg_type == RTM_NEWVLAN)
+			_bridge_vlans_parse_vlandb (get_data, nlh);
+	} else {
+		if (nlh->nlmsg_type == RTM_NEWLINK)
+			_bridge_vlans_parse_link (get_data, nlh);
+	}
+}
+
+static gboolean
+link_get_bridge_vlans (NMPlatform *platform,
+                       int ifindex,
+                       NMPlatformBridgeVlan **out_vlans,
+                       guint *out_len)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	gs_unref_array GArray *vlans = NULL;
+	int try_count = 0;
+	WaitForNlResponseResult seq_result;
+	BridgeVlansGetData get_data;
+	int nle;
+
+	vlans = g_array_new (FALSE, FALSE, sizeof (NMPlatformBridgeVlan));
+
+	do {
+		struct {
+			struct nlmsghdr n;
+			union {
+				struct ifinfomsg i;
+				struct _br_vlan_msg v;
+			};
+			char buf[64];
+		} req = {
+			.n.nlmsg_flags = NLM_F_DUMP,
+		};
+		gboolean use_vlandb = !priv->bridge_vlandb_unsupported;
+
+		if (use_vlandb) {
+			/* The VLAN database dump can be filtered by ifindex. */
+			req.n.nlmsg_len = NLMSG_LENGTH (sizeof (struct _br_vlan_msg));
+			req.n.nlmsg_type = RTM_GETVLAN;
+			req.v = (struct _br_vlan_msg) {
+				.family  = AF_BRIDGE,
+				.ifindex = ifindex,
+			};
+		} else {
+			guint32 ext_mask = RTEXT_FILTER_BRVLAN_COMPRESSED;
+
+			/* Older kernels only support dumping the VLANs of all bridge
+			 * ports. They ignore the ifindex in the request, so we filter
+			 * the response. */
+			req.n.nlmsg_len = NLMSG_LENGTH (sizeof (struct ifinfomsg));
+			req.n.nlmsg_type = RTM_GETLINK;
+			req.i.ifi_family = AF_BRIDGE;
+			if (!_nl_addattr_l (&req.n, sizeof (req), IFLA_EXT_MASK, &ext_mask, sizeof (ext_mask)))
+				nm_assert_not_reached ();
+		}
+
+		g_array_set_size (vlans, 0);
+		get_data = (BridgeVlansGetData) {
+			.ifindex    = ifindex,
+			.vlans      = vlans,
+			.use_vlandb = use_vlandb,
+		};
+
+		seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+		nle = _nl_send_nlmsghdr (platform, &req.n, &seq_result, NULL, DELAYED_ACTION_RESPONSE_TYPE_BRIDGE_VLANS, &get_data);
+		if (nle < 0) {
+			_LOGE ("get-bridge-vlans: failure sending netlink request \"%s\" (%d)",
+			       nm_strerror_native (-nle), -nle);
+			return FALSE;
+		}
+
+		delayed_action_handle_all (platform, FALSE);
+
+		if (   use_vlandb
+		    && -((int) seq_result) == EOPNOTSUPP) {
+			_LOGD ("get-bridge-vlans: RTM_GETVLAN not supported, dump all bridge ports instead");
+			priv->bridge_vlandb_unsupported = TRUE;
+			continue;
+		}
+
+		/* Retry, if we failed due to a cache resync. That can happen when the netlink
+		 * socket fills up and we lost the response. */
+		if (seq_result != WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC)
+			break;
+	} while (++try_count < 10);
+
+	if (   seq_result != WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	    || (   !get_data.use_vlandb
+	        && !get_data.found)
+	    || get_data.invalid) {
+		_LOGD ("get-bridge-vlans: failed to read VLANs of link %d", ifindex);
+		return FALSE;
+	}
+
+	*out_len = vlans->len;
+	*out_vlans = (NMPlatformBridgeVlan *) g_array_free (g_steal_pointer (&vlans), FALSE);
+	return TRUE;
+}
+
 static char *
 link_get_physical_port_id (NMPlatform *platform, int ifindex)
 {
@@ -7834,6 +9198,46 @@ link_vlan_change (NMPlatform *platform,
 	return (do_change_link (platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
 }
 
+static gboolean
+link_bond_change (NMPlatform *platform,
+                  int ifindex,
+                  const NMPlatformLnkBond *props,
+                  NMPlatformLnkBondAttrs attrs)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	if (attrs == NM_PLATFORM_LNK_BOND_ATTR_NONE)
+		return TRUE;
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          0,
+	                          ifindex,
+	                          NULL);
+	if (   !nlmsg
+	    || !_nl_msg_new_link_set_linkinfo_bond (nlmsg, props, attrs))
+		g_return_val_if_reached (FALSE);
+
+	return (do_change_link (platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
+}
+
+static gboolean
+link_bridge_change (NMPlatform *platform,
+                    int ifindex,
+                    const NMPlatformLnkBridge *props)
+{
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+
+	nlmsg = _nl_msg_new_link (RTM_NEWLINK,
+	                          0,
+	                          ifindex,
+	                          NULL);
+	if (   !nlmsg
+	    || !_nl_msg_new_link_set_linkinfo_bridge (nlmsg, props))
+		g_return_val_if_reached (FALSE);
+
+	return (do_change_link (platform, CHANGE_LINK_TYPE_UNSPEC, ifindex, nlmsg, NULL) >= 0);
+}
+
 static gboolean
 link_enslave (NMPlatform *platform, int master, int slave)
 {
@@ -8357,6 +9761,9 @@ object_delete (NMPlatform *platform,
 	case NMP_OBJECT_TYPE_TFILTER:
 		nlmsg = _nl_msg_new_tfilter (RTM_DELTFILTER, 0, NMP_OBJECT_CAST_TFILTER (obj));
 		break;
+	case NMP_OBJECT_TYPE_NEXTHOP:
+		nlmsg = _nl_msg_new_nexthop (RTM_DELNEXTHOP, 0, NMP_OBJECT_CAST_NEXTHOP (obj));
+		break;
 	default:
 		break;
 	}
@@ -8488,6 +9895,47 @@ routing_rule_add (NMPlatform *platform,
 
 /*****************************************************************************/
 
+static int
+nexthop_add (NMPlatform *platform,
+             NMPNlmFlags flags,
+             const NMPlatformNexthop *nexthop)
+{
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	nm_auto_nlmsg struct nl_msg *msg = NULL;
+	gs_free char *errmsg = NULL;
+	char s_buf[256];
+	int nle;
+
+	msg = _nl_msg_new_nexthop (RTM_NEWNEXTHOP, flags, nexthop);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_nlmsg (platform, msg, &seq_result, &errmsg, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	if (nle < 0) {
+		_LOGE ("do-add-nexthop: failed sending netlink request \"%s\" (%d)",
+		      nm_strerror (nle), -nle);
+		return -NME_PL_NETLINK;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	nm_assert (seq_result);
+
+	_NMLOG (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	            ? LOGL_DEBUG
+	            : LOGL_WARN,
+	        "do-add-nexthop: %s",
+	        wait_for_nl_response_to_string (seq_result, errmsg, s_buf, sizeof (s_buf)));
+
+	if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK)
+		return 0;
+	if (seq_result < 0)
+		return seq_result;
+	return -NME_UNSPEC;
+}
+
+/*****************************************************************************/
+
 static int
 qdisc_add (NMPlatform *platform,
            NMPNlmFlags flags,
@@ -8573,6 +10021,111 @@ tfilter_add (NMPlatform *platform,
 	return -NME_UNSPEC;
 }
 
+static gboolean
+tc_change_batch (NMPlatform *platform,
+                 const NMPlatformTcChange *changes,
+                 guint n_changes)
+{
+	gs_free WaitForNlResponseResult *seq_results = NULL;
+	gs_free char **errmsgs = NULL;
+	const NMPObject *refetch_obj = NULL;
+	gboolean qdisc_deleted = FALSE;
+	gboolean success = TRUE;
+	char s_buf[256];
+	guint i;
+
+	/* Send all requests first and only then wait for the acks. Kernel
+	 * handles the requests in order, so deletions that precede additions
+	 * are done by the time the additions are processed. */
+
+	seq_results = g_new0 (WaitForNlResponseResult, n_changes);
+	errmsgs = g_new0 (char *, n_changes);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	for (i = 0; i < n_changes; i++) {
+		const NMPlatformTcChange *change = &changes[i];
+		nm_auto_nlmsg struct nl_msg *msg = NULL;
+		int nle;
+
+		nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (change->obj), NMP_OBJECT_TYPE_QDISC,
+		                                                         NMP_OBJECT_TYPE_TFILTER));
+
+		_LOGD ("tc-batch: %s %s",
+		       change->is_delete ? "delete" : "add",
+		       nmp_object_to_string (change->obj, NMP_OBJECT_TO_STRING_PUBLIC, s_buf, sizeof (s_buf)));
+
+		if (NMP_OBJECT_GET_TYPE (change->obj) == NMP_OBJECT_TYPE_QDISC) {
+			msg = _nl_msg_new_qdisc (change->is_delete ? RTM_DELQDISC : RTM_NEWQDISC,
+			                         change->is_delete ? 0 : change->flags,
+			                         NMP_OBJECT_CAST_QDISC (change->obj));
+		} else {
+			msg = _nl_msg_new_tfilter (change->is_delete ? RTM_DELTFILTER : RTM_NEWTFILTER,
+			                           change->is_delete ? 0 : change->flags,
+			                           NMP_OBJECT_CAST_TFILTER (change->obj));
+		}
+
+		nle = _nl_send_nlmsg (platform, msg, &seq_results[i], &errmsgs[i], DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+		if (nle < 0) {
+			_LOGE ("tc-batch: failed sending netlink request \"%s\" (%d)",
+			       nm_strerror (nle), -nle);
+			seq_results[i] = WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC;
+		}
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	for (i = 0; i < n_changes; i++) {
+		const NMPlatformTcChange *change = &changes[i];
+		gboolean ok;
+
+		nm_assert (seq_results[i]);
+
+		ok = (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK);
+		if (   !ok
+		    && change->is_delete
+		    && NM_IN_SET (-((int) seq_results[i]), ESRCH, ENOENT)) {
+			/* the object was already removed. */
+			ok = TRUE;
+		}
+
+		_NMLOG (ok ? LOGL_DEBUG : LOGL_WARN,
+		        "tc-batch: %s %s[%s]: %s",
+		        change->is_delete ? "delete" : "add",
+		        NMP_OBJECT_GET_CLASS (change->obj)->obj_type_name,
+		        nmp_object_to_string (change->obj, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		        wait_for_nl_response_to_string (seq_results[i], errmsgs[i], s_buf, sizeof (s_buf)));
+
+		nm_clear_g_free (&errmsgs[i]);
+
+		if (!ok)
+			success = FALSE;
+
+		if (   change->is_delete
+		    && NMP_OBJECT_GET_TYPE (change->obj) == NMP_OBJECT_TYPE_QDISC)
+			qdisc_deleted = TRUE;
+
+		/* See do_delete_object(): the object might still be there after
+		 * the ACK. */
+		if (   change->is_delete
+		    && nmp_cache_lookup_obj (nm_platform_get_cache (platform), change->obj))
+			refetch_obj = change->obj;
+	}
+
+	if (qdisc_deleted) {
+		/* Kernel silently drops the qdiscs and tfilters that were attached
+		 * to a deleted qdisc. Dump them again, so that the next sync sees
+		 * them missing and adds them back. */
+		do_request_all_no_delayed_actions (platform,
+		                                     DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS
+		                                   | DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS);
+		delayed_action_handle_all (platform, FALSE);
+	} else if (refetch_obj)
+		do_request_one_type_by_needle_object (platform, refetch_obj);
+
+	return success;
+}
+
 /*****************************************************************************/
 
 #define EVENT_CONDITIONS      ((GIOCondition) (G_IO_IN | G_IO_PRI))
@@ -8605,11 +10158,33 @@ event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
 	struct sockaddr_nl nla = {0};
 	struct ucred creds;
 	gboolean creds_has;
-	nm_auto_free unsigned char *buf = NULL;
+	unsigned char *buf = NULL;
+	gboolean recv_buf_acquired = FALSE;
+
+	if (!priv->netlink_recv_buf.in_use) {
+		priv->netlink_recv_buf.in_use = TRUE;
+		recv_buf_acquired = TRUE;
+	}
 
 continue_reading:
-	g_clear_pointer (&buf, free);
-	n = nl_recv (sk, &nla, &buf, &creds, &creds_has);
+	if (buf != priv->netlink_recv_buf.buf)
+		g_free (buf);
+	buf = NULL;
+
+	if (   recv_buf_acquired
+	    && priv->netlink_recv_buf.len < nl_socket_get_msg_buf_size (sk)) {
+		priv->netlink_recv_buf.len = nl_socket_get_msg_buf_size (sk);
+		g_free (priv->netlink_recv_buf.buf);
+		priv->netlink_recv_buf.buf = g_malloc (priv->netlink_recv_buf.len);
+	}
+
+	n = nl_recv (sk,
+	             recv_buf_acquired ? priv->netlink_recv_buf.buf : NULL,
+	             recv_buf_acquired ? priv->netlink_recv_buf.len : 0,
+	             &nla,
+	             &buf,
+	             &creds,
+	             &creds_has);
 
 	if (n <= 0) {
 
@@ -8629,22 +10204,24 @@ continue_reading:
 			}
 		}
 
+		if (recv_buf_acquired)
+			priv->netlink_recv_buf.in_use = FALSE;
 		return n;
 	}
 
 	hdr = (struct nlmsghdr *) buf;
 	while (nlmsg_ok (hdr, n)) {
-		nm_auto_nlmsg struct nl_msg *msg = NULL;
 		gboolean abort_parsing = FALSE;
 		gboolean process_valid_msg = FALSE;
 		guint32 seq_number;
 		char buf_nlmsghdr[400];
 		const char *extack_msg = NULL;
-
-		msg = nlmsg_alloc_convert (hdr);
-
-		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
+		const struct nl_msg_lite msg = {
+			.nm_protocol = NETLINK_ROUTE,
+			.nm_src      = &nla,
+			.nm_creds    = creds_has ? &creds : NULL,
+			.nm_nlh      = hdr,
+		};
 
 		if (!creds_has || creds.pid) {
 			if (!creds_has)
@@ -8658,8 +10235,6 @@ continue_reading:
 		_LOGt ("netlink: recvmsg: new message %s",
 		       nl_nlmsghdr_to_str (hdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
 
-		nlmsg_set_creds (msg, &creds);
-
 		if (hdr->nlmsg_flags & NLM_F_MULTI)
 			multipart = TRUE;
 
@@ -8735,14 +10310,14 @@ continue_reading:
 				       nm_strerror_native (errsv),
 				       errsv,
 				       NM_PRINT_FMT_QUOTED (extack_msg, " \"", extack_msg, "\"", ""),
-				       nlmsg_hdr (msg)->nlmsg_seq);
+				       hdr->nlmsg_seq);
 				seq_result = -NM_ERRNO_NATIVE (errsv);
 			} else
 				seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else
 			process_valid_msg = TRUE;
 
-		seq_number = nlmsg_hdr (msg)->nlmsg_seq;
+		seq_number = hdr->nlmsg_seq;
 
 		/* check whether the seq number is different from before, and
 		 * whether the previous number (@nlh_seq_last_seen) is a pending
@@ -8758,7 +10333,7 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
-			event_valid_msg (platform, msg, handle_events);
+			event_valid_msg (platform, &msg, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
@@ -8784,6 +10359,11 @@ stop:
 		goto continue_reading;
 	}
 
+	if (buf != priv->netlink_recv_buf.buf)
+		g_free (buf);
+	if (recv_buf_acquired)
+		priv->netlink_recv_buf.in_use = FALSE;
+
 	if (interrupted)
 		return -NME_NL_DUMP_INTR;
 	return err;
@@ -8839,6 +10419,8 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					event_handler_recvmsgs (platform, FALSE);
 					delayed_action_wait_for_nl_response_complete_all (platform,
 					                                                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
+					_change_link_async_fail_all (platform,
+					                             WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
 
 					delayed_action_schedule (platform,
 					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
@@ -8848,7 +10430,8 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
 					                         DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
 					                         DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+					                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS |
+					                         DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,
 					                         NULL);
 					break;
 				default:
@@ -9044,6 +10627,7 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
+	c_list_init (&priv->change_link_async.lst_head);
 }
 
 static void
@@ -9122,6 +10706,12 @@ constructed (GObject *_object)
 	                                 RTNLGRP_TC,
 	                                 0);
 	g_assert (!nle);
+
+	nle = nl_socket_add_memberships (priv->nlh,
+	                                 RTNLGRP_NEXTHOP,
+	                                 0);
+	if (nle)
+		_LOGD ("could not subscribe to nexthop notifications (%s)", nm_strerror (nle));
 	_LOGD ("Netlink socket for events established: port=%u, fd=%d", nl_socket_get_local_port (priv->nlh), nl_socket_get_fd (priv->nlh));
 
 	priv->event_channel = g_io_channel_unix_new (nl_socket_get_fd (priv->nlh));
@@ -9147,7 +10737,8 @@ constructed (GObject *_object)
 	                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES |
 	                         DELAYED_ACTION_TYPE_REFRESH_ALL_ROUTING_RULES_ALL |
 	                         DELAYED_ACTION_TYPE_REFRESH_ALL_QDISCS |
-	                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS,
+	                         DELAYED_ACTION_TYPE_REFRESH_ALL_TFILTERS |
+	                         DELAYED_ACTION_TYPE_REFRESH_ALL_NEXTHOPS,
 	                         NULL);
 
 	delayed_action_handle_all (platform, FALSE);
@@ -9208,6 +10799,11 @@ dispose (GObject *object)
 	delayed_action_wait_for_nl_response_complete_all (platform,
 	                                                  WAIT_FOR_NL_RESPONSE_RESULT_FAILED_DISPOSING);
 
+	nm_clear_g_source (&priv->change_link_async.idle_id);
+	_change_link_async_complete_all (platform,
+	                                 WAIT_FOR_NL_RESPONSE_RESULT_FAILED_DISPOSING);
+	nm_clear_g_source (&priv->change_link_async.idle_id);
+
 	priv->delayed_action.flags = DELAYED_ACTION_TYPE_NONE;
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
@@ -9230,6 +10826,8 @@ finalize (GObject *object)
 	g_io_channel_unref (priv->event_channel);
 	nl_socket_free (priv->nlh);
 
+	g_free (priv->netlink_recv_buf.buf);
+
 	if (priv->sysctl_get_prev_values) {
 		sysctl_clear_cache_list = g_slist_remove (sysctl_clear_cache_list, object);
 		g_hash_table_destroy (priv->sysctl_get_prev_values);
@@ -9262,6 +10860,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_set_netns = link_set_netns;
 
 	platform_class->link_set_up = link_set_up;
+	platform_class->link_set_up_async = link_set_up_async;
 	platform_class->link_set_down = link_set_down;
 	platform_class->link_set_arp = link_set_arp;
 	platform_class->link_set_noarp = link_set_noarp;
@@ -9278,6 +10877,8 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 	platform_class->link_set_sriov_params_async = link_set_sriov_params_async;
 	platform_class->link_set_sriov_vfs = link_set_sriov_vfs;
 	platform_class->link_set_bridge_vlans = link_set_bridge_vlans;
+	platform_class->link_del_bridge_vlans = link_del_bridge_vlans;
+	platform_class->link_get_bridge_vlans = link_get_bridge_vlans;
 
 	platform_class->link_get_physical_port_id = link_get_physical_port_id;
 	platform_class->link_get_dev_id = link_get_dev_id;
@@ -9295,6 +10896,8 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 
 	platform_class->vlan_add = vlan_add;
 	platform_class->link_vlan_change = link_vlan_change;
+	platform_class->link_bond_change = link_bond_change;
+	platform_class->link_bridge_change = link_bridge_change;
 	platform_class->link_wireguard_change = link_wireguard_change;
 	platform_class->link_vxlan_add = link_vxlan_add;
 
@@ -9345,8 +10948,10 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 
 	platform_class->routing_rule_add = routing_rule_add;
 
+	platform_class->nexthop_add = nexthop_add;
 	platform_class->qdisc_add = qdisc_add;
 	platform_class->tfilter_add = tfilter_add;
+	platform_class->tc_change_batch = tc_change_batch;
 
 	platform_class->process_events = process_events;
 }
@@ -106,6 +106,9 @@ nl_nlmsghdr_to_str (const struct nlmsghdr *hdr, char *buf, gsize len)
 	case RTM_GETTFILTER: s = "RTM_GETTFILTER";  break;
 	case RTM_NEWTFILTER: s = "RTM_NEWTFILTER";  break;
 	case RTM_DELTFILTER: s = "RTM_DELTFILTER";  break;
+	case RTM_GETNEXTHOP: s = "RTM_GETNEXTHOP";  break;
+	case RTM_NEWNEXTHOP: s = "RTM_NEWNEXTHOP";  break;
+	case RTM_DELNEXTHOP: s = "RTM_DELNEXTHOP";  break;
 	case NLMSG_NOOP:     s = "NLMSG_NOOP";      break;
 	case NLMSG_ERROR:    s = "NLMSG_ERROR";     break;
 	case NLMSG_DONE:     s = "NLMSG_DONE";      break;
@@ -154,6 +157,7 @@ nl_nlmsghdr_to_str (const struct nlmsghdr *hdr, char *buf, gsize len)
 	case RTM_NEWROUTE:
 	case RTM_NEWQDISC:
 	case RTM_NEWTFILTER:
+	case RTM_NEWNEXTHOP:
 		_F (NLM_F_REPLACE, "replace");
 		_F (NLM_F_EXCL, "excl");
 		_F (NLM_F_CREATE, "create");
@@ -164,6 +168,7 @@ nl_nlmsghdr_to_str (const struct nlmsghdr *hdr, char *buf, gsize len)
 	case RTM_GETROUTE:
 	case RTM_DELQDISC:
 	case RTM_DELTFILTER:
+	case RTM_GETNEXTHOP:
 		_F (NLM_F_DUMP, "dump");
 		_F (NLM_F_ROOT, "root");
 		_F (NLM_F_MATCH, "match");
@@ -1122,7 +1127,7 @@ nl_recvmsgs (struct nl_sock *sk, const struct nl_cb *cb)
 	gboolean creds_has;
 
 continue_reading:
-	n = nl_recv (sk, &nla, &buf, &creds, &creds_has);
+	n = nl_recv (sk, NULL, 0, &nla, &buf, &creds, &creds_has);
 	if (n <= 0)
 		return n;
 
@@ -1349,8 +1354,27 @@ int nl_send_auto (struct nl_sock *sk, struct nl_msg *msg)
 	return nl_send (sk, msg);
 }
 
+/**
+ * nl_recv:
+ * @sk: the netlink socket
+ * @buf0: (allow-none): a caller owned buffer for receiving the data
+ * @buf0_len: the size of @buf0
+ * @nla: the source address of the message
+ * @buf: (out): on success, the buffer with the received data
+ * @out_creds: (allow-none): the credentials of the sender
+ * @out_creds_has: whether @out_creds was set
+ *
+ * If @buf0 is large enough for the message, the data is received into it
+ * and @buf is set to @buf0. Otherwise, a new buffer is allocated that the
+ * caller must free. That allows to reuse one receive buffer instead of
+ * allocating a new one for each datagram.
+ *
+ * Returns: the number of bytes received or a negative error code.
+ */
 int
 nl_recv (struct nl_sock *sk,
+         unsigned char *buf0,
+         size_t buf0_len,
          struct sockaddr_nl *nla,
          unsigned char **buf,
          struct ucred *out_creds,
@@ -1381,7 +1405,12 @@ nl_recv (struct nl_sock *sk,
 
 	iov.iov_len =    sk->s_bufsize
 	              ?: (((size_t) nm_utils_getpagesize ()) * 4u);
-	iov.iov_base = g_malloc (iov.iov_len);
+	if (   buf0
+	    && buf0_len >= iov.iov_len) {
+		iov.iov_len = buf0_len;
+		iov.iov_base = buf0;
+	} else
+		iov.iov_base = g_malloc (iov.iov_len);
 
 	if (   out_creds
 	    && (sk->s_flags & NL_SOCK_PASSCRED)) {
@@ -1426,7 +1455,11 @@ retry:
 		/* Provided buffer is not long enough, enlarge it
 		 * to size of n (which should be total length of the message)
 		 * and try again. */
-		iov.iov_base = g_realloc (iov.iov_base, n);
+		if (iov.iov_base == buf0) {
+			iov.iov_base = g_malloc (n);
+			nm_assert (iov.iov_base != buf0);
+		} else
+			iov.iov_base = g_realloc (iov.iov_base, n);
 		iov.iov_len = n;
 		flags = 0;
 		goto retry;
@@ -1463,7 +1496,8 @@ abort:
 	g_free (msg.msg_control);
 
 	if (retval <= 0) {
-		g_free (iov.iov_base);
+		if (iov.iov_base != buf0)
+			g_free (iov.iov_base);
 		return retval;
 	}
 
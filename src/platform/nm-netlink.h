@@ -24,6 +24,13 @@
 #define NLM_F_ACK_TLVS                  0x200
 #endif
 
+/* Appeared in kernel 5.3 dated September 15, 2019 */
+#ifndef RTM_NEWNEXTHOP
+#define RTM_NEWNEXTHOP                  104
+#define RTM_DELNEXTHOP                  105
+#define RTM_GETNEXTHOP                  106
+#endif
+
 /*****************************************************************************/
 
 /* Basic attribute data types */
@@ -426,6 +433,16 @@ nlmsg_next (struct nlmsghdr *nlh, int *remaining)
 	return (struct nlmsghdr *) ((unsigned char *) nlh + totlen);
 }
 
+/* A lightweight, non-owning view of a received netlink message. Unlike
+ * struct nl_msg it can live on the stack and points into the receive
+ * buffer, so that received messages can be parsed in place, without copying. */
+struct nl_msg_lite {
+	int nm_protocol;
+	const struct sockaddr_nl *nm_src;
+	const struct ucred *nm_creds;
+	struct nlmsghdr *nm_nlh;
+};
+
 int nlmsg_get_proto (struct nl_msg *msg);
 void nlmsg_set_proto (struct nl_msg *msg, int protocol);
 
@@ -541,6 +558,8 @@ int nl_socket_add_memberships (struct nl_sock *sk, int group, ...);
 int nl_connect (struct nl_sock *sk, int protocol);
 
 int nl_recv (struct nl_sock *sk,
+             unsigned char *buf0,
+             size_t buf0_len,
              struct sockaddr_nl *nla,
              unsigned char **buf,
              struct ucred *out_creds,
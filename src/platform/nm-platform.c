@@ -19,6 +19,7 @@
 #include <linux/if_tun.h>
 #include <linux/if_tunnel.h>
 #include <linux/rtnetlink.h>
+#include <linux/pkt_sched.h>
 #include <linux/tc_act/tc_mirred.h>
 #include <libudev.h>
 
@@ -167,6 +168,7 @@ typedef struct _NMPlatformPrivate {
 	guint ip4_dev_route_blacklist_check_id;
 	guint ip4_dev_route_blacklist_gc_timeout_id;
 	GHashTable *ip4_dev_route_blacklist_hash;
+	GHashTable *ifindex_listeners;
 	NMDedupMultiIndex *multi_idx;
 	NMPCache *cache;
 } NMPlatformPrivate;
@@ -1780,6 +1782,221 @@ nm_platform_link_set_bridge_vlans (NMPlatform *self, int ifindex, gboolean on_ma
 	return klass->link_set_bridge_vlans (self, ifindex, on_master, vlans);
 }
 
+/**
+ * nm_platform_link_get_bridge_vlans:
+ * @self: platform instance
+ * @ifindex: the bridge or bridge port
+ * @out_vlans: (out) (transfer full): the VLANs of the link, as sorted
+ *   list of ranges with the same flags.
+ * @out_len: (out): the number of entries in @out_vlans
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_link_get_bridge_vlans (NMPlatform *self, int ifindex, NMPlatformBridgeVlan **out_vlans, guint *out_len)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (out_vlans, FALSE);
+	g_return_val_if_fail (out_len, FALSE);
+
+	if (!klass->link_get_bridge_vlans)
+		return FALSE;
+
+	return klass->link_get_bridge_vlans (self, ifindex, out_vlans, out_len);
+}
+
+/*
+ * _nm_platform_bridge_vlans_to_state:
+ * @state: array indexed by VID, with the NM_PLATFORM_BRIDGE_VLAN_STATE_*
+ *   flags of each VLAN. Index 0 is not a valid VID and stays unused.
+ * @pvid: (inout): the VID that currently has the PVID flag in @state,
+ *   or 0 if none has.
+ * @vlan: the VLAN range to add to @state
+ */
+void
+_nm_platform_bridge_vlans_to_state (guint8 *state,
+                                    guint16 *pvid,
+                                    const NMPlatformBridgeVlan *vlan)
+{
+	guint8 s;
+	guint vid;
+
+	s = NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT;
+	if (vlan->untagged)
+		s |= NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED;
+	if (vlan->pvid)
+		s |= NM_PLATFORM_BRIDGE_VLAN_STATE_PVID;
+
+	for (vid = NM_MAX (vlan->vid_start, NM_BRIDGE_VLAN_VID_MIN); vid <= NM_MIN (vlan->vid_end, NM_BRIDGE_VLAN_VID_MAX); vid++) {
+		/* there can only be one PVID. A later one wins. */
+		if (NM_FLAGS_HAS (s, NM_PLATFORM_BRIDGE_VLAN_STATE_PVID)) {
+			if (*pvid != 0)
+				state[*pvid] &= ~NM_PLATFORM_BRIDGE_VLAN_STATE_PVID;
+			*pvid = vid;
+		} else if (*pvid == vid)
+			*pvid = 0;
+		state[vid] = s;
+	}
+}
+
+/*
+ * _nm_platform_bridge_vlans_collect:
+ * @state_cur: the current state, see _nm_platform_bridge_vlans_to_state()
+ * @state_new: the desired state
+ * @for_delete: whether to collect the VLANs to remove, or the ones to
+ *   add or modify.
+ * @out_len: (out): the number of returned ranges
+ *
+ * Returns: (transfer full): a %NULL terminated list of VLAN ranges, or %NULL
+ *   if there are none. Free it with a single g_free().
+ */
+const NMPlatformBridgeVlan **
+_nm_platform_bridge_vlans_collect (const guint8 *state_cur,
+                                   const guint8 *state_new,
+                                   gboolean for_delete,
+                                   guint *out_len)
+{
+	gs_unref_array GArray *ranges = NULL;
+	const NMPlatformBridgeVlan **result;
+	NMPlatformBridgeVlan *data;
+	guint vid;
+	guint i;
+
+	ranges = g_array_new (FALSE, FALSE, sizeof (NMPlatformBridgeVlan));
+
+	for (vid = NM_BRIDGE_VLAN_VID_MIN; vid <= NM_BRIDGE_VLAN_VID_MAX; vid++) {
+		NMPlatformBridgeVlan *last;
+		guint8 s;
+
+		if (for_delete) {
+			if (   !state_cur[vid]
+			    || state_new[vid])
+				continue;
+			s = NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT;
+		} else {
+			if (   !state_new[vid]
+			    || state_new[vid] == state_cur[vid])
+				continue;
+			s = state_new[vid];
+		}
+
+		last = ranges->len > 0 ? &g_array_index (ranges, NMPlatformBridgeVlan, ranges->len - 1) : NULL;
+		if (   last
+		    && last->vid_end + 1u == vid
+		    && !last->pvid
+		    && !NM_FLAGS_HAS (s, NM_PLATFORM_BRIDGE_VLAN_STATE_PVID)
+		    && (   for_delete
+		        || last->untagged == NM_FLAGS_HAS (s, NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED))) {
+			last->vid_end = vid;
+			continue;
+		}
+
+		g_array_append_val (ranges,
+		                    ((NMPlatformBridgeVlan) {
+		                        .vid_start = vid,
+		                        .vid_end   = vid,
+		                        .untagged  = !for_delete && NM_FLAGS_HAS (s, NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED),
+		                        .pvid      = !for_delete && NM_FLAGS_HAS (s, NM_PLATFORM_BRIDGE_VLAN_STATE_PVID),
+		                    }));
+	}
+
+	*out_len = ranges->len;
+	if (ranges->len == 0)
+		return NULL;
+
+	/* return a NULL terminated list of pointers, followed by the data,
+	 * so that it can be freed with one g_free(). */
+	result = g_malloc (  (sizeof (NMPlatformBridgeVlan *) * (ranges->len + 1))
+	                   + (sizeof (NMPlatformBridgeVlan  ) * (ranges->len    )));
+	data = (NMPlatformBridgeVlan *) &result[ranges->len + 1];
+	for (i = 0; i < ranges->len; i++) {
+		data[i] = g_array_index (ranges, NMPlatformBridgeVlan, i);
+		result[i] = &data[i];
+	}
+	result[i] = NULL;
+	return result;
+}
+
+/**
+ * nm_platform_link_sync_bridge_vlans:
+ * @self: platform instance
+ * @ifindex: the bridge or bridge port
+ * @on_master: whether to configure the VLANs of the port on the master
+ * @vlans: (allow-none): %NULL terminated list of the desired VLANs.
+ *
+ * Compares the VLANs currently configured in kernel with @vlans and only
+ * removes, adds and modifies the differing ones. Unlike first flushing
+ * all VLANs and setting them anew, this does not interrupt traffic on
+ * VLANs that stay.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_link_sync_bridge_vlans (NMPlatform *self, int ifindex, gboolean on_master, const NMPlatformBridgeVlan *const *vlans)
+{
+	gs_free NMPlatformBridgeVlan *vlans_cur = NULL;
+	gs_free const NMPlatformBridgeVlan **vlans_del = NULL;
+	gs_free const NMPlatformBridgeVlan **vlans_add = NULL;
+	guint vlans_cur_len = 0;
+	guint vlans_del_len;
+	guint vlans_add_len;
+	guint i;
+	guint8 state_cur[NM_BRIDGE_VLAN_VID_MAX + 1] = { 0 };
+	guint8 state_new[NM_BRIDGE_VLAN_VID_MAX + 1] = { 0 };
+	guint16 pvid_cur = 0;
+	guint16 pvid_new = 0;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	if (   !klass->link_get_bridge_vlans
+	    || !klass->link_del_bridge_vlans
+	    || !klass->link_get_bridge_vlans (self, ifindex, &vlans_cur, &vlans_cur_len)) {
+		_LOG3D ("link: cannot read bridge VLANs, flush and set them instead");
+		if (!nm_platform_link_set_bridge_vlans (self, ifindex, on_master, NULL))
+			return FALSE;
+		if (   vlans
+		    && vlans[0]
+		    && !nm_platform_link_set_bridge_vlans (self, ifindex, on_master, vlans))
+			return FALSE;
+		return TRUE;
+	}
+
+	for (i = 0; i < vlans_cur_len; i++)
+		_nm_platform_bridge_vlans_to_state (state_cur, &pvid_cur, &vlans_cur[i]);
+	if (vlans) {
+		for (i = 0; vlans[i]; i++)
+			_nm_platform_bridge_vlans_to_state (state_new, &pvid_new, vlans[i]);
+	}
+
+	vlans_del = _nm_platform_bridge_vlans_collect (state_cur, state_new, TRUE, &vlans_del_len);
+	vlans_add = _nm_platform_bridge_vlans_collect (state_cur, state_new, FALSE, &vlans_add_len);
+
+	_LOG3D ("link: sync bridge VLANs on %s: %u ranges to remove, %u ranges to add or modify",
+	        on_master ? "master" : "self",
+	        vlans_del_len,
+	        vlans_add_len);
+
+	if (vlans_del) {
+		for (i = 0; vlans_del[i]; i++)
+			_LOG3D ("link:   remove bridge VLAN %s", nm_platform_bridge_vlan_to_string (vlans_del[i], NULL, 0));
+		if (!klass->link_del_bridge_vlans (self, ifindex, on_master, vlans_del))
+			return FALSE;
+	}
+
+	if (vlans_add) {
+		for (i = 0; vlans_add[i]; i++)
+			_LOG3D ("link:   set bridge VLAN %s", nm_platform_bridge_vlan_to_string (vlans_add[i], NULL, 0));
+		if (!klass->link_set_bridge_vlans (self, ifindex, on_master, vlans_add))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
 /**
  * nm_platform_link_set_up:
  * @self: platform instance
@@ -1799,6 +2016,93 @@ nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmwar
 	return klass->link_set_up (self, ifindex, out_no_firmware);
 }
 
+static void
+_link_change_sync_idle_cb (gpointer user_data,
+                           GCancellable *cancellable)
+{
+	gs_free_error GError *error = NULL;
+	NMPlatformAsyncCallback callback;
+	gpointer callback_data;
+	gpointer result;
+	int r;
+
+	nm_utils_user_data_unpack (user_data, &callback, &callback_data, &result);
+	r = GPOINTER_TO_INT (result);
+
+	if (   !g_cancellable_set_error_if_cancelled (cancellable, &error)
+	    && r < 0) {
+		g_set_error (&error,
+		             NM_UTILS_ERROR,
+		             NM_UTILS_ERROR_UNKNOWN,
+		             "failure changing link: %s",
+		             nm_strerror (r));
+	}
+	if (callback)
+		callback (error, callback_data);
+}
+
+static void
+_link_change_sync_complete (int result,
+                            NMPlatformAsyncCallback callback,
+                            gpointer callback_data,
+                            GCancellable *cancellable)
+{
+	/* for platform implementations that only support the synchronous
+	 * variant. Still invoke the callback asynchronously. */
+	nm_utils_invoke_on_idle (_link_change_sync_idle_cb,
+	                         nm_utils_user_data_pack (callback,
+	                                                  callback_data,
+	                                                  GINT_TO_POINTER (result)),
+	                         cancellable);
+}
+
+/**
+ * nm_platform_link_set_up_async:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @callback: called when the operation finishes
+ * @callback_data: data passed to @callback
+ * @cancellable: cancellable to abort the operation
+ *
+ * Like nm_platform_link_set_up(), but does not block waiting
+ * for the kernel's response. The callback function is always
+ * invoked, and asynchronously. That is also the case if @ifindex
+ * is invalid, or if the platform instance gets destroyed first.
+ */
+void
+nm_platform_link_set_up_async (NMPlatform *self,
+                               int ifindex,
+                               NMPlatformAsyncCallback callback,
+                               gpointer callback_data,
+                               GCancellable *cancellable)
+{
+	gboolean no_firmware = FALSE;
+	gboolean success;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	if (ifindex <= 0) {
+		/* the callback is invoked in any case. */
+		_link_change_sync_complete (-NME_PL_NOT_FOUND, callback, callback_data, cancellable);
+		return;
+	}
+
+	_LOG3D ("link: setting up (async)");
+
+	if (klass->link_set_up_async) {
+		klass->link_set_up_async (self, ifindex, callback, callback_data, cancellable);
+		return;
+	}
+
+	success = klass->link_set_up (self, ifindex, &no_firmware);
+	_link_change_sync_complete (  success
+	                            ? 0
+	                            : (no_firmware ? -NME_PL_NO_FIRMWARE : -NME_UNSPEC),
+	                            callback,
+	                            callback_data,
+	                            cancellable);
+}
+
 /**
  * nm_platform_link_set_down:
  * @self: platform instance
@@ -2139,6 +2443,18 @@ _link_get_lnk (NMPlatform *self, int ifindex, NMLinkType link_type, const NMPlat
 	return lnk ? &lnk->object : NULL;
 }
 
+const NMPlatformLnkBond *
+nm_platform_link_get_lnk_bond (NMPlatform *self, int ifindex, const NMPlatformLink **out_link)
+{
+	return _link_get_lnk (self, ifindex, NM_LINK_TYPE_BOND, out_link);
+}
+
+const NMPlatformLnkBridge *
+nm_platform_link_get_lnk_bridge (NMPlatform *self, int ifindex, const NMPlatformLink **out_link)
+{
+	return _link_get_lnk (self, ifindex, NM_LINK_TYPE_BRIDGE, out_link);
+}
+
 const NMPlatformLnkGre *
 nm_platform_link_get_lnk_gre (NMPlatform *self, int ifindex, const NMPlatformLink **out_link)
 {
@@ -2247,6 +2563,7 @@ NM_UTILS_FLAGS2STR_DEFINE_STATIC (_wireguard_change_peer_flags_to_string, NMPlat
 	NM_UTILS_FLAGS2STR (NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT,           "ep"),
 	NM_UTILS_FLAGS2STR (NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS,         "aips"),
 	NM_UTILS_FLAGS2STR (NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS,     "remove-aips"),
+	NM_UTILS_FLAGS2STR (NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY,            "update-only"),
 );
 
 int
@@ -2673,6 +2990,69 @@ nm_platform_sysctl_slave_get_option (NMPlatform *self, int ifindex, const char *
 
 /*****************************************************************************/
 
+/**
+ * nm_platform_link_bond_change:
+ * @self: platform instance
+ * @ifindex: the bond
+ * @props: the bond options
+ * @attrs: the options from @props to set. The others are left alone.
+ *
+ * Sets all the bond options with one netlink request.
+ *
+ * Returns: %TRUE on success. On failure, none of the options
+ *   might be set and the caller may retry them via sysfs.
+ */
+gboolean
+nm_platform_link_bond_change (NMPlatform *self,
+                              int ifindex,
+                              const NMPlatformLnkBond *props,
+                              NMPlatformLnkBondAttrs attrs)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (props, FALSE);
+
+	if (!klass->link_bond_change)
+		return FALSE;
+
+	_LOG3D ("link: change bond options (0x%llx): %s",
+	        (unsigned long long) attrs,
+	        nm_platform_lnk_bond_to_string (props, NULL, 0));
+
+	return klass->link_bond_change (self, ifindex, props, attrs);
+}
+
+/**
+ * nm_platform_link_bridge_change:
+ * @self: platform instance
+ * @ifindex: the bridge
+ * @props: the bridge options
+ *
+ * Sets the bridge options with one netlink request. The VLAN options
+ * of @props are ignored, they are configured separately.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_link_bridge_change (NMPlatform *self,
+                                int ifindex,
+                                const NMPlatformLnkBridge *props)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (props, FALSE);
+
+	if (!klass->link_bridge_change)
+		return FALSE;
+
+	_LOG3D ("link: change bridge options: %s",
+	        nm_platform_lnk_bridge_to_string (props, NULL, 0));
+
+	return klass->link_bridge_change (self, ifindex, props);
+}
+
 gboolean
 nm_platform_link_vlan_change (NMPlatform *self,
                               int ifindex,
@@ -3594,6 +3974,72 @@ nm_platform_lookup_entry (NMPlatform *self,
 	                                             obj);
 }
 
+void
+nm_platform_get_cache_stats (NMPlatform *self,
+                             NMPCacheStats *out_stats)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (out_stats);
+
+	nmp_cache_get_stats (nm_platform_get_cache (self), out_stats);
+}
+
+/**
+ * nm_platform_ip_route_lookup_best:
+ * @self: the #NMPlatform instance
+ * @addr_family: the address family, AF_INET or AF_INET6
+ * @table: the route table
+ * @dst: the destination address
+ *
+ * Returns: the route in @table that the kernel would most likely use to
+ *   reach @dst, based on a longest-prefix-match of the cached routes.
+ *   See nmp_cache_lookup_route_best().
+ */
+const NMPObject *
+nm_platform_ip_route_lookup_best (NMPlatform *self,
+                                  int addr_family,
+                                  guint32 table,
+                                  gconstpointer dst)
+{
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), NULL);
+	g_return_val_if_fail (dst, NULL);
+
+	return nmp_cache_lookup_route_best (nm_platform_get_cache (self),
+	                                    addr_family,
+	                                    table,
+	                                    dst);
+}
+
+/**
+ * nm_platform_ip_route_lookup_prefix:
+ * @self: the #NMPlatform instance
+ * @addr_family: the address family, AF_INET or AF_INET6
+ * @table: the route table
+ * @network: the network address of the prefix
+ * @plen: the prefix length
+ *
+ * Returns: (transfer container): all routes in @table within @network/@plen
+ *   or %NULL. See nmp_cache_lookup_routes_in_prefix().
+ */
+GPtrArray *
+nm_platform_ip_route_lookup_prefix (NMPlatform *self,
+                                    int addr_family,
+                                    guint32 table,
+                                    gconstpointer network,
+                                    guint8 plen)
+{
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), NULL);
+	g_return_val_if_fail (network, NULL);
+	g_return_val_if_fail (plen <= (addr_family == AF_INET ? 32 : 128), NULL);
+
+	return nmp_cache_lookup_routes_in_prefix (nm_platform_get_cache (self),
+	                                          addr_family,
+	                                          table,
+	                                          network,
+	                                          plen);
+}
+
 const NMDedupMultiHeadEntry *
 nm_platform_lookup (NMPlatform *self,
                     const NMPLookup *lookup)
@@ -4884,6 +5330,7 @@ nm_platform_object_delete (NMPlatform *self,
 
 	switch (NMP_OBJECT_GET_TYPE (obj)) {
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
+	case NMP_OBJECT_TYPE_NEXTHOP:
 		_LOGD ("%s: delete %s",
 		       NMP_OBJECT_GET_CLASS (obj)->obj_type_name,
 		       nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
@@ -5243,6 +5690,33 @@ nm_platform_routing_rule_add (NMPlatform *self,
 
 /*****************************************************************************/
 
+/**
+ * nm_platform_nexthop_add:
+ * @self: the #NMPlatform instance
+ * @flags: the netlink flags. Use %NMP_NLM_FLAG_REPLACE to modify an
+ *   existing nexthop in place. All routes referencing the nexthop by its
+ *   id follow the change, without the need to touch the routes themselves.
+ * @nexthop: the nexthop to add. The id must be set.
+ *
+ * Returns: 0 on success or a negative error code.
+ */
+int
+nm_platform_nexthop_add (NMPlatform *self,
+                         NMPNlmFlags flags,
+                         const NMPlatformNexthop *nexthop)
+{
+	_CHECK_SELF (self, klass, -NME_BUG);
+
+	g_return_val_if_fail (nexthop, -NME_BUG);
+	g_return_val_if_fail (nexthop->id > 0, -NME_BUG);
+	g_return_val_if_fail (NM_IN_SET (nexthop->addr_family, AF_INET, AF_INET6), -NME_BUG);
+
+	_LOGD ("nexthop: adding or updating: %s", nm_platform_nexthop_to_string (nexthop, NULL, 0));
+	return klass->nexthop_add (self, flags, nexthop);
+}
+
+/*****************************************************************************/
+
 int
 nm_platform_qdisc_add (NMPlatform *self,
                        NMPNlmFlags flags,
@@ -5258,72 +5732,220 @@ nm_platform_qdisc_add (NMPlatform *self,
 	return klass->qdisc_add (self, flags, qdisc);
 }
 
-/**
- * nm_platform_qdisc_sync:
- * @self: the #NMPlatform instance
- * @ifindex: the ifindex where to configure the qdiscs.
- * @known_qdiscs: the list of qdiscs (#NMPObject).
- *
- * The function promises not to take any reference to the qdisc
- * instances from @known_qdiscs, nor to keep them around after
- * the function returns. This is important, because it allows the
- * caller to pass NMPlatformQdisc instances which "kind" string
- * have a limited lifetime.
- *
- * Returns: %TRUE on success.
- */
 gboolean
-nm_platform_qdisc_sync (NMPlatform *self,
-                        int ifindex,
-                        GPtrArray *known_qdiscs)
+_nm_platform_qdisc_matches (const NMPlatformQdisc *known, const NMPlatformQdisc *plat)
+{
+	NMPlatformQdisc tmp = *plat;
+
+	/* For qdiscs, kernel reports the reference count in tcm_info. A
+	 * handle of zero lets kernel pick one, any handle is fine then. */
+	tmp.info = known->info;
+	if (known->handle == 0)
+		tmp.handle = 0;
+
+	/* fq_codel options that we don't set are left to kernel's defaults,
+	 * which it then reports back. Any value matches them. */
+	if (   nm_streq0 (known->kind, "fq_codel")
+	    && nm_streq0 (plat->kind, "fq_codel")) {
+		if (known->fq_codel.limit == 0)
+			tmp.fq_codel.limit = 0;
+		if (known->fq_codel.flows == 0)
+			tmp.fq_codel.flows = 0;
+		if (known->fq_codel.target == 0)
+			tmp.fq_codel.target = 0;
+		if (known->fq_codel.interval == 0)
+			tmp.fq_codel.interval = 0;
+		if (known->fq_codel.quantum == 0)
+			tmp.fq_codel.quantum = 0;
+		if (known->fq_codel.memory_limit == NM_PLATFORM_FQ_CODEL_MEMORY_LIMIT_UNSET)
+			tmp.fq_codel.memory_limit = NM_PLATFORM_FQ_CODEL_MEMORY_LIMIT_UNSET;
+		if (!known->fq_codel.ecn)
+			tmp.fq_codel.ecn = FALSE;
+	}
+
+	return nm_platform_qdisc_cmp (known, &tmp) == 0;
+}
+
+static gboolean
+_tfilter_matches (const NMPlatformTfilter *known, const NMPlatformTfilter *plat)
 {
-	gs_unref_ptrarray GPtrArray *plat_qdiscs = NULL;
+	NMPlatformTfilter tmp = *plat;
+
+	/* tcm_info has the priority in the upper 16 bits. If we don't set
+	 * one, kernel picks it. */
+	if ((known->info & 0xFFFF0000u) == 0)
+		tmp.info &= 0x0000FFFFu;
+	if (known->handle == 0)
+		tmp.handle = 0;
+	return nm_platform_tfilter_cmp (known, &tmp) == 0;
+}
+
+static gboolean
+_qdisc_is_child (const NMPlatformQdisc *child, const NMPlatformQdisc *parent)
+{
+	/* The root and the ingress qdiscs have a special parent, that is
+	 * not a class of another qdisc. */
+	if (NM_IN_SET (child->parent, TC_H_ROOT, TC_H_INGRESS))
+		return FALSE;
+	return    parent->handle != 0
+	       && TC_H_MAJ (child->parent) == TC_H_MAJ (parent->handle);
+}
+
+static gboolean
+_tc_sync (NMPlatform *self,
+          NMPObjectType obj_type,
+          int ifindex,
+          GPtrArray *known_objs)
+{
+	gs_unref_ptrarray GPtrArray *plat_objs = NULL;
+	gs_unref_array GArray *changes = NULL;
+	gs_free guint *plat_matched = NULL;
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (self);
 	NMPLookup lookup;
-	guint i;
 	gboolean success = TRUE;
-	gs_unref_hashtable GHashTable *known_qdiscs_idx = NULL;
+	gboolean again;
+	guint n_known;
+	guint n_plat;
+	guint i, j, k;
 
 	nm_assert (NM_IS_PLATFORM (self));
 	nm_assert (ifindex > 0);
+	nm_assert (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_QDISC, NMP_OBJECT_TYPE_TFILTER));
+
+	plat_objs = nm_platform_lookup_clone (self,
+	                                      nmp_lookup_init_object (&lookup,
+	                                                              obj_type,
+	                                                              ifindex),
+	                                      NULL, NULL);
+
+	n_known = known_objs ? known_objs->len : 0u;
+	n_plat = plat_objs ? plat_objs->len : 0u;
+
+	/* For each platform object, the 1-based index of the wanted object
+	 * it matches, or zero. */
+	plat_matched = g_new0 (guint, n_plat + 1);
 
-	known_qdiscs_idx = g_hash_table_new ((GHashFunc) nmp_object_id_hash,
-	                                     (GEqualFunc) nmp_object_id_equal);
+	/* Keep the objects that are already configured exactly like that.
+	 * Re-adding identical qdiscs would reset their state (for example,
+	 * the flows of fq_codel). The lists are short, a linear search is fine. */
+	for (i = 0; i < n_known; i++) {
+		const NMPObject *o = known_objs->pdata[i];
 
-	if (known_qdiscs) {
-		for (i = 0; i < known_qdiscs->len; i++) {
-			const NMPObject *q = g_ptr_array_index (known_qdiscs, i);
+		for (j = 0; j < n_plat; j++) {
+			const NMPObject *p = plat_objs->pdata[j];
+			gboolean found;
 
-			g_hash_table_insert (known_qdiscs_idx, (gpointer) q, (gpointer) q);
+			if (plat_matched[j])
+				continue;
+			if (obj_type == NMP_OBJECT_TYPE_QDISC)
+				found = _nm_platform_qdisc_matches (NMP_OBJECT_CAST_QDISC (o), NMP_OBJECT_CAST_QDISC (p));
+			else
+				found = _tfilter_matches (NMP_OBJECT_CAST_TFILTER (o), NMP_OBJECT_CAST_TFILTER (p));
+			if (found) {
+				plat_matched[j] = i + 1;
+				break;
+			}
 		}
 	}
 
-	plat_qdiscs = nm_platform_lookup_clone (self,
-	                                        nmp_lookup_init_object (&lookup,
-	                                                                NMP_OBJECT_TYPE_QDISC,
-	                                                                ifindex),
-	                                        NULL, NULL);
+	/* Deleting a qdisc also deletes the qdiscs attached to its classes.
+	 * Those must be added again, even if they were configured as wanted. */
+	if (obj_type == NMP_OBJECT_TYPE_QDISC) {
+		do {
+			again = FALSE;
+			for (j = 0; j < n_plat; j++) {
+				if (!plat_matched[j])
+					continue;
+				for (k = 0; k < n_plat; k++) {
+					if (   !plat_matched[k]
+					    && _qdisc_is_child (NMP_OBJECT_CAST_QDISC (plat_objs->pdata[j]),
+					                        NMP_OBJECT_CAST_QDISC (plat_objs->pdata[k]))) {
+						plat_matched[j] = 0;
+						again = TRUE;
+						break;
+					}
+				}
+			}
+		} while (again);
+	}
 
-	if (plat_qdiscs) {
-		for (i = 0; i < plat_qdiscs->len; i++) {
-			const NMPObject *q = g_ptr_array_index (plat_qdiscs, i);
+	changes = g_array_new (FALSE, FALSE, sizeof (NMPlatformTcChange));
+
+	/* Objects that differ from the wanted ones are removed first, so that
+	 * their replacement can be added. */
+	for (j = 0; j < n_plat; j++) {
+		if (plat_matched[j])
+			continue;
+		g_array_append_val (changes, ((NMPlatformTcChange) {
+			.obj       = plat_objs->pdata[j],
+			.is_delete = TRUE,
+		}));
+	}
 
-			if (!g_hash_table_lookup (known_qdiscs_idx, q))
-				success &= nm_platform_object_delete (self, q);
+	for (i = 0; i < n_known; i++) {
+		for (j = 0; j < n_plat; j++) {
+			if (plat_matched[j] == i + 1)
+				break;
 		}
+		if (j < n_plat)
+			continue;
+		g_array_append_val (changes, ((NMPlatformTcChange) {
+			.obj   = known_objs->pdata[i],
+			.flags = NMP_NLM_FLAG_ADD,
+		}));
 	}
 
-	if (known_qdiscs) {
-		for (i = 0; i < known_qdiscs->len; i++) {
-			const NMPObject *q = g_ptr_array_index (known_qdiscs, i);
+	if (changes->len == 0) {
+		_LOG3D ("%s: already configured", nmp_class_from_type (obj_type)->obj_type_name);
+		return TRUE;
+	}
 
-			success &= (nm_platform_qdisc_add (self, NMP_NLM_FLAG_ADD,
-			                                   NMP_OBJECT_CAST_QDISC (q)) >= 0);
-		}
+	if (klass->tc_change_batch) {
+		return klass->tc_change_batch (self,
+		                               &g_array_index (changes, NMPlatformTcChange, 0),
+		                               changes->len);
+	}
+
+	for (i = 0; i < changes->len; i++) {
+		const NMPlatformTcChange *change = &g_array_index (changes, NMPlatformTcChange, i);
+
+		if (change->is_delete)
+			success &= nm_platform_object_delete (self, change->obj);
+		else if (obj_type == NMP_OBJECT_TYPE_QDISC)
+			success &= (nm_platform_qdisc_add (self, change->flags, NMP_OBJECT_CAST_QDISC (change->obj)) >= 0);
+		else
+			success &= (nm_platform_tfilter_add (self, change->flags, NMP_OBJECT_CAST_TFILTER (change->obj)) >= 0);
 	}
 
 	return success;
 }
 
+/**
+ * nm_platform_qdisc_sync:
+ * @self: the #NMPlatform instance
+ * @ifindex: the ifindex where to configure the qdiscs.
+ * @known_qdiscs: the list of qdiscs (#NMPObject).
+ *
+ * Qdiscs that are already configured as requested are left untouched.
+ * The others are removed or added, if supported with all requests sent
+ * to kernel at once.
+ *
+ * The function promises not to take any reference to the qdisc
+ * instances from @known_qdiscs, nor to keep them around after
+ * the function returns. This is important, because it allows the
+ * caller to pass NMPlatformQdisc instances which "kind" string
+ * have a limited lifetime.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_qdisc_sync (NMPlatform *self,
+                        int ifindex,
+                        GPtrArray *known_qdiscs)
+{
+	return _tc_sync (self, NMP_OBJECT_TYPE_QDISC, ifindex, known_qdiscs);
+}
+
 /*****************************************************************************/
 
 int
@@ -5342,11 +5964,14 @@ nm_platform_tfilter_add (NMPlatform *self,
 }
 
 /**
- * nm_platform_qdisc_sync:
+ * nm_platform_tfilter_sync:
  * @self: the #NMPlatform instance
  * @ifindex: the ifindex where to configure the qdiscs.
  * @known_tfilters: the list of tfilters (#NMPObject).
  *
+ * Like nm_platform_qdisc_sync(), tfilters that are already configured
+ * as requested are left untouched.
+ *
  * The function promises not to take any reference to the tfilter
  * instances from @known_tfilters, nor to keep them around after
  * the function returns. This is important, because it allows the
@@ -5360,51 +5985,7 @@ nm_platform_tfilter_sync (NMPlatform *self,
                           int ifindex,
                           GPtrArray *known_tfilters)
 {
-	gs_unref_ptrarray GPtrArray *plat_tfilters = NULL;
-	NMPLookup lookup;
-	guint i;
-	gboolean success = TRUE;
-	gs_unref_hashtable GHashTable *known_tfilters_idx = NULL;
-
-	nm_assert (NM_IS_PLATFORM (self));
-	nm_assert (ifindex > 0);
-
-	known_tfilters_idx = g_hash_table_new ((GHashFunc) nmp_object_id_hash,
-	                                       (GEqualFunc) nmp_object_id_equal);
-
-	if (known_tfilters) {
-		for (i = 0; i < known_tfilters->len; i++) {
-			const NMPObject *q = g_ptr_array_index (known_tfilters, i);
-
-			g_hash_table_insert (known_tfilters_idx, (gpointer) q, (gpointer) q);
-		}
-	}
-
-	plat_tfilters = nm_platform_lookup_clone (self,
-	                                          nmp_lookup_init_object (&lookup,
-	                                                                  NMP_OBJECT_TYPE_TFILTER,
-	                                                                  ifindex),
-	                                          NULL, NULL);
-
-	if (plat_tfilters) {
-		for (i = 0; i < plat_tfilters->len; i++) {
-			const NMPObject *q = g_ptr_array_index (plat_tfilters, i);
-
-			if (!g_hash_table_lookup (known_tfilters_idx, q))
-				success &= nm_platform_object_delete (self, q);
-		}
-	}
-
-	if (known_tfilters) {
-		for (i = 0; i < known_tfilters->len; i++) {
-			const NMPObject *q = g_ptr_array_index (known_tfilters, i);
-
-			success &= (nm_platform_tfilter_add (self, NMP_NLM_FLAG_ADD,
-			                                     NMP_OBJECT_CAST_TFILTER (q)) >= 0);
-		}
-	}
-
-	return success;
+	return _tc_sync (self, NMP_OBJECT_TYPE_TFILTER, ifindex, known_tfilters);
 }
 
 /*****************************************************************************/
@@ -5570,6 +6151,119 @@ nm_platform_link_to_string (const NMPlatformLink *link, char *buf, gsize len)
 	return buf;
 }
 
+const char *
+nm_platform_lnk_bond_to_string (const NMPlatformLnkBond *lnk, char *buf, gsize len)
+{
+	char str_arp_ip_target[NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS * (NM_UTILS_INET_ADDRSTRLEN + 1) + 20];
+	char sbuf[NM_UTILS_INET_ADDRSTRLEN];
+	char str_ad_actor_system[sizeof (lnk->ad_actor_system) * 3];
+	char *b;
+	gsize l;
+	guint i;
+
+	if (!nm_utils_to_string_buffer_init_null (lnk, &buf, &len))
+		return buf;
+
+	str_arp_ip_target[0] = '\0';
+	b = str_arp_ip_target;
+	l = sizeof (str_arp_ip_target);
+	for (i = 0; i < lnk->arp_ip_targets_num && i < NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS; i++) {
+		nm_utils_strbuf_append (&b, &l,
+		                        "%s%s",
+		                        i == 0 ? " arp_ip_target " : ",",
+		                        nm_utils_inet4_ntop (lnk->arp_ip_target[i], sbuf));
+	}
+
+	g_snprintf (buf, len,
+	            "bond"
+	            " mode %u"
+	            " active_slave %d"
+	            " primary %d"
+	            " miimon %u"
+	            " updelay %u"
+	            " downdelay %u"
+	            " use_carrier %d"
+	            " arp_interval %u"
+	            "%s" /* arp_ip_target */
+	            " arp_validate %u"
+	            " arp_all_targets %u"
+	            " primary_reselect %u"
+	            " fail_over_mac %u"
+	            " xmit_hash_policy %u"
+	            " resend_igmp %u"
+	            " num_peer_notif %u"
+	            " all_slaves_active %u"
+	            " min_links %u"
+	            " lp_interval %u"
+	            " packets_per_slave %u"
+	            " lacp_rate %u"
+	            " ad_select %u"
+	            " ad_actor_sys_prio %u"
+	            " ad_user_port_key %u"
+	            " ad_actor_system %s"
+	            " tlb_dynamic_lb %d"
+	            "",
+	            lnk->mode,
+	            lnk->active_slave,
+	            lnk->primary,
+	            lnk->miimon,
+	            lnk->updelay,
+	            lnk->downdelay,
+	            (int) lnk->use_carrier,
+	            lnk->arp_interval,
+	            str_arp_ip_target,
+	            lnk->arp_validate,
+	            lnk->arp_all_targets,
+	            lnk->primary_reselect,
+	            lnk->fail_over_mac,
+	            lnk->xmit_hash_policy,
+	            lnk->resend_igmp,
+	            lnk->num_peer_notif,
+	            lnk->all_slaves_active,
+	            lnk->min_links,
+	            lnk->lp_interval,
+	            lnk->packets_per_slave,
+	            lnk->lacp_rate,
+	            lnk->ad_select,
+	            lnk->ad_actor_sys_prio,
+	            lnk->ad_user_port_key,
+	            nm_utils_hwaddr_ntoa_buf (lnk->ad_actor_system, sizeof (lnk->ad_actor_system), TRUE, str_ad_actor_system, sizeof (str_ad_actor_system)),
+	            (int) lnk->tlb_dynamic_lb);
+	return buf;
+}
+
+const char *
+nm_platform_lnk_bridge_to_string (const NMPlatformLnkBridge *lnk, char *buf, gsize len)
+{
+	if (!nm_utils_to_string_buffer_init_null (lnk, &buf, &len))
+		return buf;
+
+	g_snprintf (buf, len,
+	            "bridge"
+	            " stp_state %d"
+	            " forward_delay %u"
+	            " hello_time %u"
+	            " max_age %u"
+	            " ageing_time %u"
+	            " priority %u"
+	            " group_fwd_mask %#x"
+	            " mcast_snooping %d"
+	            " vlan_filtering %d"
+	            " vlan_default_pvid %u"
+	            "",
+	            (int) lnk->stp_state,
+	            lnk->forward_delay,
+	            lnk->hello_time,
+	            lnk->max_age,
+	            lnk->ageing_time,
+	            lnk->priority,
+	            lnk->group_fwd_mask,
+	            (int) lnk->mcast_snooping,
+	            (int) lnk->vlan_filtering,
+	            lnk->vlan_default_pvid);
+	return buf;
+}
+
 const char *
 nm_platform_lnk_gre_to_string (const NMPlatformLnkGre *lnk, char *buf, gsize len)
 {
@@ -6256,6 +6950,7 @@ nm_platform_ip4_route_to_string (const NMPlatformIP4Route *route, char *buf, gsi
 	char str_scope[30], s_source[50];
 	char str_tos[32], str_window[32], str_cwnd[32], str_initcwnd[32], str_initrwnd[32], str_mtu[32];
 	char str_rtm_flags[_RTM_FLAGS_TO_STRING_MAXLEN];
+	char str_nhid[30];
 
 	if (!nm_utils_to_string_buffer_init_null (route, &buf, &len))
 		return buf;
@@ -6270,6 +6965,7 @@ nm_platform_ip4_route_to_string (const NMPlatformIP4Route *route, char *buf, gsi
 	            "%s/%d"
 	            " via %s"
 	            "%s"
+	            "%s" /* nhid */
 	            " metric %"G_GUINT32_FORMAT
 	            " mss %"G_GUINT32_FORMAT
 	            " rt-src %s" /* protocol */
@@ -6288,6 +6984,7 @@ nm_platform_ip4_route_to_string (const NMPlatformIP4Route *route, char *buf, gsi
 	            route->plen,
 	            s_gateway,
 	            str_dev,
+	            route->nhid ? nm_sprintf_buf (str_nhid, " nhid %u", route->nhid) : "",
 	            route->metric,
 	            route->mss,
 	            nmp_utils_ip_config_source_to_string (route->rt_source, s_source, sizeof (s_source)),
@@ -6336,6 +7033,7 @@ nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, char *buf, gsi
 	char str_initrwnd[32];
 	char str_mtu[32];
 	char str_rtm_flags[_RTM_FLAGS_TO_STRING_MAXLEN];
+	char str_nhid[30];
 
 	if (!nm_utils_to_string_buffer_init_null (route, &buf, &len))
 		return buf;
@@ -6355,6 +7053,7 @@ nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, char *buf, gsi
 	            "%s/%d"
 	            " via %s"
 	            "%s"
+	            "%s" /* nhid */
 	            " metric %"G_GUINT32_FORMAT
 	            " mss %"G_GUINT32_FORMAT
 	            " rt-src %s" /* protocol */
@@ -6373,6 +7072,7 @@ nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, char *buf, gsi
 	            route->plen,
 	            s_gateway,
 	            str_dev,
+	            route->nhid ? nm_sprintf_buf (str_nhid, " nhid %u", route->nhid) : "",
 	            route->metric,
 	            route->mss,
 	            nmp_utils_ip_config_source_to_string (route->rt_source, s_source, sizeof (s_source)),
@@ -6777,6 +7477,72 @@ nm_platform_tfilter_to_string (const NMPlatformTfilter *tfilter, char *buf, gsiz
 	return buf;
 }
 
+const char *
+nm_platform_nexthop_to_string (const NMPlatformNexthop *nexthop, char *buf, gsize len)
+{
+	char str_dev[TO_STRING_DEV_BUF_SIZE];
+	char s_gateway[NM_UTILS_INET_ADDRSTRLEN];
+	char s_source[50];
+	const char *buf0;
+
+	if (!nm_utils_to_string_buffer_init_null (nexthop, &buf, &len))
+		return buf;
+
+	buf0 = buf;
+	nm_utils_strbuf_append (&buf, &len,
+	                        "id %u family %u",
+	                        nexthop->id,
+	                        nexthop->addr_family);
+	if (nexthop->blackhole)
+		nm_utils_strbuf_append_str (&buf, &len, " blackhole");
+	else {
+		if (   NM_IN_SET (nexthop->addr_family, AF_INET, AF_INET6)
+		    && !nm_ip_addr_is_null (nexthop->addr_family, &nexthop->gateway)) {
+			nm_utils_strbuf_append (&buf, &len,
+			                        " via %s",
+			                        nm_utils_inet_ntop (nexthop->addr_family, &nexthop->gateway, s_gateway));
+		}
+		nm_utils_strbuf_append_str (&buf, &len,
+		                            _to_string_dev (NULL, nexthop->ifindex, str_dev, sizeof (str_dev)));
+	}
+	nm_utils_strbuf_append (&buf, &len,
+	                        " proto %s",
+	                        nmp_utils_ip_config_source_to_string (nmp_utils_ip_config_source_from_rtprot (nexthop->protocol),
+	                                                              s_source,
+	                                                              sizeof (s_source)));
+	if (nexthop->flags)
+		nm_utils_strbuf_append (&buf, &len, " flags 0x%x", (unsigned) nexthop->flags);
+
+	return buf0;
+}
+
+void
+nm_platform_nexthop_hash_update (const NMPlatformNexthop *obj, NMHashState *h)
+{
+	nm_hash_update_vals (h,
+	                     obj->id,
+	                     obj->ifindex,
+	                     obj->flags,
+	                     obj->addr_family,
+	                     obj->protocol,
+	                     NM_HASH_COMBINE_BOOLS (guint8, obj->blackhole));
+	nm_hash_update (h, &obj->gateway, nm_utils_addr_family_to_size (obj->addr_family ?: AF_INET6));
+}
+
+int
+nm_platform_nexthop_cmp (const NMPlatformNexthop *a, const NMPlatformNexthop *b)
+{
+	NM_CMP_SELF (a, b);
+	NM_CMP_FIELD (a, b, id);
+	NM_CMP_FIELD (a, b, addr_family);
+	NM_CMP_FIELD (a, b, ifindex);
+	NM_CMP_FIELD_UNSAFE (a, b, blackhole);
+	NM_CMP_FIELD_MEMCMP_LEN (a, b, gateway, nm_utils_addr_family_to_size (a->addr_family ?: AF_INET6));
+	NM_CMP_FIELD (a, b, protocol);
+	NM_CMP_FIELD (a, b, flags);
+	return 0;
+}
+
 void
 nm_platform_tfilter_hash_update (const NMPlatformTfilter *obj, NMHashState *h)
 {
@@ -6961,6 +7727,108 @@ nm_platform_link_cmp (const NMPlatformLink *a, const NMPlatformLink *b)
 	return 0;
 }
 
+void
+nm_platform_lnk_bond_hash_update (const NMPlatformLnkBond *obj, NMHashState *h)
+{
+	nm_hash_update_vals (h,
+	                     obj->active_slave,
+	                     obj->primary,
+	                     obj->arp_all_targets,
+	                     obj->arp_interval,
+	                     obj->arp_validate,
+	                     obj->downdelay,
+	                     obj->lp_interval,
+	                     obj->miimon,
+	                     obj->min_links,
+	                     obj->packets_per_slave,
+	                     obj->resend_igmp,
+	                     obj->updelay,
+	                     obj->ad_actor_sys_prio,
+	                     obj->ad_user_port_key,
+	                     obj->ad_select,
+	                     obj->all_slaves_active,
+	                     obj->arp_ip_targets_num,
+	                     obj->fail_over_mac,
+	                     obj->lacp_rate,
+	                     obj->mode,
+	                     obj->num_peer_notif,
+	                     obj->primary_reselect,
+	                     obj->xmit_hash_policy,
+	                     NM_HASH_COMBINE_BOOLS (guint8,
+	                                            obj->tlb_dynamic_lb,
+	                                            obj->use_carrier));
+	nm_hash_update (h, obj->ad_actor_system, sizeof (obj->ad_actor_system));
+	nm_hash_update (h, obj->arp_ip_target, sizeof (obj->arp_ip_target[0]) * NM_MIN (obj->arp_ip_targets_num, NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS));
+}
+
+int
+nm_platform_lnk_bond_cmp (const NMPlatformLnkBond *a, const NMPlatformLnkBond *b)
+{
+	NM_CMP_SELF (a, b);
+	NM_CMP_FIELD (a, b, mode);
+	NM_CMP_FIELD (a, b, active_slave);
+	NM_CMP_FIELD (a, b, primary);
+	NM_CMP_FIELD (a, b, miimon);
+	NM_CMP_FIELD (a, b, updelay);
+	NM_CMP_FIELD (a, b, downdelay);
+	NM_CMP_FIELD_BOOL (a, b, use_carrier);
+	NM_CMP_FIELD (a, b, arp_interval);
+	NM_CMP_FIELD (a, b, arp_ip_targets_num);
+	NM_CMP_FIELD_MEMCMP_LEN (a, b, arp_ip_target, sizeof (a->arp_ip_target[0]) * NM_MIN (a->arp_ip_targets_num, NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS));
+	NM_CMP_FIELD (a, b, arp_validate);
+	NM_CMP_FIELD (a, b, arp_all_targets);
+	NM_CMP_FIELD (a, b, primary_reselect);
+	NM_CMP_FIELD (a, b, fail_over_mac);
+	NM_CMP_FIELD (a, b, xmit_hash_policy);
+	NM_CMP_FIELD (a, b, resend_igmp);
+	NM_CMP_FIELD (a, b, num_peer_notif);
+	NM_CMP_FIELD (a, b, all_slaves_active);
+	NM_CMP_FIELD (a, b, min_links);
+	NM_CMP_FIELD (a, b, lp_interval);
+	NM_CMP_FIELD (a, b, packets_per_slave);
+	NM_CMP_FIELD (a, b, lacp_rate);
+	NM_CMP_FIELD (a, b, ad_select);
+	NM_CMP_FIELD (a, b, ad_actor_sys_prio);
+	NM_CMP_FIELD (a, b, ad_user_port_key);
+	NM_CMP_FIELD_MEMCMP (a, b, ad_actor_system);
+	NM_CMP_FIELD_BOOL (a, b, tlb_dynamic_lb);
+	return 0;
+}
+
+void
+nm_platform_lnk_bridge_hash_update (const NMPlatformLnkBridge *obj, NMHashState *h)
+{
+	nm_hash_update_vals (h,
+	                     obj->ageing_time,
+	                     obj->forward_delay,
+	                     obj->hello_time,
+	                     obj->max_age,
+	                     obj->group_fwd_mask,
+	                     obj->priority,
+	                     obj->vlan_default_pvid,
+	                     NM_HASH_COMBINE_BOOLS (guint8,
+	                                            obj->mcast_snooping,
+	                                            obj->stp_state,
+	                                            obj->vlan_filtering));
+}
+
+int
+nm_platform_lnk_bridge_cmp (const NMPlatformLnkBridge *a, const NMPlatformLnkBridge *b)
+{
+	NM_CMP_SELF (a, b);
+	NM_CMP_FIELD_BOOL (a, b, stp_state);
+	NM_CMP_FIELD (a, b, forward_delay);
+	NM_CMP_FIELD (a, b, hello_time);
+	NM_CMP_FIELD (a, b, max_age);
+	NM_CMP_FIELD (a, b, ageing_time);
+	NM_CMP_FIELD (a, b, priority);
+	NM_CMP_FIELD (a, b, group_fwd_mask);
+	NM_CMP_FIELD_BOOL (a, b, mcast_snooping);
+	NM_CMP_FIELD_BOOL (a, b, vlan_filtering);
+	NM_CMP_FIELD (a, b, vlan_default_pvid);
+	return 0;
+}
+
 void
 nm_platform_lnk_gre_hash_update (const NMPlatformLnkGre *obj, NMHashState *h)
 {
@@ -7381,6 +8249,7 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     nmp_utils_ip_config_source_round_trip_rtprot (obj->rt_source),
 		                     _ip_route_scope_inv_get_normalized (obj),
 		                     obj->gateway,
+		                     obj->nhid,
 		                     obj->mss,
 		                     obj->pref_src,
 		                     obj->window,
@@ -7404,6 +8273,7 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     obj->plen,
 		                     obj->metric,
 		                     obj->gateway,
+		                     obj->nhid,
 		                     nmp_utils_ip_config_source_round_trip_rtprot (obj->rt_source),
 		                     _ip_route_scope_inv_get_normalized (obj),
 		                     obj->tos,
@@ -7430,6 +8300,7 @@ nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRo
 		                     obj->plen,
 		                     obj->metric,
 		                     obj->gateway,
+		                     obj->nhid,
 		                     obj->rt_source,
 		                     obj->scope_inv,
 		                     obj->tos,
@@ -7471,6 +8342,7 @@ nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route
 			NM_CMP_DIRECT (_ip_route_scope_inv_get_normalized (a),
 			               _ip_route_scope_inv_get_normalized (b));
 			NM_CMP_FIELD (a, b, gateway);
+			NM_CMP_FIELD (a, b, nhid);
 			NM_CMP_FIELD (a, b, mss);
 			NM_CMP_FIELD (a, b, pref_src);
 			NM_CMP_FIELD (a, b, window);
@@ -7502,6 +8374,7 @@ nm_platform_ip4_route_cmp (const NMPlatformIP4Route *a, const NMPlatformIP4Route
 		NM_CMP_FIELD (a, b, plen);
 		NM_CMP_FIELD (a, b, metric);
 		NM_CMP_FIELD (a, b, gateway);
+		NM_CMP_FIELD (a, b, nhid);
 		if (cmp_type == NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) {
 			NM_CMP_DIRECT (nmp_utils_ip_config_source_round_trip_rtprot (a->rt_source),
 			               nmp_utils_ip_config_source_round_trip_rtprot (b->rt_source));
@@ -7559,7 +8432,8 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 		                     obj->src_plen,
 		                     /* on top of WEAK_ID: */
 		                     obj->ifindex,
-		                     obj->gateway);
+		                     obj->gateway,
+		                     obj->nhid);
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY:
 		nm_hash_update_vals (h,
@@ -7569,6 +8443,7 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 		                     obj->plen,
 		                     nm_utils_ip6_route_metric_normalize (obj->metric),
 		                     obj->gateway,
+		                     obj->nhid,
 		                     obj->pref_src,
 		                     *nm_utils_ip6_address_clear_host_address (&a2, &obj->src, obj->src_plen),
 		                     obj->src_plen,
@@ -7596,6 +8471,7 @@ nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRo
 		                     obj->plen,
 		                     obj->metric,
 		                     obj->gateway,
+		                     obj->nhid,
 		                     obj->pref_src,
 		                     obj->src,
 		                     obj->src_plen,
@@ -7635,6 +8511,7 @@ nm_platform_ip6_route_cmp (const NMPlatformIP6Route *a, const NMPlatformIP6Route
 		if (cmp_type == NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID) {
 			NM_CMP_FIELD (a, b, ifindex);
 			NM_CMP_FIELD_IN6ADDR (a, b, gateway);
+			NM_CMP_FIELD (a, b, nhid);
 		}
 		break;
 	case NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY:
@@ -7655,6 +8532,7 @@ nm_platform_ip6_route_cmp (const NMPlatformIP6Route *a, const NMPlatformIP6Route
 		else
 			NM_CMP_FIELD (a, b, metric);
 		NM_CMP_FIELD_IN6ADDR (a, b, gateway);
+		NM_CMP_FIELD (a, b, nhid);
 		NM_CMP_FIELD_IN6ADDR (a, b, pref_src);
 		if (cmp_type == NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) {
 			NM_CMP_DIRECT_IN6ADDR_SAME_PREFIX (&a->src, &b->src, MIN (a->src_plen, b->src_plen));
@@ -8016,6 +8894,207 @@ log_tfilter (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformTf
 	_LOG3D ("signal: tfilter %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_tfilter_to_string (tfilter, NULL, 0));
 }
 
+static void
+log_nexthop (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatformNexthop *nexthop, NMPlatformSignalChangeType change_type, gpointer user_data)
+{
+	_LOGD ("signal: nexthop %7s: %s", nm_platform_signal_change_type_to_string (change_type), nm_platform_nexthop_to_string (nexthop, NULL, 0));
+}
+
+/*****************************************************************************/
+
+struct _NMPlatformIfindexListener {
+	NMPlatform *platform;
+	NMPlatformIfindexListenerFunc callback;
+	gpointer user_data;
+	CList lst;
+	int ifindex;
+};
+
+typedef struct {
+	int ifindex;
+
+	/* the number of _ifindex_listeners_dispatch() calls that currently
+	 * iterate the bucket. While non-zero, the bucket is kept alive. */
+	guint dispatching;
+
+	CList lst_head;
+} IfindexListenerBucket;
+
+static void
+_ifindex_listener_bucket_free (gpointer data)
+{
+	IfindexListenerBucket *bucket = data;
+
+	nm_assert (c_list_is_empty (&bucket->lst_head));
+	g_slice_free (IfindexListenerBucket, bucket);
+}
+
+/**
+ * nm_platform_ifindex_listener_new:
+ * @self: the #NMPlatform instance
+ * @callback: the function to invoke for changes of the ifindex
+ * @user_data: the user data for @callback
+ *
+ * Creates a listener that gets notified about platform changes of one
+ * interface. Contrary to the GObject signals of #NMPlatform, which are
+ * emitted to every subscriber, the listener is only invoked for objects
+ * of the ifindex set with nm_platform_ifindex_listener_set_ifindex().
+ * Initially, the listener is not registered to any ifindex.
+ *
+ * Returns: (transfer full): the new listener. Free with
+ *   nm_platform_ifindex_listener_free().
+ */
+NMPlatformIfindexListener *
+nm_platform_ifindex_listener_new (NMPlatform *self,
+                                  NMPlatformIfindexListenerFunc callback,
+                                  gpointer user_data)
+{
+	NMPlatformIfindexListener *listener;
+
+	_CHECK_SELF (self, klass, NULL);
+	g_return_val_if_fail (callback, NULL);
+
+	listener = g_slice_new (NMPlatformIfindexListener);
+	*listener = (NMPlatformIfindexListener) {
+		.platform  = g_object_ref (self),
+		.callback  = callback,
+		.user_data = user_data,
+		.lst       = C_LIST_INIT (listener->lst),
+	};
+	return listener;
+}
+
+/**
+ * nm_platform_ifindex_listener_set_ifindex:
+ * @listener: the listener
+ * @ifindex: the ifindex to listen to, or 0 to unregister the listener
+ *
+ * Returns: %TRUE if the ifindex of @listener changed.
+ */
+gboolean
+nm_platform_ifindex_listener_set_ifindex (NMPlatformIfindexListener *listener,
+                                          int ifindex)
+{
+	NMPlatformPrivate *priv;
+	IfindexListenerBucket *bucket;
+
+	g_return_val_if_fail (listener, FALSE);
+
+	if (ifindex < 0)
+		ifindex = 0;
+
+	if (listener->ifindex == ifindex)
+		return FALSE;
+
+	priv = NM_PLATFORM_GET_PRIVATE (listener->platform);
+
+	if (listener->ifindex > 0) {
+		c_list_unlink (&listener->lst);
+		bucket = g_hash_table_lookup (priv->ifindex_listeners, GINT_TO_POINTER (listener->ifindex));
+		nm_assert (bucket);
+		if (   c_list_is_empty (&bucket->lst_head)
+		    && bucket->dispatching == 0)
+			g_hash_table_remove (priv->ifindex_listeners, GINT_TO_POINTER (listener->ifindex));
+	}
+
+	listener->ifindex = ifindex;
+
+	if (ifindex > 0) {
+		if (!priv->ifindex_listeners) {
+			priv->ifindex_listeners = g_hash_table_new_full (nm_direct_hash,
+			                                                 NULL,
+			                                                 NULL,
+			                                                 _ifindex_listener_bucket_free);
+		}
+		bucket = g_hash_table_lookup (priv->ifindex_listeners, GINT_TO_POINTER (ifindex));
+		if (!bucket) {
+			bucket = g_slice_new (IfindexListenerBucket);
+			bucket->ifindex = ifindex;
+			bucket->dispatching = 0;
+			c_list_init (&bucket->lst_head);
+			g_hash_table_insert (priv->ifindex_listeners, GINT_TO_POINTER (ifindex), bucket);
+		}
+		c_list_link_tail (&bucket->lst_head, &listener->lst);
+	}
+	return TRUE;
+}
+
+void
+nm_platform_ifindex_listener_free (NMPlatformIfindexListener *listener)
+{
+	NMPlatform *platform;
+
+	if (!listener)
+		return;
+
+	nm_platform_ifindex_listener_set_ifindex (listener, 0);
+	platform = listener->platform;
+	g_slice_free (NMPlatformIfindexListener, listener);
+	g_object_unref (platform);
+}
+
+static void
+_ifindex_listeners_dispatch (NMPlatform *self,
+                             NMPObjectType obj_type,
+                             int ifindex,
+                             const NMPObject *obj,
+                             NMPlatformSignalChangeType change_type)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	IfindexListenerBucket *bucket;
+	NMPlatformIfindexListener *listener;
+	NMPlatformIfindexListener marker = {
+		.callback = NULL,
+	};
+	CList *iter;
+
+	if (   ifindex <= 0
+	    || !priv->ifindex_listeners)
+		return;
+
+	if (!NM_IN_SET (obj_type, NMP_OBJECT_TYPE_LINK,
+	                          NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                          NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                          NMP_OBJECT_TYPE_IP4_ROUTE,
+	                          NMP_OBJECT_TYPE_IP6_ROUTE))
+		return;
+
+	bucket = g_hash_table_lookup (priv->ifindex_listeners, GINT_TO_POINTER (ifindex));
+	if (!bucket)
+		return;
+
+	/* The callbacks may register, re-key or free any listener, and they
+	 * may process platform events, which dispatches again. Hence, we cannot
+	 * remember the next listener while invoking the current one. Instead,
+	 * keep a marker in the list right after the listener that gets invoked,
+	 * and continue after the marker. Markers have no callback. */
+	bucket->dispatching++;
+	c_list_link_front (&bucket->lst_head, &marker.lst);
+
+	while ((iter = marker.lst.next) != &bucket->lst_head) {
+		listener = c_list_entry (iter, NMPlatformIfindexListener, lst);
+
+		c_list_unlink_stale (&marker.lst);
+		c_list_link_after (&listener->lst, &marker.lst);
+
+		if (!listener->callback)
+			continue;
+
+		nm_assert (listener->ifindex == ifindex);
+		listener->callback (self,
+		                    obj_type,
+		                    ifindex,
+		                    &obj->object,
+		                    change_type,
+		                    listener->user_data);
+	}
+
+	c_list_unlink_stale (&marker.lst);
+	if (   --bucket->dispatching == 0
+	    && c_list_is_empty (&bucket->lst_head))
+		g_hash_table_remove (priv->ifindex_listeners, GINT_TO_POINTER (ifindex));
+}
+
 /*****************************************************************************/
 
 void
@@ -8074,6 +9153,8 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 
 	if (klass->obj_type == NMP_OBJECT_TYPE_ROUTING_RULE)
 		ifindex = 0;
+	else if (klass->obj_type == NMP_OBJECT_TYPE_NEXTHOP)
+		ifindex = NMP_OBJECT_CAST_NEXTHOP (o)->ifindex;
 	else
 		ifindex = NMP_OBJECT_CAST_OBJ_WITH_IFINDEX (o)->ifindex;
 
@@ -8095,6 +9176,11 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 	               ifindex,
 	               &o->object,
 	               (int) cache_op);
+	_ifindex_listeners_dispatch (self,
+	                             klass->obj_type,
+	                             ifindex,
+	                             o,
+	                             (NMPlatformSignalChangeType) cache_op);
 	nmp_object_unref (o);
 }
 
@@ -8232,6 +9318,8 @@ finalize (GObject *object)
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_check_id);
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_gc_timeout_id);
 	g_clear_pointer (&priv->ip4_dev_route_blacklist_hash, g_hash_table_unref);
+	nm_assert (!priv->ifindex_listeners || g_hash_table_size (priv->ifindex_listeners) == 0);
+	g_clear_pointer (&priv->ifindex_listeners, g_hash_table_unref);
 	g_clear_object (&self->_netns);
 	nm_dedup_multi_index_unref (priv->multi_idx);
 	nmp_cache_free (priv->cache);
@@ -8299,4 +9387,5 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_ROUTING_RULE, NM_PLATFORM_SIGNAL_ROUTING_RULE_CHANGED, log_routing_rule);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_QDISC,        NM_PLATFORM_SIGNAL_QDISC_CHANGED,        log_qdisc);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_TFILTER,      NM_PLATFORM_SIGNAL_TFILTER_CHANGED,      log_tfilter);
+	SIGNAL (NM_PLATFORM_SIGNAL_ID_NEXTHOP,      NM_PLATFORM_SIGNAL_NEXTHOP_CHANGED,      log_nexthop);
 }
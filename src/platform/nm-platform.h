@@ -260,6 +260,7 @@ typedef enum { /*< skip >*/
 	NM_PLATFORM_SIGNAL_ID_ROUTING_RULE,
 	NM_PLATFORM_SIGNAL_ID_QDISC,
 	NM_PLATFORM_SIGNAL_ID_TFILTER,
+	NM_PLATFORM_SIGNAL_ID_NEXTHOP,
 	_NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -449,6 +450,14 @@ typedef union {
 	/* RTA_PRIORITY (iproute2: metric) */ \
 	guint32 metric; \
 	\
+	/* RTA_NH_ID (iproute2: nhid)
+	 *
+	 * If set, the route references a nexthop object (see #NMPlatformNexthop)
+	 * instead of carrying its own gateway. In that case, the gateway is not
+	 * sent to kernel and ignored in the routes that kernel reports. The ifindex
+	 * must still be set and match the device of the nexthop. */ \
+	guint32 nhid; \
+	\
 	/* rtm_table, RTA_TABLE.
 	 *
 	 * This is not the original table ID. Instead, 254 (RT_TABLE_MAIN) and
@@ -589,6 +598,18 @@ typedef struct {
 	bool     uid_range_has:1;            /* has(FRA_UID_RANGE) */
 } NMPlatformRoutingRule;
 
+typedef struct {
+	/* A kernel nexthop object (RTM_NEWNEXTHOP). Only plain nexthops are
+	 * supported, nexthop groups (NHA_GROUP) are not tracked in the cache. */
+	NMIPAddr gateway;                    /* NHA_GATEWAY */
+	guint32  id;                         /* NHA_ID */
+	int      ifindex;                    /* NHA_OIF */
+	guint32  flags;                      /* (struct nhmsg).nh_flags */
+	guint8   addr_family;                /* (struct nhmsg).nh_family */
+	guint8   protocol;                   /* (struct nhmsg).nh_protocol */
+	bool     blackhole:1;                /* NHA_BLACKHOLE */
+} NMPlatformNexthop;
+
 #define NM_PLATFORM_FQ_CODEL_MEMORY_LIMIT_UNSET   (~((guint32) 0))
 
 #define NM_PLATFORM_FQ_CODEL_CE_THRESHOLD_DISABLED ((guint32) 0x83126E97u)
@@ -674,6 +695,14 @@ typedef struct {
 	NMPlatformAction action;
 } NMPlatformTfilter;
 
+/* A traffic control object (qdisc or tfilter) to add or delete as part
+ * of a batch. See nm_platform_qdisc_sync(). */
+typedef struct {
+	const NMPObject *obj;
+	NMPNlmFlags flags;
+	bool is_delete:1;
+} NMPlatformTcChange;
+
 #undef __NMPlatformObjWithIfindex_COMMON
 
 typedef struct {
@@ -723,6 +752,82 @@ typedef struct {
 	bool pvid:1;
 } NMPlatformBridgeVlan;
 
+#define NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS 16
+
+typedef enum {
+	NM_PLATFORM_LNK_BOND_ATTR_NONE                = 0,
+	NM_PLATFORM_LNK_BOND_ATTR_MODE                = (1LL <<  0),
+	NM_PLATFORM_LNK_BOND_ATTR_ACTIVE_SLAVE        = (1LL <<  1),
+	NM_PLATFORM_LNK_BOND_ATTR_MIIMON              = (1LL <<  2),
+	NM_PLATFORM_LNK_BOND_ATTR_UPDELAY             = (1LL <<  3),
+	NM_PLATFORM_LNK_BOND_ATTR_DOWNDELAY           = (1LL <<  4),
+	NM_PLATFORM_LNK_BOND_ATTR_USE_CARRIER         = (1LL <<  5),
+	NM_PLATFORM_LNK_BOND_ATTR_ARP_INTERVAL        = (1LL <<  6),
+	NM_PLATFORM_LNK_BOND_ATTR_ARP_IP_TARGET       = (1LL <<  7),
+	NM_PLATFORM_LNK_BOND_ATTR_ARP_VALIDATE        = (1LL <<  8),
+	NM_PLATFORM_LNK_BOND_ATTR_ARP_ALL_TARGETS     = (1LL <<  9),
+	NM_PLATFORM_LNK_BOND_ATTR_PRIMARY             = (1LL << 10),
+	NM_PLATFORM_LNK_BOND_ATTR_PRIMARY_RESELECT    = (1LL << 11),
+	NM_PLATFORM_LNK_BOND_ATTR_FAIL_OVER_MAC       = (1LL << 12),
+	NM_PLATFORM_LNK_BOND_ATTR_XMIT_HASH_POLICY    = (1LL << 13),
+	NM_PLATFORM_LNK_BOND_ATTR_RESEND_IGMP         = (1LL << 14),
+	NM_PLATFORM_LNK_BOND_ATTR_NUM_PEER_NOTIF      = (1LL << 15),
+	NM_PLATFORM_LNK_BOND_ATTR_ALL_SLAVES_ACTIVE   = (1LL << 16),
+	NM_PLATFORM_LNK_BOND_ATTR_MIN_LINKS           = (1LL << 17),
+	NM_PLATFORM_LNK_BOND_ATTR_LP_INTERVAL         = (1LL << 18),
+	NM_PLATFORM_LNK_BOND_ATTR_PACKETS_PER_SLAVE   = (1LL << 19),
+	NM_PLATFORM_LNK_BOND_ATTR_AD_LACP_RATE        = (1LL << 20),
+	NM_PLATFORM_LNK_BOND_ATTR_AD_SELECT           = (1LL << 21),
+	NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYS_PRIO   = (1LL << 22),
+	NM_PLATFORM_LNK_BOND_ATTR_AD_USER_PORT_KEY    = (1LL << 23),
+	NM_PLATFORM_LNK_BOND_ATTR_AD_ACTOR_SYSTEM     = (1LL << 24),
+	NM_PLATFORM_LNK_BOND_ATTR_TLB_DYNAMIC_LB      = (1LL << 25),
+} NMPlatformLnkBondAttrs;
+
+typedef struct {
+	in_addr_t arp_ip_target[NM_PLATFORM_LNK_BOND_MAX_ARP_TARGETS];
+	int active_slave;
+	int primary;
+	guint32 arp_all_targets;
+	guint32 arp_interval;
+	guint32 arp_validate;
+	guint32 downdelay;
+	guint32 lp_interval;
+	guint32 miimon;
+	guint32 min_links;
+	guint32 packets_per_slave;
+	guint32 resend_igmp;
+	guint32 updelay;
+	guint16 ad_actor_sys_prio;
+	guint16 ad_user_port_key;
+	guint8 ad_actor_system[6 /* ETH_ALEN */];
+	guint8 ad_select;
+	guint8 all_slaves_active;
+	guint8 arp_ip_targets_num;
+	guint8 fail_over_mac;
+	guint8 lacp_rate;
+	guint8 mode;
+	guint8 num_peer_notif;
+	guint8 primary_reselect;
+	guint8 xmit_hash_policy;
+	bool tlb_dynamic_lb:1;
+	bool use_carrier:1;
+} NMPlatformLnkBond;
+
+typedef struct {
+	/* the time values are in clock_t (USER_HZ), like in sysfs. */
+	guint32 ageing_time;
+	guint32 forward_delay;
+	guint32 hello_time;
+	guint32 max_age;
+	guint16 group_fwd_mask;
+	guint16 priority;
+	guint16 vlan_default_pvid;
+	bool mcast_snooping:1;
+	bool stp_state:1;
+	bool vlan_filtering:1;
+} NMPlatformLnkBridge;
+
 typedef struct {
 	in_addr_t local;
 	in_addr_t remote;
@@ -881,6 +986,9 @@ typedef enum {
 	NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS         = (1LL << 4),
 	NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS     = (1LL << 5),
 
+	/* only update the peer, if it exists already. Never (re-)add it. */
+	NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY            = (1LL << 6),
+
 	NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY
 	                                                 | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL
 	                                                 | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
@@ -973,6 +1081,11 @@ typedef struct {
 	gboolean (*link_refresh) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_netns) (NMPlatform *self, int ifindex, int netns_fd);
 	gboolean (*link_set_up) (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
+	void (*link_set_up_async) (NMPlatform *self,
+	                           int ifindex,
+	                           NMPlatformAsyncCallback callback,
+	                           gpointer callback_data,
+	                           GCancellable *cancellable);
 	gboolean (*link_set_down) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_arp) (NMPlatform *self, int ifindex);
 	gboolean (*link_set_noarp) (NMPlatform *self, int ifindex);
@@ -999,6 +1112,8 @@ typedef struct {
 	                                     GCancellable *cancellable);
 	gboolean (*link_set_sriov_vfs) (NMPlatform *self, int ifindex, const NMPlatformVF *const *vfs);
 	gboolean (*link_set_bridge_vlans) (NMPlatform *self, int ifindex, gboolean on_master, const NMPlatformBridgeVlan *const *vlans);
+	gboolean (*link_del_bridge_vlans) (NMPlatform *self, int ifindex, gboolean on_master, const NMPlatformBridgeVlan *const *vlans);
+	gboolean (*link_get_bridge_vlans) (NMPlatform *self, int ifindex, NMPlatformBridgeVlan **out_vlans, guint *out_len);
 
 	char *   (*link_get_physical_port_id) (NMPlatform *self, int ifindex);
 	guint    (*link_get_dev_id) (NMPlatform *self, int ifindex);
@@ -1026,6 +1141,14 @@ typedef struct {
 	                              guint peers_len,
 	                              NMPlatformWireGuardChangeFlags change_flags);
 
+	gboolean (*link_bond_change) (NMPlatform *self,
+	                              int ifindex,
+	                              const NMPlatformLnkBond *props,
+	                              NMPlatformLnkBondAttrs attrs);
+	gboolean (*link_bridge_change) (NMPlatform *self,
+	                                int ifindex,
+	                                const NMPlatformLnkBridge *props);
+
 	gboolean (*vlan_add) (NMPlatform *self, const char *name, int parent, int vlanid, guint32 vlanflags, const NMPlatformLink **out_link);
 	gboolean (*link_vlan_change) (NMPlatform *self,
 	                              int ifindex,
@@ -1143,6 +1266,10 @@ typedef struct {
 	                         NMPNlmFlags flags,
 	                         const NMPlatformRoutingRule *routing_rule);
 
+	int (*nexthop_add) (NMPlatform *self,
+	                    NMPNlmFlags flags,
+	                    const NMPlatformNexthop *nexthop);
+
 	int (*qdisc_add)   (NMPlatform *self,
 	                    NMPNlmFlags flags,
 	                    const NMPlatformQdisc *qdisc);
@@ -1150,6 +1277,10 @@ typedef struct {
 	int (*tfilter_add)   (NMPlatform *self,
 	                      NMPNlmFlags flags,
 	                      const NMPlatformTfilter *tfilter);
+
+	gboolean (*tc_change_batch) (NMPlatform *self,
+	                             const NMPlatformTcChange *changes,
+	                             guint n_changes);
 } NMPlatformClass;
 
 /* NMPlatform signals
@@ -1171,11 +1302,42 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_ROUTING_RULE_CHANGED "routing-rule-changed"
 #define NM_PLATFORM_SIGNAL_QDISC_CHANGED "qdisc-changed"
 #define NM_PLATFORM_SIGNAL_TFILTER_CHANGED "tfilter-changed"
+#define NM_PLATFORM_SIGNAL_NEXTHOP_CHANGED "nexthop-changed"
 
 const char *nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type);
 
 /*****************************************************************************/
 
+typedef struct _NMPlatformIfindexListener NMPlatformIfindexListener;
+
+/**
+ * NMPlatformIfindexListenerFunc:
+ *
+ * Invoked for every link, address and route change of the ifindex the
+ * listener is registered for, with the same arguments as the corresponding
+ * platform signal. This is called after the GObject signal got emitted.
+ * The callback may register, change or free any listener, including its own,
+ * and it may process platform events. Listeners that get registered for the
+ * ifindex while dispatching are already invoked for the current change.
+ */
+typedef void (*NMPlatformIfindexListenerFunc) (NMPlatform *platform,
+                                               NMPObjectType obj_type,
+                                               int ifindex,
+                                               gconstpointer platform_object,
+                                               NMPlatformSignalChangeType change_type,
+                                               gpointer user_data);
+
+NMPlatformIfindexListener *nm_platform_ifindex_listener_new (NMPlatform *self,
+                                                             NMPlatformIfindexListenerFunc callback,
+                                                             gpointer user_data);
+
+gboolean nm_platform_ifindex_listener_set_ifindex (NMPlatformIfindexListener *listener,
+                                                   int ifindex);
+
+void nm_platform_ifindex_listener_free (NMPlatformIfindexListener *listener);
+
+/*****************************************************************************/
+
 GType nm_platform_get_type (void);
 
 void nm_platform_setup (NMPlatform *instance);
@@ -1416,6 +1578,11 @@ const NMPlatformLink *nm_platform_process_events_ensure_link (NMPlatform *self,
                                                               const char *ifname);
 
 gboolean nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
+void nm_platform_link_set_up_async (NMPlatform *self,
+                                    int ifindex,
+                                    NMPlatformAsyncCallback callback,
+                                    gpointer callback_data,
+                                    GCancellable *cancellable);
 gboolean nm_platform_link_set_down (NMPlatform *self, int ifindex);
 gboolean nm_platform_link_set_arp (NMPlatform *self, int ifindex);
 gboolean nm_platform_link_set_noarp (NMPlatform *self, int ifindex);
@@ -1442,6 +1609,18 @@ void nm_platform_link_set_sriov_params_async (NMPlatform *self,
 
 gboolean nm_platform_link_set_sriov_vfs (NMPlatform *self, int ifindex, const NMPlatformVF *const *vfs);
 gboolean nm_platform_link_set_bridge_vlans (NMPlatform *self, int ifindex, gboolean on_master, const NMPlatformBridgeVlan *const *vlans);
+gboolean nm_platform_link_get_bridge_vlans (NMPlatform *self, int ifindex, NMPlatformBridgeVlan **out_vlans, guint *out_len);
+gboolean nm_platform_link_sync_bridge_vlans (NMPlatform *self, int ifindex, gboolean on_master, const NMPlatformBridgeVlan *const *vlans);
+
+#define NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT   ((guint8) 0x01)
+#define NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED  ((guint8) 0x02)
+#define NM_PLATFORM_BRIDGE_VLAN_STATE_PVID      ((guint8) 0x04)
+
+void _nm_platform_bridge_vlans_to_state (guint8 *state, guint16 *pvid, const NMPlatformBridgeVlan *vlan);
+const NMPlatformBridgeVlan **_nm_platform_bridge_vlans_collect (const guint8 *state_cur,
+                                                                const guint8 *state_new,
+                                                                gboolean for_delete,
+                                                                guint *out_len);
 
 char    *nm_platform_link_get_physical_port_id (NMPlatform *self, int ifindex);
 guint    nm_platform_link_get_dev_id (NMPlatform *self, int ifindex);
@@ -1465,6 +1644,8 @@ gboolean nm_platform_sysctl_slave_set_option (NMPlatform *self, int ifindex, con
 char *nm_platform_sysctl_slave_get_option (NMPlatform *self, int ifindex, const char *option);
 
 const NMPObject *nm_platform_link_get_lnk (NMPlatform *self, int ifindex, NMLinkType link_type, const NMPlatformLink **out_link);
+const NMPlatformLnkBond *nm_platform_link_get_lnk_bond (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
+const NMPlatformLnkBridge *nm_platform_link_get_lnk_bridge (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
 const NMPlatformLnkGre *nm_platform_link_get_lnk_gre (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
 const NMPlatformLnkGre *nm_platform_link_get_lnk_gretap (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
 const NMPlatformLnkIp6Tnl *nm_platform_link_get_lnk_ip6tnl (NMPlatform *self, int ifindex, const NMPlatformLink **out_link);
@@ -1490,6 +1671,14 @@ int nm_platform_link_vlan_add (NMPlatform *self,
                                const NMPlatformLink **out_link);
 gboolean nm_platform_link_vlan_set_ingress_map (NMPlatform *self, int ifindex, int from, int to);
 gboolean nm_platform_link_vlan_set_egress_map (NMPlatform *self, int ifindex, int from, int to);
+gboolean nm_platform_link_bond_change (NMPlatform *self,
+                                       int ifindex,
+                                       const NMPlatformLnkBond *props,
+                                       NMPlatformLnkBondAttrs attrs);
+gboolean nm_platform_link_bridge_change (NMPlatform *self,
+                                         int ifindex,
+                                         const NMPlatformLnkBridge *props);
+
 gboolean nm_platform_link_vlan_change (NMPlatform *self,
                                        int ifindex,
                                        NMVlanFlags flags_mask,
@@ -1667,12 +1856,17 @@ int nm_platform_routing_rule_add (NMPlatform *self,
                                   NMPNlmFlags flags,
                                   const NMPlatformRoutingRule *routing_rule);
 
+int nm_platform_nexthop_add (NMPlatform *self,
+                             NMPNlmFlags flags,
+                             const NMPlatformNexthop *nexthop);
+
 int nm_platform_qdisc_add   (NMPlatform *self,
                              NMPNlmFlags flags,
                              const NMPlatformQdisc *qdisc);
 gboolean nm_platform_qdisc_sync         (NMPlatform *self,
                                          int ifindex,
                                          GPtrArray *known_qdiscs);
+gboolean _nm_platform_qdisc_matches (const NMPlatformQdisc *known, const NMPlatformQdisc *plat);
 
 int nm_platform_tfilter_add   (NMPlatform *self,
                                NMPNlmFlags flags,
@@ -1682,6 +1876,8 @@ gboolean nm_platform_tfilter_sync         (NMPlatform *self,
                                            GPtrArray *known_tfilters);
 
 const char *nm_platform_link_to_string (const NMPlatformLink *link, char *buf, gsize len);
+const char *nm_platform_lnk_bond_to_string (const NMPlatformLnkBond *lnk, char *buf, gsize len);
+const char *nm_platform_lnk_bridge_to_string (const NMPlatformLnkBridge *lnk, char *buf, gsize len);
 const char *nm_platform_lnk_gre_to_string (const NMPlatformLnkGre *lnk, char *buf, gsize len);
 const char *nm_platform_lnk_infiniband_to_string (const NMPlatformLnkInfiniband *lnk, char *buf, gsize len);
 const char *nm_platform_lnk_ip6tnl_to_string (const NMPlatformLnkIp6Tnl *lnk, char *buf, gsize len);
@@ -1700,6 +1896,7 @@ const char *nm_platform_ip6_route_to_string (const NMPlatformIP6Route *route, ch
 const char *nm_platform_routing_rule_to_string (const NMPlatformRoutingRule *routing_rule, char *buf, gsize len);
 const char *nm_platform_qdisc_to_string (const NMPlatformQdisc *qdisc, char *buf, gsize len);
 const char *nm_platform_tfilter_to_string (const NMPlatformTfilter *tfilter, char *buf, gsize len);
+const char *nm_platform_nexthop_to_string (const NMPlatformNexthop *nexthop, char *buf, gsize len);
 const char *nm_platform_vf_to_string (const NMPlatformVF *vf, char *buf, gsize len);
 const char *nm_platform_bridge_vlan_to_string (const NMPlatformBridgeVlan *vlan, char *buf, gsize len);
 
@@ -1714,6 +1911,8 @@ const char *nm_platform_wireguard_peer_to_string (const struct _NMPWireGuardPeer
                                                   gsize len);
 
 int nm_platform_link_cmp (const NMPlatformLink *a, const NMPlatformLink *b);
+int nm_platform_lnk_bond_cmp (const NMPlatformLnkBond *a, const NMPlatformLnkBond *b);
+int nm_platform_lnk_bridge_cmp (const NMPlatformLnkBridge *a, const NMPlatformLnkBridge *b);
 int nm_platform_lnk_gre_cmp (const NMPlatformLnkGre *a, const NMPlatformLnkGre *b);
 int nm_platform_lnk_infiniband_cmp (const NMPlatformLnkInfiniband *a, const NMPlatformLnkInfiniband *b);
 int nm_platform_lnk_ip6tnl_cmp (const NMPlatformLnkIp6Tnl *a, const NMPlatformLnkIp6Tnl *b);
@@ -1753,6 +1952,7 @@ nm_platform_routing_rule_cmp_full (const NMPlatformRoutingRule *a, const NMPlatf
 
 int nm_platform_qdisc_cmp (const NMPlatformQdisc *a, const NMPlatformQdisc *b);
 int nm_platform_tfilter_cmp (const NMPlatformTfilter *a, const NMPlatformTfilter *b);
+int nm_platform_nexthop_cmp (const NMPlatformNexthop *a, const NMPlatformNexthop *b);
 
 void nm_platform_link_hash_update (const NMPlatformLink *obj, NMHashState *h);
 void nm_platform_ip4_address_hash_update (const NMPlatformIP4Address *obj, NMHashState *h);
@@ -1760,6 +1960,8 @@ void nm_platform_ip6_address_hash_update (const NMPlatformIP6Address *obj, NMHas
 void nm_platform_ip4_route_hash_update (const NMPlatformIP4Route *obj, NMPlatformIPRouteCmpType cmp_type, NMHashState *h);
 void nm_platform_ip6_route_hash_update (const NMPlatformIP6Route *obj, NMPlatformIPRouteCmpType cmp_type, NMHashState *h);
 void nm_platform_routing_rule_hash_update (const NMPlatformRoutingRule *obj, NMPlatformRoutingRuleCmpType cmp_type, NMHashState *h);
+void nm_platform_lnk_bond_hash_update (const NMPlatformLnkBond *obj, NMHashState *h);
+void nm_platform_lnk_bridge_hash_update (const NMPlatformLnkBridge *obj, NMHashState *h);
 void nm_platform_lnk_gre_hash_update (const NMPlatformLnkGre *obj, NMHashState *h);
 void nm_platform_lnk_infiniband_hash_update (const NMPlatformLnkInfiniband *obj, NMHashState *h);
 void nm_platform_lnk_ip6tnl_hash_update (const NMPlatformLnkIp6Tnl *obj, NMHashState *h);
@@ -1774,6 +1976,7 @@ void nm_platform_lnk_wireguard_hash_update (const NMPlatformLnkWireGuard *obj, N
 
 void nm_platform_qdisc_hash_update (const NMPlatformQdisc *obj, NMHashState *h);
 void nm_platform_tfilter_hash_update (const NMPlatformTfilter *obj, NMHashState *h);
+void nm_platform_nexthop_hash_update (const NMPlatformNexthop *obj, NMHashState *h);
 
 #define NM_PLATFORM_LINK_FLAGS2STR_MAX_LEN ((gsize) 162)
 
@@ -69,6 +69,11 @@ struct _NMPCache {
 	 * Don't bother, use _idx_type_get() instead! */
 	DedupMultiIdxType idx_types[NMP_CACHE_ID_TYPE_MAX];
 
+	/* an index of the visible routes by (table, destination network), used for
+	 * longest-prefix-match lookups. It is only created on the first such
+	 * lookup and kept up to date by _idxcache_update() afterwards. */
+	struct _RouteDstIdx *route_dst_idx;
+
 	gboolean use_udev;
 };
 
@@ -618,6 +623,249 @@ _wireguard_peer_cmp (const NMPWireGuardPeer *a,
 	return 0;
 }
 
+static guint
+_wireguard_public_key_hash (gconstpointer ptr)
+{
+	NMHashState h;
+
+	nm_hash_init (&h, 1876201381u);
+	nm_hash_update (&h, ptr, NMP_WIREGUARD_PUBLIC_KEY_LEN);
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_wireguard_public_key_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, NMP_WIREGUARD_PUBLIC_KEY_LEN) == 0;
+}
+
+/*
+ * nmp_wireguard_allowed_ips_equal:
+ *
+ * Compares two lists of allowed-ips, regardless of their order. The
+ * host part of the addresses beyond the prefix length is ignored.
+ */
+gboolean
+nmp_wireguard_allowed_ips_equal (const NMPWireGuardAllowedIP *a,
+                                 guint a_len,
+                                 const NMPWireGuardAllowedIP *b,
+                                 guint b_len)
+{
+	guint i, j;
+
+	if (a_len != b_len)
+		return FALSE;
+
+	/* the kernel returns the allowed-ips in its own order. Compare them as sets.
+	 * Peers usually only have a handful of allowed-ips. */
+	for (i = 0; i < a_len; i++) {
+		for (j = 0; j < b_len; j++) {
+			if (   a[i].family != b[j].family
+			    || a[i].mask != b[j].mask)
+				continue;
+			if (  a[i].family == AF_INET
+			    ? nm_utils_ip4_address_same_prefix (a[i].addr.addr4, b[j].addr.addr4, a[i].mask)
+			    : nm_utils_ip6_address_same_prefix (&a[i].addr.addr6, &b[j].addr.addr6, a[i].mask))
+				break;
+		}
+		if (j == b_len)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * nmp_wireguard_reduce_change:
+ * @cached: the current configuration of the device
+ * @lnk_wireguard: the requested device settings
+ * @peers: the requested peers
+ * @peer_flags: (inout): the change flags of each peer in @peers
+ * @peers_len: the number of peers
+ * @change_flags: (inout): the change flags for the device
+ *
+ * Drops the parts of the requested change that already match @cached.
+ * Peers without remaining changes get their flags cleared to
+ * %NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE, so that they are skipped.
+ * @cached must be up to date, otherwise a needed change might be dropped.
+ *
+ * Returns: whether anything is left to change.
+ */
+gboolean
+nmp_wireguard_reduce_change (const NMPObjectLnkWireGuard *cached,
+                             const NMPlatformLnkWireGuard *lnk_wireguard,
+                             const NMPWireGuardPeer *peers,
+                             NMPlatformWireGuardChangePeerFlags *peer_flags,
+                             guint peers_len,
+                             NMPlatformWireGuardChangeFlags *change_flags)
+{
+	gs_unref_hashtable GHashTable *cached_peers = NULL;
+	gboolean has_changes = FALSE;
+	guint i;
+
+	nm_assert (!NM_FLAGS_HAS (*change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_REPLACE_PEERS));
+
+	if (   NM_FLAGS_HAS (*change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY)
+	    && memcmp (lnk_wireguard->private_key, cached->_public.private_key, sizeof (lnk_wireguard->private_key)) == 0)
+		*change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY;
+	if (   NM_FLAGS_HAS (*change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT)
+	    && lnk_wireguard->listen_port == cached->_public.listen_port)
+		*change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT;
+	if (   NM_FLAGS_HAS (*change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK)
+	    && lnk_wireguard->fwmark == cached->_public.fwmark)
+		*change_flags &= ~NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK;
+
+	if (*change_flags != NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE)
+		has_changes = TRUE;
+
+	if (peers_len == 0)
+		return has_changes;
+
+	if (cached->peers_len > 0) {
+		cached_peers = g_hash_table_new (_wireguard_public_key_hash, _wireguard_public_key_equal);
+		for (i = 0; i < cached->peers_len; i++)
+			g_hash_table_insert (cached_peers, (gpointer) cached->peers[i].public_key, (gpointer) &cached->peers[i]);
+	}
+
+	for (i = 0; i < peers_len; i++) {
+		const NMPWireGuardPeer *p = &peers[i];
+		NMPlatformWireGuardChangePeerFlags *plf = &peer_flags[i];
+		const NMPWireGuardPeer *c;
+
+		c = cached_peers
+		    ? g_hash_table_lookup (cached_peers, p->public_key)
+		    : NULL;
+
+		if (NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME)) {
+			if (c)
+				has_changes = TRUE;
+			else
+				*plf = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+			continue;
+		}
+
+		if (!c) {
+			/* a new peer. It's added by the change, unless it's update-only. */
+			if (NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY))
+				*plf = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+			else if (*plf != NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE)
+				has_changes = TRUE;
+			continue;
+		}
+
+		if (   NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY)
+		    && memcmp (p->preshared_key, c->preshared_key, sizeof (p->preshared_key)) == 0)
+			*plf &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY;
+		if (   NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL)
+		    && p->persistent_keepalive_interval == c->persistent_keepalive_interval)
+			*plf &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL;
+		if (   NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT)
+		    && nm_sock_addr_union_cmp (&p->endpoint, &c->endpoint) == 0)
+			*plf &= ~NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT;
+		if (   NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS)
+		    && (   NM_FLAGS_HAS (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS)
+		        || p->allowed_ips_len == 0)
+		    && nmp_wireguard_allowed_ips_equal (p->allowed_ips, p->allowed_ips_len,
+		                                        c->allowed_ips, c->allowed_ips_len)) {
+			*plf &= ~(  NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS
+			          | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS);
+		}
+
+		if (NM_IN_SET (*plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE,
+		                     NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY))
+			*plf = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+		else
+			has_changes = TRUE;
+	}
+
+	return has_changes;
+}
+
+/**
+ * nmp_wireguard_patch_change:
+ * @lnk_cached: the cached NMP_OBJECT_TYPE_LNK_WIREGUARD object
+ * @lnk_wireguard: the device settings that were sent
+ * @peers: the peers that were sent
+ * @peer_flags: (allow-none): the change flags of each peer in @peers
+ * @peers_len: the number of peers
+ * @change_flags: the change flags for the device
+ *
+ * After a successful change that was reduced by nmp_wireguard_reduce_change(),
+ * the resulting configuration is often known without asking the kernel. That
+ * is the case when only the fwmark, or the endpoint, keepalive interval and
+ * preshared-key of existing peers were changed (like after re-resolving
+ * the endpoints).
+ *
+ * Returns: the patched lnk object, or %NULL if the device must be
+ *   dumped again to learn the resulting configuration.
+ */
+NMPObject *
+nmp_wireguard_patch_change (const NMPObject *lnk_cached,
+                            const NMPlatformLnkWireGuard *lnk_wireguard,
+                            const NMPWireGuardPeer *peers,
+                            const NMPlatformWireGuardChangePeerFlags *peer_flags,
+                            guint peers_len,
+                            NMPlatformWireGuardChangeFlags change_flags)
+{
+	nm_auto_nmpobj NMPObject *lnk_new = NULL;
+	gs_unref_hashtable GHashTable *idx = NULL;
+	guint i;
+
+	nm_assert (NMP_OBJECT_GET_TYPE (lnk_cached) == NMP_OBJECT_TYPE_LNK_WIREGUARD);
+
+	if (   !peer_flags
+	    || !NM_IN_SET (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE,
+	                                 NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK))
+		return NULL;
+
+	for (i = 0; i < peers_len; i++) {
+		if (NM_FLAGS_ANY (peer_flags[i], ~(  NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+		                                   | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL
+		                                   | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY
+		                                   | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY)))
+			return NULL;
+	}
+
+	lnk_new = nmp_object_clone (lnk_cached, FALSE);
+
+	if (NM_FLAGS_HAS (change_flags, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK))
+		lnk_new->_lnk_wireguard._public.fwmark = lnk_wireguard->fwmark;
+
+	if (peers_len == 0)
+		return g_steal_pointer (&lnk_new);
+
+	idx = g_hash_table_new (_wireguard_public_key_hash, _wireguard_public_key_equal);
+	for (i = 0; i < lnk_new->_lnk_wireguard.peers_len; i++) {
+		/* the clone owns its peers, so it's fine to modify them. */
+		NMPWireGuardPeer *c = (NMPWireGuardPeer *) &lnk_new->_lnk_wireguard.peers[i];
+
+		g_hash_table_insert (idx, c->public_key, c);
+	}
+
+	for (i = 0; i < peers_len; i++) {
+		const NMPlatformWireGuardChangePeerFlags plf = peer_flags[i];
+		NMPWireGuardPeer *c;
+
+		if (NM_IN_SET (plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE,
+		                    NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY))
+			continue;
+
+		c = g_hash_table_lookup (idx, peers[i].public_key);
+		if (!c) {
+			/* a new peer. We don't know how the kernel would fill in the
+			 * remaining fields. */
+			return NULL;
+		}
+		if (NM_FLAGS_HAS (plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT))
+			c->endpoint = peers[i].endpoint;
+		if (NM_FLAGS_HAS (plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_KEEPALIVE_INTERVAL))
+			c->persistent_keepalive_interval = peers[i].persistent_keepalive_interval;
+		if (NM_FLAGS_HAS (plf, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_PRESHARED_KEY))
+			memcpy (c->preshared_key, peers[i].preshared_key, sizeof (c->preshared_key));
+	}
+
+	return g_steal_pointer (&lnk_new);
+}
+
 /*****************************************************************************/
 
 static const char *
@@ -1088,6 +1336,7 @@ _vt_cmd_plobj_to_string_id (ip4_address, NMPlatformIP4Address, "%d: %s/%d%s%s",
 _vt_cmd_plobj_to_string_id (ip6_address, NMPlatformIP6Address, "%d: %s",        obj->ifindex, nm_utils_inet6_ntop (&obj->address, buf1));
 _vt_cmd_plobj_to_string_id (qdisc,       NMPlatformQdisc,      "%d: %d",        obj->ifindex, obj->parent);
 _vt_cmd_plobj_to_string_id (tfilter,     NMPlatformTfilter,    "%d: %d",        obj->ifindex, obj->parent);
+_vt_cmd_plobj_to_string_id (nexthop,     NMPlatformNexthop,    "%u",            obj->id);
 
 void
 nmp_object_hash_update (const NMPObject *obj, NMHashState *h)
@@ -1454,6 +1703,11 @@ _vt_cmd_plobj_id_cmp (tfilter, NMPlatformTfilter,
                       NM_CMP_FIELD (obj1, obj2, ifindex);
                       NM_CMP_FIELD (obj1, obj2, handle);
 )
+_vt_cmd_plobj_id_cmp (nexthop, NMPlatformNexthop,
+                      /* nexthop IDs are unique per network namespace, regardless
+                       * of the address family. */
+                      NM_CMP_FIELD (obj1, obj2, id);
+)
 
 static int
 _vt_cmd_plobj_id_cmp_ip4_route (const NMPlatformObject *obj1, const NMPlatformObject *obj2)
@@ -1551,6 +1805,9 @@ _vt_cmd_plobj_id_hash_update (tfilter, NMPlatformTfilter, {
 	                     obj->ifindex,
 	                     obj->handle);
 })
+_vt_cmd_plobj_id_hash_update (nexthop, NMPlatformNexthop, {
+	nm_hash_update_val (h, obj->id);
+})
 
 static void
 _vt_cmd_plobj_hash_update_ip4_route (const NMPlatformObject *obj, NMHashState *h)
@@ -1637,6 +1894,12 @@ _vt_cmd_obj_is_alive_tfilter (const NMPObject *obj)
 	return NMP_OBJECT_CAST_TFILTER (obj)->ifindex > 0;
 }
 
+static gboolean
+_vt_cmd_obj_is_alive_nexthop (const NMPObject *obj)
+{
+	return NMP_OBJECT_CAST_NEXTHOP (obj)->id > 0;
+}
+
 gboolean
 nmp_object_is_visible (const NMPObject *obj)
 {
@@ -1698,6 +1961,11 @@ static const guint8 _supported_cache_ids_routing_rules[] = {
 	0,
 };
 
+static const guint8 _supported_cache_ids_nexthop[] = {
+	NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+	0,
+};
+
 /*****************************************************************************/
 
 static void
@@ -1978,6 +2246,7 @@ nmp_lookup_init_obj_type (NMPLookup *lookup,
 	case NMP_OBJECT_TYPE_ROUTING_RULE:
 	case NMP_OBJECT_TYPE_QDISC:
 	case NMP_OBJECT_TYPE_TFILTER:
+	case NMP_OBJECT_TYPE_NEXTHOP:
 		_nmp_object_stackinit_from_type (&lookup->selector_obj, obj_type);
 		lookup->cache_id_type = NMP_CACHE_ID_TYPE_OBJECT_TYPE;
 		return _L (lookup);
@@ -2369,6 +2638,303 @@ _idxcache_update_other_cache_ids (NMPCache *cache,
 		nm_dedup_multi_index_remove_entry (cache->multi_idx, entry_old);
 }
 
+/*****************************************************************************/
+
+/* The destination index groups the routes by (addr_family, table, plen, network).
+ * A longest-prefix-match then requires at most one hash lookup per prefix length
+ * that is in use (similar to the kernel's former fib_hash implementation), which
+ * is much cheaper than iterating over all routes in the cache.
+ *
+ * The buckets only track pointers of the objects in the cache. They are not
+ * referenced, because _idxcache_update() removes them before they get released. */
+
+typedef struct {
+	NMIPAddr network;
+	guint32 table_coerced;
+	int addr_family;
+	guint8 plen;
+	GPtrArray *routes;
+} RouteDstBucket;
+
+typedef struct _RouteDstIdx {
+	GHashTable *buckets;
+
+	/* the number of buckets per prefix length, indexed by [IS_IPv4][plen]. */
+	guint plen_count[2][129];
+} RouteDstIdx;
+
+static guint
+_route_dst_bucket_hash (gconstpointer ptr)
+{
+	const RouteDstBucket *bucket = ptr;
+	NMHashState h;
+
+	nm_hash_init (&h, 2417632131u);
+	nm_hash_update_vals (&h,
+	                     bucket->addr_family,
+	                     bucket->plen,
+	                     bucket->table_coerced);
+	nm_hash_update (&h, &bucket->network, nm_utils_addr_family_to_size (bucket->addr_family));
+	return nm_hash_complete (&h);
+}
+
+static gboolean
+_route_dst_bucket_equal (gconstpointer a, gconstpointer b)
+{
+	const RouteDstBucket *bucket_a = a;
+	const RouteDstBucket *bucket_b = b;
+
+	return    bucket_a->addr_family == bucket_b->addr_family
+	       && bucket_a->plen == bucket_b->plen
+	       && bucket_a->table_coerced == bucket_b->table_coerced
+	       && memcmp (&bucket_a->network, &bucket_b->network, nm_utils_addr_family_to_size (bucket_a->addr_family)) == 0;
+}
+
+static void
+_route_dst_bucket_free (gpointer ptr)
+{
+	RouteDstBucket *bucket = ptr;
+
+	g_ptr_array_unref (bucket->routes);
+	g_slice_free (RouteDstBucket, bucket);
+}
+
+static void
+_route_dst_bucket_init (RouteDstBucket *bucket,
+                        int addr_family,
+                        guint32 table_coerced,
+                        gconstpointer network,
+                        guint8 plen)
+{
+	memset (bucket, 0, sizeof (*bucket));
+	bucket->addr_family = addr_family;
+	bucket->table_coerced = table_coerced;
+	bucket->plen = plen;
+	nm_utils_ipx_address_clear_host_address (addr_family, &bucket->network, network, plen);
+}
+
+static void
+_route_dst_bucket_init_from_obj (RouteDstBucket *bucket,
+                                 const NMPObject *obj)
+{
+	_route_dst_bucket_init (bucket,
+	                        NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP4_ROUTE ? AF_INET : AF_INET6,
+	                        obj->ip_route.table_coerced,
+	                        obj->ip_route.network_ptr,
+	                        obj->ip_route.plen);
+}
+
+static void
+_route_dst_idx_add (RouteDstIdx *idx,
+                    const NMPObject *obj)
+{
+	RouteDstBucket needle;
+	RouteDstBucket *bucket;
+
+	if (!nmp_object_is_visible (obj))
+		return;
+
+	_route_dst_bucket_init_from_obj (&needle, obj);
+	bucket = g_hash_table_lookup (idx->buckets, &needle);
+	if (!bucket) {
+		bucket = g_slice_new (RouteDstBucket);
+		*bucket = needle;
+		bucket->routes = g_ptr_array_new ();
+		g_hash_table_add (idx->buckets, bucket);
+		idx->plen_count[bucket->addr_family == AF_INET][bucket->plen]++;
+	}
+	g_ptr_array_add (bucket->routes, (gpointer) obj);
+}
+
+static void
+_route_dst_idx_remove (RouteDstIdx *idx,
+                       const NMPObject *obj)
+{
+	RouteDstBucket needle;
+	RouteDstBucket *bucket;
+
+	_route_dst_bucket_init_from_obj (&needle, obj);
+	bucket = g_hash_table_lookup (idx->buckets, &needle);
+	if (   !bucket
+	    || !g_ptr_array_remove_fast (bucket->routes, (gpointer) obj))
+		return;
+
+	if (bucket->routes->len == 0) {
+		nm_assert (idx->plen_count[bucket->addr_family == AF_INET][bucket->plen] > 0);
+		idx->plen_count[bucket->addr_family == AF_INET][bucket->plen]--;
+		g_hash_table_remove (idx->buckets, bucket);
+	}
+}
+
+static RouteDstIdx *
+_route_dst_idx_get (NMPCache *cache)
+{
+	static const NMPObjectType obj_types[] = {
+		NMP_OBJECT_TYPE_IP4_ROUTE,
+		NMP_OBJECT_TYPE_IP6_ROUTE,
+	};
+	RouteDstIdx *idx;
+	NMPLookup lookup;
+	NMDedupMultiIter iter;
+	const NMPObject *obj;
+	guint i;
+
+	if (G_LIKELY (cache->route_dst_idx))
+		return cache->route_dst_idx;
+
+	idx = g_slice_new0 (RouteDstIdx);
+	idx->buckets = g_hash_table_new_full (_route_dst_bucket_hash,
+	                                      _route_dst_bucket_equal,
+	                                      _route_dst_bucket_free,
+	                                      NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (obj_types); i++) {
+		nmp_cache_iter_for_each (&iter,
+		                         nmp_cache_lookup (cache,
+		                                           nmp_lookup_init_obj_type (&lookup, obj_types[i])),
+		                         &obj)
+			_route_dst_idx_add (idx, obj);
+	}
+
+	cache->route_dst_idx = idx;
+	return idx;
+}
+
+static void
+_route_dst_idx_free (RouteDstIdx *idx)
+{
+	if (!idx)
+		return;
+	g_hash_table_unref (idx->buckets);
+	g_slice_free (RouteDstIdx, idx);
+}
+
+/**
+ * nmp_cache_lookup_route_best:
+ * @cache: the platform cache
+ * @addr_family: the address family, AF_INET or AF_INET6
+ * @table: the (uncoerced) route table
+ * @dst: the destination address, of size according to @addr_family
+ *
+ * Performs a longest-prefix-match for @dst in the route table @table.
+ * If there are multiple routes for the best matching destination, the
+ * one with the lowest metric is returned. Other route attributes (like
+ * the source prefix of IPv6 routes or the TOS) are not considered.
+ *
+ * Returns: the best route or %NULL, if there is no matching route.
+ */
+const NMPObject *
+nmp_cache_lookup_route_best (NMPCache *cache,
+                             int addr_family,
+                             guint32 table,
+                             gconstpointer dst)
+{
+	const gboolean IS_IPv4 = (addr_family == AF_INET);
+	RouteDstIdx *idx;
+	guint32 table_coerced;
+	int plen;
+
+	nm_assert (cache);
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+	nm_assert (dst);
+
+	idx = _route_dst_idx_get (cache);
+	table_coerced = nm_platform_route_table_coerce (table);
+
+	for (plen = IS_IPv4 ? 32 : 128; plen >= 0; plen--) {
+		RouteDstBucket needle;
+		const RouteDstBucket *bucket;
+		const NMPObject *best = NULL;
+		guint i;
+
+		if (idx->plen_count[IS_IPv4][plen] == 0)
+			continue;
+
+		_route_dst_bucket_init (&needle, addr_family, table_coerced, dst, plen);
+		bucket = g_hash_table_lookup (idx->buckets, &needle);
+		if (!bucket)
+			continue;
+
+		for (i = 0; i < bucket->routes->len; i++) {
+			const NMPObject *obj = bucket->routes->pdata[i];
+
+			if (   !best
+			    || obj->ip_route.metric < best->ip_route.metric)
+				best = obj;
+		}
+		return best;
+	}
+
+	return NULL;
+}
+
+/**
+ * nmp_cache_lookup_routes_in_prefix:
+ * @cache: the platform cache
+ * @addr_family: the address family, AF_INET or AF_INET6
+ * @table: the (uncoerced) route table
+ * @network: the network address of the prefix
+ * @plen: the prefix length
+ *
+ * Returns all routes in @table whose destination lies within
+ * @network/@plen (including routes for exactly that prefix).
+ * Unlike nmp_cache_lookup_route_best(), this visits every distinct
+ * destination in the index once.
+ *
+ * Returns: (transfer container): a #GPtrArray with references to the
+ *   matching route objects, or %NULL if there are none.
+ */
+GPtrArray *
+nmp_cache_lookup_routes_in_prefix (NMPCache *cache,
+                                   int addr_family,
+                                   guint32 table,
+                                   gconstpointer network,
+                                   guint8 plen)
+{
+	RouteDstIdx *idx;
+	RouteDstBucket needle;
+	const RouteDstBucket *bucket;
+	GHashTableIter h_iter;
+	GPtrArray *result = NULL;
+	guint i;
+
+	nm_assert (cache);
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+	nm_assert (network);
+	nm_assert (plen <= (addr_family == AF_INET ? 32 : 128));
+
+	idx = _route_dst_idx_get (cache);
+	_route_dst_bucket_init (&needle,
+	                        addr_family,
+	                        nm_platform_route_table_coerce (table),
+	                        network,
+	                        plen);
+
+	g_hash_table_iter_init (&h_iter, idx->buckets);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &bucket, NULL)) {
+		if (   bucket->addr_family != needle.addr_family
+		    || bucket->table_coerced != needle.table_coerced
+		    || bucket->plen < needle.plen)
+			continue;
+		if (addr_family == AF_INET) {
+			if (!nm_utils_ip4_address_same_prefix (bucket->network.addr4, needle.network.addr4, plen))
+				continue;
+		} else {
+			if (!nm_utils_ip6_address_same_prefix (&bucket->network.addr6, &needle.network.addr6, plen))
+				continue;
+		}
+
+		if (!result)
+			result = g_ptr_array_new_full (bucket->routes->len, (GDestroyNotify) nmp_object_unref);
+		for (i = 0; i < bucket->routes->len; i++)
+			g_ptr_array_add (result, (gpointer) nmp_object_ref (bucket->routes->pdata[i]));
+	}
+
+	return result;
+}
+
+/*****************************************************************************/
+
 static void
 _idxcache_update (NMPCache *cache,
                   const NMDedupMultiEntry *entry_old,
@@ -2448,6 +3014,15 @@ _idxcache_update (NMPCache *cache,
 		                                  is_dump);
 	}
 
+	if (   cache->route_dst_idx
+	    && NM_IN_SET (klass->obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                   NMP_OBJECT_TYPE_IP6_ROUTE)) {
+		if (obj_old)
+			_route_dst_idx_remove (cache->route_dst_idx, obj_old);
+		if (entry_new)
+			_route_dst_idx_add (cache->route_dst_idx, entry_new->obj);
+	}
+
 	NM_SET_OUT (out_entry_new, entry_new);
 }
 
@@ -2990,6 +3565,53 @@ nmp_cache_dirty_set_all_main (NMPCache *cache,
 
 /*****************************************************************************/
 
+void
+nmp_cache_get_stats (const NMPCache *cache,
+                     NMPCacheStats *out_stats)
+{
+	static const NMPObjectType obj_types[] = {
+		NMP_OBJECT_TYPE_LINK,
+		NMP_OBJECT_TYPE_IP4_ADDRESS,
+		NMP_OBJECT_TYPE_IP6_ADDRESS,
+		NMP_OBJECT_TYPE_IP4_ROUTE,
+		NMP_OBJECT_TYPE_IP6_ROUTE,
+		NMP_OBJECT_TYPE_ROUTING_RULE,
+		NMP_OBJECT_TYPE_QDISC,
+		NMP_OBJECT_TYPE_TFILTER,
+		NMP_OBJECT_TYPE_NEXTHOP,
+	};
+	NMPLookup lookup;
+	guint i;
+
+	nm_assert (cache);
+	nm_assert (out_stats);
+
+	memset (out_stats, 0, sizeof (*out_stats));
+
+	/* the counts are tracked by the head entries of the object-type index,
+	 * so this is cheap and needs no additional bookkeeping. The byte counts
+	 * only consider the NMPObject instances themselves, not data that they
+	 * reference (like the udev device of a link). */
+	for (i = 0; i < G_N_ELEMENTS (obj_types); i++) {
+		const NMPClass *klass = nmp_class_from_type (obj_types[i]);
+		const NMDedupMultiHeadEntry *head_entry;
+		guint n;
+
+		head_entry = nmp_cache_lookup (cache, nmp_lookup_init_obj_type (&lookup, obj_types[i]));
+		n = head_entry ? head_entry->len : 0u;
+
+		out_stats->obj_types[obj_types[i] - 1].n_objs = n;
+		out_stats->obj_types[obj_types[i] - 1].n_bytes = n * (G_STRUCT_OFFSET (NMPObject, object) + klass->sizeof_data);
+	}
+
+	if (cache->route_dst_idx)
+		out_stats->n_route_dst_buckets = g_hash_table_size (cache->route_dst_idx->buckets);
+
+	nm_dedup_multi_index_get_stats (cache->multi_idx, &out_stats->multi_idx);
+}
+
+/*****************************************************************************/
+
 NMPCache *
 nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev)
 {
@@ -3013,6 +3635,8 @@ nmp_cache_free (NMPCache *cache)
 	for (i = NMP_CACHE_ID_TYPE_NONE + 1; i <= NMP_CACHE_ID_TYPE_MAX; i++)
 		nm_dedup_multi_index_remove_idx (cache->multi_idx, _idx_type_get (cache, i));
 
+	_route_dst_idx_free (cache->route_dst_idx);
+
 	nm_dedup_multi_index_unref (cache->multi_idx);
 
 	g_slice_free (NMPCache, cache);
@@ -3188,6 +3812,46 @@ const NMPClass _nmp_classes[NMP_OBJECT_TYPE_MAX] = {
 		.cmd_plobj_hash_update              = (void (*) (const NMPlatformObject *obj, NMHashState *h)) nm_platform_tfilter_hash_update,
 		.cmd_plobj_cmp                      = (int (*) (const NMPlatformObject *obj1, const NMPlatformObject *obj2)) nm_platform_tfilter_cmp,
 	},
+	[NMP_OBJECT_TYPE_NEXTHOP - 1] = {
+		.parent                             = DEDUP_MULTI_OBJ_CLASS_INIT(),
+		.obj_type                           = NMP_OBJECT_TYPE_NEXTHOP,
+		.sizeof_data                        = sizeof (NMPObjectNexthop),
+		.sizeof_public                      = sizeof (NMPlatformNexthop),
+		.obj_type_name                      = "nexthop",
+		.rtm_gettype                        = RTM_GETNEXTHOP,
+		.signal_type_id                     = NM_PLATFORM_SIGNAL_ID_NEXTHOP,
+		.signal_type                        = NM_PLATFORM_SIGNAL_NEXTHOP_CHANGED,
+		.supported_cache_ids                = _supported_cache_ids_nexthop,
+		.cmd_obj_is_alive                   = _vt_cmd_obj_is_alive_nexthop,
+		.cmd_plobj_id_cmp                   = _vt_cmd_plobj_id_cmp_nexthop,
+		.cmd_plobj_id_hash_update           = _vt_cmd_plobj_id_hash_update_nexthop,
+		.cmd_plobj_to_string_id             = _vt_cmd_plobj_to_string_id_nexthop,
+		.cmd_plobj_to_string                = (const char *(*) (const NMPlatformObject *obj, char *buf, gsize len)) nm_platform_nexthop_to_string,
+		.cmd_plobj_hash_update              = (void (*) (const NMPlatformObject *obj, NMHashState *h)) nm_platform_nexthop_hash_update,
+		.cmd_plobj_cmp                      = (int (*) (const NMPlatformObject *obj1, const NMPlatformObject *obj2)) nm_platform_nexthop_cmp,
+	},
+	[NMP_OBJECT_TYPE_LNK_BOND - 1] = {
+		.parent                             = DEDUP_MULTI_OBJ_CLASS_INIT(),
+		.obj_type                           = NMP_OBJECT_TYPE_LNK_BOND,
+		.sizeof_data                        = sizeof (NMPObjectLnkBond),
+		.sizeof_public                      = sizeof (NMPlatformLnkBond),
+		.obj_type_name                      = "bond",
+		.lnk_link_type                      = NM_LINK_TYPE_BOND,
+		.cmd_plobj_to_string                = (const char *(*) (const NMPlatformObject *obj, char *buf, gsize len)) nm_platform_lnk_bond_to_string,
+		.cmd_plobj_hash_update              = (void (*) (const NMPlatformObject *obj, NMHashState *h)) nm_platform_lnk_bond_hash_update,
+		.cmd_plobj_cmp                      = (int (*) (const NMPlatformObject *obj1, const NMPlatformObject *obj2)) nm_platform_lnk_bond_cmp,
+	},
+	[NMP_OBJECT_TYPE_LNK_BRIDGE - 1] = {
+		.parent                             = DEDUP_MULTI_OBJ_CLASS_INIT(),
+		.obj_type                           = NMP_OBJECT_TYPE_LNK_BRIDGE,
+		.sizeof_data                        = sizeof (NMPObjectLnkBridge),
+		.sizeof_public                      = sizeof (NMPlatformLnkBridge),
+		.obj_type_name                      = "bridge",
+		.lnk_link_type                      = NM_LINK_TYPE_BRIDGE,
+		.cmd_plobj_to_string                = (const char *(*) (const NMPlatformObject *obj, char *buf, gsize len)) nm_platform_lnk_bridge_to_string,
+		.cmd_plobj_hash_update              = (void (*) (const NMPlatformObject *obj, NMHashState *h)) nm_platform_lnk_bridge_hash_update,
+		.cmd_plobj_cmp                      = (int (*) (const NMPlatformObject *obj1, const NMPlatformObject *obj2)) nm_platform_lnk_bridge_cmp,
+	},
 	[NMP_OBJECT_TYPE_LNK_GRE - 1] = {
 		.parent                             = DEDUP_MULTI_OBJ_CLASS_INIT(),
 		.obj_type                           = NMP_OBJECT_TYPE_LNK_GRE,
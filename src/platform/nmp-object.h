@@ -243,6 +243,14 @@ typedef struct {
 	int wireguard_family_id;
 } NMPObjectLink;
 
+typedef struct {
+	NMPlatformLnkBond _public;
+} NMPObjectLnkBond;
+
+typedef struct {
+	NMPlatformLnkBridge _public;
+} NMPObjectLnkBridge;
+
 typedef struct {
 	NMPlatformLnkGre _public;
 } NMPObjectLnkGre;
@@ -326,6 +334,10 @@ typedef struct {
 	NMPlatformTfilter _public;
 } NMPObjectTfilter;
 
+typedef struct {
+	NMPlatformNexthop _public;
+} NMPObjectNexthop;
+
 struct _NMPObject {
 	union {
 		NMDedupMultiObj parent;
@@ -339,6 +351,12 @@ struct _NMPObject {
 		NMPlatformLink          link;
 		NMPObjectLink           _link;
 
+		NMPlatformLnkBond       lnk_bond;
+		NMPObjectLnkBond        _lnk_bond;
+
+		NMPlatformLnkBridge     lnk_bridge;
+		NMPObjectLnkBridge      _lnk_bridge;
+
 		NMPlatformLnkGre        lnk_gre;
 		NMPObjectLnkGre         _lnk_gre;
 
@@ -393,6 +411,9 @@ struct _NMPObject {
 		NMPObjectQdisc          _qdisc;
 		NMPlatformTfilter       tfilter;
 		NMPObjectTfilter        _tfilter;
+
+		NMPlatformNexthop       nexthop;
+		NMPObjectNexthop        _nexthop;
 	};
 };
 
@@ -480,6 +501,8 @@ _NMP_OBJECT_TYPE_IS_OBJ_WITH_IFINDEX (NMPObjectType obj_type)
 
 	case NMP_OBJECT_TYPE_TFILTER:
 
+	case NMP_OBJECT_TYPE_LNK_BOND:
+	case NMP_OBJECT_TYPE_LNK_BRIDGE:
 	case NMP_OBJECT_TYPE_LNK_GRE:
 	case NMP_OBJECT_TYPE_LNK_GRETAP:
 	case NMP_OBJECT_TYPE_LNK_INFINIBAND:
@@ -540,6 +563,7 @@ _NMP_OBJECT_TYPE_IS_OBJ_WITH_IFINDEX (NMPObjectType obj_type)
 #define NMP_OBJECT_CAST_ROUTING_RULE(obj)  _NMP_OBJECT_CAST (obj, routing_rule,  NMP_OBJECT_TYPE_ROUTING_RULE)
 #define NMP_OBJECT_CAST_QDISC(obj)         _NMP_OBJECT_CAST (obj, qdisc,         NMP_OBJECT_TYPE_QDISC)
 #define NMP_OBJECT_CAST_TFILTER(obj)       _NMP_OBJECT_CAST (obj, tfilter,       NMP_OBJECT_TYPE_TFILTER)
+#define NMP_OBJECT_CAST_NEXTHOP(obj)       _NMP_OBJECT_CAST (obj, nexthop,       NMP_OBJECT_TYPE_NEXTHOP)
 #define NMP_OBJECT_CAST_LNK_WIREGUARD(obj) _NMP_OBJECT_CAST (obj, lnk_wireguard, NMP_OBJECT_TYPE_LNK_WIREGUARD)
 
 static inline const NMPObject *
@@ -631,6 +655,25 @@ gboolean nmp_object_is_visible (const NMPObject *obj);
 
 void _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gboolean use_udev);
 
+gboolean nmp_wireguard_allowed_ips_equal (const NMPWireGuardAllowedIP *a,
+                                          guint a_len,
+                                          const NMPWireGuardAllowedIP *b,
+                                          guint b_len);
+
+gboolean nmp_wireguard_reduce_change (const NMPObjectLnkWireGuard *cached,
+                                      const NMPlatformLnkWireGuard *lnk_wireguard,
+                                      const NMPWireGuardPeer *peers,
+                                      NMPlatformWireGuardChangePeerFlags *peer_flags,
+                                      guint peers_len,
+                                      NMPlatformWireGuardChangeFlags *change_flags);
+
+NMPObject *nmp_wireguard_patch_change (const NMPObject *lnk_cached,
+                                       const NMPlatformLnkWireGuard *lnk_wireguard,
+                                       const NMPWireGuardPeer *peers,
+                                       const NMPlatformWireGuardChangePeerFlags *peer_flags,
+                                       guint peers_len,
+                                       NMPlatformWireGuardChangeFlags change_flags);
+
 static inline void
 _nm_auto_nmpobj_cleanup (gpointer p)
 {
@@ -699,6 +742,16 @@ const NMPLookup *nmp_lookup_init_object_by_addr_family (NMPLookup *lookup,
                                                         NMPObjectType obj_type,
                                                         int addr_family);
 
+const NMPObject *nmp_cache_lookup_route_best (NMPCache *cache,
+                                              int addr_family,
+                                              guint32 table,
+                                              gconstpointer dst);
+GPtrArray *nmp_cache_lookup_routes_in_prefix (NMPCache *cache,
+                                              int addr_family,
+                                              guint32 table,
+                                              gconstpointer network,
+                                              guint8 plen);
+
 GArray *nmp_cache_lookup_to_array (const NMDedupMultiHeadEntry *head_entry,
                                    NMPObjectType obj_type,
                                    gboolean visible_only);
@@ -819,6 +872,22 @@ void nmp_cache_dirty_set_all_main (NMPCache *cache,
 NMPCache *nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev);
 void nmp_cache_free (NMPCache *cache);
 
+typedef struct {
+	/* indexed by obj_type - 1. Only object types that are cached
+	 * on their own have non-zero values. */
+	struct {
+		guint n_objs;
+		gsize n_bytes;
+	} obj_types[NMP_OBJECT_TYPE_MAX];
+
+	guint n_route_dst_buckets;
+
+	NMDedupMultiIndexStats multi_idx;
+} NMPCacheStats;
+
+void nmp_cache_get_stats (const NMPCache *cache,
+                          NMPCacheStats *out_stats);
+
 static inline void
 ASSERT_nmp_cache_ops (const NMPCache *cache,
                       NMPCacheOpsType ops_type,
@@ -867,6 +936,19 @@ const NMDedupMultiEntry *nm_platform_lookup_entry (NMPlatform *platform,
                                                    NMPCacheIdType cache_id_type,
                                                    const NMPObject *obj);
 
+void nm_platform_get_cache_stats (NMPlatform *platform,
+                                  NMPCacheStats *out_stats);
+
+const NMPObject *nm_platform_ip_route_lookup_best (NMPlatform *platform,
+                                                   int addr_family,
+                                                   guint32 table,
+                                                   gconstpointer dst);
+GPtrArray *nm_platform_ip_route_lookup_prefix (NMPlatform *platform,
+                                               int addr_family,
+                                               guint32 table,
+                                               gconstpointer network,
+                                               guint8 plen);
+
 static inline const NMPObject *
 nm_platform_lookup_obj (NMPlatform *platform,
                         NMPCacheIdType cache_id_type,
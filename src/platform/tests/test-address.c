@@ -5,6 +5,8 @@
 
 #include "nm-default.h"
 
+#include "nm-ip4-config.h"
+
 #include "test-common.h"
 
 #define IP4_ADDRESS "192.0.2.1"
@@ -338,6 +340,148 @@ test_ip4_address_peer_zero (void)
 
 /*****************************************************************************/
 
+static void
+_capture_changed_cb (NMPlatform *platform,
+                     NMPObjectType obj_type,
+                     int ifindex,
+                     gconstpointer platform_object,
+                     NMPlatformSignalChangeType change_type,
+                     gpointer user_data)
+{
+	GHashTable *changed = user_data;
+
+	if (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                         NMP_OBJECT_TYPE_IP4_ROUTE))
+		g_hash_table_add (changed, (gpointer) nmp_object_ref (NMP_OBJECT_UP_CAST (platform_object)));
+}
+
+static void
+_capture_apply_changes (GHashTable *changed, NMIP4Config *captured, NMIP4Config *ext)
+{
+	GHashTableIter h_iter;
+	const NMPObject *obj;
+
+	/* like NMDevice, apply the current state of every changed object. */
+	g_hash_table_iter_init (&h_iter, changed);
+	while (g_hash_table_iter_next (&h_iter, (gpointer *) &obj, NULL)) {
+		const NMPObject *plobj;
+		NMPlatformSignalChangeType change_type;
+
+		plobj = nm_platform_lookup_obj (NM_PLATFORM_GET, NMP_CACHE_ID_TYPE_OBJECT_TYPE, obj);
+		if (   plobj
+		    && nmp_object_is_visible (plobj))
+			change_type = NM_PLATFORM_SIGNAL_CHANGED;
+		else {
+			plobj = obj;
+			change_type = NM_PLATFORM_SIGNAL_REMOVED;
+		}
+		g_assert (nm_ip4_config_capture_update (captured, NM_PLATFORM_GET, plobj, change_type));
+		g_assert (nm_ip4_config_capture_update (ext, NM_PLATFORM_GET, plobj, change_type));
+	}
+	g_hash_table_remove_all (changed);
+}
+
+static void
+_capture_assert_equal (const NMIP4Config *a, const NMIP4Config *b)
+{
+	NMDedupMultiIter ipconf_iter;
+	const NMPlatformIP4Address *address;
+	const NMPlatformIP4Route *route;
+
+	/* the order of the routes may differ. */
+	g_assert_cmpint (nm_ip4_config_get_num_addresses (a), ==, nm_ip4_config_get_num_addresses (b));
+	g_assert_cmpint (nm_ip4_config_get_num_routes (a), ==, nm_ip4_config_get_num_routes (b));
+	nm_ip_config_iter_ip4_address_for_each (&ipconf_iter, a, &address)
+		g_assert (nmp_object_equal (nm_ip4_config_nmpobj_lookup (b, NMP_OBJECT_UP_CAST (address)), NMP_OBJECT_UP_CAST (address)));
+	nm_ip_config_iter_ip4_route_for_each (&ipconf_iter, a, &route)
+		g_assert (nmp_object_equal (nm_ip4_config_nmpobj_lookup (b, NMP_OBJECT_UP_CAST (route)), NMP_OBJECT_UP_CAST (route)));
+}
+
+static void
+test_ip4_address_capture_update (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	NMDedupMultiIndex *multi_idx = nm_platform_get_multi_idx (NM_PLATFORM_GET);
+	gs_unref_hashtable GHashTable *changed = NULL;
+	gs_unref_object NMIP4Config *captured = NULL;
+	gs_unref_object NMIP4Config *ext = NULL;
+	gs_unref_object NMIP4Config *internal = NULL;
+	NMPlatformIfindexListener *listener;
+	NMPlatformIP4Address a_internal = {
+		.ifindex = ifindex,
+		.plen = IP4_PLEN,
+		.lifetime = NM_PLATFORM_LIFETIME_PERMANENT,
+		.preferred = NM_PLATFORM_LIFETIME_PERMANENT,
+	};
+	in_addr_t addr;
+	in_addr_t addr2;
+
+	inet_pton (AF_INET, IP4_ADDRESS, &addr);
+	inet_pton (AF_INET, IP4_ADDRESS_PEER2, &addr2);
+
+	changed = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+	                                 (GEqualFunc) nmp_object_id_equal,
+	                                 (GDestroyNotify) nmp_object_unref,
+	                                 NULL);
+	listener = nm_platform_ifindex_listener_new (NM_PLATFORM_GET, _capture_changed_cb, changed);
+	nm_platform_ifindex_listener_set_ifindex (listener, ifindex);
+
+	nmtstp_ip4_address_add (NULL, EX, ifindex, addr, IP4_PLEN, addr, NM_PLATFORM_LIFETIME_PERMANENT, NM_PLATFORM_LIFETIME_PERMANENT, 0, NULL);
+
+	captured = nm_ip4_config_capture (multi_idx, NM_PLATFORM_GET, ifindex);
+	g_assert (captured);
+	g_hash_table_remove_all (changed);
+
+	/* the external configuration has the internal one subtracted. */
+	a_internal.address = addr;
+	a_internal.peer_address = addr;
+	internal = nm_ip4_config_new (multi_idx, ifindex);
+	nm_ip4_config_add_address (internal, &a_internal);
+	ext = nm_ip4_config_clone (captured);
+	nm_ip4_config_subtract (ext, internal, 0);
+	g_assert (!nm_ip4_config_nmpobj_lookup (ext, NMP_OBJECT_UP_CAST (nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, addr, IP4_PLEN, addr))));
+
+	/* add an address, and change the internal one. */
+	nmtstp_ip4_address_add (NULL, EX, ifindex, addr2, IP4_PLEN, addr2, NM_PLATFORM_LIFETIME_PERMANENT, NM_PLATFORM_LIFETIME_PERMANENT, 0, NULL);
+	nmtstp_ip4_address_add (NULL, EX, ifindex, addr, IP4_PLEN, addr, 2000, 1000, 0, NULL);
+	g_assert_cmpint (g_hash_table_size (changed), >, 0);
+	_capture_apply_changes (changed, captured, ext);
+	nm_ip4_config_subtract (ext, internal, 0);
+
+	{
+		gs_unref_object NMIP4Config *expected = NULL;
+		gs_unref_object NMIP4Config *expected_ext = NULL;
+
+		expected = nm_ip4_config_capture (multi_idx, NM_PLATFORM_GET, ifindex);
+		_capture_assert_equal (captured, expected);
+
+		expected_ext = nm_ip4_config_clone (expected);
+		nm_ip4_config_subtract (expected_ext, internal, 0);
+		_capture_assert_equal (ext, expected_ext);
+		g_assert (nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, addr2, IP4_PLEN, addr2));
+		g_assert_cmpint (nm_ip4_config_get_num_addresses (ext), ==, 1);
+	}
+
+	/* remove both addresses again. */
+	nmtstp_ip4_address_del (NULL, EX, ifindex, addr, IP4_PLEN, addr);
+	nmtstp_ip4_address_del (NULL, EX, ifindex, addr2, IP4_PLEN, addr2);
+	_capture_apply_changes (changed, captured, ext);
+	nm_ip4_config_subtract (ext, internal, 0);
+
+	{
+		gs_unref_object NMIP4Config *expected = NULL;
+
+		expected = nm_ip4_config_capture (multi_idx, NM_PLATFORM_GET, ifindex);
+		_capture_assert_equal (captured, expected);
+		g_assert_cmpint (nm_ip4_config_get_num_addresses (captured), ==, 0);
+		g_assert_cmpint (nm_ip4_config_get_num_addresses (ext), ==, 0);
+	}
+
+	nm_platform_ifindex_listener_free (listener);
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -362,4 +506,6 @@ _nmtstp_setup_tests (void)
 
 	add_test_func ("/address/ipv4/peer", test_ip4_address_peer);
 	add_test_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
+
+	add_test_func ("/address/ipv4/capture-update", test_ip4_address_capture_update);
 }
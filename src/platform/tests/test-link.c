@@ -615,6 +615,165 @@ test_internal (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	NMPlatformIfindexListener *listener;
+	NMPlatformIfindexListener **p_other;
+	int take_over_ifindex;
+	int last_ifindex;
+	guint n_called;
+} ListenerData;
+
+static void
+_ifindex_listener_cb (NMPlatform *platform,
+                      NMPObjectType obj_type,
+                      int ifindex,
+                      gconstpointer platform_object,
+                      NMPlatformSignalChangeType change_type,
+                      gpointer user_data)
+{
+	ListenerData *data = user_data;
+
+	data->n_called++;
+	data->last_ifindex = ifindex;
+
+	if (data->take_over_ifindex > 0) {
+		/* like nm_device_take_over_link(), re-key our own listener and
+		 * drop another listener of the bucket that is being dispatched. */
+		nm_platform_ifindex_listener_set_ifindex (data->listener, data->take_over_ifindex);
+		data->take_over_ifindex = 0;
+		nm_clear_pointer (data->p_other, nm_platform_ifindex_listener_free);
+	}
+}
+
+static void
+test_ifindex_listener (void)
+{
+	ListenerData data1 = { 0 };
+	ListenerData data2 = { 0 };
+	int ifindex_a;
+	int ifindex_b;
+
+	ifindex_a = nmtstp_link_dummy_add (NM_PLATFORM_GET, -1, "nm-test-lst-a")->ifindex;
+	ifindex_b = nmtstp_link_dummy_add (NM_PLATFORM_GET, -1, "nm-test-lst-b")->ifindex;
+
+	data1.listener = nm_platform_ifindex_listener_new (NM_PLATFORM_GET, _ifindex_listener_cb, &data1);
+	data2.listener = nm_platform_ifindex_listener_new (NM_PLATFORM_GET, _ifindex_listener_cb, &data2);
+	g_assert (nm_platform_ifindex_listener_set_ifindex (data1.listener, ifindex_a));
+	g_assert (!nm_platform_ifindex_listener_set_ifindex (data1.listener, ifindex_a));
+	g_assert (nm_platform_ifindex_listener_set_ifindex (data2.listener, ifindex_a));
+
+	data1.take_over_ifindex = ifindex_b;
+	data1.p_other = &data2.listener;
+
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, ifindex_a, NULL));
+	g_assert_cmpint (data1.n_called, ==, 1);
+	g_assert_cmpint (data1.last_ifindex, ==, ifindex_a);
+	g_assert_cmpint (data2.n_called, ==, 0);
+	g_assert (!data2.listener);
+
+	/* after the take-over, the listener follows the new ifindex. */
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, ifindex_b, NULL));
+	g_assert_cmpint (data1.n_called, >=, 2);
+	g_assert_cmpint (data1.last_ifindex, ==, ifindex_b);
+
+	nm_clear_pointer (&data1.listener, nm_platform_ifindex_listener_free);
+
+	nmtstp_link_delete (NULL, -1, ifindex_a, "nm-test-lst-a", TRUE);
+	nmtstp_link_delete (NULL, -1, ifindex_b, "nm-test-lst-b", TRUE);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	GMainLoop *loop;
+	guint n_called;
+	int error_code;
+	bool cancelled:1;
+} SetUpAsyncData;
+
+static void
+_link_set_up_async_cb (GError *error, gpointer user_data)
+{
+	SetUpAsyncData *data = user_data;
+
+	data->n_called++;
+	data->error_code = error ? error->code : 0;
+	data->cancelled = nm_utils_error_is_cancelled (error, FALSE);
+	g_main_loop_quit (data->loop);
+}
+
+static void
+test_link_set_up_async (void)
+{
+	SetUpAsyncData data = { 0 };
+	gs_unref_object GCancellable *cancellable = NULL;
+	int ifindex;
+
+	data.loop = g_main_loop_new (NULL, FALSE);
+	ifindex = nmtstp_link_dummy_add (NM_PLATFORM_GET, -1, DEVICE_NAME)->ifindex;
+	g_assert (!nm_platform_link_is_up (NM_PLATFORM_GET, ifindex));
+
+	/* the callback is never invoked synchronously. */
+	nm_platform_link_set_up_async (NM_PLATFORM_GET, ifindex, _link_set_up_async_cb, &data, NULL);
+	g_assert_cmpint (data.n_called, ==, 0);
+	if (!nmtst_main_loop_run (data.loop, 2000))
+		g_assert_not_reached ();
+	g_assert_cmpint (data.n_called, ==, 1);
+	g_assert_cmpint (data.error_code, ==, 0);
+	g_assert (nm_platform_link_is_up (NM_PLATFORM_GET, ifindex));
+
+	/* neither for an invalid ifindex. */
+	data.n_called = 0;
+	nm_platform_link_set_up_async (NM_PLATFORM_GET, 0, _link_set_up_async_cb, &data, NULL);
+	g_assert_cmpint (data.n_called, ==, 0);
+	if (!nmtst_main_loop_run (data.loop, 2000))
+		g_assert_not_reached ();
+	g_assert_cmpint (data.n_called, ==, 1);
+	g_assert (!data.cancelled);
+	g_assert_cmpint (data.error_code, !=, 0);
+
+	/* a cancelled request still invokes the callback. */
+	data.n_called = 0;
+	cancellable = g_cancellable_new ();
+	g_cancellable_cancel (cancellable);
+	nm_platform_link_set_up_async (NM_PLATFORM_GET, ifindex, _link_set_up_async_cb, &data, cancellable);
+	g_assert_cmpint (data.n_called, ==, 0);
+	if (!nmtst_main_loop_run (data.loop, 2000))
+		g_assert_not_reached ();
+	g_assert_cmpint (data.n_called, ==, 1);
+	g_assert (data.cancelled);
+
+	nmtstp_link_delete (NULL, -1, ifindex, DEVICE_NAME, TRUE);
+	g_main_loop_unref (data.loop);
+}
+
+/*****************************************************************************/
+
+static void
+test_cache_stats (void)
+{
+	NMPCacheStats stats;
+	guint n_links;
+	int ifindex;
+
+	nm_platform_get_cache_stats (NM_PLATFORM_GET, &stats);
+	n_links = stats.obj_types[NMP_OBJECT_TYPE_LINK - 1].n_objs;
+	g_assert_cmpint (n_links, >, 0);
+	g_assert_cmpint (stats.multi_idx.n_objs, >=, n_links);
+
+	ifindex = nmtstp_link_dummy_add (NM_PLATFORM_GET, -1, DEVICE_NAME)->ifindex;
+
+	nm_platform_get_cache_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_LINK - 1].n_objs, ==, n_links + 1);
+
+	nmtstp_link_delete (NULL, -1, ifindex, DEVICE_NAME, TRUE);
+
+	nm_platform_get_cache_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_LINK - 1].n_objs, ==, n_links);
+}
+
+/*****************************************************************************/
+
 static void
 test_external (void)
 {
@@ -2078,6 +2237,120 @@ test_vlan_set_xgress (void)
 
 /*****************************************************************************/
 
+static void
+test_bond_change (void)
+{
+	const NMPlatformLink *plink;
+	const NMPlatformLnkBond *plnk;
+	NMPlatformLnkBond lnk;
+	int ifindex;
+
+	if (   !g_file_test ("/proc/1/net/bonding", G_FILE_TEST_IS_DIR)
+	    && _system ("modprobe --show bonding") != 0) {
+		g_test_skip ("Skipping test for bonding: bonding module not available");
+		return;
+	}
+
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_bond_add (NM_PLATFORM_GET, DEVICE_NAME, &plink)));
+	ifindex = plink->ifindex;
+
+	plnk = nm_platform_link_get_lnk_bond (NM_PLATFORM_GET, ifindex, NULL);
+	g_assert (plnk);
+	g_assert_cmpint (plnk->mode, ==, 0 /* balance-rr */);
+
+	/* the mode can only be changed while the bond is down. */
+	lnk = *plnk;
+	lnk.mode = 1 /* active-backup */;
+	g_assert (nm_platform_link_bond_change (NM_PLATFORM_GET, ifindex, &lnk, NM_PLATFORM_LNK_BOND_ATTR_MODE));
+
+	lnk.miimon = 100;
+	lnk.updelay = 200;
+	lnk.downdelay = 300;
+	lnk.xmit_hash_policy = 2 /* layer2+3 */;
+	lnk.arp_validate = 6 /* filter_backup */;
+	lnk.min_links = 2;
+	lnk.resend_igmp = 3;
+	lnk.use_carrier = FALSE;
+	g_assert (nm_platform_link_bond_change (NM_PLATFORM_GET,
+	                                        ifindex,
+	                                        &lnk,
+	                                          NM_PLATFORM_LNK_BOND_ATTR_MIIMON
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_UPDELAY
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_DOWNDELAY
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_XMIT_HASH_POLICY
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_ARP_VALIDATE
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_MIN_LINKS
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_RESEND_IGMP
+	                                        | NM_PLATFORM_LNK_BOND_ATTR_USE_CARRIER));
+
+	plnk = nm_platform_link_get_lnk_bond (NM_PLATFORM_GET, ifindex, NULL);
+	g_assert (plnk);
+	g_assert_cmpint (plnk->mode, ==, 1);
+	g_assert_cmpint (plnk->miimon, ==, 100);
+	g_assert_cmpint (plnk->updelay, ==, 200);
+	g_assert_cmpint (plnk->downdelay, ==, 300);
+	g_assert_cmpint (plnk->xmit_hash_policy, ==, 2);
+	g_assert_cmpint (plnk->arp_validate, ==, 6);
+	g_assert_cmpint (plnk->min_links, ==, 2);
+	g_assert_cmpint (plnk->resend_igmp, ==, 3);
+	g_assert (!plnk->use_carrier);
+
+	/* options that are not in the mask are left alone. */
+	lnk = *plnk;
+	lnk.miimon = 500;
+	lnk.min_links = 4;
+	g_assert (nm_platform_link_bond_change (NM_PLATFORM_GET, ifindex, &lnk, NM_PLATFORM_LNK_BOND_ATTR_MIN_LINKS));
+
+	plnk = nm_platform_link_get_lnk_bond (NM_PLATFORM_GET, ifindex, NULL);
+	g_assert (plnk);
+	g_assert_cmpint (plnk->miimon, ==, 100);
+	g_assert_cmpint (plnk->min_links, ==, 4);
+
+	nmtstp_link_delete (NULL, -1, ifindex, DEVICE_NAME, TRUE);
+}
+
+static void
+test_bridge_change (void)
+{
+	const NMPlatformLink *plink;
+	const NMPlatformLnkBridge *plnk;
+	NMPlatformLnkBridge lnk;
+	int ifindex;
+
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_link_bridge_add (NM_PLATFORM_GET, DEVICE_NAME, NULL, 0, &plink)));
+	ifindex = plink->ifindex;
+
+	plnk = nm_platform_link_get_lnk_bridge (NM_PLATFORM_GET, ifindex, NULL);
+	g_assert (plnk);
+	g_assert (!plnk->stp_state);
+
+	/* the time values are in clock_t, like in sysfs. */
+	lnk = *plnk;
+	lnk.forward_delay = 1000;
+	lnk.hello_time = 300;
+	lnk.max_age = 2500;
+	lnk.ageing_time = 30000;
+	lnk.priority = 4096;
+	lnk.group_fwd_mask = 0x8;
+	lnk.mcast_snooping = FALSE;
+	g_assert (nm_platform_link_bridge_change (NM_PLATFORM_GET, ifindex, &lnk));
+
+	plnk = nm_platform_link_get_lnk_bridge (NM_PLATFORM_GET, ifindex, NULL);
+	g_assert (plnk);
+	g_assert_cmpint (plnk->forward_delay, ==, 1000);
+	g_assert_cmpint (plnk->hello_time, ==, 300);
+	g_assert_cmpint (plnk->max_age, ==, 2500);
+	g_assert_cmpint (plnk->ageing_time, ==, 30000);
+	g_assert_cmpint (plnk->priority, ==, 4096);
+	g_assert_cmpint (plnk->group_fwd_mask, ==, 0x8);
+	g_assert (!plnk->mcast_snooping);
+	g_assert (!plnk->stp_state);
+
+	nmtstp_link_delete (NULL, -1, ifindex, DEVICE_NAME, TRUE);
+}
+
+/*****************************************************************************/
+
 static void
 test_create_many_links_do (guint n_devices)
 {
@@ -3278,6 +3551,9 @@ _nmtstp_setup_tests (void)
 	g_test_add_func ("/link/bogus", test_bogus);
 	g_test_add_func ("/link/loopback", test_loopback);
 	g_test_add_func ("/link/internal", test_internal);
+	g_test_add_func ("/link/ifindex-listener", test_ifindex_listener);
+	g_test_add_func ("/link/cache-stats", test_cache_stats);
+	g_test_add_func ("/link/set-up-async", test_link_set_up_async);
 	g_test_add_func ("/link/software/bridge", test_bridge);
 	g_test_add_func ("/link/software/bond", test_bond);
 	g_test_add_func ("/link/software/team", test_team);
@@ -3306,6 +3582,8 @@ _nmtstp_setup_tests (void)
 		test_software_detect_add ("/link/software/detect/wireguard/2", NM_LINK_TYPE_WIREGUARD, 2);
 
 		g_test_add_func ("/link/software/vlan/set-xgress", test_vlan_set_xgress);
+		g_test_add_func ("/link/software/bond/change", test_bond_change);
+		g_test_add_func ("/link/software/bridge/change", test_bridge_change);
 
 		g_test_add_data_func ("/link/create-many-links/20", GUINT_TO_POINTER (20), test_create_many_links);
 		g_test_add_data_func ("/link/create-many-links/1000", GUINT_TO_POINTER (1000), test_create_many_links);
@@ -7,6 +7,7 @@
 
 #include <libudev.h>
 #include <linux/pkt_sched.h>
+#include <linux/rtnetlink.h>
 
 #include "platform/nmp-object.h"
 #include "nm-udev-aux/nm-udev-utils.h"
@@ -524,6 +525,513 @@ test_cache_qdisc (void)
 
 /*****************************************************************************/
 
+static void
+test_cache_route_lpm (void)
+{
+	NMPCache *cache;
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	const NMPlatformIP4Route pl_default = {
+		.ifindex = 1,
+		.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+		.network = 0,
+		.plen = 0,
+		.metric = 100,
+	};
+	const NMPlatformIP4Route pl_net16 = {
+		.ifindex = 1,
+		.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+		.network = nmtst_inet4_from_string ("192.168.0.0"),
+		.plen = 16,
+		.metric = 100,
+	};
+	const NMPlatformIP4Route pl_net24a = {
+		.ifindex = 1,
+		.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+		.network = nmtst_inet4_from_string ("192.168.1.0"),
+		.plen = 24,
+		.metric = 200,
+	};
+	const NMPlatformIP4Route pl_net24b = {
+		.ifindex = 2,
+		.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+		.network = nmtst_inet4_from_string ("192.168.1.0"),
+		.plen = 24,
+		.metric = 50,
+	};
+	nm_auto_nmpobj NMPObject *obj_default = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_default);
+	nm_auto_nmpobj NMPObject *obj_net16 = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_net16);
+	nm_auto_nmpobj NMPObject *obj_net24a = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_net24a);
+	nm_auto_nmpobj NMPObject *obj_net24b = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_net24b);
+	in_addr_t addr_1_5 = nmtst_inet4_from_string ("192.168.1.5");
+	in_addr_t addr_2_5 = nmtst_inet4_from_string ("192.168.2.5");
+	in_addr_t addr_other = nmtst_inet4_from_string ("10.0.0.1");
+	in_addr_t net_168 = nmtst_inet4_from_string ("192.168.0.0");
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, nmtst_get_rand_uint32 () % 2);
+
+	g_assert (nmp_cache_update_netlink (cache, obj_default, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_update_netlink (cache, obj_net24a, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+
+	/* the index is created lazily on the first lookup... */
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_1_5) == obj_net24a);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_2_5) == obj_default);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, 1000, &addr_1_5) == NULL);
+
+	/* ... and updated afterwards. */
+	g_assert (nmp_cache_update_netlink (cache, obj_net16, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_update_netlink (cache, obj_net24b, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_1_5) == obj_net24b);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_2_5) == obj_net16);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_other) == obj_default);
+
+	routes = nmp_cache_lookup_routes_in_prefix (cache, AF_INET, RT_TABLE_MAIN, &net_168, 16);
+	g_assert (routes);
+	g_assert_cmpint (routes->len, ==, 3);
+	g_clear_pointer (&routes, g_ptr_array_unref);
+
+	g_assert (nmp_cache_remove (cache, obj_net24b, TRUE, FALSE, NULL) == NMP_CACHE_OPS_REMOVED);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_1_5) == obj_net24a);
+
+	g_assert (nmp_cache_remove (cache, obj_net24a, TRUE, FALSE, NULL) == NMP_CACHE_OPS_REMOVED);
+	g_assert (nmp_cache_lookup_route_best (cache, AF_INET, RT_TABLE_MAIN, &addr_1_5) == obj_net16);
+
+	routes = nmp_cache_lookup_routes_in_prefix (cache, AF_INET, RT_TABLE_MAIN, &addr_1_5, 24);
+	g_assert (!routes);
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static void
+test_cache_nexthop (void)
+{
+	NMPCache *cache;
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPLookup lookup;
+	const NMDedupMultiHeadEntry *head_entry;
+	const NMPlatformNexthop pl_nh_1a = {
+		.id = 1,
+		.addr_family = AF_INET,
+		.ifindex = 2,
+		.gateway.addr4 = nmtst_inet4_from_string ("192.168.1.1"),
+	};
+	const NMPlatformNexthop pl_nh_1b = {
+		.id = 1,
+		.addr_family = AF_INET,
+		.ifindex = 2,
+		.gateway.addr4 = nmtst_inet4_from_string ("192.168.1.2"),
+	};
+	const NMPlatformNexthop pl_nh_2 = {
+		.id = 2,
+		.addr_family = AF_INET6,
+		.ifindex = 2,
+		.gateway.addr6 = *nmtst_inet6_from_string ("fe80::1"),
+	};
+	const NMPlatformIP4Route pl_route_a = {
+		.ifindex = 2,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = nmtst_inet4_from_string ("10.0.0.0"),
+		.plen = 8,
+		.metric = 100,
+		.nhid = 1,
+	};
+	const NMPlatformIP4Route pl_route_b = {
+		.ifindex = 2,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = nmtst_inet4_from_string ("10.0.0.0"),
+		.plen = 8,
+		.metric = 100,
+		.gateway = nmtst_inet4_from_string ("192.168.1.1"),
+	};
+	nm_auto_nmpobj NMPObject *obj1a = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_1a);
+	nm_auto_nmpobj NMPObject *obj1b = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_1b);
+	nm_auto_nmpobj NMPObject *obj2 = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_2);
+	nm_auto_nmpobj NMPObject *obj_route_a = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_route_a);
+	nm_auto_nmpobj NMPObject *obj_route_b = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_route_b);
+
+	/* nexthops are identified by their ID alone. */
+	g_assert (nmp_object_id_equal (obj1a, obj1b));
+	g_assert (!nmp_object_equal (obj1a, obj1b));
+	g_assert (!nmp_object_id_equal (obj1a, obj2));
+
+	/* a route referencing a nexthop differs from a route with the
+	 * same gateway. */
+	g_assert (!nmp_object_equal (obj_route_a, obj_route_b));
+	g_assert (nm_platform_ip4_route_cmp_full (&pl_route_a, &pl_route_b) != 0);
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, nmtst_get_rand_uint32 () % 2);
+
+	g_assert (nmp_cache_update_netlink (cache, obj1a, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_lookup_obj (cache, obj1a) == obj1a);
+	g_assert (nmp_cache_lookup_obj (cache, obj1b) == obj1a);
+	g_assert (nmp_cache_lookup_obj (cache, obj2) == NULL);
+
+	/* replacing the nexthop updates the object in place. */
+	g_assert (nmp_cache_update_netlink (cache, obj1b, FALSE, NULL, NULL) == NMP_CACHE_OPS_UPDATED);
+	g_assert (nmp_cache_lookup_obj (cache, obj1a) == obj1b);
+
+	g_assert (nmp_cache_update_netlink (cache, obj2, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_lookup_obj (cache, obj2) == obj2);
+
+	head_entry = nmp_cache_lookup (cache,
+	                               nmp_lookup_init_obj_type (&lookup,
+	                                                         NMP_OBJECT_TYPE_NEXTHOP));
+	g_assert (head_entry);
+	g_assert_cmpint (head_entry->len, ==, 2);
+
+	g_assert (nmp_cache_update_netlink (cache, obj_route_a, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_update_netlink (cache, obj_route_b, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_lookup_obj (cache, obj_route_a) == obj_route_a);
+	g_assert (nmp_cache_lookup_obj (cache, obj_route_b) == obj_route_b);
+
+	g_assert (nmp_cache_remove (cache, obj1b, TRUE, FALSE, NULL) == NMP_CACHE_OPS_REMOVED);
+	g_assert (nmp_cache_lookup_obj (cache, obj1a) == NULL);
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static void
+test_cache_stats (void)
+{
+	NMPCache *cache;
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCacheStats stats;
+	const NMPClass *klass;
+	const NMPlatformNexthop pl_nh_1 = {
+		.id = 1,
+		.addr_family = AF_INET,
+		.ifindex = 2,
+		.gateway.addr4 = nmtst_inet4_from_string ("192.168.1.1"),
+	};
+	const NMPlatformNexthop pl_nh_2 = {
+		.id = 2,
+		.addr_family = AF_INET,
+		.ifindex = 2,
+		.gateway.addr4 = nmtst_inet4_from_string ("192.168.1.2"),
+	};
+	const NMPlatformIP4Route pl_route = {
+		.ifindex = 2,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = nmtst_inet4_from_string ("10.0.0.0"),
+		.plen = 8,
+		.metric = 100,
+	};
+	nm_auto_nmpobj NMPObject *obj_nh_1 = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_1);
+	nm_auto_nmpobj NMPObject *obj_nh_1b = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_1);
+	nm_auto_nmpobj NMPObject *obj_nh_2 = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (NMPlatformObject *) &pl_nh_2);
+	nm_auto_nmpobj NMPObject *obj_route = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (NMPlatformObject *) &pl_route);
+	const NMDedupMultiObj *obj_interned;
+	guint64 n_hits;
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, nmtst_get_rand_uint32 () % 2);
+
+	nmp_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_NEXTHOP - 1].n_objs, ==, 0);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_IP4_ROUTE - 1].n_objs, ==, 0);
+	g_assert_cmpint (stats.multi_idx.n_objs, ==, 0);
+
+	g_assert (nmp_cache_update_netlink (cache, obj_nh_1, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_update_netlink (cache, obj_nh_2, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+	g_assert (nmp_cache_update_netlink (cache, obj_route, FALSE, NULL, NULL) == NMP_CACHE_OPS_ADDED);
+
+	nmp_cache_get_stats (cache, &stats);
+	klass = nmp_class_from_type (NMP_OBJECT_TYPE_NEXTHOP);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_NEXTHOP - 1].n_objs, ==, 2);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_NEXTHOP - 1].n_bytes, ==, 2 * (G_STRUCT_OFFSET (NMPObject, object) + klass->sizeof_data));
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_IP4_ROUTE - 1].n_objs, ==, 1);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_IP6_ROUTE - 1].n_objs, ==, 0);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_LINK - 1].n_objs, ==, 0);
+	g_assert_cmpint (stats.multi_idx.n_objs, ==, 3);
+	g_assert_cmpint (stats.multi_idx.n_entries, >, 3);
+	g_assert_cmpint (stats.multi_idx.n_intern_misses, >=, 3);
+
+	/* interning an equal object shares the cached instance. */
+	n_hits = stats.multi_idx.n_intern_hits;
+	obj_interned = nm_dedup_multi_index_obj_intern (multi_idx, (const NMDedupMultiObj *) obj_nh_1b);
+	g_assert (obj_interned == (const NMDedupMultiObj *) obj_nh_1);
+	nm_dedup_multi_obj_unref (obj_interned);
+	nmp_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.multi_idx.n_intern_hits, ==, n_hits + 1);
+	g_assert_cmpint (stats.multi_idx.n_objs, ==, 3);
+
+	g_assert (nmp_cache_remove (cache, obj_nh_2, TRUE, FALSE, NULL) == NMP_CACHE_OPS_REMOVED);
+	nmp_cache_get_stats (cache, &stats);
+	g_assert_cmpint (stats.obj_types[NMP_OBJECT_TYPE_NEXTHOP - 1].n_objs, ==, 1);
+
+	/* the removed object stays interned while we hold a reference. */
+	g_assert_cmpint (stats.multi_idx.n_objs, ==, 3);
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static NMPWireGuardAllowedIP
+_wg_aip4 (const char *addr, guint8 mask)
+{
+	return (NMPWireGuardAllowedIP) {
+		.family     = AF_INET,
+		.mask       = mask,
+		.addr.addr4 = nmtst_inet4_from_string (addr),
+	};
+}
+
+static NMPWireGuardAllowedIP
+_wg_aip6 (const char *addr, guint8 mask)
+{
+	return (NMPWireGuardAllowedIP) {
+		.family     = AF_INET6,
+		.mask       = mask,
+		.addr.addr6 = *nmtst_inet6_from_string (addr),
+	};
+}
+
+static void
+test_wireguard_allowed_ips_equal (void)
+{
+	const NMPWireGuardAllowedIP a[] = {
+		_wg_aip4 ("192.168.1.0", 24),
+		_wg_aip6 ("fd01::", 64),
+		_wg_aip4 ("10.0.0.1", 32),
+	};
+	const NMPWireGuardAllowedIP b[] = {
+		_wg_aip4 ("10.0.0.1", 32),
+		_wg_aip4 ("192.168.1.5", 24),
+		_wg_aip6 ("fd01::1", 64),
+	};
+	const NMPWireGuardAllowedIP c[] = {
+		_wg_aip4 ("10.0.0.1", 32),
+		_wg_aip4 ("192.168.1.0", 25),
+		_wg_aip6 ("fd01::", 64),
+	};
+	const NMPWireGuardAllowedIP d[] = {
+		_wg_aip4 ("10.0.0.1", 32),
+		_wg_aip4 ("192.168.1.0", 24),
+		_wg_aip4 ("192.168.1.0", 24),
+	};
+
+	g_assert (nmp_wireguard_allowed_ips_equal (NULL, 0, NULL, 0));
+	g_assert (nmp_wireguard_allowed_ips_equal (a, G_N_ELEMENTS (a), a, G_N_ELEMENTS (a)));
+
+	/* the order and the host part don't matter. */
+	g_assert (nmp_wireguard_allowed_ips_equal (a, G_N_ELEMENTS (a), b, G_N_ELEMENTS (b)));
+	g_assert (nmp_wireguard_allowed_ips_equal (b, G_N_ELEMENTS (b), a, G_N_ELEMENTS (a)));
+
+	/* the prefix length and the family do. */
+	g_assert (!nmp_wireguard_allowed_ips_equal (a, G_N_ELEMENTS (a), c, G_N_ELEMENTS (c)));
+	g_assert (!nmp_wireguard_allowed_ips_equal (a, G_N_ELEMENTS (a), d, G_N_ELEMENTS (d)));
+	g_assert (!nmp_wireguard_allowed_ips_equal (a, G_N_ELEMENTS (a), a, G_N_ELEMENTS (a) - 1));
+	g_assert (!nmp_wireguard_allowed_ips_equal (a, 1, NULL, 0));
+}
+
+static void
+test_wireguard_reduce_change (void)
+{
+	const NMPWireGuardAllowedIP aips1[] = {
+		_wg_aip4 ("10.0.0.1", 32),
+		_wg_aip6 ("fd01::1", 128),
+	};
+	const NMPWireGuardAllowedIP aips1_reordered[] = {
+		_wg_aip6 ("fd01::1", 128),
+		_wg_aip4 ("10.0.0.1", 32),
+	};
+	const NMPWireGuardAllowedIP aips2[] = {
+		_wg_aip4 ("10.0.0.2", 32),
+	};
+	NMPWireGuardPeer cached_peers[2] = { };
+	NMPWireGuardPeer peers[4] = { };
+	NMPObjectLnkWireGuard cached;
+	NMPlatformLnkWireGuard lnk;
+	NMPlatformWireGuardChangePeerFlags peer_flags[G_N_ELEMENTS (peers)];
+	NMPlatformWireGuardChangeFlags change_flags;
+	guint i;
+
+	cached_peers[0] = (NMPWireGuardPeer) {
+		.endpoint.in = {
+			.sin_family      = AF_INET,
+			.sin_port        = htons (51820),
+			.sin_addr.s_addr = nmtst_inet4_from_string ("192.0.2.1"),
+		},
+		.persistent_keepalive_interval = 25,
+		.allowed_ips                   = aips1,
+		.allowed_ips_len               = G_N_ELEMENTS (aips1),
+	};
+	memset (cached_peers[0].public_key, 1, sizeof (cached_peers[0].public_key));
+	memset (cached_peers[0].preshared_key, 11, sizeof (cached_peers[0].preshared_key));
+
+	cached_peers[1] = (NMPWireGuardPeer) {
+		.allowed_ips     = aips2,
+		.allowed_ips_len = G_N_ELEMENTS (aips2),
+	};
+	memset (cached_peers[1].public_key, 2, sizeof (cached_peers[1].public_key));
+
+	cached = (NMPObjectLnkWireGuard) {
+		._public = {
+			.listen_port = 51820,
+			.fwmark      = 5,
+		},
+		.peers     = cached_peers,
+		.peers_len = G_N_ELEMENTS (cached_peers),
+	};
+	memset (cached._public.private_key, 42, sizeof (cached._public.private_key));
+
+	/* the device settings are unchanged, only the fwmark differs. */
+	lnk = cached._public;
+	lnk.fwmark = 6;
+	change_flags =   NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY
+	               | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT
+	               | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK;
+	g_assert (nmp_wireguard_reduce_change (&cached, &lnk, NULL, NULL, 0, &change_flags));
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK);
+
+	lnk.fwmark = cached._public.fwmark;
+	change_flags =   NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_PRIVATE_KEY
+	               | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT
+	               | NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK;
+	g_assert (!nmp_wireguard_reduce_change (&cached, &lnk, NULL, NULL, 0, &change_flags));
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+
+	/* peer #0 is identical, the allowed-ips are just in another order. */
+	peers[0] = cached_peers[0];
+	peers[0].allowed_ips = aips1_reordered;
+
+	/* peer #1 only has a new endpoint. */
+	peers[1] = cached_peers[1];
+	peers[1].endpoint.in = (struct sockaddr_in) {
+		.sin_family      = AF_INET,
+		.sin_port        = htons (51820),
+		.sin_addr.s_addr = nmtst_inet4_from_string ("192.0.2.2"),
+	};
+
+	/* peer #2 is unknown. */
+	memset (peers[2].public_key, 3, sizeof (peers[2].public_key));
+
+	/* peer #3 is unknown too, and shall be removed. */
+	memset (peers[3].public_key, 4, sizeof (peers[3].public_key));
+
+	for (i = 0; i < G_N_ELEMENTS (peers); i++) {
+		peer_flags[i] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT
+		                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS;
+	}
+	peer_flags[3] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+
+	change_flags = NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE;
+	g_assert (nmp_wireguard_reduce_change (&cached, &lnk, peers, peer_flags, G_N_ELEMENTS (peers), &change_flags));
+	g_assert_cmpint (change_flags, ==, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert_cmpint (peer_flags[0], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE);
+	g_assert_cmpint (peer_flags[1], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT);
+	g_assert_cmpint (peer_flags[2], ==,   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_DEFAULT
+	                                    | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REPLACE_ALLOWEDIPS);
+	g_assert_cmpint (peer_flags[3], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE);
+
+	/* an update-only change of an unknown peer is dropped, and so is a
+	 * change that only carries the update-only flag. */
+	peer_flags[0] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+	                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+	peer_flags[2] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+	                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+	peer_flags[3] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+	g_assert (!nmp_wireguard_reduce_change (&cached, &lnk, peers, peer_flags, G_N_ELEMENTS (peers), &change_flags));
+	for (i = 0; i < G_N_ELEMENTS (peers); i++)
+		g_assert_cmpint (peer_flags[i], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE);
+
+	/* an update-only change of a known peer is kept. */
+	peer_flags[1] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+	                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+	g_assert (nmp_wireguard_reduce_change (&cached, &lnk, peers, peer_flags, G_N_ELEMENTS (peers), &change_flags));
+	g_assert_cmpint (peer_flags[1], ==,   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+	                                    | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY);
+
+	/* removing a known peer is kept. */
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+	g_assert (nmp_wireguard_reduce_change (&cached, &lnk, peers, peer_flags, G_N_ELEMENTS (peers), &change_flags));
+	g_assert_cmpint (peer_flags[1], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME);
+
+	/* appending allowed-ips (without replacing) that differ is kept. */
+	peers[1].allowed_ips = aips1;
+	peers[1].allowed_ips_len = G_N_ELEMENTS (aips1);
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+	g_assert (nmp_wireguard_reduce_change (&cached, &lnk, peers, peer_flags, G_N_ELEMENTS (peers), &change_flags));
+	g_assert_cmpint (peer_flags[1], ==, NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS);
+}
+
+static void
+test_wireguard_patch_change (void)
+{
+	nm_auto_nmpobj NMPObject *lnk_cached = NULL;
+	nm_auto_nmpobj NMPObject *lnk_patched = NULL;
+	NMPWireGuardPeer *cached_peers;
+	NMPWireGuardPeer peers[2] = { };
+	NMPlatformWireGuardChangePeerFlags peer_flags[G_N_ELEMENTS (peers)];
+	NMPlatformLnkWireGuard lnk;
+
+	lnk_cached = nmp_object_new (NMP_OBJECT_TYPE_LNK_WIREGUARD, NULL);
+	lnk_cached->_lnk_wireguard._public.listen_port = 51820;
+	lnk_cached->_lnk_wireguard._public.fwmark = 5;
+	cached_peers = g_new0 (NMPWireGuardPeer, 2);
+	memset (cached_peers[0].public_key, 1, sizeof (cached_peers[0].public_key));
+	memset (cached_peers[1].public_key, 2, sizeof (cached_peers[1].public_key));
+	cached_peers[1].persistent_keepalive_interval = 25;
+	lnk_cached->_lnk_wireguard.peers = cached_peers;
+	lnk_cached->_lnk_wireguard.peers_len = 2;
+
+	lnk = lnk_cached->_lnk_wireguard._public;
+
+	/* only the endpoint of peer #1 changed. */
+	peers[0] = cached_peers[1];
+	peers[0].endpoint.in = (struct sockaddr_in) {
+		.sin_family      = AF_INET,
+		.sin_port        = htons (51820),
+		.sin_addr.s_addr = nmtst_inet4_from_string ("192.0.2.2"),
+	};
+	peer_flags[0] =   NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT
+	                | NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_UPDATE_ONLY;
+	lnk_patched = nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 1, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE);
+	g_assert (lnk_patched);
+	g_assert (lnk_patched != lnk_cached);
+	g_assert_cmpint (lnk_patched->_lnk_wireguard.peers_len, ==, 2);
+	g_assert (nm_sock_addr_union_cmp (&lnk_patched->_lnk_wireguard.peers[1].endpoint, &peers[0].endpoint) == 0);
+	g_assert_cmpint (lnk_patched->_lnk_wireguard.peers[1].persistent_keepalive_interval, ==, 25);
+	g_assert_cmpint (lnk_patched->_lnk_wireguard.peers[0].endpoint.sa.sa_family, ==, AF_UNSPEC);
+	g_assert_cmpint (cached_peers[1].endpoint.sa.sa_family, ==, AF_UNSPEC);
+	g_clear_pointer (&lnk_patched, nmp_object_unref);
+
+	/* the fwmark can be patched too. */
+	lnk.fwmark = 6;
+	lnk_patched = nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 0, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_FWMARK);
+	g_assert (lnk_patched);
+	g_assert_cmpint (lnk_patched->_lnk_wireguard._public.fwmark, ==, 6);
+	g_clear_pointer (&lnk_patched, nmp_object_unref);
+
+	/* a listen-port of zero lets the kernel choose the port. We cannot know it. */
+	lnk.listen_port = 0;
+	g_assert (!nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 0, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_HAS_LISTEN_PORT));
+
+	/* the kernel orders the allowed-ips on its own. */
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ALLOWEDIPS;
+	g_assert (!nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 1, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE));
+
+	/* removing a peer. */
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_REMOVE_ME;
+	g_assert (!nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 1, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE));
+
+	/* adding a new peer. */
+	memset (peers[1].public_key, 3, sizeof (peers[1].public_key));
+	peer_flags[0] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_NONE;
+	peer_flags[1] = NM_PLATFORM_WIREGUARD_CHANGE_PEER_FLAG_HAS_ENDPOINT;
+	g_assert (!nmp_wireguard_patch_change (lnk_cached, &lnk, peers, peer_flags, 2, NM_PLATFORM_WIREGUARD_CHANGE_FLAG_NONE));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -569,6 +1077,12 @@ main (int argc, char **argv)
 	g_test_add_func ("/nmp-object/obj-base", test_obj_base);
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
 	g_test_add_func ("/nmp-object/cache_qdisc", test_cache_qdisc);
+	g_test_add_func ("/nmp-object/cache_route_lpm", test_cache_route_lpm);
+	g_test_add_func ("/nmp-object/cache_nexthop", test_cache_nexthop);
+	g_test_add_func ("/nmp-object/cache_stats", test_cache_stats);
+	g_test_add_func ("/nmp-object/wireguard_allowed_ips_equal", test_wireguard_allowed_ips_equal);
+	g_test_add_func ("/nmp-object/wireguard_reduce_change", test_wireguard_reduce_change);
+	g_test_add_func ("/nmp-object/wireguard_patch_change", test_wireguard_patch_change);
 
 	result = g_test_run ();
 
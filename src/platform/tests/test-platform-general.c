@@ -6,6 +6,7 @@
 #include "nm-default.h"
 
 #include <linux/rtnetlink.h>
+#include <linux/pkt_sched.h>
 
 #include "platform/nm-platform-utils.h"
 #include "platform/nm-linux-platform.h"
@@ -62,6 +63,251 @@ test_nm_platform_link_flags2str (void)
 
 /*****************************************************************************/
 
+static guint16
+_bridge_vlans_fill_state (guint8 *state,
+                          const NMPlatformBridgeVlan *vlans,
+                          guint len)
+{
+	guint16 pvid = 0;
+	guint i;
+
+	memset (state, 0, NM_BRIDGE_VLAN_VID_MAX + 1);
+	for (i = 0; i < len; i++)
+		_nm_platform_bridge_vlans_to_state (state, &pvid, &vlans[i]);
+	return pvid;
+}
+
+static void
+_assert_bridge_vlan (const NMPlatformBridgeVlan *vlan,
+                     guint16 vid_start,
+                     guint16 vid_end,
+                     gboolean untagged,
+                     gboolean pvid)
+{
+	g_assert (vlan);
+	g_assert_cmpint (vlan->vid_start, ==, vid_start);
+	g_assert_cmpint (vlan->vid_end, ==, vid_end);
+	g_assert_cmpint (vlan->untagged, ==, untagged);
+	g_assert_cmpint (vlan->pvid, ==, pvid);
+}
+
+static void
+test_bridge_vlans_to_state (void)
+{
+	guint8 state[NM_BRIDGE_VLAN_VID_MAX + 1];
+	const NMPlatformBridgeVlan vlans[] = {
+		{ .vid_start = 10, .vid_end = 12, .untagged = TRUE },
+		{ .vid_start = 5,  .vid_end = 5,  .pvid = TRUE },
+		{ .vid_start = 6,  .vid_end = 6,  .pvid = TRUE, .untagged = TRUE },
+		{ .vid_start = 0,  .vid_end = 4095 + 10 },
+	};
+	const NMPlatformBridgeVlan vlans_large[] = {
+		{ .vid_start = 300,  .vid_end = 300,  .pvid = TRUE },
+		{ .vid_start = 10,   .vid_end = 10,   .pvid = TRUE },
+		{ .vid_start = 4000, .vid_end = 4000, .pvid = TRUE },
+		{ .vid_start = 4000, .vid_end = 4000, .untagged = TRUE },
+	};
+
+	g_assert_cmpint (_bridge_vlans_fill_state (state, vlans, 3), ==, 6);
+	g_assert_cmpint (state[10], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT | NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED);
+	g_assert_cmpint (state[12], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT | NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED);
+	g_assert_cmpint (state[13], ==, 0);
+
+	/* there can only be one PVID, the later one wins. */
+	g_assert_cmpint (state[5], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT);
+	g_assert_cmpint (state[6], ==,   NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT
+	                               | NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED
+	                               | NM_PLATFORM_BRIDGE_VLAN_STATE_PVID);
+
+	/* invalid VIDs are ignored. */
+	g_assert_cmpint (_bridge_vlans_fill_state (state, &vlans[3], 1), ==, 0);
+	g_assert_cmpint (state[0], ==, 0);
+	g_assert_cmpint (state[NM_BRIDGE_VLAN_VID_MIN], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT);
+	g_assert_cmpint (state[NM_BRIDGE_VLAN_VID_MAX], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT);
+
+	/* PVIDs above 255 are tracked correctly. */
+	g_assert_cmpint (_bridge_vlans_fill_state (state, vlans_large, 2), ==, 10);
+	g_assert_cmpint (state[300], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT);
+	g_assert_cmpint (state[300 & 0xFF], ==, 0);
+	g_assert_cmpint (state[10], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT | NM_PLATFORM_BRIDGE_VLAN_STATE_PVID);
+
+	/* a later entry without PVID flag for the same VID drops the PVID. */
+	g_assert_cmpint (_bridge_vlans_fill_state (state, vlans_large, 4), ==, 0);
+	g_assert_cmpint (state[10], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT);
+	g_assert_cmpint (state[4000], ==, NM_PLATFORM_BRIDGE_VLAN_STATE_PRESENT | NM_PLATFORM_BRIDGE_VLAN_STATE_UNTAGGED);
+}
+
+static void
+test_bridge_vlans_collect (void)
+{
+	guint8 state_cur[NM_BRIDGE_VLAN_VID_MAX + 1];
+	guint8 state_new[NM_BRIDGE_VLAN_VID_MAX + 1];
+	gs_free const NMPlatformBridgeVlan **vlans_del = NULL;
+	gs_free const NMPlatformBridgeVlan **vlans_add = NULL;
+	guint len;
+
+	{
+		const NMPlatformBridgeVlan cur[] = {
+			{ .vid_start = 10, .vid_end = 20 },
+			{ .vid_start = 30, .vid_end = 30, .untagged = TRUE },
+			{ .vid_start = 40, .vid_end = 40, .pvid = TRUE },
+		};
+		const NMPlatformBridgeVlan new[] = {
+			{ .vid_start = 10, .vid_end = 15 },
+			{ .vid_start = 30, .vid_end = 30 },
+			{ .vid_start = 40, .vid_end = 40, .pvid = TRUE },
+			{ .vid_start = 50, .vid_end = 50 },
+		};
+
+		_bridge_vlans_fill_state (state_cur, cur, G_N_ELEMENTS (cur));
+		_bridge_vlans_fill_state (state_new, new, G_N_ELEMENTS (new));
+
+		/* only the VLANs that go away are removed, merged into a range. */
+		vlans_del = _nm_platform_bridge_vlans_collect (state_cur, state_new, TRUE, &len);
+		g_assert_cmpint (len, ==, 1);
+		_assert_bridge_vlan (vlans_del[0], 16, 20, FALSE, FALSE);
+		g_assert (!vlans_del[1]);
+
+		/* only new and modified VLANs are set. */
+		vlans_add = _nm_platform_bridge_vlans_collect (state_cur, state_new, FALSE, &len);
+		g_assert_cmpint (len, ==, 2);
+		_assert_bridge_vlan (vlans_add[0], 30, 30, FALSE, FALSE);
+		_assert_bridge_vlan (vlans_add[1], 50, 50, FALSE, FALSE);
+		g_assert (!vlans_add[2]);
+
+		nm_clear_g_free (&vlans_del);
+		nm_clear_g_free (&vlans_add);
+
+		/* nothing to do, if the state is the same. */
+		vlans_del = _nm_platform_bridge_vlans_collect (state_new, state_new, TRUE, &len);
+		g_assert (!vlans_del);
+		g_assert_cmpint (len, ==, 0);
+		vlans_add = _nm_platform_bridge_vlans_collect (state_new, state_new, FALSE, &len);
+		g_assert (!vlans_add);
+		g_assert_cmpint (len, ==, 0);
+	}
+
+	{
+		const NMPlatformBridgeVlan cur[] = {
+			{ .vid_start = 1, .vid_end = 1, .pvid = TRUE, .untagged = TRUE },
+		};
+		const NMPlatformBridgeVlan new[] = {
+			{ .vid_start = 1,   .vid_end = 1, .untagged = TRUE },
+			{ .vid_start = 2,   .vid_end = 2, .pvid = TRUE, .untagged = TRUE },
+			{ .vid_start = 3,   .vid_end = 99, .untagged = TRUE },
+			{ .vid_start = 100, .vid_end = 199 },
+			{ .vid_start = 200, .vid_end = 299 },
+		};
+
+		_bridge_vlans_fill_state (state_cur, cur, G_N_ELEMENTS (cur));
+		_bridge_vlans_fill_state (state_new, new, G_N_ELEMENTS (new));
+
+		vlans_del = _nm_platform_bridge_vlans_collect (state_cur, state_new, TRUE, &len);
+		g_assert (!vlans_del);
+		g_assert_cmpint (len, ==, 0);
+
+		/* the PVID is never merged into a range, and ranges are only
+		 * merged with the same flags. */
+		vlans_add = _nm_platform_bridge_vlans_collect (state_cur, state_new, FALSE, &len);
+		g_assert_cmpint (len, ==, 4);
+		_assert_bridge_vlan (vlans_add[0], 1, 1, TRUE, FALSE);
+		_assert_bridge_vlan (vlans_add[1], 2, 2, TRUE, TRUE);
+		_assert_bridge_vlan (vlans_add[2], 3, 99, TRUE, FALSE);
+		_assert_bridge_vlan (vlans_add[3], 100, 299, FALSE, FALSE);
+		g_assert (!vlans_add[4]);
+
+		nm_clear_g_free (&vlans_del);
+		nm_clear_g_free (&vlans_add);
+	}
+
+	{
+		/* the bridge default PVID (300) is overruled by the PVID of the
+		 * setting. After it was applied, syncing again changes nothing. */
+		const NMPlatformBridgeVlan cur[] = {
+			{ .vid_start = 10,  .vid_end = 10,  .pvid = TRUE, .untagged = TRUE },
+			{ .vid_start = 300, .vid_end = 300, .untagged = TRUE },
+		};
+		const NMPlatformBridgeVlan new[] = {
+			{ .vid_start = 300, .vid_end = 300, .pvid = TRUE, .untagged = TRUE },
+			{ .vid_start = 10,  .vid_end = 10,  .pvid = TRUE, .untagged = TRUE },
+		};
+
+		g_assert_cmpint (_bridge_vlans_fill_state (state_cur, cur, G_N_ELEMENTS (cur)), ==, 10);
+		g_assert_cmpint (_bridge_vlans_fill_state (state_new, new, G_N_ELEMENTS (new)), ==, 10);
+
+		vlans_del = _nm_platform_bridge_vlans_collect (state_cur, state_new, TRUE, &len);
+		g_assert (!vlans_del);
+		vlans_add = _nm_platform_bridge_vlans_collect (state_cur, state_new, FALSE, &len);
+		g_assert (!vlans_add);
+		g_assert_cmpint (len, ==, 0);
+	}
+}
+
+/*****************************************************************************/
+
+static void
+test_qdisc_matches (void)
+{
+	const char *fq_codel = g_intern_static_string ("fq_codel");
+	NMPlatformQdisc known = {
+		.ifindex                = 5,
+		.kind                   = fq_codel,
+		.handle                 = 0,
+		.parent                 = TC_H_ROOT,
+		.fq_codel.ce_threshold  = NM_PLATFORM_FQ_CODEL_CE_THRESHOLD_DISABLED,
+		.fq_codel.memory_limit  = NM_PLATFORM_FQ_CODEL_MEMORY_LIMIT_UNSET,
+	};
+	NMPlatformQdisc plat = {
+		.ifindex                = 5,
+		.kind                   = fq_codel,
+		.handle                 = TC_H_MAKE (0x8001 << 16, 0),
+		.parent                 = TC_H_ROOT,
+		.info                   = 2,
+		.fq_codel.limit         = 10240,
+		.fq_codel.flows         = 1024,
+		.fq_codel.target        = 4999,
+		.fq_codel.interval      = 99999,
+		.fq_codel.quantum       = 1514,
+		.fq_codel.ce_threshold  = NM_PLATFORM_FQ_CODEL_CE_THRESHOLD_DISABLED,
+		.fq_codel.memory_limit  = 32 << 20,
+		.fq_codel.ecn           = TRUE,
+	};
+
+	/* kernel fills in the defaults, the handle and the reference count. */
+	g_assert (_nm_platform_qdisc_matches (&known, &plat));
+
+	/* explicitly set options must match. */
+	known.fq_codel.flows = 1024;
+	known.fq_codel.ecn = TRUE;
+	g_assert (_nm_platform_qdisc_matches (&known, &plat));
+	known.fq_codel.limit = 2000;
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+	known.fq_codel.limit = 0;
+	known.fq_codel.memory_limit = 16 << 20;
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+	known.fq_codel.memory_limit = NM_PLATFORM_FQ_CODEL_MEMORY_LIMIT_UNSET;
+
+	/* the threshold is only reported when it's enabled. */
+	known.fq_codel.ce_threshold = 0;
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+	known.fq_codel.ce_threshold = NM_PLATFORM_FQ_CODEL_CE_THRESHOLD_DISABLED;
+
+	/* a requested handle must match. */
+	known.handle = TC_H_MAKE (0x1234 << 16, 0);
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+	known.handle = plat.handle;
+	g_assert (_nm_platform_qdisc_matches (&known, &plat));
+
+	/* so do the parent and the kind. */
+	known.parent = TC_H_INGRESS;
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+	known.parent = TC_H_ROOT;
+	known.kind = g_intern_static_string ("sfq");
+	g_assert (!_nm_platform_qdisc_matches (&known, &plat));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -72,6 +318,9 @@ main (int argc, char **argv)
 	g_test_add_func ("/general/init_linux_platform", test_init_linux_platform);
 	g_test_add_func ("/general/link_get_all", test_link_get_all);
 	g_test_add_func ("/general/nm_platform_link_flags2str", test_nm_platform_link_flags2str);
+	g_test_add_func ("/general/bridge_vlans_to_state", test_bridge_vlans_to_state);
+	g_test_add_func ("/general/bridge_vlans_collect", test_bridge_vlans_collect);
+	g_test_add_func ("/general/qdisc_matches", test_qdisc_matches);
 
 	return g_test_run ();
 }
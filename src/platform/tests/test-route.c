@@ -469,6 +469,112 @@ test_ip4_zero_gateway (void)
 	nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
 }
 
+static void
+test_ip4_route_nexthop (void)
+{
+	const int IFINDEX = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME);
+	const guint32 NHID = 4711;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	nm_auto_nmpobj NMPObject *obj_nh = NULL;
+	const NMPlatformIP4Route *r;
+	NMDedupMultiIter iter;
+	NMPLookup lookup;
+	const NMPObject *o;
+	gboolean found = FALSE;
+	NMPlatformNexthop nh = {
+		.id = NHID,
+		.addr_family = AF_INET,
+		.ifindex = IFINDEX,
+		.gateway.addr4 = nmtst_inet4_from_string ("172.16.1.1"),
+	};
+	NMPlatformIP4Route rt = {
+		.ifindex = IFINDEX,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = nmtst_inet4_from_string ("172.17.1.0"),
+		.plen = 24,
+		.metric = 20,
+		.nhid = NHID,
+	};
+
+	g_assert (nm_platform_ip4_address_add (NM_PLATFORM_GET,
+	                                       IFINDEX,
+	                                       nmtst_inet4_from_string ("172.16.1.5"),
+	                                       24,
+	                                       nmtst_inet4_from_string ("172.16.1.5"),
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       NM_PLATFORM_LIFETIME_PERMANENT,
+	                                       0,
+	                                       NULL));
+	if (nmtstp_is_root_test ())
+		_wait_for_ipv4_addr_device_route (NM_PLATFORM_GET, 200, IFINDEX, nmtst_inet4_from_string ("172.16.1.5"), 24);
+
+	if (nm_platform_nexthop_add (NM_PLATFORM_GET, NMP_NLM_FLAG_REPLACE, &nh) < 0) {
+		g_test_skip ("Skipping test for nexthop objects: not supported by kernel");
+		goto out;
+	}
+
+	obj_nh = nmp_object_new (NMP_OBJECT_TYPE_NEXTHOP, (const NMPlatformObject *) &nh);
+	nmp_cache_iter_for_each (&iter,
+	                         nm_platform_lookup (NM_PLATFORM_GET,
+	                                             nmp_lookup_init_obj_type (&lookup,
+	                                                                       NMP_OBJECT_TYPE_NEXTHOP)),
+	                         &o) {
+		if (nmp_object_id_equal (o, obj_nh)) {
+			g_assert_cmpint (NMP_OBJECT_CAST_NEXTHOP (o)->ifindex, ==, IFINDEX);
+			g_assert_cmpint (NMP_OBJECT_CAST_NEXTHOP (o)->gateway.addr4, ==, nh.gateway.addr4);
+			found = TRUE;
+		}
+	}
+	g_assert (found);
+
+	/* the route references the nexthop. Kernel reports the device of the
+	 * nexthop, but we ignore its gateway. */
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_ip4_route_add (NM_PLATFORM_GET, NMP_NLM_FLAG_REPLACE, &rt)));
+	routes = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, IFINDEX);
+	g_assert (routes);
+	g_assert_cmpint (routes->len, ==, 1);
+	r = NMP_OBJECT_CAST_IP4_ROUTE (routes->pdata[0]);
+	g_assert_cmpint (r->nhid, ==, NHID);
+	g_assert_cmpint (r->ifindex, ==, IFINDEX);
+	g_assert_cmpint (r->gateway, ==, 0);
+	g_clear_pointer (&routes, g_ptr_array_unref);
+
+	/* changing the gateway of the nexthop leaves the route alone. */
+	nh.gateway.addr4 = nmtst_inet4_from_string ("172.16.1.2");
+	g_assert (NMTST_NM_ERR_SUCCESS (nm_platform_nexthop_add (NM_PLATFORM_GET, NMP_NLM_FLAG_REPLACE, &nh)));
+	g_assert (nmtstp_ip4_route_get (NM_PLATFORM_GET, IFINDEX, rt.network, rt.plen, rt.metric, 0));
+
+	/* routes referencing a nexthop group have no device and are ignored. */
+	if (   nmtstp_is_root_test ()
+	    && nmtstp_run_command ("ip nexthop add id %u group %u", NHID + 1, NHID) == 0) {
+		nmtstp_run_command_check ("ip route add 172.18.1.0/24 nhid %u", NHID + 1);
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+		g_assert (!nmtstp_ip4_route_get (NM_PLATFORM_GET, 0, nmtst_inet4_from_string ("172.18.1.0"), 24, 0, 0));
+		nmtstp_run_command_check ("ip nexthop del id %u", NHID + 1);
+	}
+
+	/* kernel removes the route together with the nexthop. */
+	g_assert (nm_platform_object_delete (NM_PLATFORM_GET, obj_nh));
+	NMTST_WAIT_ASSERT (200, {
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 10);
+		if (!nmtstp_ip4_route_get (NM_PLATFORM_GET, IFINDEX, rt.network, rt.plen, rt.metric, 0))
+			break;
+	});
+
+out:
+	if (nmtstp_is_root_test ()) {
+		nmtstp_run_command_check ("ip route flush dev %s", DEVICE_NAME);
+		nmtstp_run_command_check ("ip address flush dev %s", DEVICE_NAME);
+		nmtstp_wait_for_signal (NM_PLATFORM_GET, 50);
+	} else {
+		g_assert (nm_platform_ip4_address_delete (NM_PLATFORM_GET,
+		                                          IFINDEX,
+		                                          nmtst_inet4_from_string ("172.16.1.5"),
+		                                          24,
+		                                          nmtst_inet4_from_string ("172.16.1.5")));
+	}
+}
+
 static void
 test_ip4_route_options (gconstpointer test_data)
 {
@@ -1735,6 +1841,7 @@ _nmtstp_setup_tests (void)
 	add_test_func ("/route/ip4", test_ip4_route);
 	add_test_func ("/route/ip6", test_ip6_route);
 	add_test_func ("/route/ip4_metric0", test_ip4_route_metric0);
+	add_test_func ("/route/ip4_nexthop", test_ip4_route_nexthop);
 	add_test_func_data ("/route/ip4_options/1", test_ip4_route_options, GINT_TO_POINTER (1));
 	if (nmtstp_is_root_test ())
 		add_test_func_data ("/route/ip4_options/2", test_ip4_route_options, GINT_TO_POINTER (2));
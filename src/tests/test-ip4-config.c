@@ -8,6 +8,8 @@
 #include <arpa/inet.h>
 
 #include "nm-ip4-config.h"
+#include "nm-config.h"
+#include "nm-dbus-manager.h"
 #include "platform/nm-platform.h"
 
 #include "nm-test-utils-core.h"
@@ -359,6 +361,210 @@ test_strip_search_trailing_dot (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	GMainLoop *loop;
+	GVariant *properties_changed;
+	GVariant *legacy_properties_changed;
+} LargePropertyData;
+
+static void
+_large_property_signal_cb (GDBusConnection *connection,
+                           const char *sender_name,
+                           const char *object_path,
+                           const char *interface_name,
+                           const char *signal_name,
+                           GVariant *parameters,
+                           gpointer user_data)
+{
+	LargePropertyData *data = user_data;
+
+	g_assert_cmpstr (signal_name, ==, "PropertiesChanged");
+
+	if (nm_streq (interface_name, "org.freedesktop.DBus.Properties")) {
+		g_assert (!data->properties_changed);
+		data->properties_changed = g_variant_ref (parameters);
+	} else {
+		/* the legacy signal is emitted last. */
+		g_assert_cmpstr (interface_name, ==, NM_DBUS_INTERFACE_IP4_CONFIG);
+		g_assert (!data->legacy_properties_changed);
+		data->legacy_properties_changed = g_variant_ref (parameters);
+		g_main_loop_quit (data->loop);
+	}
+}
+
+static void
+_large_property_get_cb (GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	GVariant **p_ret = user_data;
+	GError *error = NULL;
+
+	*p_ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	g_assert_no_error (error);
+}
+
+static void
+test_dbus_large_property (void)
+{
+	gs_unref_object GTestDBus *test_bus = NULL;
+	gs_unref_object GDBusConnection *client = NULL;
+	gs_unref_object NMConfigData *config_data = NULL;
+	gs_unref_object NMIP4Config *config = NULL;
+	gs_unref_keyfile GKeyFile *keyfile = NULL;
+	gs_free char *dbus_daemon = NULL;
+	gs_unref_variant GVariant *changed = NULL;
+	gs_unref_variant GVariant *value = NULL;
+	gs_unref_variant GVariant *ret = NULL;
+	gs_free const char **invalidated = NULL;
+	NMDBusManager *dbus_manager;
+	LargePropertyData data = { };
+	NMPlatformIP4Route route;
+	const char *path;
+	GError *error = NULL;
+	guint threshold;
+	guint subscription_id;
+	int i;
+
+	dbus_daemon = g_find_program_in_path ("dbus-daemon");
+	if (!dbus_daemon) {
+		g_test_skip ("dbus-daemon not available");
+		return;
+	}
+
+	keyfile = g_key_file_new ();
+	g_key_file_set_string (keyfile,
+	                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                       NM_CONFIG_KEYFILE_KEY_MAIN_DBUS_LARGE_PROPERTY_THRESHOLD,
+	                       "2");
+	config_data = nm_config_data_new (NULL, NULL, NULL, keyfile, NULL);
+	threshold = nm_config_data_get_value_int64 (config_data,
+	                                            NM_CONFIG_KEYFILE_GROUP_MAIN,
+	                                            NM_CONFIG_KEYFILE_KEY_MAIN_DBUS_LARGE_PROPERTY_THRESHOLD,
+	                                            10, 0, G_MAXUINT32, 0);
+	g_assert_cmpint (threshold, ==, 2);
+
+	/* NMDBusManager connects to the system bus. Point it to a private bus. */
+	test_bus = g_test_dbus_new (G_TEST_DBUS_NONE);
+	g_test_dbus_up (test_bus);
+	g_setenv ("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address (test_bus), TRUE);
+
+	dbus_manager = nm_dbus_manager_get ();
+	g_assert (nm_dbus_manager_acquire_bus (dbus_manager, TRUE));
+	nm_dbus_manager_set_large_property_threshold (dbus_manager, threshold);
+	nm_dbus_manager_start (dbus_manager, NULL, NULL);
+
+	client = g_dbus_connection_new_for_address_sync (g_test_dbus_get_bus_address (test_bus),
+	                                                 G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT
+	                                                 | G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+	                                                 NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	config = nmtst_ip4_config_new (1);
+	path = nm_dbus_object_export (NM_DBUS_OBJECT (config));
+	g_assert (path);
+
+	data.loop = g_main_loop_new (NULL, FALSE);
+	subscription_id = g_dbus_connection_signal_subscribe (client,
+	                                                      NULL,
+	                                                      NULL,
+	                                                      "PropertiesChanged",
+	                                                      path,
+	                                                      NULL,
+	                                                      G_DBUS_SIGNAL_FLAGS_NONE,
+	                                                      _large_property_signal_cb,
+	                                                      &data,
+	                                                      NULL);
+
+	/* let the subscription reach the bus before emitting signals. */
+	g_dbus_connection_call (client,
+	                        "org.freedesktop.DBus",
+	                        "/org/freedesktop/DBus",
+	                        "org.freedesktop.DBus",
+	                        "GetId",
+	                        NULL,
+	                        G_VARIANT_TYPE ("(s)"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        NULL,
+	                        _large_property_get_cb,
+	                        &ret);
+	while (!ret)
+		g_main_context_iteration (NULL, TRUE);
+	nm_clear_g_variant (&ret);
+
+	/* 3 addresses and 3 routes are above the threshold. The nameserver
+	 * is small and goes into both signals. */
+	g_object_freeze_notify (G_OBJECT (config));
+	for (i = 0; i < 3; i++) {
+		char addr_str[INET_ADDRSTRLEN];
+		char net_str[INET_ADDRSTRLEN];
+
+		nm_sprintf_buf (addr_str, "192.168.%d.10", i + 1);
+		nm_ip4_config_add_address (config, nmtst_platform_ip4_address (addr_str, NULL, 24));
+
+		nm_sprintf_buf (net_str, "10.%d.0.0", i + 1);
+		route = *nmtst_platform_ip4_route (net_str, 16, "192.168.1.1");
+		nm_ip4_config_add_route (config, &route, NULL);
+	}
+	nm_ip4_config_add_nameserver (config, nmtst_inet4_from_string ("4.2.2.1"));
+	g_object_thaw_notify (G_OBJECT (config));
+
+	if (!nmtst_main_loop_run (data.loop, 5000))
+		g_assert_not_reached ();
+
+	g_assert (data.properties_changed);
+	g_variant_get (data.properties_changed, "(&s@a{sv}^a&s)", NULL, &changed, &invalidated);
+	for (i = 0; i < 4; i++) {
+		const char *name = ((const char *const[]) { "Addresses", "AddressData", "Routes", "RouteData" })[i];
+
+		g_assert (g_strv_contains (invalidated, name));
+		value = g_variant_lookup_value (changed, name, NULL);
+		g_assert (!value);
+	}
+	g_assert (!g_strv_contains (invalidated, "Nameservers"));
+	value = g_variant_lookup_value (changed, "Nameservers", G_VARIANT_TYPE ("au"));
+	g_assert (value);
+	nm_clear_g_variant (&value);
+	nm_clear_g_variant (&changed);
+
+	g_assert (data.legacy_properties_changed);
+	g_variant_get (data.legacy_properties_changed, "(@a{sv})", &changed);
+	g_assert (!g_variant_lookup_value (changed, "Addresses", NULL));
+	g_assert (!g_variant_lookup_value (changed, "AddressData", NULL));
+	g_assert (!g_variant_lookup_value (changed, "Routes", NULL));
+	g_assert (!g_variant_lookup_value (changed, "RouteData", NULL));
+	value = g_variant_lookup_value (changed, "Nameservers", G_VARIANT_TYPE ("au"));
+	g_assert (value);
+	nm_clear_g_variant (&value);
+
+	/* the value is still available on request. */
+	g_dbus_connection_call (client,
+	                        NM_DBUS_SERVICE,
+	                        path,
+	                        "org.freedesktop.DBus.Properties",
+	                        "Get",
+	                        g_variant_new ("(ss)", NM_DBUS_INTERFACE_IP4_CONFIG, "RouteData"),
+	                        G_VARIANT_TYPE ("(v)"),
+	                        G_DBUS_CALL_FLAGS_NONE,
+	                        -1,
+	                        NULL,
+	                        _large_property_get_cb,
+	                        &ret);
+	while (!ret)
+		g_main_context_iteration (NULL, TRUE);
+	g_variant_get (ret, "(v)", &value);
+	g_assert_cmpint (g_variant_n_children (value), ==, 3);
+
+	g_dbus_connection_signal_unsubscribe (client, subscription_id);
+	nm_dbus_object_unexport (NM_DBUS_OBJECT (config));
+	nm_clear_g_variant (&data.properties_changed);
+	nm_clear_g_variant (&data.legacy_properties_changed);
+	g_main_loop_unref (data.loop);
+	g_dbus_connection_close_sync (client, NULL, NULL);
+	g_test_dbus_down (test_bus);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -373,6 +579,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
 	g_test_add_func ("/ip4-config/merge-subtract-mtu", test_merge_subtract_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip4-config/dbus-large-property", test_dbus_large_property);
 
 	return g_test_run ();
 }
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Copyright (C) 2020 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+/* The messages that reached the logging backend. Before nm_logging_init(),
+ * nm-logging writes them with g_log(), where the handler below collects them.
+ * The writer thread can be blocked in the handler, to simulate a slow
+ * logging backend. */
+static struct {
+	GMutex lock;
+	GCond cond;
+	GThread *main_thread;
+	GPtrArray *msgs;
+	bool block_writer:1;
+	bool writer_blocked:1;
+} gl_test;
+
+static void
+_log_handler (const char *log_domain,
+              GLogLevelFlags log_level,
+              const char *message,
+              gpointer user_data)
+{
+	g_mutex_lock (&gl_test.lock);
+	if (g_thread_self () != gl_test.main_thread) {
+		while (gl_test.block_writer) {
+			gl_test.writer_blocked = TRUE;
+			g_cond_broadcast (&gl_test.cond);
+			g_cond_wait (&gl_test.cond, &gl_test.lock);
+		}
+		gl_test.writer_blocked = FALSE;
+	}
+	g_ptr_array_add (gl_test.msgs, g_strdup (message));
+	g_mutex_unlock (&gl_test.lock);
+}
+
+static GPtrArray *
+_msgs_take (void)
+{
+	GPtrArray *msgs;
+
+	g_mutex_lock (&gl_test.lock);
+	msgs = g_steal_pointer (&gl_test.msgs);
+	gl_test.msgs = g_ptr_array_new_with_free_func (g_free);
+	g_mutex_unlock (&gl_test.lock);
+	return msgs;
+}
+
+static void
+_msgs_clear (void)
+{
+	g_ptr_array_unref (_msgs_take ());
+}
+
+static void
+_set_block_writer (gboolean block)
+{
+	g_mutex_lock (&gl_test.lock);
+	gl_test.block_writer = block;
+	g_cond_broadcast (&gl_test.cond);
+	g_mutex_unlock (&gl_test.lock);
+}
+
+static void
+_wait_writer_blocked (void)
+{
+	g_mutex_lock (&gl_test.lock);
+	while (!gl_test.writer_blocked)
+		g_cond_wait (&gl_test.cond, &gl_test.lock);
+	g_mutex_unlock (&gl_test.lock);
+}
+
+#define _assert_msg(msgs, idx, ...) \
+	G_STMT_START { \
+		GPtrArray *const _msgs = (msgs); \
+		const guint _idx = (idx); \
+		gs_free char *_expected = g_strdup_printf (__VA_ARGS__); \
+		\
+		g_assert_cmpint (_idx, <, _msgs->len); \
+		if (!g_str_has_suffix (_msgs->pdata[_idx], _expected)) \
+			g_error ("message #%u \"%s\" does not end with \"%s\"", _idx, (char *) _msgs->pdata[_idx], _expected); \
+	} G_STMT_END
+
+/*****************************************************************************/
+
+static void
+test_flight_recorder (void)
+{
+	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	char long_msg[301];
+	int i;
+
+	g_assert (nm_logging_setup ("INFO", "CORE,DHCP4", NULL, NULL));
+
+	/* the number of records gets rounded up to 4. */
+	nm_logging_init_flight_recorder (3, NULL);
+
+	/* all levels get enabled for recording, but only the configured ones
+	 * are written to the backend. */
+	g_assert (nm_logging_enabled (LOGL_TRACE, LOGD_DHCP4));
+	g_assert (nm_logging_enabled (LOGL_TRACE, LOGD_WIFI));
+	g_assert (!nm_logging_output_enabled (LOGL_TRACE, LOGD_DHCP4));
+	g_assert (!nm_logging_output_enabled (LOGL_DEBUG, LOGD_CORE));
+	g_assert (!nm_logging_output_enabled (LOGL_INFO, LOGD_WIFI));
+	g_assert (nm_logging_output_enabled (LOGL_INFO, LOGD_DHCP4));
+	g_assert_cmpint (nm_logging_get_level (LOGD_DHCP4), ==, LOGL_INFO);
+	g_assert_cmpint (nm_logging_get_level (LOGD_WIFI), ==, _LOGL_OFF);
+
+	_msgs_clear ();
+
+	for (i = 0; i < 6; i++)
+		nm_log_trace (LOGD_DHCP4, "record %d", i);
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 0);
+	nm_clear_pointer (&msgs, g_ptr_array_unref);
+
+	/* only the most recent records are kept, oldest first. */
+	nm_logging_flight_recorder_dump (0);
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 5);
+	_assert_msg (msgs, 0, "flight-recorder: dump the last 4 records");
+	for (i = 0; i < 4; i++)
+		_assert_msg (msgs, i + 1, "flight-recorder[DHCP4]: record %d", i + 2);
+	nm_clear_pointer (&msgs, g_ptr_array_unref);
+
+	/* dumping does not consume the records. */
+	nm_logging_flight_recorder_dump (2);
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 3);
+	_assert_msg (msgs, 0, "flight-recorder: dump the last 2 records");
+	_assert_msg (msgs, 1, "flight-recorder[DHCP4]: record 4");
+	_assert_msg (msgs, 2, "flight-recorder[DHCP4]: record 5");
+	nm_clear_pointer (&msgs, g_ptr_array_unref);
+
+	/* messages that are written are recorded too, long ones truncated. */
+	memset (long_msg, 'x', sizeof (long_msg) - 1);
+	long_msg[sizeof (long_msg) - 1] = '\0';
+	nm_log_info (LOGD_DHCP4, "%s", long_msg);
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 1);
+	_assert_msg (msgs, 0, "%s", long_msg);
+	nm_clear_pointer (&msgs, g_ptr_array_unref);
+
+	nm_logging_flight_recorder_dump (1);
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 2);
+	_assert_msg (msgs, 1, "flight-recorder[DHCP4]: %.223s", long_msg);
+	g_assert (!g_str_has_suffix (msgs->pdata[1], long_msg));
+}
+
+/*****************************************************************************/
+
+static void
+test_async_writer_flush (void)
+{
+	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	int i;
+
+	g_assert (nm_logging_setup ("DEBUG", "CORE", NULL, NULL));
+	nm_logging_init_async_writer ();
+	_msgs_clear ();
+
+	for (i = 0; i < 100; i++)
+		nm_log_dbg (LOGD_CORE, "async %d", i);
+
+	/* shutting down writes all pending messages, in order. */
+	nm_logging_shutdown ();
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 100);
+	for (i = 0; i < 100; i++)
+		_assert_msg (msgs, i, "async %d", i);
+	nm_clear_pointer (&msgs, g_ptr_array_unref);
+
+	/* afterwards, messages are written synchronously again. */
+	nm_log_dbg (LOGD_CORE, "sync");
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, ==, 1);
+	_assert_msg (msgs, 0, "sync");
+}
+
+static void
+test_async_writer_drop (void)
+{
+	gs_unref_ptrarray GPtrArray *msgs = NULL;
+	const int N_MSGS = 20000;
+	const char *s;
+	gint64 n_dropped;
+	guint i;
+
+	g_assert (nm_logging_setup ("DEBUG", "CORE", NULL, NULL));
+	nm_logging_init_async_writer ();
+	_msgs_clear ();
+
+	/* stall the writer thread while it writes the first message, so that
+	 * the queue fills up. */
+	_set_block_writer (TRUE);
+	nm_log_dbg (LOGD_CORE, "async %d", 0);
+	_wait_writer_blocked ();
+
+	for (i = 1; i < N_MSGS; i++)
+		nm_log_dbg (LOGD_CORE, "async %u", i);
+
+	_set_block_writer (FALSE);
+	nm_logging_shutdown ();
+
+	/* the first queued messages are written, the others got dropped. The
+	 * writer reports their number before the next message. */
+	msgs = _msgs_take ();
+	g_assert_cmpint (msgs->len, >, 2);
+	_assert_msg (msgs, 0, "async 0");
+
+	s = strstr (msgs->pdata[1], "logging: dropped ");
+	g_assert (s);
+	n_dropped = g_ascii_strtoll (&s[NM_STRLEN ("logging: dropped ")], NULL, 10);
+	g_assert_cmpint (n_dropped, >, 0);
+	g_assert_cmpint (n_dropped + msgs->len - 1, ==, N_MSGS);
+
+	for (i = 2; i < msgs->len; i++)
+		_assert_msg (msgs, i, "async %u", i - 1);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, "INFO", "DEFAULT");
+
+	gl_test.main_thread = g_thread_self ();
+	gl_test.msgs = g_ptr_array_new_with_free_func (g_free);
+	g_log_set_handler ("NetworkManager",
+	                   G_LOG_LEVEL_MASK,
+	                   _log_handler,
+	                   NULL);
+
+	g_test_add_func ("/logging/flight_recorder", test_flight_recorder);
+	g_test_add_func ("/logging/async_writer_flush", test_async_writer_flush);
+	g_test_add_func ("/logging/async_writer_drop", test_async_writer_drop);
+
+	return g_test_run ();
+}
@@ -109,6 +109,114 @@ test_hw_addr_gen_stable_eth (void)
 
 /*****************************************************************************/
 
+#define BATCH_N_DEVICES 2000
+#define BATCH_N_STAGES  3
+
+typedef struct {
+	NMUtilsBatchIdle *batch;
+	NMUtilsBatchIdleEntry entry4;
+	NMUtilsBatchIdleEntry entry6;
+	guint stage;
+	guint n_stage6;
+} BatchDevice;
+
+static gboolean batch_stage6_seen;
+
+static void
+_batch_stage4_cb (gpointer user_data)
+{
+	BatchDevice *d = user_data;
+
+	/* within one batch, all priority 0 entries run first. */
+	g_assert (!batch_stage6_seen);
+
+	d->stage++;
+	if (d->stage < BATCH_N_STAGES)
+		nm_utils_batch_idle_queue (d->batch, &d->entry4, 0);
+	else
+		nm_utils_batch_idle_queue (d->batch, &d->entry6, 1);
+}
+
+static void
+_batch_stage6_cb (gpointer user_data)
+{
+	BatchDevice *d = user_data;
+
+	batch_stage6_seen = TRUE;
+	d->n_stage6++;
+}
+
+static void
+test_batch_idle (void)
+{
+	NMUtilsBatchIdle batch = NM_UTILS_BATCH_IDLE_INIT (batch);
+	gs_free BatchDevice *devices = g_new0 (BatchDevice, BATCH_N_DEVICES);
+	guint n_iterations = 0;
+	gint64 start;
+	gint64 elapsed;
+	guint i;
+
+	for (i = 0; i < BATCH_N_DEVICES; i++) {
+		BatchDevice *d = &devices[i];
+
+		d->batch = &batch;
+		nm_utils_batch_idle_entry_init (&d->entry4, _batch_stage4_cb, d);
+		nm_utils_batch_idle_entry_init (&d->entry6, _batch_stage6_cb, d);
+		nm_utils_batch_idle_queue (&batch, &d->entry4, 0);
+
+		/* queueing the same entry twice doesn't invoke it twice. */
+		if (i % 2)
+			nm_utils_batch_idle_queue (&batch, &d->entry4, 0);
+
+		/* unqueued entries are not invoked. */
+		if (i % 3 == 0) {
+			nm_utils_batch_idle_queue (&batch, &d->entry6, 1);
+			nm_utils_batch_idle_unqueue (&d->entry6);
+			g_assert (!nm_utils_batch_idle_entry_is_queued (&d->entry6));
+		}
+	}
+
+	start = g_get_monotonic_time ();
+
+	while (batch.idle_id) {
+		batch_stage6_seen = FALSE;
+		g_main_context_iteration (NULL, TRUE);
+		n_iterations++;
+
+		/* every device progresses by exactly one stage per
+		 * mainloop iteration. Entries queued while dispatching
+		 * are handled by the next batch. */
+		for (i = 0; i < BATCH_N_DEVICES; i++) {
+			g_assert_cmpint (devices[i].stage, ==, MIN (n_iterations, BATCH_N_STAGES));
+			g_assert_cmpint (devices[i].n_stage6, ==, n_iterations > BATCH_N_STAGES ? 1 : 0);
+		}
+	}
+
+	elapsed = g_get_monotonic_time () - start;
+
+	g_assert_cmpint (n_iterations, ==, BATCH_N_STAGES + 1);
+
+	g_test_message ("batch-idle: %u devices with %u stages took %u mainloop iterations and %.3f msec",
+	                (guint) BATCH_N_DEVICES,
+	                (guint) BATCH_N_STAGES + 1,
+	                n_iterations,
+	                elapsed / 1000.0);
+
+	/* a very generous bound, this only catches a pathological
+	 * (e.g. quadratic) dispatch. */
+	g_assert_cmpint (elapsed, <, 5 * G_USEC_PER_SEC);
+
+	/* clearing a batch with pending entries unqueues them. */
+	nm_utils_batch_idle_queue (&batch, &devices[0].entry4, 0);
+	nm_utils_batch_idle_queue (&batch, &devices[0].entry6, 1);
+	nm_utils_batch_idle_clear (&batch);
+	g_assert (!batch.idle_id);
+	g_assert (!nm_utils_batch_idle_entry_is_queued (&devices[0].entry4));
+	g_assert (!nm_utils_batch_idle_entry_is_queued (&devices[0].entry6));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -118,6 +226,7 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/utils/stable_privacy", test_stable_privacy);
 	g_test_add_func ("/utils/hw_addr_gen_stable_eth", test_hw_addr_gen_stable_eth);
+	g_test_add_func ("/utils/batch_idle", test_batch_idle);
 
 	return g_test_run ();
 }
@@ -22,12 +22,14 @@ fi
 for dir in "${pkgconfdir}/conf.d" \
            "${pkgconfdir}/system-connections" \
            "${pkgconfdir}/dispatcher.d/no-wait.d" \
+           "${pkgconfdir}/dispatcher.d/parallel.d" \
            "${pkgconfdir}/dispatcher.d/pre-down.d" \
            "${pkgconfdir}/dispatcher.d/pre-up.d" \
            "${pkgconfdir}/dnsmasq.d" \
            "${pkgconfdir}/dnsmasq-shared.d" \
            "${pkglibdir}/conf.d" \
            "${pkglibdir}/dispatcher.d/no-wait.d" \
+           "${pkglibdir}/dispatcher.d/parallel.d" \
            "${pkglibdir}/dispatcher.d/pre-down.d" \
            "${pkglibdir}/dispatcher.d/pre-up.d" \
            "${pkglibdir}/system-connections" \